@@ -42,6 +42,7 @@ extern "C" {
 #define ID_SCVP_PARAM_SEI_VIEWPORT         1006
 #define ID_SCVP_BITSTREAMS_HEADER          1007
 #define ID_SCVP_RWPK_INFO                  1008
+#define ID_SCVP_OUTPUT_SEGMENTS            1009
 #define DEFAULT_REGION_NUM                 1000
 
 typedef enum SliceType {
@@ -329,6 +330,31 @@ typedef struct PARAM_BSHEADER
     int64_t size;
 }Param_BSHeader;
 
+//!
+//! \brief  This structure is for one piece of the output bitstream
+//!
+typedef struct PARAM_BSSEGMENT
+{
+    uint8_t  *data;
+    uint32_t  size;
+}Param_BSSegment;
+
+//!
+//! \brief  This structure is for the gather list of the output bitstream, the output frame is
+//!         the segments concatenated in order. The segments point to the memory of the library
+//!         or to the input bitstreams directly, so they are valid until the next I360SCVP_process
+//!         and only while the input buffers are kept unchanged
+//!
+//! \param    segments,     output,   the segments in the output order, owned by the library
+//! \param    segmentsNum,  output,   the number of the segments
+//! \param    totalSize,    output,   the total length of the segments
+typedef struct PARAM_BSSEGMENTS
+{
+    Param_BSSegment *segments;
+    uint32_t         segmentsNum;
+    uint32_t         totalSize;
+}Param_BSSegments;
+
 //!
 //! \brief  This structure is for the pitcure parameters
 //!
@@ -402,6 +428,64 @@ typedef struct PARAM_VIEWPORT_OUTPUT
     int32_t yTopLeftNet;
 }Param_ViewportOutput;
 
+//!
+//! \brief  This structure is for the incremental tile selection, which compares the pose with
+//!         the pose of the previous selection. While the viewing direction moves less than the
+//!         hysteresis angle, the previous tiles are kept and the selection is skipped; else the
+//!         tiles are selected again and the difference to the previous tiles is output.
+//!         The caller keeps pPrevPose at the pose of the last selection, which is the pose
+//!         passed when bReselected is output as true, so slow drift is still detected.
+//!
+//! \param    pPrevPose,        input,     the pose of the previous selection, NULL to force the selection
+//! \param    pPrevTiles,       input,     the tiles of the previous selection
+//! \param    prevTilesNum,     input,     the number of the previous tiles
+//! \param    hysteresis,       input,     the angle in degree which the viewing direction can move without the selection
+//! \param    pTiles,           output,    the tiles in the viewport, allocated by the caller apart from pPrevTiles
+//! \param    tilesNum,         output,    the number of the tiles in the viewport
+//! \param    pAddedTiles,      output,    the tiles not in the previous tiles, allocated by the caller, can be NULL
+//! \param    addedTilesNum,    output,    the number of the added tiles
+//! \param    pRemovedTiles,    output,    the previous tiles not in the viewport any more, allocated by the caller, can be NULL
+//! \param    removedTilesNum,  output,    the number of the removed tiles
+//! \param    bReselected,      output,    whether the tiles are selected again for the pose
+typedef struct PARAM_TILESDELTA
+{
+    HeadPose *pPrevPose;
+    TileDef  *pPrevTiles;
+    int32_t   prevTilesNum;
+    float     hysteresis;
+    TileDef  *pTiles;
+    int32_t   tilesNum;
+    TileDef  *pAddedTiles;
+    int32_t   addedTilesNum;
+    TileDef  *pRemovedTiles;
+    int32_t   removedTilesNum;
+    bool      bReselected;
+}Param_TilesDelta;
+
+//!
+//! \brief  This structure is for the tile selection of many poses in one call, the poses
+//!         are selected in parallel on the viewport instances of the worker threads,
+//!         apart from the viewport of the handle.
+//!
+//! \param    pPoses,            input,     the poses, only the yaw and pitch are used
+//! \param    posesNum,          input,     the number of the poses
+//! \param    maxTilesNum,       input,     the max tiles number of one pose, the stride of pTiles
+//! \param    pTiles,            output,    the tiles of the pose i start from pTiles[i * maxTilesNum], allocated by the caller
+//! \param    pTilesNum,         output,    the tiles number of each pose, <=0 if the selection of the pose fails,
+//!                                         allocated by the caller
+//! \param    pViewportOutputs,  output,    the viewport output of each pose, allocated by the caller, can be NULL
+//! \param    pContentCoverages, output,    the content coverage of each pose, allocated by the caller, can be NULL
+typedef struct PARAM_TILESBATCH
+{
+    HeadPose             *pPoses;
+    int32_t               posesNum;
+    int32_t               maxTilesNum;
+    TileDef              *pTiles;
+    int32_t              *pTilesNum;
+    Param_ViewportOutput *pViewportOutputs;
+    CCDef                *pContentCoverages;
+}Param_TilesBatch;
+
 //!
 //! \brief  This structure is for the view port parameters
 //!
@@ -463,6 +547,8 @@ typedef struct INPUT_ONESTREAM_IFO
 //! \param    VUI_enable,            input,           the flag indicates Video Usability Information enable or not
 //! \param    pTiledBitstream,       input,           this is pointer, which points all of the bistreams
 //! \param    sliceType,             output,          the slice type[I(2), P(1)] of the input bistream
+//! \param    mergeThreadNum,        input,           the threads number to merge the tiles, 0 or 1 means the tiles are
+//!                                                    merged in the calling thread
 typedef struct PARAM_STREAMSTITCHINFO
 {
     bool                   AUD_enable;
@@ -470,6 +556,7 @@ typedef struct PARAM_STREAMSTITCHINFO
     param_oneStream_info **pTiledBitstream;
     uint32_t               sliceType;
     uint32_t               pts;
+    int32_t                mergeThreadNum;
 }param_streamStitchInfo;
 
 //!
@@ -498,6 +585,9 @@ typedef struct PARAM_STREAMSTITCHINFO
 //! \param    pOutputSEI,         output,   the buffer for the output SEI bistream, mainly RWPK, just used in the usedType=E_MERGE_AND_VIEWPORT
 //! \param    outputSEILen,       output,   the length of the output SEI bistream, just used in the usedType=E_MERGE_AND_VIEWPORT
 //! \param    timeStamp,          input,    using timestamp to track frame, especially used in the E_MERGE_AND_VIEWPORT use case
+//! \param    outputSegmentsEnable,input,   output the frame as a gather list got by ID_SCVP_OUTPUT_SEGMENTS instead of copying it
+//!                                         into pOutputBitstream, just used in the usedType=E_STREAM_STITCH_ONLY & E_MERGE_AND_VIEWPORT,
+//!                                         pOutputBitstream can be NULL then for E_STREAM_STITCH_ONLY
 //!
 typedef struct PARAM_360SCVP
 {
@@ -525,6 +615,7 @@ typedef struct PARAM_360SCVP
     PluginDef              pluginDef;
     uint32_t               timeStamp;
     void                  *logFunction;       //external log callback function pointer, NULL if external log is not used
+    bool                   outputSegmentsEnable;
 }param_360SCVP;
 
 //!
@@ -547,6 +638,41 @@ void * I360SCVP_Init(param_360SCVP* pParam360SCVP);
 //!             null, if the creation fails
 void * I360SCVP_New(void* p360SCVPHandle);
 
+//!
+//! \brief      This function creates a context, the read only state which many handles share: the parameter sets
+//!             parsed from the input bitstream and the initialized viewport with its tile tables. The context is
+//!             never changed after the creation, so the sessions can be created from it in any thread without locks.
+//!             It supports the usedType E_STREAM_STITCH_ONLY, E_PARSER_ONENAL, E_PARSER_FOR_CLIENT and E_VIEWPORT_ONLY,
+//!             except the planar video which needs the tile selection plugin
+//! \param      param_360SCVP* pParam360SCVP, input, refer to the structure param_360SCVP, as I360SCVP_Init
+//!
+//! \return     void *, the context, which is released by I360SCVP_DestroyContext
+//!             not null, if the creation is ok
+//!             null, if the creation fails
+void * I360SCVP_CreateContext(param_360SCVP* pParam360SCVP);
+
+//!
+//! \brief      This function creates a session, a handle which starts from the state of the context instead of the
+//!             initialization, so it is much cheaper than I360SCVP_Init. The session is used as the handle of
+//!             I360SCVP_Init by one thread at a time, and it is released by I360SCVP_unInit. The session keeps
+//!             the context alive until it is released
+//! \param      void* p360SCVPContext, input, which is created by the I360SCVP_CreateContext function
+//!
+//! \return     void *, the new session handle
+//!             not null, if the creation is ok
+//!             null, if the creation fails
+void * I360SCVP_CreateSession(void* p360SCVPContext);
+
+//!
+//! \brief      This function releases the context, it is freed when the sessions created from it are released too
+//! \param      void* p360SCVPContext, input, which is created by the I360SCVP_CreateContext function
+//!
+//! \return     int32_t, the status of the function.
+//!     0,      if succeed
+//!     not 0,  if fail
+//!
+int32_t I360SCVP_DestroyContext(void* p360SCVPContext);
+
 //!
 //! \brief      This function completes the stitch, this is to say, according to the viewport information to select the tiles
 //!             and then stitch each tiles into one frame bitstream.
@@ -621,6 +747,35 @@ int32_t I360SCVP_getFixedNumTiles(TileDef* pOutTile, Param_ViewportOutput* pPara
 //!
 int32_t I360SCVP_getTilesInViewport(TileDef* pOutTile, Param_ViewportOutput* pParamViewPortOutput, void* p360SCVPHandle);
 
+//!
+//! \brief    This function selects the tiles for the pose incrementally, refer to the structure Param_TilesDelta.
+//!           The small moves of the pose inside the hysteresis keep the previous tiles without the selection,
+//!           and the added and removed tiles are output for the larger moves.
+//!
+//! \param    HeadPose*              pose,                  input,  the current pose
+//! \param    Param_TilesDelta*      pTilesDelta,           input and output, please refer to the structure Param_TilesDelta
+//! \param    Param_ViewportOutput*  pParamViewPortOutput,  output, please refer to the structure Param_ViewportOutput
+//! \param    void*                  p360SCVPHandle,        input,  which is created by the I360SVCP_Init function
+//!
+//! \return   int32_t, the number of the tiles inside the viewport.
+//!           <=0, if fail
+//!
+int32_t I360SCVP_getTilesInViewportDelta(HeadPose* pose, Param_TilesDelta* pTilesDelta, Param_ViewportOutput* pParamViewPortOutput, void* p360SCVPHandle);
+
+//!
+//! \brief    This function selects the tiles of many poses in one call, refer to the structure Param_TilesBatch.
+//!           It gives the same tiles as I360SCVP_setViewPortEx and I360SCVP_getTilesInViewport for each pose,
+//!           without changing the viewport of the handle, and it can be called from multiple threads on one handle.
+//!
+//! \param    Param_TilesBatch*  pTilesBatch,     input and output, please refer to the structure Param_TilesBatch
+//! \param    void*              p360SCVPHandle,  input,  which is created by the I360SVCP_Init function
+//!
+//! \return   int32_t, the status of the function.
+//!           0,     if the tiles of all the poses are selected
+//!           not 0, if fail, the failed poses have pTilesNum <= 0
+//!
+int32_t I360SCVP_getTilesInViewportBatch(Param_TilesBatch* pTilesBatch, void* p360SCVPHandle);
+
 //!
 //! \brief    This function provides the parsing NAL function, can give the slice type, tileCols number, tileRows number and nal information
 //!           if it is the Slice, must provide the slice header length; if SEI, provide the SEI payload type
@@ -763,6 +918,20 @@ int32_t I360SCVP_SetParameter(void* p360SCVPHandle, int32_t paramID, void* pValu
 //!
 int32_t I360SCVP_GetTilesByLegacyWay(TileDef* pOutTile, void* p360SCVPHandle);
 
+//!
+//! \brief    This function copies the gather list of the output bitstream into one contiguous buffer,
+//!           for the consumers which need the whole frame in one buffer.
+//!
+//! \param    Param_BSSegments*  pSegments,   input,     the gather list got by ID_SCVP_OUTPUT_SEGMENTS
+//! \param    uint8_t*           pOutput,     output,    the buffer for the whole frame
+//! \param    uint32_t           outputSize,  input,     the size of the buffer
+//!
+//! \return   int32_t, the length of the whole frame.
+//!           >=0, if succeed
+//!           <0,  if fail, for example the buffer is not enough
+//!
+int32_t I360SCVP_CoalesceSegments(Param_BSSegments* pSegments, uint8_t* pOutput, uint32_t outputSize);
+
 //! \brief    This function can set the logcallback funciton.
 //!
 //! \param    void*     p360SCVPHandle,  input,     which is created by the I360SVCP_Init function
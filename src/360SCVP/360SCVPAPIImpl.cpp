@@ -35,6 +35,7 @@
 #include "360SCVPHevcEncHdr.h"
 #include "360SCVPLog.h"
 #include "360SCVPImpl.h"
+#include "360SCVPContext.h"
 
 void* I360SCVP_Init(param_360SCVP* pParam360SCVP)
 {
@@ -62,6 +63,41 @@ void* I360SCVP_New(void* p360SCVPHandle)
     return (void*)newHandle;
 }
 
+void* I360SCVP_CreateContext(param_360SCVP* pParam360SCVP)
+{
+    if (pParam360SCVP == NULL)
+        return NULL;
+    TscvpContext* pContext = new TscvpContext;
+    if (pContext == NULL)
+        return NULL;
+
+    if (pContext->Init(pParam360SCVP) < 0)
+    {
+        pContext->Release();
+        return NULL;
+    }
+    return (void*)pContext;
+}
+
+void* I360SCVP_CreateSession(void* p360SCVPContext)
+{
+    TscvpContext* pContext = (TscvpContext*)(p360SCVPContext);
+    if (pContext == NULL)
+        return NULL;
+
+    return (void*)pContext->CreateSession();
+}
+
+int32_t I360SCVP_DestroyContext(void* p360SCVPContext)
+{
+    TscvpContext* pContext = (TscvpContext*)(p360SCVPContext);
+    if (pContext == NULL)
+        return -1;
+
+    pContext->Release();
+    return 0;
+}
+
 int32_t   I360SCVP_process(param_360SCVP* pParam360SCVP, void* p360SCVPHandle)
 {
     TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
@@ -165,6 +201,30 @@ int32_t I360SCVP_getTilesInViewport(TileDef* pOutTile, Param_ViewportOutput* pPa
     return ret;
 }
 
+int32_t I360SCVP_getTilesInViewportDelta(HeadPose* pose, Param_TilesDelta* pTilesDelta, Param_ViewportOutput* pParamViewPortOutput, void* p360SCVPHandle)
+{
+    int32_t ret = 0;
+    TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
+    if (!pStitch || !pose || !pTilesDelta || !pParamViewPortOutput)
+        return -1;
+    ret = pStitch->getTilesInViewportDelta(pose, pTilesDelta);
+    pParamViewPortOutput->dstWidthAlignTile = pStitch->m_viewportDestWidth;
+    pParamViewPortOutput->dstHeightAlignTile = pStitch->m_viewportDestHeight;
+    pParamViewPortOutput->dstWidthNet = pStitch->m_dstWidthNet;
+    pParamViewPortOutput->dstHeightNet = pStitch->m_dstHeightNet;
+    pParamViewPortOutput->xTopLeftNet = pStitch->m_xTopLeftNet;
+    pParamViewPortOutput->yTopLeftNet = pStitch->m_yTopLeftNet;
+    return ret;
+}
+
+int32_t I360SCVP_getTilesInViewportBatch(Param_TilesBatch* pTilesBatch, void* p360SCVPHandle)
+{
+    TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
+    if (!pStitch || !pTilesBatch)
+        return -1;
+    return pStitch->getTilesInViewportBatch(pTilesBatch);
+}
+
 int32_t I360SCVP_ParseNAL(Nalu* pNALU, void* p360SCVPHandle)
 {
     TstitchStream* pStitch = (TstitchStream*)(p360SCVPHandle);
@@ -272,6 +332,7 @@ int32_t I360SCVP_GetParameter(void* p360SCVPHandle, int32_t paramID, void** pVal
     Param_PicInfo* pPicInfo = NULL;
     Param_BSHeader* bsHeader = NULL;
     RegionWisePacking* pRWPK = NULL;
+    Param_BSSegments* pSegments = NULL;
     switch (paramID)
     {
         case ID_SCVP_PARAM_PICINFO:
@@ -289,6 +350,10 @@ int32_t I360SCVP_GetParameter(void* p360SCVPHandle, int32_t paramID, void** pVal
             pRWPK = (RegionWisePacking *)*pValue;
             ret = pStitch->getRWPKInfo(pRWPK);
             break;
+        case ID_SCVP_OUTPUT_SEGMENTS:
+            pSegments = (Param_BSSegments *)*pValue;
+            ret = pStitch->getOutputSegments(pSegments);
+            break;
         default:
             break;
     }
@@ -349,6 +414,25 @@ int32_t I360SCVP_GetTilesByLegacyWay(TileDef* pOutTile, void* p360SCVPHandle)
     return ret;
 }
 
+int32_t I360SCVP_CoalesceSegments(Param_BSSegments* pSegments, uint8_t* pOutput, uint32_t outputSize)
+{
+    if (!pSegments || !pOutput || (pSegments->segmentsNum && !pSegments->segments))
+        return -1;
+    if (pSegments->totalSize > outputSize)
+        return -1;
+
+    uint32_t outputLen = 0;
+    for (uint32_t i = 0; i < pSegments->segmentsNum; i++)
+    {
+        Param_BSSegment *pSegment = &pSegments->segments[i];
+        if (outputLen + pSegment->size > outputSize)
+            return -1;
+        memcpy_s(pOutput + outputLen, pSegment->size, pSegment->data, pSegment->size);
+        outputLen += pSegment->size;
+    }
+    return (int32_t)outputLen;
+}
+
 int32_t I360SCVPSetLogCallBack(void* p360SCVPHandle, void* externalLog)
 {
     TstitchStream* pStitch = (TstitchStream*)p360SCVPHandle;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   360SCVPContext.cpp
+//! \brief:  Implement the context shared by the sessions
+//!
+
+#include "string.h"
+#include "360SCVPViewportAPI.h"
+#include "360SCVPMergeStreamAPI.h"
+#include "360SCVPCommonDef.h"
+#include "360SCVPLog.h"
+#include "360SCVPImpl.h"
+#include "360SCVPContext.h"
+
+TscvpContext::TscvpContext()
+{
+    m_pTemplate = NULL;
+    m_refCount = 1;
+}
+
+TscvpContext::~TscvpContext()
+{
+    if (m_pTemplate)
+        m_pTemplate->uninit();
+    SAFE_DELETE(m_pTemplate);
+}
+
+int32_t TscvpContext::Init(param_360SCVP* pParam360SCVP)
+{
+    if (!pParam360SCVP || m_pTemplate)
+        return -1;
+
+    m_pTemplate = new TstitchStream;
+    if (!m_pTemplate)
+        return -1;
+
+    int32_t ret = m_pTemplate->initContext(pParam360SCVP);
+    if (ret < 0)
+    {
+        m_pTemplate->uninit();
+        SAFE_DELETE(m_pTemplate);
+    }
+    return ret;
+}
+
+TstitchStream* TscvpContext::CreateSession()
+{
+    if (!m_pTemplate)
+        return NULL;
+
+    TstitchStream *pSession = new TstitchStream(*m_pTemplate);
+    if (!pSession)
+        return NULL;
+
+    if (pSession->initSession(this) < 0)
+    {
+        SCVP_LOG(LOG_ERROR, "failed to create the session from the context!\n");
+        pSession->uninit();
+        SAFE_DELETE(pSession);
+        return NULL;
+    }
+    return pSession;
+}
+
+void TscvpContext::AddRef()
+{
+    m_refCount++;
+}
+
+void TscvpContext::Release()
+{
+    if (--m_refCount == 0)
+        delete this;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   360SCVPContext.h
+//! \brief:  The handle state which many sessions share, the parsed parameter
+//!          sets and the initialized viewport, read only once it is created
+//!
+
+#ifndef _360SCVP_CONTEXT_H_
+#define _360SCVP_CONTEXT_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "360SCVPAPI.h"
+
+class TstitchStream;
+
+class TscvpContext
+{
+public:
+    TscvpContext();
+    virtual ~TscvpContext();
+
+    //!
+    //! \brief  initialize the template handle from pParam360SCVP, as
+    //!         I360SCVP_Init does for one handle
+    //!
+    int32_t Init(param_360SCVP* pParam360SCVP);
+
+    //!
+    //! \brief  create one session starting from the state of the template
+    //!         handle, the session holds a reference until it is deleted
+    //!
+    TstitchStream* CreateSession();
+
+    //!
+    //! \brief  the template handle, which is never changed after Init, so
+    //!         the sessions read it from any thread without locks
+    //!
+    TstitchStream* GetTemplate() { return m_pTemplate; };
+
+    void AddRef();
+
+    //!
+    //! \brief  drop one reference, the context is deleted with the last one
+    //!
+    void Release();
+
+private:
+    TscvpContext(const TscvpContext&) = delete;
+    TscvpContext& operator=(const TscvpContext&) = delete;
+
+    TstitchStream          *m_pTemplate;
+    std::atomic<int32_t>    m_refCount;
+};
+
+#endif // _360SCVP_CONTEXT_H_
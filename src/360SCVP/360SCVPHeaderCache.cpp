@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   360SCVPHeaderCache.cpp
+//! \brief:  Implement the LRU cache of the serialized headers
+//!
+
+#include "360SCVPHeaderCache.h"
+#include "360SCVPCommonDef.h"
+
+TheaderCache::TheaderCache(uint32_t capacity)
+{
+    m_capacity = capacity ? capacity : 1;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+TheaderCache::~TheaderCache()
+{
+    m_index.clear();
+    m_entries.clear();
+}
+
+TheaderCache* TheaderCache::GetShared()
+{
+    static TheaderCache sharedCache(HEADER_CACHE_CAPACITY);
+    return &sharedCache;
+}
+
+uint32_t TheaderCache::Lookup(const std::string& key, uint8_t* pOutput, uint32_t outputSize)
+{
+    if (!pOutput)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end() || it->second->second.size() > outputSize)
+    {
+        m_misses++;
+        return 0;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    std::vector<uint8_t> &blob = it->second->second;
+    memcpy_s(pOutput, blob.size(), blob.data(), blob.size());
+    m_hits++;
+    return (uint32_t)blob.size();
+}
+
+void TheaderCache::Insert(const std::string& key, const uint8_t* pData, uint32_t dataSize)
+{
+    if (!pData || !dataSize)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        it->second->second.assign(pData, pData + dataSize);
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    if (m_entries.size() >= m_capacity)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+    m_entries.emplace_front(key, std::vector<uint8_t>(pData, pData + dataSize));
+    m_index[key] = m_entries.begin();
+}
+
+uint64_t TheaderCache::GetHits()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t TheaderCache::GetMisses()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
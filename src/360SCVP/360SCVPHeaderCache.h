@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   360SCVPHeaderCache.h
+//! \brief:  LRU cache of the serialized parameter sets and SEI NALs,
+//!          keyed by everything the rewritten headers depend on. One cache
+//!          is shared by all the handles of the process, so the stream
+//!          stitch and the SPS/PPS generation of the client stitch reuse
+//!          the blobs of each other
+//!
+
+#ifndef _360SCVP_HEADER_CACHE_H_
+#define _360SCVP_HEADER_CACHE_H_
+
+#include <stdint.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//the blobs of all the handles in the process
+#define HEADER_CACHE_CAPACITY 64
+//the input headers longer than it are not cached, they are not parameter sets only
+#define HEADER_CACHE_MAX_INPUT_SIZE 4096
+
+//! the kinds of cached blobs, the first byte of the key
+enum HeaderCacheType
+{
+    HEADER_CACHE_MERGED_HEADERS = 1,   //VPS, SPS and PPS of the stream stitch
+    HEADER_CACHE_SPS,                  //SPS of I360SCVP_GenerateSPS
+    HEADER_CACHE_PPS,                  //PPS of I360SCVP_GeneratePPS
+    HEADER_CACHE_MERGED_SEIS,          //SEIs after the RWPK SEI of the stream stitch, the RWPK SEI has the frame timestamp
+};
+
+class TheaderCache
+{
+public:
+    TheaderCache(uint32_t capacity);
+    virtual ~TheaderCache();
+
+    //!
+    //! \brief  get the cache shared by all the handles, it lives until exit
+    //!
+    static TheaderCache* GetShared();
+
+    //!
+    //! \brief  start a key of the blob type
+    //!
+    static void BeginKey(std::string& key, HeaderCacheType type)
+    {
+        key.assign(1, (char)type);
+    }
+
+    //!
+    //! \brief  append the bytes of one key field
+    //!
+    static void AppendKey(std::string& key, const void* pData, size_t size)
+    {
+        if (pData && size)
+            key.append((const char*)pData, size);
+    }
+
+    //!
+    //! \brief  append one scalar key field, structs are appended field by
+    //!         field so that their padding never reaches the key
+    //!
+    template<typename T>
+    static void AppendKeyField(std::string& key, const T& value)
+    {
+        key.append((const char*)&value, sizeof(T));
+    }
+
+    //!
+    //! \brief  copy the blob of the key into pOutput and mark it as the most
+    //!         recently used one
+    //!
+    //! \return uint32_t, the blob size, 0 if the key is missed or outputSize is not enough
+    //!
+    uint32_t Lookup(const std::string& key, uint8_t* pOutput, uint32_t outputSize);
+
+    //!
+    //! \brief  keep the blob of the key, the least recently used blob is
+    //!         dropped when the cache is full
+    //!
+    void Insert(const std::string& key, const uint8_t* pData, uint32_t dataSize);
+
+    uint64_t GetHits();
+    uint64_t GetMisses();
+
+private:
+    TheaderCache(const TheaderCache&) = delete;
+    TheaderCache& operator=(const TheaderCache&) = delete;
+
+    typedef std::list<std::pair<std::string, std::vector<uint8_t>>> EntryList;
+
+    std::mutex                                              m_mutex;
+    uint32_t                                                m_capacity;
+    EntryList                                               m_entries;  //most recently used first
+    std::unordered_map<std::string, EntryList::iterator>    m_index;
+    uint64_t                                                m_hits;
+    uint64_t                                                m_misses;
+};
+
+#endif // _360SCVP_HEADER_CACHE_H_
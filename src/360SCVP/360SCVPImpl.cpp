@@ -32,6 +32,7 @@
 #include "360SCVPViewportAPI.h"
 #include "360SCVPMergeStreamAPI.h"
 #include "360SCVPCommonDef.h"
+#include "360SCVPGeometry.h"
 #include "360SCVPHevcEncHdr.h"
 #include "360SCVPLog.h"
 #include "TileSelectionPlugins_API.h"
@@ -101,6 +102,13 @@ TstitchStream::TstitchStream()
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
     m_bNeedPlugin = false;
+    m_pMergeWorkers = NULL;
+    m_mergeThreadNum = 1;
+    m_bOutputSegments = false;
+    m_outputSegmentsSize = 0;
+    m_pHeaderCache = TheaderCache::GetShared();
+    m_pViewportBatch = NULL;
+    m_pContext = NULL;
 }
 
 TstitchStream::TstitchStream(TstitchStream& other)
@@ -180,6 +188,13 @@ TstitchStream::TstitchStream(TstitchStream& other)
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
     m_bNeedPlugin = false;
+    m_pMergeWorkers = NULL;
+    m_mergeThreadNum = other.m_mergeThreadNum;
+    m_bOutputSegments = other.m_bOutputSegments;
+    m_outputSegmentsSize = 0;
+    m_pHeaderCache = TheaderCache::GetShared();
+    m_pViewportBatch = NULL;
+    m_pContext = NULL;
 }
 
 TstitchStream& TstitchStream::operator=(const TstitchStream& other)
@@ -269,6 +284,12 @@ TstitchStream& TstitchStream::operator=(const TstitchStream& other)
     m_createPlugin = NULL;
     m_destroyPlugin = NULL;
     m_bNeedPlugin = false;
+    SAFE_DELETE(m_pMergeWorkers);
+    m_mergeThreadNum = other.m_mergeThreadNum;
+    m_bOutputSegments = other.m_bOutputSegments;
+    m_outputSegments.clear();
+    m_outputSegmentsSize = 0;
+    SAFE_DELETE(m_pViewportBatch);
 
     return *this;
 }
@@ -284,6 +305,11 @@ TstitchStream::~TstitchStream()
     SAFE_DELETE(m_hevcState);
     SAFE_DELETE_ARRAY(m_specialInfo[0]);
     SAFE_DELETE_ARRAY(m_specialInfo[1]);
+    SAFE_DELETE(m_pMergeWorkers);
+    SAFE_DELETE(m_pViewportBatch);
+    if (m_pContext)
+        m_pContext->Release();
+    m_pContext = NULL;
 }
 
 int32_t TstitchStream::initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t tilecolCount, int32_t tilerowCount)
@@ -355,6 +381,10 @@ int32_t TstitchStream::initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t t
     }
 
     m_pViewport = genViewport_Init(&m_pViewportParam);
+    {
+        std::lock_guard<std::mutex> lock(m_viewportBatchMutex);
+        SAFE_DELETE(m_pViewportBatch);
+    }
     return ERROR_NONE;
 }
 
@@ -712,6 +742,10 @@ int32_t TstitchStream::init(param_360SCVP* pParamStitchStream)
         m_streamStitch.tilesWidthCount = pParamStitchStream->paramPicInfo.tileWidthNum;
         m_streamStitch.VUI_enable = pParamStitchStream->paramStitchInfo.VUI_enable;
         m_streamStitch.pNalInfo = m_pNalInfo[0];
+        // the parallel merge is opt-in, 0 keeps the tiles merged in the calling thread
+        m_mergeThreadNum = pParamStitchStream->paramStitchInfo.mergeThreadNum;
+        if (m_mergeThreadNum <= 0)
+            m_mergeThreadNum = 1;
         m_pSteamStitch = genTiledStream_Init(&m_streamStitch);
         if (!m_pSteamStitch)
             return -1;
@@ -743,6 +777,84 @@ int32_t TstitchStream::init(param_360SCVP* pParamStitchStream)
     return ret;
 }
 
+int32_t TstitchStream::initContext(param_360SCVP* pParamStitchStream)
+{
+    if (pParamStitchStream == NULL)
+        return -1;
+    // the merge state follows the input bitstreams and the plugin keeps its own viewport,
+    // neither can be shared by the sessions
+    if (pParamStitchStream->usedType == E_MERGE_AND_VIEWPORT)
+    {
+        SCVP_LOG(LOG_ERROR, "The merge and viewport usage is not supported by the shared context!\n");
+        return ERROR_BAD_PARAM;
+    }
+    if (pParamStitchStream->usedType != E_PARSER_FOR_CLIENT
+        && pParamStitchStream->paramViewPort.geoTypeInput == E_SVIDEO_PLANAR)
+    {
+        SCVP_LOG(LOG_ERROR, "The tile selection plugin is not supported by the shared context!\n");
+        return ERROR_BAD_PARAM;
+    }
+
+    int32_t ret = init(pParamStitchStream);
+    if (ret < 0)
+        return ret;
+    if (m_usedType == E_PARSER_ONENAL)
+    {
+        // parse all the parameter sets at the head of the input once, for all the sessions
+        uint8_t *pData = pParamStitchStream->pInputBitstream;
+        int32_t leftLen = (int32_t)pParamStitchStream->inputBitstreamLen;
+        while (pData && leftLen > 0 && !(m_bSPSReady && m_bPPSReady))
+        {
+            Nalu nal;
+            memset_s(&nal, sizeof(Nalu), 0);
+            nal.data = pData;
+            nal.dataSize = leftLen;
+            if (parseNals(NULL, E_PARSER_ONENAL, &nal, 0) < 0)
+                break;
+            if (m_nalType != GTS_HEVC_NALU_VID_PARAM && m_nalType != GTS_HEVC_NALU_SEQ_PARAM
+                && m_nalType != GTS_HEVC_NALU_PIC_PARAM)
+                break;
+            int32_t nalLen = m_dataSize + m_startCodesSize;
+            if (nalLen <= 0)
+                break;
+            pData += nalLen;
+            leftLen -= nalLen;
+        }
+        m_data = NULL;
+    }
+    if (m_usedType == E_VIEWPORT_ONLY && !m_pViewport)
+    {
+        SCVP_LOG(LOG_ERROR, "failed to initialize the viewport of the shared context!\n");
+        return -1;
+    }
+    return ret;
+}
+
+int32_t TstitchStream::initSession(TscvpContext* pContext)
+{
+    if (!pContext || !pContext->GetTemplate())
+        return -1;
+    TstitchStream *pTemplate = pContext->GetTemplate();
+    m_pContext = pContext;
+    m_pContext->AddRef();
+
+    if (pTemplate->m_pViewport)
+    {
+        m_pViewportParam.m_pUpLeft = m_pUpLeft;
+        m_pViewportParam.m_pDownRight = m_pDownRight;
+        m_pViewport = genViewport_Clone(pTemplate->m_pViewport);
+        if (!m_pViewport)
+            return -1;
+    }
+    if (m_usedType == E_STREAM_STITCH_ONLY)
+    {
+        m_streamStitch.pNalInfo = m_pNalInfo[0];
+        m_pSteamStitch = genTiledStream_Init(&m_streamStitch);
+        if (!m_pSteamStitch)
+            return -1;
+    }
+    return ERROR_NONE;
+}
 
 int32_t TstitchStream::uninit()
 {
@@ -792,6 +904,7 @@ int32_t TstitchStream::uninit()
 
         ret = tile_merge_Close(m_pMergeStream);
     }
+    SAFE_DELETE(m_pViewportBatch);
     if(m_pViewport)
         ret |= genViewport_unInit(m_pViewport);
     if (m_pSteamStitch)
@@ -1071,7 +1184,12 @@ int32_t TstitchStream::setViewPort(HeadPose *pose)
     else if (m_bNeedPlugin)
         return SCVP_ERROR_PLUGIN_NOEXIST;
     else
+    {
+        std::lock_guard<std::mutex> lock(m_viewportBatchMutex);
+        if (m_pViewportBatch)
+            m_pViewportBatch->SetViewportParam(&m_pViewportParam);
         return genViewport_setViewPort(m_pViewport, pose->yaw, pose->pitch);
+    }
 }
 
 int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
@@ -1079,6 +1197,9 @@ int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
     int32_t ret = 0;
     if (pParamStitchStream == NULL)
         return -1;
+    m_bOutputSegments = pParamStitchStream->outputSegmentsEnable;
+    m_outputSegments.clear();
+    m_outputSegmentsSize = 0;
     ret = tile_merge_Process(&m_mergeStreamParam, m_pMergeStream);
     if (ret < 0)
         return -1;
@@ -1106,7 +1227,19 @@ int32_t TstitchStream::doMerge(param_360SCVP* pParamStitchStream)
         ret = EncRWPKSEI(&m_dstRwpk, pParamStitchStream->pOutputSEI, &pParamStitchStream->outputSEILen);
 
     pParamStitchStream->outputBitstreamLen = m_mergeStreamParam.outputiledbistreamlen;
-    memcpy_s(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
+    if (m_bOutputSegments)
+    {
+        // the merged frame is handed out in place instead of copying it again
+        Param_BSSegment segment;
+        segment.data = m_mergeStreamParam.pOutputBitstream;
+        segment.size = m_mergeStreamParam.outputiledbistreamlen;
+        m_outputSegments.assign(1, segment);
+        m_outputSegmentsSize = segment.size;
+    }
+    else
+    {
+        memcpy_s(pParamStitchStream->pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen, m_mergeStreamParam.pOutputBitstream, m_mergeStreamParam.outputiledbistreamlen);
+    }
 
     return ret;
 }
@@ -1268,6 +1401,123 @@ int32_t TstitchStream::getTilesInViewport(TileDef* pOutTile)
     return ret;
 }
 
+// the angle in degree between the viewing directions of two poses on the sphere
+static double getPoseAngle(HeadPose* pose1, HeadPose* pose2)
+{
+    double pitch1 = pose1->pitch * S_PI / 180;
+    double pitch2 = pose2->pitch * S_PI / 180;
+    double yawDiff = (pose1->yaw - pose2->yaw) * S_PI / 180;
+    double cosAngle = ssin(pitch1) * ssin(pitch2) + scos(pitch1) * scos(pitch2) * scos(yawDiff);
+    if (cosAngle > 1)
+        cosAngle = 1;
+    else if (cosAngle < -1)
+        cosAngle = -1;
+    return sacos(cosAngle) * 180 / S_PI;
+}
+
+// streamId and the offsets are not written by every selection, so they are left out
+static bool isSameTile(TileDef* tile1, TileDef* tile2)
+{
+    return tile1->x == tile2->x && tile1->y == tile2->y
+        && tile1->idx == tile2->idx && tile1->faceId == tile2->faceId;
+}
+
+int32_t TstitchStream::getTilesInViewportBatch(Param_TilesBatch* pTilesBatch)
+{
+    if (pTilesBatch == NULL)
+        return -1;
+    // the plugin keeps one viewport, which can not select the poses in parallel
+    if (m_pTileSelection || m_bNeedPlugin)
+    {
+        SCVP_LOG(LOG_ERROR, "the batch tile selection is not supported by the tile selection plugin!\n");
+        return SCVP_ERROR_PLUGIN_NOEXIST;
+    }
+    TviewportBatch *pViewportBatch = getViewportBatch();
+    if (!pViewportBatch)
+        return -1;
+    return pViewportBatch->Process(pTilesBatch);
+}
+
+TviewportBatch* TstitchStream::getViewportBatch()
+{
+    std::lock_guard<std::mutex> lock(m_viewportBatchMutex);
+    if (m_pViewportBatch)
+        return m_pViewportBatch;
+    // the copies of I360SCVP_New have the viewport parameters but no viewport
+    if (m_pViewportParam.m_tileNumCol == 0 || m_pViewportParam.m_tileNumRow == 0
+        || m_pViewportParam.m_iInputWidth <= 0 || m_pViewportParam.m_iInputHeight <= 0)
+        return NULL;
+    // the sessions clone the viewport of the context, which does not change
+    void *pSrcViewport = NULL;
+    if (m_pContext && m_pContext->GetTemplate())
+        pSrcViewport = m_pContext->GetTemplate()->m_pViewport;
+    m_pViewportBatch = new TviewportBatch(&m_pViewportParam, m_maxSelTiles, (int32_t)std::thread::hardware_concurrency(), pSrcViewport);
+    return m_pViewportBatch;
+}
+
+int32_t TstitchStream::getTilesInViewportDelta(HeadPose* pose, Param_TilesDelta* pTilesDelta)
+{
+    if (pose == NULL || pTilesDelta == NULL || pTilesDelta->pTiles == NULL)
+        return -1;
+    if (pTilesDelta->prevTilesNum > 0 &&
+        (pTilesDelta->pPrevTiles == NULL || pTilesDelta->pPrevTiles == pTilesDelta->pTiles))
+        return -1;
+
+    pTilesDelta->addedTilesNum = 0;
+    pTilesDelta->removedTilesNum = 0;
+    pTilesDelta->bReselected = false;
+
+    // the planar viewport is moved by the center and the zoom, only the direction has the hysteresis
+    HeadPose *prevPose = pTilesDelta->pPrevPose;
+    if (prevPose && pTilesDelta->prevTilesNum > 0
+        && prevPose->centerX == pose->centerX && prevPose->centerY == pose->centerY
+        && sfabs(prevPose->zoomFactor - pose->zoomFactor) < S_EPS
+        && getPoseAngle(prevPose, pose) < pTilesDelta->hysteresis)
+    {
+        memcpy_s(pTilesDelta->pTiles, pTilesDelta->prevTilesNum * sizeof(TileDef),
+            pTilesDelta->pPrevTiles, pTilesDelta->prevTilesNum * sizeof(TileDef));
+        pTilesDelta->tilesNum = pTilesDelta->prevTilesNum;
+        return pTilesDelta->tilesNum;
+    }
+
+    int32_t ret = setViewPort(pose);
+    if (ret)
+        return ret > 0 ? -ret : ret;
+    getViewPortTiles();
+    int32_t tilesNum = getTilesInViewport(pTilesDelta->pTiles);
+    if (tilesNum <= 0)
+        return tilesNum;
+    pTilesDelta->tilesNum = tilesNum;
+    pTilesDelta->bReselected = true;
+
+    // the tile sets are a few tens of tiles, so the pairwise compare is cheap
+    for (int32_t i = 0; i < tilesNum; i++)
+    {
+        bool found = false;
+        for (int32_t j = 0; j < pTilesDelta->prevTilesNum && !found; j++)
+            found = isSameTile(&pTilesDelta->pTiles[i], &pTilesDelta->pPrevTiles[j]);
+        if (!found)
+        {
+            if (pTilesDelta->pAddedTiles)
+                pTilesDelta->pAddedTiles[pTilesDelta->addedTilesNum] = pTilesDelta->pTiles[i];
+            pTilesDelta->addedTilesNum++;
+        }
+    }
+    for (int32_t j = 0; j < pTilesDelta->prevTilesNum; j++)
+    {
+        bool found = false;
+        for (int32_t i = 0; i < tilesNum && !found; i++)
+            found = isSameTile(&pTilesDelta->pPrevTiles[j], &pTilesDelta->pTiles[i]);
+        if (!found)
+        {
+            if (pTilesDelta->pRemovedTiles)
+                pTilesDelta->pRemovedTiles[pTilesDelta->removedTilesNum] = pTilesDelta->pPrevTiles[j];
+            pTilesDelta->removedTilesNum++;
+        }
+    }
+    return tilesNum;
+}
+
 int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream)
 {
     int32_t ret = 0;
@@ -1297,6 +1547,9 @@ int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream)
     }
 
     pGenTilesStream->pOutputTiledBitstream = pParamStitchStream->pOutputBitstream;
+    m_bOutputSegments = pParamStitchStream->outputSegmentsEnable;
+    m_outputSegments.clear();
+    m_outputSegmentsSize = 0;
 
     ret = merge_partstream_into1bitstream(pParamStitchStream->inputBitstreamLen);
 
@@ -1325,12 +1578,13 @@ int32_t  TstitchStream::doStreamStitch(param_360SCVP* pParamStitchStream)
     return ret;
 }
 
-int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSlice, GTS_BitStream *bs, bool bFirstTile)
+int32_t TstitchStream::rewrite_one_tile(TileMergeJob* pJob)
 {
     hevc_gen_tiledstream* pGenTilesStream = (hevc_gen_tiledstream*)m_pSteamStitch;
-    if (!pGenTilesStream || !pBitstream || !pSlice || !bs)
+    if (!pGenTilesStream || !pJob || !pJob->pSlice)
         return GTS_BAD_PARAM;
 
+    oneStream_info* pSlice = pJob->pSlice;
     uint32_t nalsize[20];
     uint32_t specialLen = 0;
     int32_t framesize = 0;
@@ -1338,10 +1592,6 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
     uint8_t *pBufferSliceCur = pSlice->pTiledBitstreamBuffer + pSlice->curBufferLen;
     int32_t lenSlice = pSlice->inputBufferLen - pSlice->curBufferLen;
 
-    uint8_t *pBitstreamCur = *pBitstream;
-    if (!pBitstreamCur)
-        return GTS_BAD_PARAM;
-
     HEVCState *hevc = pSlice->hevcSlice;
     if (!hevc)
         return GTS_BAD_PARAM;
@@ -1357,15 +1607,30 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
         = hevc->pps[hevc->last_parsed_pps_id].org_tiles_enabled_flag;
 
     memset_s(nalsize, sizeof(nalsize), 0);
-    uint64_t bs_position = bs->position;
     int32_t spsCnt;
     parse_hevc_specialinfo(&specialInfo, hevc, nalsize, &specialLen, &spsCnt, 0);
 
+    uint32_t paramSetsInLen = specialLen;
     specialLen += nalsize[SLICE_HEADER];
     framesize = specialLen + nalsize[SLICE_DATA];
-    lenSlice -= framesize;
 
-    if (pGenTilesStream->AUD_enable && bFirstTile)
+    // the rewritten headers are at most twice of the input ones, plus the SEIs
+    uint32_t headerSize = 2 * specialLen + MERGE_HEADER_RESERVED_SIZE;
+    if (nalsize[SEQ_PARAM_SET] && pSlice->address == 0 && m_seiRWPK_enable && m_pRWPK)
+        headerSize += m_pRWPK->numRegions * MERGE_SEI_ENTRY_SIZE;
+    if (nalsize[SEQ_PARAM_SET] && pSlice->address == 0 && m_seiViewport_enable && m_pSeiViewport)
+        headerSize += m_pSeiViewport->viewportsSize * MERGE_SEI_ENTRY_SIZE;
+    if (pJob->header.size() < headerSize)
+        pJob->header.resize(headerSize);
+
+    GTS_BitStream *bs = gts_bs_new((const int8_t *)pJob->header.data(), pJob->header.size(), GTS_BITSTREAM_WRITE);
+    if (!bs)
+        return GTS_OUT_OF_MEM;
+
+    pJob->paramSetsPos = -1;
+    pJob->paramSetsLen = 0;
+
+    if (pGenTilesStream->AUD_enable && pJob->bFirstTile)
     {
         hevc_write_bitstream_aud(bs, hevc);
     }
@@ -1381,86 +1646,212 @@ int32_t TstitchStream::merge_one_tile(uint8_t **pBitstream, oneStream_info* pSli
         //merge vps, sps, pps and SEI if at first tile
         if (pSlice->address == 0)
         {
-            pGenTilesStream->headerNal = (uint8_t*)bs->original + bs->position;
-            pGenTilesStream->headerNalSize = (uint8_t)(bs->position);
-            hevc_write_parameter_sets(bs, hevc);
-            //add the sei information, rwpk, projectoin, sphere rotation, and framepacking
-            if (m_seiRWPK_enable)
+            pJob->paramSetsPos = (int32_t)bs->position;
+
+            // the headers only change with the input parameter sets, the layout and the SEIs.
+            // the RWPK SEI carries the frame timestamp, so it is written each time between
+            // the cached parameter sets and the cached SEIs after it
+            std::string key;
+            uint32_t cachedLen = 0;
+            bool bCacheable = (paramSetsInLen <= HEADER_CACHE_MAX_INPUT_SIZE);
+            if (bCacheable)
             {
-                hevc_write_RwpkSEI(bs, m_pRWPK, 1);
+                getMergedHeadersKey(key, pBufferSliceCur, paramSetsInLen);
+                cachedLen = m_pHeaderCache->Lookup(key, pJob->header.data() + bs->position, (uint32_t)(bs->size - bs->position));
             }
-
-            if (m_seiProj_enable)
+            if (cachedLen)
             {
-                hevc_write_ProjectionSEI(bs, m_projType, 1);
+                bs->position += cachedLen;
             }
-
-            if (m_seiSphereRot_enable)
+            else
             {
-                hevc_write_SphereRotSEI(bs, m_pSphereRot, 1);
+                hevc_write_parameter_sets(bs, hevc);
+                if (bCacheable && bs->position < bs->size)
+                    m_pHeaderCache->Insert(key, pJob->header.data() + pJob->paramSetsPos, (uint32_t)(bs->position - pJob->paramSetsPos));
             }
 
-            if (m_seiFramePacking_enable)
+            //add the sei information, rwpk, projectoin, sphere rotation, and framepacking
+            if (m_seiRWPK_enable)
             {
-                hevc_write_FramePackingSEI(bs, m_pFramePacking, 1);
+                hevc_write_RwpkSEI(bs, m_pRWPK, 1);
             }
 
-            if (m_seiViewport_enable)
+            if (m_seiProj_enable || m_seiSphereRot_enable || m_seiFramePacking_enable || m_seiViewport_enable)
             {
-                hevc_write_ViewportSEI(bs, m_pSeiViewport, 1);
+                int64_t seisPos = bs->position;
+                cachedLen = 0;
+                if (bCacheable && bs->position < bs->size)
+                {
+                    key[0] = (char)HEADER_CACHE_MERGED_SEIS;
+                    cachedLen = m_pHeaderCache->Lookup(key, pJob->header.data() + bs->position, (uint32_t)(bs->size - bs->position));
+                }
+                if (cachedLen)
+                {
+                    bs->position += cachedLen;
+                }
+                else
+                {
+                    if (m_seiProj_enable)
+                    {
+                        hevc_write_ProjectionSEI(bs, m_projType, 1);
+                    }
 
+                    if (m_seiSphereRot_enable)
+                    {
+                        hevc_write_SphereRotSEI(bs, m_pSphereRot, 1);
+                    }
+
+                    if (m_seiFramePacking_enable)
+                    {
+                        hevc_write_FramePackingSEI(bs, m_pFramePacking, 1);
+                    }
+
+                    if (m_seiViewport_enable)
+                    {
+                        hevc_write_ViewportSEI(bs, m_pSeiViewport, 1);
+
+                    }
+                    if (bCacheable && bs->position < bs->size)
+                        m_pHeaderCache->Insert(key, pJob->header.data() + seisPos, (uint32_t)(bs->position - seisPos));
+                }
             }
-            pGenTilesStream->headerNalSize = (uint8_t)(bs->position - pGenTilesStream->headerNalSize);
+            pJob->paramSetsLen = (uint32_t)(bs->position - pJob->paramSetsPos);
         }
     }
 
     hevc->pps[hevc->last_parsed_pps_id].tiles_enabled_flag = (bool)(pGenTilesStream->outTilesWidthCount > 1
         || pGenTilesStream->outTilesHeightCount > 1);
 
-    // modify the tiled slice header , and merge slice data
+    // modify the tiled slice header, the slice data is copied after the output offsets are known
     gts_media_hevc_stitch_slice_segment(hevc, pSlice, pGenTilesStream->frameWidth, (uint32_t)pSlice->currentTileIdx);
     hevc_write_slice_header(bs, hevc);
 
-    //move to current address
-    pBitstreamCur += bs->position - bs_position;
-    bs_position = bs->position;
+    bool bOverflow = (bs->position >= bs->size);
+    pJob->headerLen = (uint32_t)bs->position;
+    gts_bs_del(bs);
+    if (bOverflow)
+    {
+        SCVP_LOG(LOG_ERROR, "the rewritten headers of the tile exceed %u bytes\n", headerSize);
+        return GTS_OUT_OF_MEM;
+    }
 
-    //copy slice data
-    memcpy_s(pBitstreamCur, nalsize[SLICE_DATA], pBufferSliceCur + specialLen, nalsize[SLICE_DATA]);
-    pBitstreamCur += nalsize[SLICE_DATA];
-    bs->position += nalsize[SLICE_DATA];
-    pBufferSliceCur += specialLen + nalsize[SLICE_DATA];
+    pJob->pSliceData = pBufferSliceCur + specialLen;
+    pJob->sliceDataLen = nalsize[SLICE_DATA];
+    pJob->frameSize = framesize;
 
     pSlice->currentTileIdx++;
-    *pBitstream = pBitstreamCur;
+    pSlice->curBufferLen += framesize;
+    pSlice->outputBufferLen += pJob->headerLen + pJob->sliceDataLen;
 
     return framesize;
 }
 
+static void appendFramePackingKey(std::string& key, FramePacking* pFramePacking)
+{
+    TheaderCache::AppendKeyField(key, pFramePacking->fpArrangementId);
+    TheaderCache::AppendKeyField(key, pFramePacking->fpArrangementType);
+    TheaderCache::AppendKeyField(key, pFramePacking->quincunxSamplingFlag);
+    TheaderCache::AppendKeyField(key, pFramePacking->contentInterpretationType);
+    TheaderCache::AppendKeyField(key, pFramePacking->spatialFlipping);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame0Flipped);
+    TheaderCache::AppendKeyField(key, pFramePacking->fieldViews);
+    TheaderCache::AppendKeyField(key, pFramePacking->currentFrameIsFrame0);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame0SelfContained);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame1SelfContained);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame0GridX);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame0GridY);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame1GridX);
+    TheaderCache::AppendKeyField(key, pFramePacking->frame1GridY);
+    TheaderCache::AppendKeyField(key, pFramePacking->upsampledAspectRatio);
+}
+
+void TstitchStream::getMergedHeadersKey(std::string& key, uint8_t* pParamSets, uint32_t paramSetsLen)
+{
+    hevc_gen_tiledstream* pGenTilesStream = (hevc_gen_tiledstream*)m_pSteamStitch;
+
+    TheaderCache::BeginKey(key, HEADER_CACHE_MERGED_HEADERS);
+
+    // the tile layout of the output frame
+    TheaderCache::AppendKey(key, &pGenTilesStream->frameWidth, sizeof(uint32_t));
+    TheaderCache::AppendKey(key, &pGenTilesStream->frameHeight, sizeof(uint32_t));
+    TheaderCache::AppendKey(key, &pGenTilesStream->outTilesWidthCount, sizeof(int32_t));
+    TheaderCache::AppendKey(key, &pGenTilesStream->outTilesHeightCount, sizeof(int32_t));
+    TheaderCache::AppendKey(key, &pGenTilesStream->tilesUniformSpacing, sizeof(bool));
+    TheaderCache::AppendKey(key, &pGenTilesStream->VUI_enable, sizeof(bool));
+    if (!pGenTilesStream->tilesUniformSpacing)
+    {
+        TheaderCache::AppendKey(key, pGenTilesStream->columnWidth, sizeof(pGenTilesStream->columnWidth));
+        TheaderCache::AppendKey(key, pGenTilesStream->rowHeight, sizeof(pGenTilesStream->rowHeight));
+    }
+
+    // the SEIs written after the parameter sets
+    bool seiEnable[5] = { m_seiRWPK_enable, m_seiProj_enable, m_seiSphereRot_enable,
+        m_seiFramePacking_enable, m_seiViewport_enable };
+    TheaderCache::AppendKey(key, seiEnable, sizeof(seiEnable));
+    if (m_seiProj_enable)
+        TheaderCache::AppendKeyField(key, m_projType);
+    if (m_seiSphereRot_enable && m_pSphereRot)
+    {
+        TheaderCache::AppendKeyField(key, m_pSphereRot->yawRotation);
+        TheaderCache::AppendKeyField(key, m_pSphereRot->pitchRotation);
+        TheaderCache::AppendKeyField(key, m_pSphereRot->rollRotation);
+    }
+    if (m_seiFramePacking_enable && m_pFramePacking)
+        appendFramePackingKey(key, m_pFramePacking);
+    if (m_seiViewport_enable && m_pSeiViewport)
+    {
+        TheaderCache::AppendKeyField(key, m_pSeiViewport->vpId);
+        TheaderCache::AppendKeyField(key, m_pSeiViewport->viewportsSize);
+        for (uint16_t i = 0; m_pSeiViewport->pViewports && i < m_pSeiViewport->viewportsSize; i++)
+        {
+            oneViewport* pViewport = &m_pSeiViewport->pViewports[i];
+            TheaderCache::AppendKeyField(key, pViewport->AzimuthCentre);
+            TheaderCache::AppendKeyField(key, pViewport->ElevationCentre);
+            TheaderCache::AppendKeyField(key, pViewport->tiltCentre);
+            TheaderCache::AppendKeyField(key, pViewport->HorzRange);
+            TheaderCache::AppendKeyField(key, pViewport->VertRange);
+        }
+    }
+
+    // the input parameter sets end the key, so their length needs no prefix
+    TheaderCache::AppendKey(key, pParamSets, paramSetsLen);
+}
+
 int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
 {
     hevc_gen_tiledstream* pGenTilesStream = (hevc_gen_tiledstream*)m_pSteamStitch;
     if (!pGenTilesStream)
         return GTS_BAD_PARAM;
 
-    // Set bs size larger than input, in case of additional syntax
+    // Set output size larger than input, in case of additional syntax
     // need to be wrote into output bitstream.
-    int32_t outputBSLen = 2 * totalInputLen;
+    uint64_t outputBSLen = 2 * (uint64_t)totalInputLen;
 
-    uint8_t* pBitstreamCur = pGenTilesStream->pOutputTiledBitstream;
-    if (!pBitstreamCur)
+    // the output buffer is not touched when the gather list is output
+    uint8_t* pOutput = pGenTilesStream->pOutputTiledBitstream;
+    if (!pOutput && !m_bOutputSegments)
         return GTS_BAD_PARAM;
 
     // define nxm tiles here, uniform type is default setting
     int32_t tilesWidthCount = pGenTilesStream->tilesWidthCount;
     int32_t tilesHeightCount = pGenTilesStream->tilesHeightCount;
 
-    GTS_BitStream *bs = gts_bs_new((const int8_t *)pBitstreamCur, outputBSLen, GTS_BITSTREAM_WRITE);
-    if (!bs)
-        return GTS_OUT_OF_MEM;
-
     parse_tiles_info(pGenTilesStream);
 
+    int32_t tilesNum = pGenTilesStream->outTilesHeightCount * pGenTilesStream->outTilesWidthCount;
+    if (tilesNum <= 0)
+        return GTS_BAD_PARAM;
+    if ((int32_t)m_mergeJobs.size() < tilesNum)
+        m_mergeJobs.resize(tilesNum);
+    m_mergeStreamJobs.resize(tilesWidthCount * tilesHeightCount);
+    for (auto &streamJobs : m_mergeStreamJobs)
+    {
+        streamJobs.clear();
+    }
+
+    // the tiles of one input stream are consecutive slices of it, so they are
+    // rewritten in order, while different input streams are independent
+    int32_t jobIdx = 0;
     for (int32_t i = 0; i < pGenTilesStream->outTilesHeightCount; i++)
     {
         for (int32_t j = 0; j < pGenTilesStream->outTilesWidthCount; j++)
@@ -1479,18 +1870,107 @@ int32_t TstitchStream::merge_partstream_into1bitstream(int32_t totalInputLen)
                     break;
                 heightIdx -= pGenTilesStream->rowCnt[kh];
             }
-            oneStream_info * pSliceCur = pGenTilesStream->pTiledBitstreams[kh*tilesWidthCount + kw];
+            if (kw >= tilesWidthCount || kh >= tilesHeightCount)
+                return GTS_BAD_PARAM;
+
+            TileMergeJob *pJob = &m_mergeJobs[jobIdx];
+            pJob->pSlice = pGenTilesStream->pTiledBitstreams[kh*tilesWidthCount + kw];
+            pJob->bFirstTile = (i == 0 && j == 0);
+            pJob->headerLen = 0;
+            pJob->paramSetsPos = -1;
+            pJob->paramSetsLen = 0;
+            pJob->pSliceData = NULL;
+            pJob->sliceDataLen = 0;
+            pJob->frameSize = 0;
+            m_mergeStreamJobs[kh*tilesWidthCount + kw].push_back(jobIdx);
+            jobIdx++;
+        }
+    }
+
+    if (!m_pMergeWorkers && m_mergeThreadNum > 1)
+    {
+        m_pMergeWorkers = new TmergeWorkers(m_mergeThreadNum);
+    }
+
+    // phase 1, rewrite the headers of each tile into its scratch
+    std::atomic<int32_t> rewriteRet(0);
+    std::function<void(int32_t)> rewriteStream = [&](int32_t streamIdx)
+    {
+        for (auto idx : m_mergeStreamJobs[streamIdx])
+        {
+            int32_t ret = rewrite_one_tile(&m_mergeJobs[idx]);
+            if (ret < 0)
+            {
+                rewriteRet = ret;
+                break;
+            }
+        }
+    };
+    if (m_pMergeWorkers)
+        m_pMergeWorkers->Run((int32_t)m_mergeStreamJobs.size(), rewriteStream);
+    else
+    {
+        for (int32_t streamIdx = 0; streamIdx < (int32_t)m_mergeStreamJobs.size(); streamIdx++)
+            rewriteStream(streamIdx);
+    }
+    if (rewriteRet < 0)
+        return rewriteRet;
 
-            uint64_t bspos = 0;
-            if (bs) bspos = bs->position;
-            bool bFirstTile = (bool)((i == 0 && j == 0) == 1 ? 1 : 0);
-            int32_t curframesize = merge_one_tile(&pBitstreamCur, pSliceCur, bs, bFirstTile);
-            pSliceCur->curBufferLen += curframesize;
-            pSliceCur->outputBufferLen += (uint32_t)(bs->position - bspos);
+    // the output offset of each tile is the prefix sum of the tiles before it
+    uint64_t outputOffset = 0;
+    for (int32_t idx = 0; idx < tilesNum; idx++)
+    {
+        TileMergeJob *pJob = &m_mergeJobs[idx];
+        pJob->outputOffset = outputOffset;
+        outputOffset += pJob->headerLen + pJob->sliceDataLen;
+        if (pJob->paramSetsPos >= 0)
+        {
+            pGenTilesStream->headerNal = m_bOutputSegments ? (pJob->header.data() + pJob->paramSetsPos)
+                : (pOutput + pJob->outputOffset + pJob->paramSetsPos);
+            pGenTilesStream->headerNalSize = (uint8_t)(pJob->paramSetsLen);
         }
     }
 
-    if (bs) gts_bs_del(bs);
+    if (m_bOutputSegments)
+    {
+        // the rewritten headers stay in the scratch of the jobs and the slice
+        // data is referred in the input bitstreams, nothing is copied
+        m_outputSegments.resize(2 * tilesNum);
+        for (int32_t idx = 0; idx < tilesNum; idx++)
+        {
+            TileMergeJob *pJob = &m_mergeJobs[idx];
+            m_outputSegments[2 * idx].data = pJob->header.data();
+            m_outputSegments[2 * idx].size = pJob->headerLen;
+            m_outputSegments[2 * idx + 1].data = pJob->pSliceData;
+            m_outputSegments[2 * idx + 1].size = pJob->sliceDataLen;
+        }
+        m_outputSegmentsSize = (uint32_t)outputOffset;
+        return 0;
+    }
+
+    if (outputOffset > outputBSLen)
+    {
+        SCVP_LOG(LOG_ERROR, "the merged frame size %llu exceeds the output buffer size %llu\n",
+            (unsigned long long)outputOffset, (unsigned long long)outputBSLen);
+        return GTS_OUT_OF_MEM;
+    }
+
+    // phase 2, copy the headers and the slice data of the tiles into the output
+    std::function<void(int32_t)> copyTile = [&](int32_t idx)
+    {
+        TileMergeJob *pJob = &m_mergeJobs[idx];
+        uint8_t *pDst = pOutput + pJob->outputOffset;
+        memcpy_s(pDst, pJob->headerLen, pJob->header.data(), pJob->headerLen);
+        memcpy_s(pDst + pJob->headerLen, pJob->sliceDataLen, pJob->pSliceData, pJob->sliceDataLen);
+    };
+    if (m_pMergeWorkers)
+        m_pMergeWorkers->Run(tilesNum, copyTile);
+    else
+    {
+        for (int32_t idx = 0; idx < tilesNum; idx++)
+            copyTile(idx);
+    }
+
     return 0;
 }
 
@@ -1537,6 +2017,22 @@ int32_t  TstitchStream::getRWPKInfo(RegionWisePacking *pRWPK)
     return ret;
 }
 
+int32_t TstitchStream::getOutputSegments(Param_BSSegments *pSegments)
+{
+    if (!pSegments)
+        return -1;
+    if (!m_bOutputSegments)
+    {
+        SCVP_LOG(LOG_ERROR, "the segments output is not enabled for the last frame\n");
+        return -1;
+    }
+
+    pSegments->segments = m_outputSegments.empty() ? NULL : m_outputSegments.data();
+    pSegments->segmentsNum = (uint32_t)m_outputSegments.size();
+    pSegments->totalSize = m_outputSegmentsSize;
+    return 0;
+}
+
 int32_t TstitchStream::setViewPortInfo(Param_ViewPortInfo* pViewPortInfo)
 {
     int32_t ret = 0;
@@ -1643,6 +2139,28 @@ int32_t  TstitchStream::GeneratePPS(param_360SCVP* pParamStitchStream, TileArran
             bsWrite = NULL;
             return ret;
         }
+        // the same pps and tiles layout give the same output, which is copied from the cache
+        std::string key;
+        uint32_t cachedLen = 0;
+        bool bCacheable = (pParamStitchStream->inputBitstreamLen <= HEADER_CACHE_MAX_INPUT_SIZE);
+        if (bCacheable)
+        {
+            TheaderCache::BeginKey(key, HEADER_CACHE_PPS);
+            TheaderCache::AppendKey(key, &pTileArrange->tileRowsNum, sizeof(pTileArrange->tileRowsNum));
+            TheaderCache::AppendKey(key, &pTileArrange->tileColsNum, sizeof(pTileArrange->tileColsNum));
+            TheaderCache::AppendKey(key, pTileArrange->tileRowHeight, pTileArrange->tileRowsNum * sizeof(uint16_t));
+            TheaderCache::AppendKey(key, pTileArrange->tileColWidth, pTileArrange->tileColsNum * sizeof(uint16_t));
+            TheaderCache::AppendKey(key, pParamStitchStream->pInputBitstream, pParamStitchStream->inputBitstreamLen);
+            cachedLen = m_pHeaderCache->Lookup(key, pParamStitchStream->pOutputBitstream, (uint32_t)bsWrite->size);
+        }
+        if (cachedLen)
+        {
+            pParamStitchStream->outputBitstreamLen = cachedLen;
+            gts_bs_del(bs);
+            gts_bs_del(bsWrite);
+            return 0;
+        }
+
         memcpy_s(&hevcTmp, sizeof(HEVCState), m_hevcState, sizeof(HEVCState));
         if (hevcTmp.last_parsed_pps_id > 63)
         {
@@ -1678,6 +2196,8 @@ int32_t  TstitchStream::GeneratePPS(param_360SCVP* pParamStitchStream, TileArran
         // write the new pps
         hevc_write_pps(bsWrite, &hevcTmp);
         pParamStitchStream->outputBitstreamLen = gts_bs_get_position(bsWrite);
+        if (bCacheable)
+            m_pHeaderCache->Insert(key, pParamStitchStream->pOutputBitstream, pParamStitchStream->outputBitstreamLen);
         if (bs)
         {
             gts_bs_del(bs);
@@ -1745,6 +2265,26 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
 
             return ret;
         }
+        // the same sps and resolution give the same output, which is copied from the cache
+        std::string key;
+        uint32_t cachedLen = 0;
+        bool bCacheable = (pParamStitchStream->inputBitstreamLen <= HEADER_CACHE_MAX_INPUT_SIZE);
+        if (bCacheable)
+        {
+            TheaderCache::BeginKey(key, HEADER_CACHE_SPS);
+            TheaderCache::AppendKey(key, &pParamStitchStream->destWidth, sizeof(int32_t));
+            TheaderCache::AppendKey(key, &pParamStitchStream->destHeight, sizeof(int32_t));
+            TheaderCache::AppendKey(key, pParamStitchStream->pInputBitstream, pParamStitchStream->inputBitstreamLen);
+            cachedLen = m_pHeaderCache->Lookup(key, pParamStitchStream->pOutputBitstream, (uint32_t)bsWrite->size);
+        }
+        if (cachedLen)
+        {
+            pParamStitchStream->outputBitstreamLen = cachedLen;
+            gts_bs_del(bs);
+            gts_bs_del(bsWrite);
+            return 0;
+        }
+
         // modify the sps
         memcpy_s(&hevcTmp, sizeof(HEVCState), m_hevcState, sizeof(HEVCState));
         HEVC_SPS *sps = &hevcTmp.sps[0];
@@ -1772,6 +2312,8 @@ int32_t  TstitchStream::GenerateSPS(param_360SCVP* pParamStitchStream)
         // write the new sps
         hevc_write_sps(bsWrite, &hevcTmp);
         pParamStitchStream->outputBitstreamLen = gts_bs_get_position(bsWrite);
+        if (bCacheable)
+            m_pHeaderCache->Insert(key, pParamStitchStream->pOutputBitstream, pParamStitchStream->outputBitstreamLen);
         if (bsWrite)
         {
             gts_bs_del(bsWrite);
@@ -28,6 +28,33 @@
 #include "360SCVPHevcTilestream.h"
 #include "../utils/data_type.h"
 #include "TileSelectionPlugins_API.h"
+#include "360SCVPMergeWorkers.h"
+#include "360SCVPHeaderCache.h"
+#include "360SCVPViewportBatch.h"
+#include "360SCVPContext.h"
+#include <vector>
+#include <mutex>
+
+//reserved scratch bytes of one tile for the AUD and the SEIs besides the rewritten headers
+#define MERGE_HEADER_RESERVED_SIZE 4096
+//reserved scratch bytes for each region of the RWPK SEI and each viewport of the viewport SEI
+#define MERGE_SEI_ENTRY_SIZE       64
+
+//! one output tile of the stream stitch, its rewritten headers are kept in
+//! the scratch until the output offsets of all the tiles are known
+struct TileMergeJob
+{
+    oneStream_info      *pSlice;
+    bool                 bFirstTile;
+    std::vector<uint8_t> header;        //AUD, parameter sets, SEIs and the rewritten slice header
+    uint32_t             headerLen;
+    int32_t              paramSetsPos;  //offset of the parameter sets in the header, -1 if not written
+    uint32_t             paramSetsLen;
+    uint8_t             *pSliceData;
+    uint32_t             sliceDataLen;
+    int32_t              frameSize;     //input bytes consumed by this tile
+    uint64_t             outputOffset;
+};
 
 class TstitchStream
 {
@@ -78,6 +105,22 @@ protected:
     int32_t         m_hrTilesInCol;
     RegionWisePacking     m_dstRwpk;
     TileSelection  *m_pTileSelection;
+    //the stream stitch jobs, one per output tile, and the jobs of each input stream in order
+    std::vector<TileMergeJob>           m_mergeJobs;
+    std::vector<std::vector<int32_t>>   m_mergeStreamJobs;
+    TmergeWorkers  *m_pMergeWorkers;
+    int32_t         m_mergeThreadNum;
+    //the gather list of the last output frame when the segments output is enabled
+    bool                            m_bOutputSegments;
+    std::vector<Param_BSSegment>    m_outputSegments;
+    uint32_t                        m_outputSegmentsSize;
+    //the rewritten parameter sets and SEIs of the recent tile layouts, shared by all the handles
+    TheaderCache   *m_pHeaderCache;
+    //the viewport instances selecting the tiles of many poses, created by the first batch selection
+    TviewportBatch *m_pViewportBatch;
+    std::mutex      m_viewportBatchMutex;
+    //the context this handle is a session of, NULL for the handles of I360SCVP_Init
+    TscvpContext   *m_pContext;
 
 public:
     uint16_t        m_nalType;
@@ -99,6 +142,8 @@ public:
     TstitchStream& operator=(const TstitchStream& other);
     virtual ~TstitchStream();
     int32_t  init(param_360SCVP* pParamStitchStream);
+    int32_t  initContext(param_360SCVP* pParamStitchStream);
+    int32_t  initSession(TscvpContext* pContext);
     int32_t  uninit();
     int32_t  getViewPortTiles();
     int32_t  feedParamToGenStream(param_360SCVP* pParamStitchStream);
@@ -106,6 +151,8 @@ public:
     int32_t  doMerge(param_360SCVP* pParamStitchStream);
     int32_t  getFixedNumTiles(TileDef* pOutTile);
     int32_t  getTilesInViewport(TileDef* pOutTile);
+    int32_t  getTilesInViewportDelta(HeadPose* pose, Param_TilesDelta* pTilesDelta);
+    int32_t  getTilesInViewportBatch(Param_TilesBatch* pTilesBatch);
     int32_t  parseNals(param_360SCVP* pParamStitchStream, int32_t parseType, Nalu* pNALU, int32_t streamIdx);
     int32_t  GenerateRWPK(RegionWisePacking* pRWPK, uint8_t *pRWPKBits, int32_t* pRWPKBitsSize);
     int32_t  GenerateProj(int32_t projType, uint8_t *pProjBits, int32_t* pProjBitsSize);
@@ -115,6 +162,7 @@ public:
     int32_t  getPicInfo(Param_PicInfo* pPicInfo);
     int32_t  getBSHeader(Param_BSHeader * bsHeader);
     int32_t  getRWPKInfo(RegionWisePacking *pRWPK);
+    int32_t  getOutputSegments(Param_BSSegments *pSegments);
     int32_t  setViewPortInfo(Param_ViewPortInfo* pViewPortInfo);
     int32_t  setSEIProjInfo(int32_t projType);
     int32_t  setSEIRWPKInfo(RegionWisePacking* pRWPK);
@@ -122,7 +170,7 @@ public:
     int32_t  setFramePacking(FramePacking* pFramePacking);
     int32_t  setViewportSEI(OMNIViewPort* pSeiViewport);
     int32_t  doStreamStitch(param_360SCVP* pParamStitchStream);
-    int32_t  merge_one_tile(uint8_t **pBitstream, oneStream_info* pSlice, GTS_BitStream *bs, bool bFirstTile);
+    int32_t  rewrite_one_tile(TileMergeJob* pJob);
     int32_t  GenerateRwpkInfo(RegionWisePacking *dstRwpk);
     int32_t  EncRWPKSEI(RegionWisePacking* pRWPK, uint8_t *pRWPKBits, uint32_t* pRWPKBitsSize);
     int32_t  DecRWPKSEI(RegionWisePacking* pRWPK, uint8_t *pRWPKBits, uint32_t RWPKBitsSize);
@@ -135,6 +183,8 @@ protected:
     int32_t initMerge(param_360SCVP* pParamStitchStream, int32_t sliceSize);
     int32_t initViewport(Param_ViewPortInfo* pViewPortInfo, int32_t tilecolCount, int32_t tilerowCount);
     int32_t merge_partstream_into1bitstream(int32_t totalInputLen);
+    void    getMergedHeadersKey(std::string& key, uint8_t* pParamSets, uint32_t paramSetsLen);
+    TviewportBatch* getViewportBatch();
 
 private:
     void* m_pluginLibHdl;
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   360SCVPMergeWorkers.cpp
+//! \brief:  Implement the fork-join worker threads of the stream stitch
+//!
+
+#include "360SCVPMergeWorkers.h"
+
+TmergeWorkers::TmergeWorkers(int32_t threadNum)
+{
+    m_job = NULL;
+    m_jobNum = 0;
+    m_nextJob = 0;
+    m_busyWorkers = 0;
+    m_round = 0;
+    m_exit = false;
+
+    if (threadNum > MAX_MERGE_THREADS)
+        threadNum = MAX_MERGE_THREADS;
+    for (int32_t i = 1; i < threadNum; i++)
+    {
+        m_threads.push_back(std::thread(&TmergeWorkers::WorkerLoop, this));
+    }
+}
+
+TmergeWorkers::~TmergeWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_startCond.notify_all();
+    for (auto &worker : m_threads)
+    {
+        worker.join();
+    }
+}
+
+void TmergeWorkers::RunJobs()
+{
+    int32_t idx = 0;
+    while ((idx = m_nextJob.fetch_add(1)) < m_jobNum)
+    {
+        (*m_job)(idx);
+    }
+}
+
+void TmergeWorkers::WorkerLoop()
+{
+    uint64_t round = 0;
+    while (1)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCond.wait(lock, [&] { return m_exit || m_round != round; });
+            if (m_exit)
+                return;
+            round = m_round;
+        }
+
+        RunJobs();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busyWorkers == 0)
+            m_doneCond.notify_one();
+    }
+}
+
+void TmergeWorkers::Run(int32_t jobNum, const std::function<void(int32_t)>& job)
+{
+    if (jobNum <= 0)
+        return;
+
+    if (m_threads.empty() || jobNum == 1)
+    {
+        for (int32_t idx = 0; idx < jobNum; idx++)
+        {
+            job(idx);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_jobNum = jobNum;
+        m_nextJob = 0;
+        m_busyWorkers = (int32_t)m_threads.size();
+        m_round++;
+    }
+    m_startCond.notify_all();
+
+    RunJobs();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCond.wait(lock, [&] { return m_busyWorkers == 0; });
+    m_job = NULL;
+}
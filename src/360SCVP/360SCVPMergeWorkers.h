@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//!
+//! \file:   360SCVPMergeWorkers.h
+//! \brief:  Fork-join worker threads used by the stream stitch to rewrite
+//!          and copy the tiles of one frame concurrently
+//!
+
+#ifndef _360SCVP_MERGE_WORKERS_H_
+#define _360SCVP_MERGE_WORKERS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define MAX_MERGE_THREADS 16
+
+class TmergeWorkers
+{
+public:
+    //!
+    //! \brief  create threadNum - 1 worker threads, the thread calling Run
+    //!         takes jobs too
+    //!
+    TmergeWorkers(int32_t threadNum);
+    virtual ~TmergeWorkers();
+
+    //!
+    //! \brief  run job(idx) for every idx in [0, jobNum) on the worker threads
+    //!         and the calling thread, return after all the jobs are done.
+    //!         Run is not reentrant, one stitch handle calls it at a time
+    //!
+    void Run(int32_t jobNum, const std::function<void(int32_t)>& job);
+
+    int32_t GetThreadNum() { return (int32_t)m_threads.size() + 1; }
+
+private:
+    TmergeWorkers(const TmergeWorkers&) = delete;
+    TmergeWorkers& operator=(const TmergeWorkers&) = delete;
+
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread>          m_threads;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_startCond;
+    std::condition_variable           m_doneCond;
+    const std::function<void(int32_t)> *m_job;
+    int32_t                           m_jobNum;
+    std::atomic<int32_t>              m_nextJob;
+    int32_t                           m_busyWorkers;
+    uint64_t                          m_round;
+    bool                              m_exit;
+};
+
+#endif // _360SCVP_MERGE_WORKERS_H_
@@ -96,6 +96,18 @@ typedef struct GENERATE_VIEWPORT_PARAM
 //!
 void* genViewport_Init(generateViewPortParam* pParamGenViewport);
 
+//!
+//! \brief    This function creates a new handle with the same state as the input handle, the tile
+//!           tables are copied so it is much cheaper than genViewport_Init. The input handle is
+//!           only read, so many threads can clone one handle which is not changed meanwhile
+//! \param    void*     pGenHandle,     input, which is created by the genViewport_Init function
+//!
+//! \return   void*, the handle of the new viewport, which is released by genViewport_unInit.
+//!           not null, if the copy is ok
+//!           null, if the copy fails
+//!
+void* genViewport_Clone(void* pGenHandle);
+
 //!
 //! \brief    This function completes the viewport range for the input , according to the FOV information.
 //!
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   360SCVPViewportBatch.cpp
+//! \brief:  Implement the tile selection of many poses
+//!
+
+#include "string.h"
+#include <atomic>
+#include <functional>
+#include "360SCVPCommonDef.h"
+#include "360SCVPLog.h"
+#include "360SCVPViewportBatch.h"
+
+TviewportBatch::TviewportBatch(generateViewPortParam* pViewportParam, int32_t maxSelTiles, int32_t threadNum, void* pSrcViewport)
+{
+    memcpy_s(&m_viewportParam, sizeof(generateViewPortParam), pViewportParam, sizeof(generateViewPortParam));
+    m_viewportParam.m_pUpLeft = NULL;
+    m_viewportParam.m_pDownRight = NULL;
+    m_maxSelTiles = maxSelTiles;
+    m_threadNum = threadNum;
+    if (m_threadNum > MAX_MERGE_THREADS)
+        m_threadNum = MAX_MERGE_THREADS;
+    if (m_threadNum < 1)
+        m_threadNum = 1;
+    m_pWorkers = NULL;
+    m_pSrcViewport = pSrcViewport;
+}
+
+TviewportBatch::~TviewportBatch()
+{
+    SAFE_DELETE(m_pWorkers);
+    ReleaseInstances();
+}
+
+void TviewportBatch::ReleaseInstances()
+{
+    for (auto pInstance : m_instances)
+    {
+        genViewport_unInit(pInstance->viewport);
+        SAFE_DELETE(pInstance);
+    }
+    m_instances.clear();
+}
+
+// the pose and the outputs are set by each selection, so only the input parameters are compared
+static bool isSameViewportInput(generateViewPortParam* param1, generateViewPortParam* param2)
+{
+    return param1->m_iViewportWidth == param2->m_iViewportWidth
+        && param1->m_iViewportHeight == param2->m_iViewportHeight
+        && param1->m_viewPort_hFOV == param2->m_viewPort_hFOV
+        && param1->m_viewPort_vFOV == param2->m_viewPort_vFOV
+        && param1->m_output_geoType == param2->m_output_geoType
+        && param1->m_input_geoType == param2->m_input_geoType
+        && param1->m_iInputWidth == param2->m_iInputWidth
+        && param1->m_iInputHeight == param2->m_iInputHeight
+        && param1->m_tileNumRow == param2->m_tileNumRow
+        && param1->m_tileNumCol == param2->m_tileNumCol
+        && param1->m_usageType == param2->m_usageType
+        && !memcmp(&param1->m_paramVideoFP, &param2->m_paramVideoFP, sizeof(Param_VideoFPStruct));
+}
+
+void TviewportBatch::SetViewportParam(generateViewPortParam* pViewportParam)
+{
+    if (!pViewportParam)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (isSameViewportInput(&m_viewportParam, pViewportParam))
+        return;
+
+    memcpy_s(&m_viewportParam, sizeof(generateViewPortParam), pViewportParam, sizeof(generateViewPortParam));
+    m_viewportParam.m_pUpLeft = NULL;
+    m_viewportParam.m_pDownRight = NULL;
+    // the source viewport has the old parameters, so the instances are initialized from the new ones
+    m_pSrcViewport = NULL;
+    ReleaseInstances();
+}
+
+TviewportBatch::ViewportInstance* TviewportBatch::CreateInstance()
+{
+    ViewportInstance *pInstance = new ViewportInstance;
+    if (!pInstance)
+        return NULL;
+
+    memcpy_s(&pInstance->param, sizeof(generateViewPortParam), &m_viewportParam, sizeof(generateViewPortParam));
+    pInstance->param.m_pUpLeft = pInstance->upLeft;
+    pInstance->param.m_pDownRight = pInstance->downRight;
+    if (m_pSrcViewport)
+        pInstance->viewport = genViewport_Clone(m_pSrcViewport);
+    else
+        pInstance->viewport = genViewport_Init(&pInstance->param);
+    if (!pInstance->viewport)
+    {
+        SCVP_LOG(LOG_ERROR, "failed to create the viewport for the batch tile selection!\n");
+        SAFE_DELETE(pInstance);
+        return NULL;
+    }
+    if (m_maxSelTiles > 0)
+        genViewport_setMaxSelTiles(pInstance->viewport, m_maxSelTiles);
+
+    // the tiles of all the faces, the most the viewport can cover
+    pInstance->tiles.resize(6 * m_viewportParam.m_tileNumCol * m_viewportParam.m_tileNumRow);
+    return pInstance;
+}
+
+int32_t TviewportBatch::SelectTiles(ViewportInstance* pInstance, Param_TilesBatch* pTilesBatch, int32_t poseIdx)
+{
+    HeadPose *pose = &pTilesBatch->pPoses[poseIdx];
+    generateViewPortParam *param = &pInstance->param;
+    if (genViewport_setViewPort(pInstance->viewport, pose->yaw, pose->pitch))
+        return -1;
+
+    for (int32_t i = 0; i < 6; i++)
+    {
+        pInstance->upLeft[i].faceId = -1;
+        pInstance->downRight[i].faceId = -1;
+    }
+    if (param->m_input_geoType == E_SVIDEO_EQUIRECT && genViewport_postprocess(param, pInstance->viewport))
+    {
+        SCVP_LOG(LOG_ERROR, "gen viewport process error!\n");
+        return -1;
+    }
+
+    int32_t tilesNum = genViewport_getTilesInViewport(pInstance->viewport, pInstance->tiles.data());
+    if (tilesNum <= 0)
+        return tilesNum;
+    if (tilesNum > pTilesBatch->maxTilesNum)
+    {
+        SCVP_LOG(LOG_ERROR, "%d tiles are selected for the pose %d, more than the max %d!\n", tilesNum, poseIdx, pTilesBatch->maxTilesNum);
+        return -1;
+    }
+    memcpy_s(&pTilesBatch->pTiles[poseIdx * pTilesBatch->maxTilesNum], tilesNum * sizeof(TileDef),
+        pInstance->tiles.data(), tilesNum * sizeof(TileDef));
+
+    if (pTilesBatch->pViewportOutputs)
+    {
+        Param_ViewportOutput *pOutput = &pTilesBatch->pViewportOutputs[poseIdx];
+        memset_s(pOutput, sizeof(Param_ViewportOutput), 0);
+        pOutput->dstWidthAlignTile = param->m_viewportDestWidth;
+        pOutput->dstHeightAlignTile = param->m_viewportDestHeight;
+        if (param->m_input_geoType == E_SVIDEO_EQUIRECT)
+        {
+            for (int32_t i = 0; i < param->m_numFaces; i++)
+            {
+                pOutput->dstWidthNet += (param->m_pDownRight[i].x - param->m_pUpLeft[i].x);
+                pOutput->dstHeightNet = (param->m_pDownRight[i].y - param->m_pUpLeft[i].y);
+            }
+            pOutput->xTopLeftNet = param->m_pUpLeft->x;
+            pOutput->yTopLeftNet = param->m_pUpLeft->y;
+        }
+    }
+
+    if (pTilesBatch->pContentCoverages &&
+        genViewport_getContentCoverage(pInstance->viewport, &pTilesBatch->pContentCoverages[poseIdx]))
+        return -1;
+
+    return tilesNum;
+}
+
+int32_t TviewportBatch::Process(Param_TilesBatch* pTilesBatch)
+{
+    if (!pTilesBatch || !pTilesBatch->pPoses || !pTilesBatch->pTiles || !pTilesBatch->pTilesNum
+        || pTilesBatch->posesNum <= 0 || pTilesBatch->maxTilesNum <= 0)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int32_t instancesNum = (pTilesBatch->posesNum < m_threadNum) ? pTilesBatch->posesNum : m_threadNum;
+    while ((int32_t)m_instances.size() < instancesNum)
+    {
+        ViewportInstance *pInstance = CreateInstance();
+        if (!pInstance)
+            break;
+        m_instances.push_back(pInstance);
+    }
+    if (m_instances.empty())
+        return -1;
+    if ((int32_t)m_instances.size() < instancesNum)
+        instancesNum = (int32_t)m_instances.size();
+    if (instancesNum > 1 && !m_pWorkers)
+        m_pWorkers = new TmergeWorkers(m_threadNum);
+
+    // one job per viewport instance, the jobs take the poses one by one to balance the threads
+    std::atomic<int32_t> nextPose(0);
+    std::atomic<int32_t> failedNum(0);
+    std::function<void(int32_t)> selectPoses = [&](int32_t instanceIdx)
+    {
+        int32_t poseIdx = 0;
+        while ((poseIdx = nextPose.fetch_add(1)) < pTilesBatch->posesNum)
+        {
+            int32_t tilesNum = SelectTiles(m_instances[instanceIdx], pTilesBatch, poseIdx);
+            pTilesBatch->pTilesNum[poseIdx] = tilesNum;
+            if (tilesNum <= 0)
+                failedNum++;
+        }
+    };
+
+    if (m_pWorkers && instancesNum > 1)
+        m_pWorkers->Run(instancesNum, selectPoses);
+    else
+        selectPoses(0);
+
+    return failedNum ? -1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   360SCVPViewportBatch.h
+//! \brief:  Tile selection of many poses on per-thread viewport instances,
+//!          apart from the viewport of the handle
+//!
+
+#ifndef _360SCVP_VIEWPORT_BATCH_H_
+#define _360SCVP_VIEWPORT_BATCH_H_
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+#include "360SCVPAPI.h"
+#include "360SCVPViewportAPI.h"
+#include "360SCVPMergeWorkers.h"
+
+class TviewportBatch
+{
+public:
+    //!
+    //! \brief  the viewport instances are created from pViewportParam, the
+    //!         parameters of the handle viewport after its initialization.
+    //!         they are cloned from pSrcViewport if it is not NULL, which
+    //!         must not change while the batch lives
+    //!
+    TviewportBatch(generateViewPortParam* pViewportParam, int32_t maxSelTiles, int32_t threadNum, void* pSrcViewport = NULL);
+    virtual ~TviewportBatch();
+
+    //!
+    //! \brief  select the tiles of all the poses, the concurrent calls run
+    //!         one after another on the same workers
+    //!
+    int32_t Process(Param_TilesBatch* pTilesBatch);
+
+    //!
+    //! \brief  set the parameters of the handle viewport again, the
+    //!         instances are created again by the next selection if the
+    //!         input parameters changed
+    //!
+    void SetViewportParam(generateViewPortParam* pViewportParam);
+
+private:
+    TviewportBatch(const TviewportBatch&) = delete;
+    TviewportBatch& operator=(const TviewportBatch&) = delete;
+
+    //! one viewport of the library with its own parameters and scratch
+    struct ViewportInstance
+    {
+        void                 *viewport;
+        generateViewPortParam param;
+        point                 upLeft[6];
+        point                 downRight[6];
+        std::vector<TileDef>  tiles;
+    };
+
+    ViewportInstance* CreateInstance();
+    void ReleaseInstances();
+    int32_t SelectTiles(ViewportInstance* pInstance, Param_TilesBatch* pTilesBatch, int32_t poseIdx);
+
+    std::mutex                      m_mutex;
+    generateViewPortParam           m_viewportParam;
+    int32_t                         m_maxSelTiles;
+    int32_t                         m_threadNum;
+    void                           *m_pSrcViewport;
+    std::vector<ViewportInstance*>  m_instances;
+    TmergeWorkers                  *m_pWorkers;
+};
+
+#endif // _360SCVP_VIEWPORT_BATCH_H_
@@ -208,6 +208,23 @@ void* genViewport_Init(generateViewPortParam* pParamGenViewport)
     return (void*)cTAppConvCfg;
 }
 
+void* genViewport_Clone(void* pGenHandle)
+{
+    TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
+    if (!cTAppConvCfg)
+        return NULL;
+
+    TgenViewport* cTAppConvCfgNew = new TgenViewport(*cTAppConvCfg);
+    if (!cTAppConvCfgNew)
+        return NULL;
+    if (cTAppConvCfg->m_srd && !cTAppConvCfgNew->m_srd)
+    {
+        SAFE_DELETE(cTAppConvCfgNew);
+        return NULL;
+    }
+    return (void*)cTAppConvCfgNew;
+}
+
 int32_t   genViewport_process(generateViewPortParam* pParamGenViewport, void* pGenHandle)
 {
     TgenViewport* cTAppConvCfg = (TgenViewport*)(pGenHandle);
@@ -726,11 +743,11 @@ TgenViewport::TgenViewport(TgenViewport& src)
     m_faceSizeAlignment = src.m_faceSizeAlignment;
     m_pUpLeft = new SPos[FACE_NUMBER];
     m_pDownRight = new SPos[FACE_NUMBER];
-    memcpy_s(m_pUpLeft, sizeof(SPos), src.m_pUpLeft, sizeof(SPos));
-    memcpy_s(m_pDownRight, sizeof(SPos), src.m_pDownRight, sizeof(SPos));
+    memcpy_s(m_pUpLeft, FACE_NUMBER * sizeof(SPos), src.m_pUpLeft, FACE_NUMBER * sizeof(SPos));
+    memcpy_s(m_pDownRight, FACE_NUMBER * sizeof(SPos), src.m_pDownRight, FACE_NUMBER * sizeof(SPos));
     m_codingSVideoInfo = src.m_codingSVideoInfo;
     m_sourceSVideoInfo = src.m_sourceSVideoInfo;
-    m_iCodingFaceWidth = src.m_iCodingFaceHeight;
+    m_iCodingFaceWidth = src.m_iCodingFaceWidth;
     m_iCodingFaceHeight = src.m_iCodingFaceHeight;
     m_iSourceWidth = src.m_iSourceWidth;
     m_iSourceHeight = src.m_iSourceHeight;
@@ -739,13 +756,22 @@ TgenViewport::TgenViewport(TgenViewport& src)
     m_iFrameRate = src.m_iFrameRate;
     m_iInputWidth = src.m_iInputWidth;
     m_iInputHeight = src.m_iInputHeight;
+    m_aiPad[0] = src.m_aiPad[0];
+    m_aiPad[1] = src.m_aiPad[1];
     m_maxTileNum = src.m_maxTileNum;
     m_usageType = src.m_usageType;
     m_numFaces = src.m_numFaces;
     m_srd = NULL;
     m_pViewportHorizontalBoudaryPoints = NULL;
-    m_paramVideoFP.cols = src.m_paramVideoFP.cols;
-    m_paramVideoFP.rows = src.m_paramVideoFP.rows;
+    m_paramVideoFP = src.m_paramVideoFP;
+    // copy the tile tables instead of computing them again
+    if (src.m_srd && src.m_pViewportHorizontalBoudaryPoints && create(m_tileNumRow, m_tileNumCol) == 0)
+    {
+        int32_t totalTileInfoSize = FACE_NUMBER * m_tileNumRow * m_tileNumCol * sizeof(ITileInfo);
+        int32_t boundaryPointsSize = (ERP_VERT_ANGLE / HORZ_BOUNDING_STEP + 1) * sizeof(SpherePoint);
+        memcpy_s(m_srd, totalTileInfoSize, src.m_srd, totalTileInfoSize);
+        memcpy_s(m_pViewportHorizontalBoudaryPoints, boundaryPointsSize, src.m_pViewportHorizontalBoudaryPoints, boundaryPointsSize);
+    }
 }
 
 TgenViewport::~TgenViewport()
@@ -790,7 +816,7 @@ int32_t TgenViewport::create(uint32_t tileNumRow, uint32_t tileNumCol)
     m_tileNumCol = tileNumCol;
     if (!m_srd)
     {
-        m_srd = new ITileInfo[FACE_NUMBER*m_tileNumRow*m_tileNumCol];
+        m_srd = new ITileInfo[FACE_NUMBER*m_tileNumRow*m_tileNumCol]();
         if (!m_srd)
             return -1;
     }
@@ -0,0 +1,8 @@
+#!/bin/bash -e
+
+# run the 360SCVP micro benchmarks and keep the results as json,
+# pass the extra google benchmark options, e.g. --benchmark_filter=ERP
+g++ -I../util/ -std=c++11 -O2 -c bench360SCVP.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+LD_FLAGS="-I/usr/local/include/ -l360SCVP -lbenchmark -lstdc++ -lpthread -lm -L/usr/local/lib"
+g++ -L/usr/local/lib bench360SCVP.o -o 360SCVP_bench ${LD_FLAGS}
+./360SCVP_bench --benchmark_out=360SCVP_bench.json --benchmark_out_format=json "$@"
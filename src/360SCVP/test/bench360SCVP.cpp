@@ -0,0 +1,764 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   bench360SCVP.cpp
+//! \brief:  micro benchmarks of the 360SCVP hot paths, viewport tile
+//!          selection, NAL parse, parameter set rewrite, RWPK SEI, tile
+//!          merge and stream stitch. Run it in this folder so that test.265
+//!          and test_low.265 are found, and use --benchmark_out=<file>
+//!          --benchmark_out_format=json to keep the results.
+//!
+
+#include "benchmark/benchmark.h"
+#include <stdio.h>
+#include <vector>
+#include "../360SCVPAPI.h"
+
+extern "C" {
+    #include "safestringlib/safe_mem_lib.h"
+}
+
+namespace{
+
+#define HIGH_RES_WIDTH   3840
+#define HIGH_RES_HEIGHT  2048
+#define LOW_RES_WIDTH    1280
+#define LOW_RES_HEIGHT   768
+#define MAX_TILES_NUM    1024
+#define YAW_STEP         7.5f
+
+static bool LoadFile(const char* name, std::vector<uint8_t>& data)
+{
+    FILE* pFile = fopen(name, "rb");
+    if (!pFile)
+        return false;
+
+    fseek(pFile, 0, SEEK_END);
+    long fileLen = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    if (fileLen <= 0)
+    {
+        fclose(pFile);
+        return false;
+    }
+
+    data.resize(fileLen);
+    size_t readLen = fread(data.data(), 1, fileLen, pFile);
+    fclose(pFile);
+    data.resize(readLen);
+    return readLen > 0;
+}
+
+//! recorded tile bitstreams shared by all benchmarks, loaded once
+class BenchStreams
+{
+public:
+    static BenchStreams& Get()
+    {
+        static BenchStreams streams;
+        return streams;
+    }
+
+    bool IsValid() { return m_valid; }
+
+    std::vector<uint8_t> m_high;
+    std::vector<uint8_t> m_low;
+
+private:
+    BenchStreams()
+    {
+        m_valid = LoadFile("./test.265", m_high) && LoadFile("./test_low.265", m_low);
+    }
+
+    bool m_valid;
+};
+
+static void SetERPViewport(param_360SCVP* pParam, int32_t faceWidth, int32_t faceHeight,
+                           int32_t tileCols, int32_t tileRows, float fov)
+{
+    pParam->paramViewPort.faceWidth = faceWidth;
+    pParam->paramViewPort.faceHeight = faceHeight;
+    pParam->paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    pParam->paramViewPort.viewportHeight = 1024;
+    pParam->paramViewPort.viewportWidth = 1024;
+    pParam->paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    pParam->paramViewPort.tileNumCol = tileCols;
+    pParam->paramViewPort.tileNumRow = tileRows;
+    pParam->paramViewPort.viewPortYaw = 0;
+    pParam->paramViewPort.viewPortPitch = 0;
+    pParam->paramViewPort.viewPortFOVH = fov;
+    pParam->paramViewPort.viewPortFOVV = fov;
+    pParam->paramViewPort.paramVideoFP.cols = 1;
+    pParam->paramViewPort.paramVideoFP.rows = 1;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].faceWidth = faceWidth;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].faceHeight = faceHeight;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].idFace = 0;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+}
+
+static void SetCubeMapViewport(param_360SCVP* pParam, int32_t tileGrid, float fov)
+{
+    pParam->paramViewPort.faceWidth = 512 * 4;
+    pParam->paramViewPort.faceHeight = 512 * 4;
+    pParam->paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+    pParam->paramViewPort.viewportHeight = 960;
+    pParam->paramViewPort.viewportWidth = 960;
+    pParam->paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    pParam->paramViewPort.tileNumCol = tileGrid;
+    pParam->paramViewPort.tileNumRow = tileGrid;
+    pParam->paramViewPort.viewPortYaw = 0;
+    pParam->paramViewPort.viewPortPitch = 0;
+    pParam->paramViewPort.viewPortFOVH = fov;
+    pParam->paramViewPort.viewPortFOVV = fov;
+    pParam->paramViewPort.paramVideoFP.cols = 3;
+    pParam->paramViewPort.paramVideoFP.rows = 2;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].idFace = 4;
+    pParam->paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    pParam->paramViewPort.paramVideoFP.faces[0][1].idFace = 0;
+    pParam->paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+    pParam->paramViewPort.paramVideoFP.faces[0][2].idFace = 5;
+    pParam->paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+    pParam->paramViewPort.paramVideoFP.faces[1][0].idFace = 3;
+    pParam->paramViewPort.paramVideoFP.faces[1][0].rotFace = ROTATION_180_ANTICLOCKWISE;
+    pParam->paramViewPort.paramVideoFP.faces[1][1].idFace = 1;
+    pParam->paramViewPort.paramVideoFP.faces[1][1].rotFace = ROTATION_270_ANTICLOCKWISE;
+    pParam->paramViewPort.paramVideoFP.faces[1][2].idFace = 2;
+    pParam->paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+}
+
+//! select the tiles for a viewport moving along the yaw, the pitch
+//! swings between -45 and 45 degrees to cover the polar tiles too
+static void RunTilesInViewport(benchmark::State& state, void* pI360SCVP)
+{
+    TileDef* pOutTile = new TileDef[MAX_TILES_NUM];
+    Param_ViewportOutput paramViewportOutput;
+    float yaw = 0;
+    int64_t tilesNum = 0;
+    int64_t loop = 0;
+
+    for (auto _ : state)
+    {
+        float pitch = (float)((loop % 7) - 3) * 15.0f;
+        I360SCVP_setViewPort(pI360SCVP, yaw, pitch);
+        int32_t ret = I360SCVP_getTilesInViewport(pOutTile, &paramViewportOutput, pI360SCVP);
+        benchmark::DoNotOptimize(ret);
+        if (ret > 0)
+            tilesNum += ret;
+
+        yaw += YAW_STEP;
+        if (yaw > 180)
+            yaw -= 360;
+        loop++;
+    }
+
+    state.counters["tiles"] = benchmark::Counter((double)tilesNum, benchmark::Counter::kAvgIterations);
+    delete[] pOutTile;
+}
+
+static void BM_ERPTilesInViewport(benchmark::State& state)
+{
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_VIEWPORT_ONLY;
+    SetERPViewport(&param, 7680, 3840, (int32_t)state.range(0), (int32_t)state.range(1), (float)state.range(2));
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    RunTilesInViewport(state, pI360SCVP);
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_ERPTilesInViewport)
+    ->ArgNames({"cols", "rows", "fov"})
+    ->ArgsProduct({{8}, {4}, {80, 100, 120}})
+    ->ArgsProduct({{20}, {10}, {80, 100, 120}})
+    ->ArgsProduct({{32}, {16}, {80, 100, 120}});
+
+//! select the tiles of a head trace of 64 poses in one batch, to compare
+//! with BM_ERPTilesInViewport per pose
+static void BM_ERPTilesInViewportBatch(benchmark::State& state)
+{
+    const int32_t posesNum = 64;
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_VIEWPORT_ONLY;
+    SetERPViewport(&param, 7680, 3840, 20, 10, (float)state.range(0));
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    std::vector<HeadPose> poses(posesNum);
+    for (int32_t i = 0; i < posesNum; i++)
+    {
+        memset_s((void*)&poses[i], sizeof(HeadPose), 0);
+        poses[i].yaw = -180 + i * YAW_STEP;
+        while (poses[i].yaw > 180)
+            poses[i].yaw -= 360;
+        poses[i].pitch = (float)((i % 7) - 3) * 15.0f;
+    }
+    std::vector<TileDef> tiles(posesNum * MAX_TILES_NUM);
+    std::vector<int32_t> tilesNum(posesNum);
+    Param_TilesBatch tilesBatch;
+    memset_s((void*)&tilesBatch, sizeof(Param_TilesBatch), 0);
+    tilesBatch.pPoses = poses.data();
+    tilesBatch.posesNum = posesNum;
+    tilesBatch.maxTilesNum = MAX_TILES_NUM;
+    tilesBatch.pTiles = tiles.data();
+    tilesBatch.pTilesNum = tilesNum.data();
+    // the first batch creates the viewport instances of the threads
+    I360SCVP_getTilesInViewportBatch(&tilesBatch, pI360SCVP);
+
+    for (auto _ : state)
+    {
+        int32_t ret = I360SCVP_getTilesInViewportBatch(&tilesBatch, pI360SCVP);
+        benchmark::DoNotOptimize(ret);
+    }
+
+    state.SetItemsProcessed(state.iterations() * posesNum);
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_ERPTilesInViewportBatch)->ArgName("fov")->Arg(80)->Arg(120)->UseRealTime();
+
+//! create and release one viewport handle, by itself or as a session of a
+//! shared context, the cost of each new stream or thread using the library
+static void BM_ERPViewportHandleCreate(benchmark::State& state)
+{
+    bool bSession = (state.range(0) != 0);
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_VIEWPORT_ONLY;
+    SetERPViewport(&param, 7680, 3840, 20, 10, 80);
+
+    void* pContext = I360SCVP_CreateContext(&param);
+    if (!pContext)
+    {
+        state.SkipWithError("Create 360SCVP context failure");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        void* pI360SCVP = bSession ? I360SCVP_CreateSession(pContext) : I360SCVP_Init(&param);
+        if (!pI360SCVP)
+        {
+            state.SkipWithError("Create 360SCVP handle failure");
+            break;
+        }
+        I360SCVP_unInit(pI360SCVP);
+    }
+    I360SCVP_DestroyContext(pContext);
+}
+BENCHMARK(BM_ERPViewportHandleCreate)->ArgName("session")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_CubeMapTilesInViewport(benchmark::State& state)
+{
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_VIEWPORT_ONLY;
+    SetCubeMapViewport(&param, (int32_t)state.range(0), (float)state.range(1));
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    RunTilesInViewport(state, pI360SCVP);
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_CubeMapTilesInViewport)
+    ->ArgNames({"grid", "fov"})
+    ->ArgsProduct({{2, 4, 8}, {80, 100, 120}});
+
+//! parse all the NAL units of the recorded high resolution stream
+static void BM_ParseNAL(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    if (!streams.IsValid())
+    {
+        state.SkipWithError("test.265 or test_low.265 is not found");
+        return;
+    }
+
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    int64_t nalsNum = 0;
+    for (auto _ : state)
+    {
+        uint8_t* pData = streams.m_high.data();
+        int32_t leftLen = (int32_t)streams.m_high.size();
+        while (leftLen > 0)
+        {
+            Nalu nal;
+            nal.data = pData;
+            nal.dataSize = leftLen;
+            if (I360SCVP_ParseNAL(&nal, pI360SCVP) || nal.dataSize <= 0)
+                break;
+            pData += nal.dataSize;
+            leftLen -= nal.dataSize;
+            nalsNum++;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * (int64_t)streams.m_high.size());
+    state.counters["nals"] = benchmark::Counter((double)nalsNum, benchmark::Counter::kAvgIterations);
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_ParseNAL);
+
+//! locate the first NAL unit of the given type in the high resolution stream,
+//! the context keeps the parsed VPS/SPS/PPS needed by the rewrite functions
+static bool FindNAL(void* pI360SCVP, std::vector<uint8_t>& stream, uint16_t naluType, Nalu* pNal, bool sliceType)
+{
+    uint8_t* pData = stream.data();
+    int32_t leftLen = (int32_t)stream.size();
+    while (leftLen > 0)
+    {
+        pNal->data = pData;
+        pNal->dataSize = leftLen;
+        if (I360SCVP_ParseNAL(pNal, pI360SCVP) || pNal->dataSize <= 0)
+            return false;
+        if ((!sliceType && pNal->naluType == naluType) || (sliceType && pNal->naluType < 22))
+            return true;
+        pData += pNal->dataSize;
+        leftLen -= pNal->dataSize;
+    }
+    return false;
+}
+
+static void BM_GenerateSPS(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    Nalu nal;
+    if (!pI360SCVP || !streams.IsValid() || !FindNAL(pI360SCVP, streams.m_high, 33, &nal, false))
+    {
+        state.SkipWithError("no SPS is found");
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    std::vector<uint8_t> output(streams.m_high.size());
+    for (auto _ : state)
+    {
+        param.pInputBitstream = nal.data;
+        param.inputBitstreamLen = nal.dataSize;
+        param.pOutputBitstream = output.data();
+        param.outputBitstreamLen = 0;
+        param.destWidth = 640;
+        param.destHeight = 320;
+        int32_t ret = I360SCVP_GenerateSPS(&param, pI360SCVP);
+        benchmark::DoNotOptimize(ret);
+    }
+
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_GenerateSPS);
+
+static void BM_GeneratePPS(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    Nalu nal;
+    if (!pI360SCVP || !streams.IsValid() || !FindNAL(pI360SCVP, streams.m_high, 34, &nal, false))
+    {
+        state.SkipWithError("no PPS is found");
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    uint16_t width[2] = { 720, 720 };
+    uint16_t height[2] = { 360, 360 };
+    TileArrangement tileArr;
+    tileArr.tileColsNum = 2;
+    tileArr.tileRowsNum = 2;
+    tileArr.tileColWidth = width;
+    tileArr.tileRowHeight = height;
+
+    std::vector<uint8_t> output(streams.m_high.size());
+    for (auto _ : state)
+    {
+        param.pInputBitstream = nal.data;
+        param.inputBitstreamLen = nal.dataSize;
+        param.pOutputBitstream = output.data();
+        param.outputBitstreamLen = 0;
+        int32_t ret = I360SCVP_GeneratePPS(&param, &tileArr, pI360SCVP);
+        benchmark::DoNotOptimize(ret);
+    }
+
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_GeneratePPS);
+
+static void BM_GenerateSliceHdr(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    Nalu nal;
+    if (!pI360SCVP || !streams.IsValid() || !FindNAL(pI360SCVP, streams.m_high, 0, &nal, true))
+    {
+        state.SkipWithError("no slice is found");
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    // the slice header is parsed together with the parameter sets in front of it
+    uint32_t inputLen = (uint32_t)(nal.data + nal.dataSize - streams.m_high.data());
+    std::vector<uint8_t> output(2 * inputLen);
+    int32_t sliceAddr = 0;
+    for (auto _ : state)
+    {
+        param.pInputBitstream = streams.m_high.data();
+        param.inputBitstreamLen = inputLen;
+        param.pOutputBitstream = output.data();
+        param.outputBitstreamLen = 0;
+        param.destWidth = 640;
+        param.destHeight = 320;
+        int32_t ret = I360SCVP_GenerateSliceHdr(&param, sliceAddr, pI360SCVP);
+        benchmark::DoNotOptimize(ret);
+        sliceAddr = (sliceAddr + 1) & 0x7;
+    }
+
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_GenerateSliceHdr);
+
+//! fill the regions as a grid of 2 rows over a 7680x3840 picture
+static void FillRWPK(RegionWisePacking* pRWPK, int32_t regionsNum)
+{
+    pRWPK->constituentPicMatching = 0;
+    pRWPK->numRegions = (uint8_t)regionsNum;
+    pRWPK->projPicWidth = 7680;
+    pRWPK->projPicHeight = 3840;
+    pRWPK->packedPicWidth = 3840;
+    pRWPK->packedPicHeight = 1920;
+
+    int32_t cols = (regionsNum + 1) / 2;
+    for (int32_t idx = 0; idx < regionsNum; idx++)
+    {
+        RectangularRegionWisePacking* pRegion = &(pRWPK->rectRegionPacking[idx]);
+        memset_s(pRegion, sizeof(RectangularRegionWisePacking), 0);
+        pRegion->projRegWidth = 7680 / cols;
+        pRegion->projRegHeight = 1920;
+        pRegion->projRegLeft = (idx % cols) * pRegion->projRegWidth;
+        pRegion->projRegTop = (idx / cols) * pRegion->projRegHeight;
+        pRegion->packedRegWidth = (uint16_t)(3840 / cols);
+        pRegion->packedRegHeight = 960;
+        pRegion->packedRegLeft = (uint16_t)((idx % cols) * pRegion->packedRegWidth);
+        pRegion->packedRegTop = (uint16_t)((idx / cols) * pRegion->packedRegHeight);
+    }
+}
+
+static void BM_RWPKEncode(benchmark::State& state)
+{
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    RegionWisePacking rwpk;
+    memset_s(&rwpk, sizeof(RegionWisePacking), 0);
+    rwpk.rectRegionPacking = new RectangularRegionWisePacking[state.range(0)];
+    FillRWPK(&rwpk, (int32_t)state.range(0));
+
+    uint8_t seiBits[1024];
+    int32_t seiLen = 0;
+    for (auto _ : state)
+    {
+        int32_t ret = I360SCVP_GenerateRWPK(pI360SCVP, &rwpk, seiBits, &seiLen);
+        benchmark::DoNotOptimize(ret);
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["bytes"] = seiLen;
+    delete[] rwpk.rectRegionPacking;
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_RWPKEncode)->ArgName("regions")->Arg(1)->Arg(2)->Arg(4);
+
+static void BM_RWPKDecode(benchmark::State& state)
+{
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    RegionWisePacking rwpk;
+    memset_s(&rwpk, sizeof(RegionWisePacking), 0);
+    rwpk.rectRegionPacking = new RectangularRegionWisePacking[state.range(0)];
+    FillRWPK(&rwpk, (int32_t)state.range(0));
+
+    uint8_t seiBits[1024];
+    int32_t seiLen = 0;
+    if (I360SCVP_GenerateRWPK(pI360SCVP, &rwpk, seiBits, &seiLen) || seiLen <= 0)
+    {
+        state.SkipWithError("generate RWPK SEI failure");
+        delete[] rwpk.rectRegionPacking;
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    RegionWisePacking decoded;
+    decoded.rectRegionPacking = new RectangularRegionWisePacking[DEFAULT_REGION_NUM];
+    for (auto _ : state)
+    {
+        int32_t ret = I360SCVP_ParseRWPK(pI360SCVP, &decoded, seiBits, (uint32_t)seiLen);
+        benchmark::DoNotOptimize(ret);
+        benchmark::ClobberMemory();
+    }
+
+    delete[] decoded.rectRegionPacking;
+    delete[] rwpk.rectRegionPacking;
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_RWPKDecode)->ArgName("regions")->Arg(1)->Arg(2)->Arg(4);
+
+//! offset of the first slice in the stream, the parameter sets are in front of it
+static int32_t FirstSliceOffset(std::vector<uint8_t>& stream)
+{
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+        return -1;
+
+    Nalu nal;
+    int32_t offset = -1;
+    if (FindNAL(pI360SCVP, stream, 0, &nal, true))
+        offset = (int32_t)(nal.data - stream.data());
+    I360SCVP_unInit(pI360SCVP);
+    return offset;
+}
+
+//! merge the viewport tiles of the high resolution frame with the tiles of
+//! the low resolution frame into one frame, a new pose for each frame.
+//! the first frame carries the parameter sets, the later frames only carry
+//! the slices, and the library puts the kept parameter sets in front of them
+//! in the input buffers, so the buffers are refilled before each frame
+static void BM_MergeAndViewport(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    int32_t highOffset = -1;
+    int32_t lowOffset = -1;
+    if (streams.IsValid())
+    {
+        highOffset = FirstSliceOffset(streams.m_high);
+        lowOffset = FirstSliceOffset(streams.m_low);
+    }
+    if (highOffset < 0 || lowOffset < 0)
+    {
+        state.SkipWithError("test.265 or test_low.265 is not found");
+        return;
+    }
+
+    uint32_t highLen = (uint32_t)streams.m_high.size();
+    uint32_t lowLen = (uint32_t)streams.m_low.size();
+    std::vector<uint8_t> inputHigh(2 * (highLen + lowLen));
+    std::vector<uint8_t> inputLow(2 * (highLen + lowLen));
+    std::vector<uint8_t> output(HIGH_RES_WIDTH * HIGH_RES_HEIGHT * 3 / 2);
+    std::vector<uint8_t> outputSEI(2000);
+    memcpy_s(inputHigh.data(), inputHigh.size(), streams.m_high.data(), highLen);
+    memcpy_s(inputLow.data(), inputLow.size(), streams.m_low.data(), lowLen);
+
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_MERGE_AND_VIEWPORT;
+    param.pInputBitstream = inputHigh.data();
+    param.inputBitstreamLen = highLen;
+    param.pInputLowBitstream = inputLow.data();
+    param.inputLowBistreamLen = lowLen;
+    param.frameWidth = HIGH_RES_WIDTH;
+    param.frameHeight = HIGH_RES_HEIGHT;
+    param.frameWidthLow = LOW_RES_WIDTH;
+    param.frameHeightLow = LOW_RES_HEIGHT;
+    param.pOutputBitstream = output.data();
+    param.pOutputSEI = outputSEI.data();
+    SetERPViewport(&param, HIGH_RES_WIDTH, HIGH_RES_HEIGHT, 0, 0, 80);
+    param.paramViewPort.viewportWidth = 960;
+    param.paramViewPort.viewportHeight = 960;
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+    if (I360SCVP_process(&param, pI360SCVP))
+    {
+        state.SkipWithError("merge failure on the first frame");
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    float yaw = 0;
+    int64_t outputLen = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        memcpy_s(inputHigh.data(), inputHigh.size(), streams.m_high.data() + highOffset, highLen - highOffset);
+        memcpy_s(inputLow.data(), inputLow.size(), streams.m_low.data() + lowOffset, lowLen - lowOffset);
+        param.inputBitstreamLen = highLen - highOffset;
+        param.inputLowBistreamLen = lowLen - lowOffset;
+        param.outputBitstreamLen = 0;
+        param.outputSEILen = 0;
+        state.ResumeTiming();
+
+        I360SCVP_setViewPort(pI360SCVP, yaw, 0);
+        int32_t ret = I360SCVP_process(&param, pI360SCVP);
+        if (ret)
+        {
+            state.SkipWithError("merge failure");
+            break;
+        }
+        outputLen += param.outputBitstreamLen;
+        yaw += YAW_STEP;
+        if (yaw > 180)
+            yaw -= 360;
+    }
+
+    state.SetBytesProcessed(outputLen);
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_MergeAndViewport)->Unit(benchmark::kMicrosecond);
+
+
+//! stitch 3x2 copies of the recorded frame into one frame, each copy keeps
+//! all its tiles, with the given threads number
+static void BM_StreamStitch(benchmark::State& state)
+{
+    BenchStreams& streams = BenchStreams::Get();
+    param_360SCVP param;
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    Nalu nal;
+    if (!pI360SCVP || !streams.IsValid() || !FindNAL(pI360SCVP, streams.m_high, 34, &nal, false))
+    {
+        state.SkipWithError("no PPS is found");
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+    Param_PicInfo picInfo;
+    Param_PicInfo* pPicInfo = &picInfo;
+    I360SCVP_GetParameter(pI360SCVP, ID_SCVP_PARAM_PICINFO, (void**)&pPicInfo);
+    I360SCVP_unInit(pI360SCVP);
+
+    const int32_t streamCols = 3;
+    const int32_t streamRows = 2;
+    const int32_t streamNum = streamCols * streamRows;
+    param_oneStream_info tiledStreams[streamNum];
+    param_oneStream_info* pTiledStreams[streamNum];
+    for (int32_t i = 0; i < streamNum; i++)
+    {
+        memset_s(&tiledStreams[i], sizeof(param_oneStream_info), 0);
+        tiledStreams[i].tilesWidthCount = picInfo.tileWidthNum;
+        tiledStreams[i].tilesHeightCount = picInfo.tileHeightNum;
+        tiledStreams[i].pTiledBitstreamBuffer = streams.m_high.data();
+        tiledStreams[i].inputBufferLen = (uint32_t)streams.m_high.size();
+        pTiledStreams[i] = &tiledStreams[i];
+    }
+
+    uint32_t inputLen = streamNum * (uint32_t)streams.m_high.size();
+    std::vector<uint8_t> output(2 * inputLen);
+    memset_s((void*)&param, sizeof(param_360SCVP), 0);
+    param.usedType = E_STREAM_STITCH_ONLY;
+    param.paramPicInfo.picWidth = picInfo.picWidth * streamCols;
+    param.paramPicInfo.picHeight = picInfo.picHeight * streamRows;
+    param.paramPicInfo.tileWidthNum = streamCols;
+    param.paramPicInfo.tileHeightNum = streamRows;
+    param.paramPicInfo.tileIsUniform = 1;
+    param.paramStitchInfo.pTiledBitstream = pTiledStreams;
+    param.paramStitchInfo.mergeThreadNum = (int32_t)state.range(0);
+    param.pOutputBitstream = output.data();
+
+    pI360SCVP = I360SCVP_Init(&param);
+    if (!pI360SCVP)
+    {
+        state.SkipWithError("Init 360SCVP failure");
+        return;
+    }
+
+    int64_t outputLen = 0;
+    for (auto _ : state)
+    {
+        param.inputBitstreamLen = inputLen;
+        int32_t ret = I360SCVP_process(&param, pI360SCVP);
+        if (ret)
+        {
+            state.SkipWithError("stitch failure");
+            break;
+        }
+        outputLen += param.outputBitstreamLen;
+    }
+
+    state.SetBytesProcessed(outputLen);
+    state.counters["tiles"] = streamNum * picInfo.tileWidthNum * picInfo.tileHeightNum;
+    I360SCVP_unInit(pI360SCVP);
+}
+BENCHMARK(BM_StreamStitch)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+BENCHMARK_MAIN();
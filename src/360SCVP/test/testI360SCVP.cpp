@@ -27,7 +27,10 @@
 #include "gtest/gtest.h"
 #include <string>
 #include <fstream>
+#include <thread>
+#include <algorithm>
 #include "../360SCVPAPI.h"
+#include "../360SCVPHeaderCache.h"
 
 extern "C" {
     #include "safestringlib/safe_mem_lib.h"
@@ -291,6 +294,113 @@ TEST_F(I360SCVPTest, GenerateSPS_PPS_SliceHdr)
     //I360SCVP_unInit(pI360SCVP);
 }
 
+TEST_F(I360SCVPTest, GenerateSPS_PPS_LayoutSwitch)
+{
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    // find the sps and the pps
+    Nalu nal;
+    Nalu sps, pps;
+    memset_s(&sps, sizeof(Nalu), 0);
+    memset_s(&pps, sizeof(Nalu), 0);
+    int32_t ret = 0;
+    unsigned char* pInputBufferTmp = pInputBuffer;
+    int32_t leftLen = bufferlen;
+    while (!ret && leftLen > 0 && !(sps.data && pps.data))
+    {
+        nal.data = pInputBufferTmp;
+        nal.dataSize = leftLen;
+        ret = I360SCVP_ParseNAL(&nal, pI360SCVP);
+        if (nal.naluType == 33)
+            sps = nal;
+        else if (nal.naluType == 34)
+            pps = nal;
+        pInputBufferTmp += nal.dataSize;
+        leftLen -= nal.dataSize;
+    }
+    EXPECT_TRUE(sps.data != NULL && pps.data != NULL);
+    if (!sps.data || !pps.data)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        return;
+    }
+
+    // switch between two layouts, the headers of a layout keep the same
+    int32_t destWidth[3] = { 640, 1280, 640 };
+    int32_t destHeight[3] = { 320, 640, 320 };
+    uint16_t width[3][2] = { { 320, 320 }, { 640, 640 }, { 320, 320 } };
+    uint16_t height[3][2] = { { 320, 320 }, { 320, 320 }, { 320, 320 } };
+    uint8_t rowsNum[3] = { 1, 2, 1 };
+    unsigned char spsOut[3][1024];
+    unsigned char ppsOut[3][1024];
+    uint32_t spsLen[3] = { 0, 0, 0 };
+    uint32_t ppsLen[3] = { 0, 0, 0 };
+    for (int32_t i = 0; i < 3; i++)
+    {
+        param.pInputBitstream = sps.data;
+        param.inputBitstreamLen = sps.dataSize;
+        param.destWidth = destWidth[i];
+        param.destHeight = destHeight[i];
+        param.pOutputBitstream = spsOut[i];
+        ret |= I360SCVP_GenerateSPS(&param, pI360SCVP);
+        spsLen[i] = param.outputBitstreamLen;
+
+        TileArrangement tileArr;
+        tileArr.tileColsNum = 2;
+        tileArr.tileRowsNum = rowsNum[i];
+        tileArr.tileColWidth = width[i];
+        tileArr.tileRowHeight = height[i];
+        param.pInputBitstream = pps.data;
+        param.inputBitstreamLen = pps.dataSize;
+        param.pOutputBitstream = ppsOut[i];
+        ret |= I360SCVP_GeneratePPS(&param, &tileArr, pI360SCVP);
+        ppsLen[i] = param.outputBitstreamLen;
+    }
+    I360SCVP_unInit(pI360SCVP);
+
+    // another handle reuses the headers cached by the first one
+    param.usedType = E_PARSER_ONENAL;
+    param.pInputBitstream = pInputBuffer;
+    param.inputBitstreamLen = bufferlen;
+    pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    unsigned char spsShared[1024];
+    uint32_t spsSharedLen = 0;
+    uint64_t hits = TheaderCache::GetShared()->GetHits();
+    if (pI360SCVP)
+    {
+        param.pInputBitstream = sps.data;
+        param.inputBitstreamLen = sps.dataSize;
+        param.destWidth = destWidth[0];
+        param.destHeight = destHeight[0];
+        param.pOutputBitstream = spsShared;
+        ret |= I360SCVP_GenerateSPS(&param, pI360SCVP);
+        spsSharedLen = param.outputBitstreamLen;
+        I360SCVP_unInit(pI360SCVP);
+    }
+    EXPECT_TRUE(TheaderCache::GetShared()->GetHits() == hits + 1);
+    EXPECT_TRUE(spsSharedLen == spsLen[0]);
+    if (spsSharedLen == spsLen[0])
+    {
+        EXPECT_TRUE(memcmp(spsShared, spsOut[0], spsLen[0]) == 0);
+    }
+
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(spsLen[0] > 0 && ppsLen[0] > 0);
+    EXPECT_TRUE(spsLen[0] == spsLen[2] && ppsLen[0] == ppsLen[2]);
+    if (spsLen[0] == spsLen[2] && ppsLen[0] == ppsLen[2])
+    {
+        EXPECT_TRUE(memcmp(spsOut[0], spsOut[2], spsLen[0]) == 0);
+        EXPECT_TRUE(memcmp(ppsOut[0], ppsOut[2], ppsLen[0]) == 0);
+    }
+    EXPECT_TRUE(spsLen[0] != spsLen[1] || memcmp(spsOut[0], spsOut[1], spsLen[0]) != 0);
+    EXPECT_TRUE(ppsLen[0] != ppsLen[1] || memcmp(ppsOut[0], ppsOut[1], ppsLen[0]) != 0);
+}
+
 TEST_F(I360SCVPTest, GetParameter_PicInfo_type0)
 {
     int ret = 0;
@@ -1210,4 +1320,691 @@ TEST_F(I360SCVPTest, ERPSelectViewportTiles)
     EXPECT_TRUE(tileNum_legacy >= 0);
 }
 
+// the selections only fill the fields they use, so only those are compared
+void expectSameTiles(TileDef* tiles1, TileDef* tiles2, int32_t tilesNum)
+{
+    for (int32_t i = 0; i < tilesNum; i++)
+    {
+        EXPECT_EQ(tiles1[i].x, tiles2[i].x);
+        EXPECT_EQ(tiles1[i].y, tiles2[i].y);
+        EXPECT_EQ(tiles1[i].idx, tiles2[i].idx);
+        EXPECT_EQ(tiles1[i].faceId, tiles2[i].faceId);
+    }
+}
+
+TEST_F(I360SCVPTest, ERPSelectViewportTilesDelta)
+{
+    TileDef prevTiles[1024];
+    TileDef tiles[1024];
+    TileDef fullTiles[1024];
+    TileDef addedTiles[1024];
+    TileDef removedTiles[1024];
+    Param_ViewportOutput paramViewportOutput;
+    memset(prevTiles, 0, sizeof(prevTiles));
+    memset(tiles, 0, sizeof(tiles));
+    memset(fullTiles, 0, sizeof(fullTiles));
+    memset(addedTiles, 0, sizeof(addedTiles));
+    memset(removedTiles, 0, sizeof(removedTiles));
+
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 1024;
+    param.paramViewPort.viewportWidth = 1024;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.viewPortYaw = 0;
+    param.paramViewPort.viewPortPitch = 0;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        printf( "Init 360SCVP failure: pI360SCVP is NULL!!!\n");
+        return;
+    }
+
+    HeadPose selectedPose;
+    memset(&selectedPose, 0, sizeof(HeadPose));
+    selectedPose.yaw = 179;
+    Param_TilesDelta tilesDelta;
+    memset(&tilesDelta, 0, sizeof(Param_TilesDelta));
+    tilesDelta.hysteresis = 5;
+    tilesDelta.pTiles = prevTiles;
+    tilesDelta.pAddedTiles = addedTiles;
+    tilesDelta.pRemovedTiles = removedTiles;
+
+    // no previous selection, all the tiles are added
+    int32_t prevTilesNum = I360SCVP_getTilesInViewportDelta(&selectedPose, &tilesDelta, &paramViewportOutput, pI360SCVP);
+    EXPECT_TRUE(prevTilesNum > 0);
+    EXPECT_TRUE(tilesDelta.bReselected);
+    EXPECT_EQ(tilesDelta.addedTilesNum, prevTilesNum);
+    EXPECT_EQ(tilesDelta.removedTilesNum, 0);
+
+    // the jitter across the yaw boundary is inside the hysteresis
+    HeadPose pose = selectedPose;
+    pose.yaw = -178;
+    pose.pitch = 2;
+    tilesDelta.pPrevPose = &selectedPose;
+    tilesDelta.pPrevTiles = prevTiles;
+    tilesDelta.prevTilesNum = prevTilesNum;
+    tilesDelta.pTiles = tiles;
+    int32_t tilesNum = I360SCVP_getTilesInViewportDelta(&pose, &tilesDelta, &paramViewportOutput, pI360SCVP);
+    EXPECT_EQ(tilesNum, prevTilesNum);
+    EXPECT_FALSE(tilesDelta.bReselected);
+    EXPECT_EQ(tilesDelta.addedTilesNum, 0);
+    EXPECT_EQ(tilesDelta.removedTilesNum, 0);
+    expectSameTiles(tiles, prevTiles, prevTilesNum);
+
+    // the large move selects again, the same as the full selection
+    pose.yaw = -120;
+    pose.pitch = 30;
+    tilesNum = I360SCVP_getTilesInViewportDelta(&pose, &tilesDelta, &paramViewportOutput, pI360SCVP);
+    EXPECT_TRUE(tilesDelta.bReselected);
+    I360SCVP_setViewPortEx(pI360SCVP, &pose);
+    int32_t fullTilesNum = I360SCVP_getTilesInViewport(fullTiles, &paramViewportOutput, pI360SCVP);
+    EXPECT_EQ(tilesNum, fullTilesNum);
+    if (tilesNum == fullTilesNum)
+    {
+        expectSameTiles(tiles, fullTiles, fullTilesNum);
+    }
+    EXPECT_TRUE(tilesDelta.addedTilesNum > 0);
+    EXPECT_TRUE(tilesDelta.removedTilesNum > 0);
+    EXPECT_EQ(prevTilesNum + tilesDelta.addedTilesNum - tilesDelta.removedTilesNum, tilesNum);
+
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest, ERPSelectViewportTilesBatch)
+{
+    const int32_t posesNum = 64;
+    const int32_t maxTilesNum = 256;
+
+    param.paramViewPort.faceWidth = 7680;
+    param.paramViewPort.faceHeight = 3840;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_EQUIRECT);
+    param.paramViewPort.viewportHeight = 1024;
+    param.paramViewPort.viewportWidth = 1024;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 20;
+    param.paramViewPort.tileNumRow = 10;
+    param.paramViewPort.viewPortYaw = 0;
+    param.paramViewPort.viewPortPitch = 0;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 90;
+    param.usedType = E_VIEWPORT_ONLY;
+    param.paramViewPort.paramVideoFP.cols = 1;
+    param.paramViewPort.paramVideoFP.rows = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceWidth = param.paramViewPort.faceWidth;
+    param.paramViewPort.paramVideoFP.faces[0][0].faceHeight = param.paramViewPort.faceHeight;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        printf( "Init 360SCVP failure: pI360SCVP is NULL!!!\n");
+        return;
+    }
+
+    HeadPose poses[posesNum];
+    memset(poses, 0, sizeof(poses));
+    for (int32_t i = 0; i < posesNum; i++)
+    {
+        poses[i].yaw = -180 + i * 360.0 / posesNum;
+        poses[i].pitch = -80 + (i % 9) * 20;
+    }
+
+    // two callers share the handle
+    TileDef *tiles[2];
+    int32_t tilesNum[2][posesNum];
+    CCDef contentCoverages[2][posesNum];
+    Param_ViewportOutput viewportOutputs[2][posesNum];
+    int32_t rets[2];
+    std::thread callers[2];
+    for (int32_t c = 0; c < 2; c++)
+    {
+        tiles[c] = new TileDef[posesNum * maxTilesNum];
+        callers[c] = std::thread([&, c]() {
+            Param_TilesBatch tilesBatch;
+            tilesBatch.pPoses = poses;
+            tilesBatch.posesNum = posesNum;
+            tilesBatch.maxTilesNum = maxTilesNum;
+            tilesBatch.pTiles = tiles[c];
+            tilesBatch.pTilesNum = tilesNum[c];
+            tilesBatch.pViewportOutputs = viewportOutputs[c];
+            tilesBatch.pContentCoverages = contentCoverages[c];
+            rets[c] = I360SCVP_getTilesInViewportBatch(&tilesBatch, pI360SCVP);
+        });
+    }
+    for (int32_t c = 0; c < 2; c++)
+        callers[c].join();
+    EXPECT_EQ(rets[0], 0);
+    EXPECT_EQ(rets[1], 0);
+
+    // the same as the selection of the poses one by one
+    TileDef fullTiles[1024];
+    Param_ViewportOutput paramViewportOutput;
+    CCDef contentCoverage;
+    for (int32_t i = 0; i < posesNum; i++)
+    {
+        I360SCVP_setViewPortEx(pI360SCVP, &poses[i]);
+        int32_t fullTilesNum = I360SCVP_getTilesInViewport(fullTiles, &paramViewportOutput, pI360SCVP);
+        I360SCVP_getContentCoverage(pI360SCVP, &contentCoverage);
+        for (int32_t c = 0; c < 2; c++)
+        {
+            EXPECT_EQ(tilesNum[c][i], fullTilesNum);
+            for (int32_t j = 0; j < fullTilesNum && j < tilesNum[c][i]; j++)
+            {
+                TileDef *tile = &tiles[c][i * maxTilesNum + j];
+                EXPECT_EQ(tile->x, fullTiles[j].x);
+                EXPECT_EQ(tile->y, fullTiles[j].y);
+                EXPECT_EQ(tile->idx, fullTiles[j].idx);
+                EXPECT_EQ(tile->faceId, fullTiles[j].faceId);
+            }
+            EXPECT_EQ(viewportOutputs[c][i].dstWidthAlignTile, paramViewportOutput.dstWidthAlignTile);
+            EXPECT_EQ(viewportOutputs[c][i].dstHeightAlignTile, paramViewportOutput.dstHeightAlignTile);
+            EXPECT_EQ(viewportOutputs[c][i].dstWidthNet, paramViewportOutput.dstWidthNet);
+            EXPECT_EQ(viewportOutputs[c][i].dstHeightNet, paramViewportOutput.dstHeightNet);
+            EXPECT_EQ(memcmp(&contentCoverages[c][i], &contentCoverage, sizeof(CCDef)), 0);
+        }
+    }
+
+    // a copy of the handle creates its own viewport instances for the batch
+    void* pI360SCVPCopy = I360SCVP_New(pI360SCVP);
+    EXPECT_TRUE(pI360SCVPCopy != NULL);
+    if (pI360SCVPCopy)
+    {
+        TileDef *copyTiles = new TileDef[posesNum * maxTilesNum];
+        int32_t copyTilesNum[posesNum];
+        Param_TilesBatch tilesBatch;
+        memset(&tilesBatch, 0, sizeof(Param_TilesBatch));
+        tilesBatch.pPoses = poses;
+        tilesBatch.posesNum = posesNum;
+        tilesBatch.maxTilesNum = maxTilesNum;
+        tilesBatch.pTiles = copyTiles;
+        tilesBatch.pTilesNum = copyTilesNum;
+        EXPECT_EQ(I360SCVP_getTilesInViewportBatch(&tilesBatch, pI360SCVPCopy), 0);
+        for (int32_t i = 0; i < posesNum; i++)
+        {
+            EXPECT_EQ(copyTilesNum[i], tilesNum[0][i]);
+            for (int32_t j = 0; j < copyTilesNum[i] && j < tilesNum[0][i]; j++)
+            {
+                EXPECT_EQ(copyTiles[i * maxTilesNum + j].idx, tiles[0][i * maxTilesNum + j].idx);
+                EXPECT_EQ(copyTiles[i * maxTilesNum + j].faceId, tiles[0][i * maxTilesNum + j].faceId);
+            }
+        }
+        delete [] copyTiles;
+        I360SCVP_unInit(pI360SCVPCopy);
+    }
+
+    for (int32_t c = 0; c < 2; c++)
+        delete [] tiles[c];
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest, cubemapSessionsShareContext)
+{
+    const int32_t posesNum = 32;
+    const int32_t sessionsNum = 3;
+
+    param.paramViewPort.faceWidth = 512 * 4;
+    param.paramViewPort.faceHeight = 512 * 4;
+    param.paramViewPort.geoTypeInput = EGeometryType(E_SVIDEO_CUBEMAP);
+    param.paramViewPort.viewportHeight = 960;
+    param.paramViewPort.viewportWidth = 960;
+    param.paramViewPort.geoTypeOutput = E_SVIDEO_VIEWPORT;
+    param.paramViewPort.tileNumCol = 4;
+    param.paramViewPort.tileNumRow = 4;
+    param.paramViewPort.viewPortYaw = -90;
+    param.paramViewPort.viewPortPitch = 0;
+    param.paramViewPort.viewPortFOVH = 80;
+    param.paramViewPort.viewPortFOVV = 80;
+    param.usedType = E_VIEWPORT_ONLY;
+    param.paramViewPort.paramVideoFP.cols = 3;
+    param.paramViewPort.paramVideoFP.rows = 2;
+    param.paramViewPort.paramVideoFP.faces[0][0].idFace = 4;
+    param.paramViewPort.paramVideoFP.faces[0][0].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][1].idFace = 0;
+    param.paramViewPort.paramVideoFP.faces[0][1].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[0][2].idFace = 5;
+    param.paramViewPort.paramVideoFP.faces[0][2].rotFace = NO_TRANSFORM;
+    param.paramViewPort.paramVideoFP.faces[1][0].idFace = 3;
+    param.paramViewPort.paramVideoFP.faces[1][0].rotFace = ROTATION_180_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][1].idFace = 1;
+    param.paramViewPort.paramVideoFP.faces[1][1].rotFace = ROTATION_270_ANTICLOCKWISE;
+    param.paramViewPort.paramVideoFP.faces[1][2].idFace = 2;
+    param.paramViewPort.paramVideoFP.faces[1][2].rotFace = NO_TRANSFORM;
+
+    param_360SCVP paramContext = param;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    void* pContext = I360SCVP_CreateContext(&paramContext);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    EXPECT_TRUE(pContext != NULL);
+    if (!pI360SCVP || !pContext)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        I360SCVP_DestroyContext(pContext);
+        return;
+    }
+
+    // the sessions keep the context after it is destroyed
+    void* sessions[sessionsNum];
+    for (int32_t c = 0; c < sessionsNum; c++)
+    {
+        sessions[c] = I360SCVP_CreateSession(pContext);
+        EXPECT_TRUE(sessions[c] != NULL);
+    }
+    I360SCVP_DestroyContext(pContext);
+
+    HeadPose poses[posesNum];
+    memset(poses, 0, sizeof(poses));
+    for (int32_t i = 0; i < posesNum; i++)
+    {
+        poses[i].yaw = -180 + i * 360.0 / posesNum;
+        poses[i].pitch = -80 + (i % 9) * 20;
+    }
+
+    TileDef *tiles[sessionsNum];
+    int32_t tilesNum[sessionsNum][posesNum];
+    std::thread callers[sessionsNum];
+    for (int32_t c = 0; c < sessionsNum; c++)
+    {
+        tiles[c] = new TileDef[posesNum * 1024];
+        if (!sessions[c])
+            continue;
+        callers[c] = std::thread([&, c]() {
+            Param_ViewportOutput paramViewportOutput;
+            for (int32_t i = 0; i < posesNum; i++)
+            {
+                I360SCVP_setViewPortEx(sessions[c], &poses[i]);
+                tilesNum[c][i] = I360SCVP_getTilesInViewport(&tiles[c][i * 1024], &paramViewportOutput, sessions[c]);
+            }
+        });
+    }
+    for (int32_t c = 0; c < sessionsNum; c++)
+    {
+        if (callers[c].joinable())
+            callers[c].join();
+    }
+
+    // the same tiles as the handle initialized by itself
+    TileDef fullTiles[1024];
+    Param_ViewportOutput paramViewportOutput;
+    for (int32_t i = 0; i < posesNum; i++)
+    {
+        I360SCVP_setViewPortEx(pI360SCVP, &poses[i]);
+        int32_t fullTilesNum = I360SCVP_getTilesInViewport(fullTiles, &paramViewportOutput, pI360SCVP);
+        for (int32_t c = 0; c < sessionsNum; c++)
+        {
+            if (!sessions[c])
+                continue;
+            EXPECT_EQ(tilesNum[c][i], fullTilesNum);
+            for (int32_t j = 0; j < fullTilesNum && j < tilesNum[c][i]; j++)
+            {
+                TileDef *tile = &tiles[c][i * 1024 + j];
+                EXPECT_EQ(tile->x, fullTiles[j].x);
+                EXPECT_EQ(tile->y, fullTiles[j].y);
+                EXPECT_EQ(tile->idx, fullTiles[j].idx);
+                EXPECT_EQ(tile->faceId, fullTiles[j].faceId);
+            }
+        }
+    }
+
+    for (int32_t c = 0; c < sessionsNum; c++)
+    {
+        delete [] tiles[c];
+        I360SCVP_unInit(sessions[c]);
+    }
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest, parserSessionsShareContext)
+{
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    void* pContext = I360SCVP_CreateContext(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    EXPECT_TRUE(pContext != NULL);
+    if (!pI360SCVP || !pContext)
+    {
+        I360SCVP_unInit(pI360SCVP);
+        I360SCVP_DestroyContext(pContext);
+        return;
+    }
+    void* pSession = I360SCVP_CreateSession(pContext);
+    EXPECT_TRUE(pSession != NULL);
+
+    // the handle parses the headers itself up to the first slice, the session has them from the context
+    Nalu nal;
+    unsigned char* pData = pInputBuffer;
+    int32_t leftLen = bufferlen;
+    nal.naluType = 0;
+    while (leftLen > 0)
+    {
+        nal.data = pData;
+        nal.dataSize = leftLen;
+        if (I360SCVP_ParseNAL(&nal, pI360SCVP) || nal.naluType < 22)
+            break;
+        pData += nal.dataSize;
+        leftLen -= nal.dataSize;
+    }
+    EXPECT_TRUE(nal.naluType < 22);
+
+    unsigned char sliceHdr[2][1024];
+    uint32_t sliceHdrLen[2];
+    void* handles[2] = { pI360SCVP, pSession };
+    for (int32_t h = 0; h < 2; h++)
+    {
+        param.pInputBitstream = nal.data;
+        param.inputBitstreamLen = nal.dataSize;
+        param.pOutputBitstream = sliceHdr[h];
+        param.destWidth = frameWidth;
+        param.destHeight = frameHeight;
+        EXPECT_EQ(I360SCVP_GenerateSliceHdr(&param, 0, handles[h]), 0);
+        sliceHdrLen[h] = param.outputBitstreamLen;
+    }
+    EXPECT_EQ(sliceHdrLen[0], sliceHdrLen[1]);
+    EXPECT_EQ(memcmp(sliceHdr[0], sliceHdr[1], sliceHdrLen[0]), 0);
+
+    I360SCVP_unInit(pSession);
+    I360SCVP_DestroyContext(pContext);
+    I360SCVP_unInit(pI360SCVP);
+}
+
+TEST_F(I360SCVPTest, streamStitchMultiThreads)
+{
+    int32_t ret = 0;
+    Param_PicInfo picInfo;
+    Param_PicInfo* pPicInfo = &picInfo;
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    // parse the parameter sets to get the tiles of the frame
+    Nalu nal;
+    nal.naluType = 0;
+    unsigned char* pInputBufferTmp = pInputBuffer;
+    int32_t leftLen = bufferlen;
+    while (!ret && leftLen > 0 && nal.naluType != 34)
+    {
+        nal.data = pInputBufferTmp;
+        nal.dataSize = leftLen;
+        ret = I360SCVP_ParseNAL(&nal, pI360SCVP);
+        pInputBufferTmp += nal.dataSize;
+        leftLen -= nal.dataSize;
+    }
+    ret |= I360SCVP_GetParameter(pI360SCVP, ID_SCVP_PARAM_PICINFO, (void**)&pPicInfo);
+    I360SCVP_unInit(pI360SCVP);
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(picInfo.tileWidthNum > 0 && picInfo.tileHeightNum > 0);
+    if (ret || picInfo.tileWidthNum <= 0 || picInfo.tileHeightNum <= 0)
+        return;
+
+    // stitch the same frame twice side by side, in the calling thread by default and in 4 threads
+    param_oneStream_info tiledStreams[2];
+    param_oneStream_info* pTiledStreams[2] = { &tiledStreams[0], &tiledStreams[1] };
+    unsigned char* pOutput[2];
+    uint32_t outputLen[2] = { 0, 0 };
+    int32_t threadNum[2] = { 0, 4 };
+    for (int32_t i = 0; i < 2; i++)
+    {
+        for (int32_t j = 0; j < 2; j++)
+        {
+            memset_s(&tiledStreams[j], sizeof(param_oneStream_info), 0);
+            tiledStreams[j].tilesWidthCount = picInfo.tileWidthNum;
+            tiledStreams[j].tilesHeightCount = picInfo.tileHeightNum;
+            tiledStreams[j].pTiledBitstreamBuffer = pInputBuffer;
+            tiledStreams[j].inputBufferLen = bufferlen;
+        }
+        memset_s((void*)&param, sizeof(param_360SCVP), 0);
+        param.usedType = E_STREAM_STITCH_ONLY;
+        param.paramPicInfo.picWidth = picInfo.picWidth * 2;
+        param.paramPicInfo.picHeight = picInfo.picHeight;
+        param.paramPicInfo.tileWidthNum = 2;
+        param.paramPicInfo.tileHeightNum = 1;
+        param.paramPicInfo.tileIsUniform = 1;
+        param.paramStitchInfo.pTiledBitstream = pTiledStreams;
+        param.paramStitchInfo.mergeThreadNum = threadNum[i];
+        pOutput[i] = new unsigned char[4 * bufferlen];
+        param.pOutputBitstream = pOutput[i];
+        param.inputBitstreamLen = 2 * bufferlen;
+
+        pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (pI360SCVP)
+        {
+            ret |= I360SCVP_process(&param, pI360SCVP);
+            outputLen[i] = param.outputBitstreamLen;
+            I360SCVP_unInit(pI360SCVP);
+        }
+    }
+
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(outputLen[0] > 0);
+    EXPECT_TRUE(outputLen[0] == outputLen[1]);
+    if (outputLen[0] == outputLen[1])
+    {
+        EXPECT_TRUE(memcmp(pOutput[0], pOutput[1], outputLen[0]) == 0);
+    }
+    delete[] pOutput[0];
+    delete[] pOutput[1];
+}
+
+TEST_F(I360SCVPTest, streamStitchHeaderCacheTimestamp)
+{
+    int32_t ret = 0;
+    Param_PicInfo picInfo;
+    Param_PicInfo* pPicInfo = &picInfo;
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    Nalu nal;
+    nal.naluType = 0;
+    unsigned char* pInputBufferTmp = pInputBuffer;
+    int32_t leftLen = bufferlen;
+    while (!ret && leftLen > 0 && nal.naluType != 34)
+    {
+        nal.data = pInputBufferTmp;
+        nal.dataSize = leftLen;
+        ret = I360SCVP_ParseNAL(&nal, pI360SCVP);
+        pInputBufferTmp += nal.dataSize;
+        leftLen -= nal.dataSize;
+    }
+    ret |= I360SCVP_GetParameter(pI360SCVP, ID_SCVP_PARAM_PICINFO, (void**)&pPicInfo);
+    I360SCVP_unInit(pI360SCVP);
+    EXPECT_TRUE(ret == 0);
+    if (ret || picInfo.tileWidthNum <= 0 || picInfo.tileHeightNum <= 0)
+        return;
+
+    RectangularRegionWisePacking regions[2];
+    memset_s(regions, sizeof(regions), 0);
+    RegionWisePacking rwpk;
+    memset_s(&rwpk, sizeof(RegionWisePacking), 0);
+    rwpk.numRegions = 2;
+    rwpk.projPicWidth = picInfo.picWidth * 2;
+    rwpk.projPicHeight = picInfo.picHeight;
+    rwpk.packedPicWidth = picInfo.picWidth * 2;
+    rwpk.packedPicHeight = picInfo.picHeight;
+    rwpk.rectRegionPacking = regions;
+    int32_t projType = E_EQUIRECT_PROJECTION;
+
+    // the same frame with two timestamps, the second one reuses the cached headers
+    uint32_t timeStamps[2] = { 0x12345678, 0x2468ace1 };
+    param_oneStream_info tiledStreams[2];
+    param_oneStream_info* pTiledStreams[2] = { &tiledStreams[0], &tiledStreams[1] };
+    unsigned char* pOutput[2];
+    uint32_t outputLen[2] = { 0, 0 };
+    uint64_t hits[2] = { 0, 0 };
+    for (int32_t i = 0; i < 2; i++)
+    {
+        for (int32_t j = 0; j < 2; j++)
+        {
+            memset_s(&tiledStreams[j], sizeof(param_oneStream_info), 0);
+            tiledStreams[j].tilesWidthCount = picInfo.tileWidthNum;
+            tiledStreams[j].tilesHeightCount = picInfo.tileHeightNum;
+            tiledStreams[j].pTiledBitstreamBuffer = pInputBuffer;
+            tiledStreams[j].inputBufferLen = bufferlen;
+        }
+        memset_s((void*)&param, sizeof(param_360SCVP), 0);
+        param.usedType = E_STREAM_STITCH_ONLY;
+        param.paramPicInfo.picWidth = picInfo.picWidth * 2;
+        param.paramPicInfo.picHeight = picInfo.picHeight;
+        param.paramPicInfo.tileWidthNum = 2;
+        param.paramPicInfo.tileHeightNum = 1;
+        param.paramPicInfo.tileIsUniform = 1;
+        param.paramStitchInfo.pTiledBitstream = pTiledStreams;
+        pOutput[i] = new unsigned char[4 * bufferlen];
+        param.pOutputBitstream = pOutput[i];
+        param.inputBitstreamLen = 2 * bufferlen;
+
+        pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (pI360SCVP)
+        {
+            rwpk.timeStamp = timeStamps[i];
+            ret |= I360SCVP_SetParameter(pI360SCVP, ID_SCVP_PARAM_SEI_RWPK, &rwpk);
+            ret |= I360SCVP_SetParameter(pI360SCVP, ID_SCVP_PARAM_SEI_PROJECTION, &projType);
+            hits[i] = TheaderCache::GetShared()->GetHits();
+            ret |= I360SCVP_process(&param, pI360SCVP);
+            hits[i] = TheaderCache::GetShared()->GetHits() - hits[i];
+            outputLen[i] = param.outputBitstreamLen;
+            I360SCVP_unInit(pI360SCVP);
+        }
+    }
+
+    EXPECT_TRUE(ret == 0);
+    // the parameter sets and the projection SEI come from the cache
+    EXPECT_TRUE(hits[1] == 2);
+    EXPECT_TRUE(outputLen[0] > 0);
+    EXPECT_TRUE(outputLen[0] == outputLen[1]);
+    // each frame carries its own timestamp in the RWPK SEI
+    for (int32_t i = 0; i < 2; i++)
+    {
+        uint8_t stamp[2][4];
+        for (int32_t k = 0; k < 2; k++)
+        {
+            for (int32_t b = 0; b < 4; b++)
+                stamp[k][b] = (uint8_t)(timeStamps[k] >> (24 - 8 * b));
+        }
+        unsigned char* pEnd = pOutput[i] + outputLen[i];
+        EXPECT_TRUE(std::search(pOutput[i], pEnd, stamp[i], stamp[i] + 4) != pEnd);
+        EXPECT_TRUE(std::search(pOutput[i], pEnd, stamp[1 - i], stamp[1 - i] + 4) == pEnd);
+    }
+    delete[] pOutput[0];
+    delete[] pOutput[1];
+}
+
+TEST_F(I360SCVPTest, streamStitchOutputSegments)
+{
+    int32_t ret = 0;
+    Param_PicInfo picInfo;
+    Param_PicInfo* pPicInfo = &picInfo;
+    param.usedType = E_PARSER_ONENAL;
+    void* pI360SCVP = I360SCVP_Init(&param);
+    EXPECT_TRUE(pI360SCVP != NULL);
+    if (!pI360SCVP)
+        return;
+
+    Nalu nal;
+    nal.naluType = 0;
+    unsigned char* pInputBufferTmp = pInputBuffer;
+    int32_t leftLen = bufferlen;
+    while (!ret && leftLen > 0 && nal.naluType != 34)
+    {
+        nal.data = pInputBufferTmp;
+        nal.dataSize = leftLen;
+        ret = I360SCVP_ParseNAL(&nal, pI360SCVP);
+        pInputBufferTmp += nal.dataSize;
+        leftLen -= nal.dataSize;
+    }
+    ret |= I360SCVP_GetParameter(pI360SCVP, ID_SCVP_PARAM_PICINFO, (void**)&pPicInfo);
+    I360SCVP_unInit(pI360SCVP);
+    EXPECT_TRUE(ret == 0);
+    if (ret || picInfo.tileWidthNum <= 0 || picInfo.tileHeightNum <= 0)
+        return;
+
+    // stitch the frame into one buffer, then as the gather list without the output buffer
+    param_oneStream_info tiledStreams[2];
+    param_oneStream_info* pTiledStreams[2] = { &tiledStreams[0], &tiledStreams[1] };
+    unsigned char* pOutput = new unsigned char[4 * bufferlen];
+    unsigned char* pCoalesced = new unsigned char[4 * bufferlen];
+    uint32_t outputLen = 0;
+    int32_t coalescedLen = -1;
+    Param_BSSegments segments;
+    Param_BSSegments* pSegments = &segments;
+    memset_s(&segments, sizeof(Param_BSSegments), 0);
+    for (int32_t i = 0; i < 2; i++)
+    {
+        for (int32_t j = 0; j < 2; j++)
+        {
+            memset_s(&tiledStreams[j], sizeof(param_oneStream_info), 0);
+            tiledStreams[j].tilesWidthCount = picInfo.tileWidthNum;
+            tiledStreams[j].tilesHeightCount = picInfo.tileHeightNum;
+            tiledStreams[j].pTiledBitstreamBuffer = pInputBuffer;
+            tiledStreams[j].inputBufferLen = bufferlen;
+        }
+        memset_s((void*)&param, sizeof(param_360SCVP), 0);
+        param.usedType = E_STREAM_STITCH_ONLY;
+        param.paramPicInfo.picWidth = picInfo.picWidth * 2;
+        param.paramPicInfo.picHeight = picInfo.picHeight;
+        param.paramPicInfo.tileWidthNum = 2;
+        param.paramPicInfo.tileHeightNum = 1;
+        param.paramPicInfo.tileIsUniform = 1;
+        param.paramStitchInfo.pTiledBitstream = pTiledStreams;
+        param.paramStitchInfo.mergeThreadNum = 1;
+        param.pOutputBitstream = (i == 0) ? pOutput : NULL;
+        param.inputBitstreamLen = 2 * bufferlen;
+        param.outputSegmentsEnable = (i == 1);
+
+        pI360SCVP = I360SCVP_Init(&param);
+        EXPECT_TRUE(pI360SCVP != NULL);
+        if (!pI360SCVP)
+            break;
+        ret |= I360SCVP_process(&param, pI360SCVP);
+        if (i == 0)
+        {
+            outputLen = param.outputBitstreamLen;
+            // the gather list is only got when it is enabled
+            EXPECT_TRUE(I360SCVP_GetParameter(pI360SCVP, ID_SCVP_OUTPUT_SEGMENTS, (void**)&pSegments) != 0);
+        }
+        else
+        {
+            ret |= I360SCVP_GetParameter(pI360SCVP, ID_SCVP_OUTPUT_SEGMENTS, (void**)&pSegments);
+            EXPECT_TRUE(segments.segmentsNum > 0);
+            EXPECT_TRUE(segments.totalSize == param.outputBitstreamLen);
+            EXPECT_TRUE(I360SCVP_CoalesceSegments(&segments, pCoalesced, segments.totalSize - 1) < 0);
+            coalescedLen = I360SCVP_CoalesceSegments(&segments, pCoalesced, 4 * bufferlen);
+        }
+        I360SCVP_unInit(pI360SCVP);
+    }
+
+    EXPECT_TRUE(ret == 0);
+    EXPECT_TRUE(outputLen > 0);
+    EXPECT_TRUE(coalescedLen == (int32_t)outputLen);
+    if (coalescedLen == (int32_t)outputLen)
+    {
+        EXPECT_TRUE(memcmp(pOutput, pCoalesced, outputLen) == 0);
+    }
+    delete[] pOutput;
+    delete[] pCoalesced;
+}
 }
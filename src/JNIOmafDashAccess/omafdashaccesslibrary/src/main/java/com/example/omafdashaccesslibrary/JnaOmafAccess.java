@@ -121,6 +121,12 @@ public interface JnaOmafAccess extends Library {
         public static final int DASH_STREAM_DYNMIC = 2;
     };
 
+    /** enum values */
+    public static interface OmafAbrPolicy {
+        public static final int OMAF_ABR_THROUGHPUT = 0;
+        public static final int OMAF_ABR_BOLA = 1;
+    };
+
     public static class RECTANGUALAR_REGION_WIZE_PACKING extends Structure {
         public byte transformType;
         public byte guardBandFlag;
@@ -312,11 +318,19 @@ public interface JnaOmafAccess extends Library {
     public static class DASHSTATISTICINFO extends Structure {
         public int avg_bandwidth;
         public int immediate_bandwidth;
+        public long prefetch_bytes;
+        public long prefetch_wasted_bytes;
+        public int prefetch_hit_tiles;
+        public long new_connections;
+        public long reused_connections;
+        public long cache_hits;
+        public long cache_misses;
+        public long cache_bytes;
         public DASHSTATISTICINFO() {
             super();
         }
         protected List getFieldOrder() {
-            return Arrays.asList("avg_bandwidth", "immediate_bandwidth");
+            return Arrays.asList("avg_bandwidth", "immediate_bandwidth", "prefetch_bytes", "prefetch_wasted_bytes", "prefetch_hit_tiles", "new_connections", "reused_connections", "cache_hits", "cache_misses", "cache_bytes");
         }
         public DASHSTATISTICINFO(int avg_bandwidth, int immediate_bandwidth) {
             super();
@@ -370,6 +384,10 @@ public interface JnaOmafAccess extends Library {
         public int retry_times;
         public int ssl_verify_peer;
         public int ssl_verify_host;
+        public int enable_event_loop;
+        public int enable_http2;
+        public int max_concurrent_streams;
+        public int enable_packed_tile_fetch;
         public _omafHttpParams() {
             super();
             this.conn_timeout = 0;
@@ -377,9 +395,13 @@ public interface JnaOmafAccess extends Library {
             this.retry_times = 0;
             this.ssl_verify_peer = 0;
             this.ssl_verify_host = 0;
+            this.enable_event_loop = 0;
+            this.enable_http2 = 0;
+            this.max_concurrent_streams = 0;
+            this.enable_packed_tile_fetch = 0;
         }
         protected List getFieldOrder() {
-            return Arrays.asList("conn_timeout", "total_timeout", "retry_times", "ssl_verify_peer", "ssl_verify_host");
+            return Arrays.asList("conn_timeout", "total_timeout", "retry_times", "ssl_verify_peer", "ssl_verify_host", "enable_event_loop", "enable_http2", "max_concurrent_streams", "enable_packed_tile_fetch");
         }
         public _omafHttpParams(long conn_timeout, long total_timeout, int retry_times, int ssl_verify_peer, int ssl_verify_host) {
             super();
@@ -389,6 +411,19 @@ public interface JnaOmafAccess extends Library {
             this.ssl_verify_peer = ssl_verify_peer;
             this.ssl_verify_host = ssl_verify_host;
         }
+        public _omafHttpParams(long conn_timeout, long total_timeout, int retry_times, int ssl_verify_peer, int ssl_verify_host,
+                               int enable_event_loop, int enable_http2, int max_concurrent_streams, int enable_packed_tile_fetch) {
+            super();
+            this.conn_timeout = conn_timeout;
+            this.total_timeout = total_timeout;
+            this.retry_times = retry_times;
+            this.ssl_verify_peer = ssl_verify_peer;
+            this.ssl_verify_host = ssl_verify_host;
+            this.enable_event_loop = enable_event_loop;
+            this.enable_http2 = enable_http2;
+            this.max_concurrent_streams = max_concurrent_streams;
+            this.enable_packed_tile_fetch = enable_packed_tile_fetch;
+        }
         protected ByReference newByReference() { return new ByReference(); }
         protected ByValue newByValue() { return new ByValue(); }
         protected _omafHttpParams newInstance() { return new _omafHttpParams(); }
@@ -449,14 +484,16 @@ public interface JnaOmafAccess extends Library {
         public String name;
         public String libpath;
         public int enable;
+        public int prefetch_tile_num;
         public _omafPredictorParams() {
             super();
             this.name = "";
             this.libpath = "";
             this.enable = 0;
+            this.prefetch_tile_num = 0;
         }
         protected List getFieldOrder() {
-            return Arrays.asList("name", "libpath", "enable");
+            return Arrays.asList("name", "libpath", "enable", "prefetch_tile_num");
         }
         public _omafPredictorParams(String name, String libpath, int enable) {
             super();
@@ -464,6 +501,13 @@ public interface JnaOmafAccess extends Library {
             this.libpath = libpath;
             this.enable = enable;
         }
+        public _omafPredictorParams(String name, String libpath, int enable, int prefetch_tile_num) {
+            super();
+            this.name = name;
+            this.libpath = libpath;
+            this.enable = enable;
+            this.prefetch_tile_num = prefetch_tile_num;
+        }
         protected ByReference newByReference() { return new ByReference(); }
         protected ByValue newByValue() { return new ByValue(); }
         protected _omafPredictorParams newInstance() { return new _omafPredictorParams(); }
@@ -472,6 +516,138 @@ public interface JnaOmafAccess extends Library {
         public static class ByValue extends _omafPredictorParams implements Structure.ByValue {  };
     };
 
+    public static class _omafAbrParams extends Structure {
+        public int enable;
+        public int policy;
+        public int buffer_target_ms;
+        public _omafAbrParams() {
+            super();
+            this.enable = 0;
+            this.policy = 0;
+            this.buffer_target_ms = 0;
+        }
+        protected List getFieldOrder() {
+            return Arrays.asList("enable", "policy", "buffer_target_ms");
+        }
+        public _omafAbrParams(int enable, int policy, int buffer_target_ms) {
+            super();
+            this.enable = enable;
+            this.policy = policy;
+            this.buffer_target_ms = buffer_target_ms;
+        }
+        protected ByReference newByReference() { return new ByReference(); }
+        protected ByValue newByValue() { return new ByValue(); }
+        protected _omafAbrParams newInstance() { return new _omafAbrParams(); }
+
+        public static class ByReference extends _omafAbrParams implements Structure.ByReference {  };
+        public static class ByValue extends _omafAbrParams implements Structure.ByValue {  };
+    };
+
+    public static class _omafCacheParams extends Structure {
+        public long memory_budget;
+        public int spill_to_disk;
+        public _omafCacheParams() {
+            super();
+            this.memory_budget = 0;
+            this.spill_to_disk = 0;
+        }
+        protected List getFieldOrder() {
+            return Arrays.asList("memory_budget", "spill_to_disk");
+        }
+        public _omafCacheParams(long memory_budget, int spill_to_disk) {
+            super();
+            this.memory_budget = memory_budget;
+            this.spill_to_disk = spill_to_disk;
+        }
+        protected ByReference newByReference() { return new ByReference(); }
+        protected ByValue newByValue() { return new ByValue(); }
+        protected _omafCacheParams newInstance() { return new _omafCacheParams(); }
+
+        public static class ByReference extends _omafCacheParams implements Structure.ByReference {  };
+        public static class ByValue extends _omafCacheParams implements Structure.ByValue {  };
+    };
+
+    public static class _omafBufferParams extends Structure {
+        public int max_parsed_segments;
+        public long max_packet_bytes;
+        public int max_downloading_segments;
+        public _omafBufferParams() {
+            super();
+            this.max_parsed_segments = 0;
+            this.max_packet_bytes = 0;
+            this.max_downloading_segments = 0;
+        }
+        protected List getFieldOrder() {
+            return Arrays.asList("max_parsed_segments", "max_packet_bytes", "max_downloading_segments");
+        }
+        public _omafBufferParams(int max_parsed_segments, long max_packet_bytes, int max_downloading_segments) {
+            super();
+            this.max_parsed_segments = max_parsed_segments;
+            this.max_packet_bytes = max_packet_bytes;
+            this.max_downloading_segments = max_downloading_segments;
+        }
+        protected ByReference newByReference() { return new ByReference(); }
+        protected ByValue newByValue() { return new ByValue(); }
+        protected _omafBufferParams newInstance() { return new _omafBufferParams(); }
+
+        public static class ByReference extends _omafBufferParams implements Structure.ByReference {  };
+        public static class ByValue extends _omafBufferParams implements Structure.ByValue {  };
+    };
+
+    public static class _omafMetricsParams extends Structure {
+        public int enable_dump;
+        public int dump_interval_ms;
+        public String dump_path;
+        public _omafMetricsParams() {
+            super();
+            this.enable_dump = 0;
+            this.dump_interval_ms = 0;
+            this.dump_path = "";
+        }
+        protected List getFieldOrder() {
+            return Arrays.asList("enable_dump", "dump_interval_ms", "dump_path");
+        }
+        public _omafMetricsParams(int enable_dump, int dump_interval_ms, String dump_path) {
+            super();
+            this.enable_dump = enable_dump;
+            this.dump_interval_ms = dump_interval_ms;
+            this.dump_path = dump_path;
+        }
+        protected ByReference newByReference() { return new ByReference(); }
+        protected ByValue newByValue() { return new ByValue(); }
+        protected _omafMetricsParams newInstance() { return new _omafMetricsParams(); }
+
+        public static class ByReference extends _omafMetricsParams implements Structure.ByReference {  };
+        public static class ByValue extends _omafMetricsParams implements Structure.ByValue {  };
+    };
+
+    public static class _omafLogParams extends Structure {
+        public int min_level;
+        public int enable_async;
+        public int async_queue_size;
+        public _omafLogParams() {
+            super();
+            this.min_level = 0;
+            this.enable_async = 0;
+            this.async_queue_size = 0;
+        }
+        protected List getFieldOrder() {
+            return Arrays.asList("min_level", "enable_async", "async_queue_size");
+        }
+        public _omafLogParams(int min_level, int enable_async, int async_queue_size) {
+            super();
+            this.min_level = min_level;
+            this.enable_async = enable_async;
+            this.async_queue_size = async_queue_size;
+        }
+        protected ByReference newByReference() { return new ByReference(); }
+        protected ByValue newByValue() { return new ByValue(); }
+        protected _omafLogParams newInstance() { return new _omafLogParams(); }
+
+        public static class ByReference extends _omafLogParams implements Structure.ByReference {  };
+        public static class ByValue extends _omafLogParams implements Structure.ByValue {  };
+    };
+
     public static class _omafDashParams extends Structure {
         public JnaOmafAccess._omafHttpProxy.ByValue proxy;
         public JnaOmafAccess._omafHttpParams.ByValue http_params;
@@ -480,6 +656,14 @@ public interface JnaOmafAccess extends Library {
         public JnaOmafAccess._omafPredictorParams.ByValue predictor_params;
         public long max_parallel_transfers;
         public int segment_open_timeout_ms;
+        public int max_decode_width;
+        public int max_decode_height;
+        public JnaOmafAccess._omafAbrParams.ByValue abr_params;
+        public JnaOmafAccess._omafCacheParams.ByValue cache_params;
+        public JnaOmafAccess._omafBufferParams.ByValue buffer_params;
+        public JnaOmafAccess._omafMetricsParams.ByValue metrics_params;
+        public JnaOmafAccess._omafLogParams.ByValue log_params;
+        public float viewport_hysteresis;
         public _omafDashParams() {
             super();
             this.proxy = null;
@@ -489,9 +673,18 @@ public interface JnaOmafAccess extends Library {
             this.predictor_params = null;
             this.max_parallel_transfers = 0;
             this.segment_open_timeout_ms = 0;
+            this.max_decode_width = 0;
+            this.max_decode_height = 0;
+            this.abr_params = null;
+            this.cache_params = null;
+            this.buffer_params = null;
+            this.metrics_params = null;
+            this.log_params = null;
+            this.viewport_hysteresis = 0;
         }
         protected List getFieldOrder() {
-            return Arrays.asList("proxy", "http_params", "statistic_params", "synchronizer_params", "predictor_params", "max_parallel_transfers", "segment_open_timeout_ms");
+            return Arrays.asList("proxy", "http_params", "statistic_params", "synchronizer_params", "predictor_params", "max_parallel_transfers", "segment_open_timeout_ms",
+                                 "max_decode_width", "max_decode_height", "abr_params", "cache_params", "buffer_params", "metrics_params", "log_params", "viewport_hysteresis");
         }
         public _omafDashParams(JnaOmafAccess._omafHttpProxy.ByValue proxy, JnaOmafAccess._omafHttpParams.ByValue http_params, JnaOmafAccess._omafStatisticsParams.ByValue statistic_params,
                                JnaOmafAccess._omafSynchronizerParams.ByValue synchronizer_params, JnaOmafAccess._omafPredictorParams.ByValue predictor_params, long max_parallel_transfers, int segment_open_timeout_ms) {
@@ -600,11 +793,13 @@ public interface JnaOmafAccess extends Library {
         public int tileRowNum;
         public int tileColNum;
         public boolean bEOS;
+        /** C type : DashPacketMeta* */
+        public Pointer meta;
         public DASHPACKET() {
             super();
         }
         protected List getFieldOrder() {
-            return Arrays.asList("videoID", "video_codec", "pts", "size", "buf", "rwpk", "segID", "height", "width", "numQuality", "qtyResolution", "tileRowNum", "tileColNum", "bEOS");
+            return Arrays.asList("videoID", "video_codec", "pts", "size", "buf", "rwpk", "segID", "height", "width", "numQuality", "qtyResolution", "tileRowNum", "tileColNum", "bEOS", "meta");
         }
         /**
          * @param buf C type : char*<br>
@@ -34,38 +34,30 @@
 
 #include "DownloadManager.h"
 
-#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <dirent.h>
-#include <stdio.h>
-#include <stdlib.h>
 #include <unistd.h>
-#include <map>
-
-#define MAX_PATH_COUNT 1024
+#include <fstream>
+#include <iterator>
 
 VCD_OMAF_BEGIN
 
-typedef struct GatherStruct {
-  int size;
-  std::string prefix;
-} GatherStruct;
+#define DEFAULT_MAX_MEMORY_SIZE 64 * 1024 * 1024
 
 DownloadManager::DownloadManager() {
   mDownloadedBytes = 0;
   mDownloadedFiles = 0;
   mCacheDir = "";
   mMaxCacheSize = 200000000;
+  mMaxMemorySize = DEFAULT_MAX_MEMORY_SIZE;
   mStartTime = 0;
   mFilePrefix = "";
-  // start count from 1 because 0 and 1 would generate
-  // same random file name, so ignore 0
   m_count = 1;
   mUseCache = false;
+  memset(&mStats, 0, sizeof(mStats));
 }
 
-DownloadManager::~DownloadManager() { }
+DownloadManager::~DownloadManager() { CleanCache(); }
 
 int DownloadManager::DeleteCacheFile(std::string url) {
   if (remove(url.c_str())) {
@@ -78,7 +70,6 @@ int DownloadManager::DeleteCacheFile(std::string url) {
 int DownloadManager::SetCacheFolder(std::string cache_dir) {
   mCacheDir = cache_dir;
   if ((access(mCacheDir.c_str(), 2)) != -1) {
-    DeleteCacheBySize();
     return ERROR_NONE;
   }
 
@@ -87,170 +78,170 @@ int DownloadManager::SetCacheFolder(std::string cache_dir) {
   return ERROR_NONE;
 }
 
-std::string DownloadManager::AssignCacheFileName() {
-  std::lock_guard<std::mutex> lock(mMutex);
-  std::string file_name = GetRandomString(32);
-  return file_name;
-}
-
 /// get download bit rate
 int DownloadManager::GetImmediateBitrate() { return 0; }
 
 int DownloadManager::GetAverageBitrate() { return 0; }
 
-void DownloadManager::CleanCache() { delete_all_cached_files(mCacheDir.c_str()); }
+void DownloadManager::CleanCache() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mMemoryLRU.clear();
+  mMemoryIndex.clear();
+  while (!mDiskLRU.empty()) {
+    RemoveDiskEntry(mDiskLRU.begin());
+  }
+  mStats.memoryBytes = 0;
+  mStats.diskBytes = 0;
+}
 
-void DownloadManager::DeleteCacheByTime(uint64_t interval) {
-  if (mCacheMtx.try_lock()) {
-    uint64_t out_size = CacheGetSize(mCacheDir.c_str());
-    if (out_size < mMaxCacheSize) {
-      mCacheMtx.unlock();
-      return;
+std::shared_ptr<SegmentBuffer> DownloadManager::LookupSegment(const std::string &url) {
+  DiskEntry spilled;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mMemoryIndex.find(url);
+    if (it != mMemoryIndex.end()) {
+      // move to the most recently used
+      mMemoryLRU.splice(mMemoryLRU.begin(), mMemoryLRU, it->second);
+      mStats.hits++;
+      return it->second->buffer;
     }
 
-    auto cachePath = GetCacheFolder();
-    DIR *dir = opendir(cachePath.c_str());
-    if (!dir) {
-      OMAF_LOG(LOG_WARNING, "Failed to open cache folder! Be cautious cache may exceed the storage limitation!\n");
-      mCacheMtx.unlock();
-      return;
+    auto dit = mDiskIndex.find(url);
+    if (dit == mDiskIndex.end()) {
+      mStats.misses++;
+      return nullptr;
     }
+    // the file is read without the lock, and belongs to the caller then
+    spilled = *(dit->second);
+    mStats.diskBytes -= spilled.size;
+    mDiskLRU.erase(dit->second);
+    mDiskIndex.erase(dit);
+  }
 
-    dirent *ent = readdir(dir);
-    int32_t removeCnt = 0;
-    while (ent && ((uint32_t)removeCnt) < out_size / 2) {
-      struct stat st;
-      if (stat(ent->d_name, &st)) {
-        OMAF_LOG(LOG_WARNING, "Failed to get cache file time info! Be cautious cache may exceed the storage limitation!\n");
-        mCacheMtx.unlock();
-        return;
-      }
-      if ((uint64_t)(st.st_mtim.tv_nsec) < GetStartTime() + interval) {
-        if (remove(ent->d_name))
-          OMAF_LOG(LOG_WARNING, "Failed to delete file in cache ! Be cautious cache may exceed the storage limitation!\n");
-      }
-
-      ent = readdir(dir);
+  std::shared_ptr<SegmentBuffer> buffer = LoadFromDisk(spilled);
+  DeleteCacheFile(spilled.path);
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (buffer.get() == nullptr) {
+      mStats.misses++;
+      return nullptr;
     }
-    closedir(dir);
-
-    mCacheMtx.unlock();
+    mStats.diskHits++;
   }
-  return;
+  InsertSegment(url, buffer);
+  return buffer;
 }
 
-void DownloadManager::DeleteCacheBySize() {
-  uint64_t out_size = CacheGetSize(mCacheDir.c_str());
-  if (out_size >= mMaxCacheSize) {
-    delete_all_cached_files(mCacheDir.c_str());
-  }
-}
+void DownloadManager::InsertSegment(const std::string &url, std::shared_ptr<SegmentBuffer> buffer) {
+  if (buffer.get() == nullptr || buffer->size == 0) return;
 
-static bool delete_cache_files(void *cbck, std::string item_name, std::string itemPath) {
-  std::string *startPattern;
-  uint32_t sz;
-  if (NULL == cbck) return false;
-  if (0 == item_name.size()) return false;
-  if (0 == itemPath.size()) return false;
-
-  startPattern = (std::string *)cbck;
-  sz = (uint32_t)strlen(startPattern->c_str());
-  if (!strncmp(startPattern->c_str(), item_name.c_str(), sz)) {
-    if (remove(itemPath.c_str()) == 0) return true;
+  std::list<MemoryEntry> evicted;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (buffer->size > mMaxMemorySize || mMemoryIndex.find(url) != mMemoryIndex.end()) {
+      return;
+    }
+
+    MemoryEntry entry;
+    entry.url = url;
+    entry.buffer = std::move(buffer);
+    mStats.memoryBytes += entry.buffer->size;
+    mMemoryLRU.push_front(std::move(entry));
+    mMemoryIndex[url] = mMemoryLRU.begin();
+    evicted = EvictMemory();
   }
 
-  return false;
+  if (!evicted.empty() && mUseCache && !mCacheDir.empty()) {
+    SpillToDisk(evicted);
+  }
 }
 
-void DownloadManager::delete_all_cached_files(std::string directory) {
-  enum_directory(directory.c_str(), false, delete_cache_files, (void *)&mFilePrefix, NULL);
+void DownloadManager::GetCacheStatistics(SegmentCacheStatistics *stats) {
+  if (stats == nullptr) return;
+  std::lock_guard<std::mutex> lock(mMutex);
+  *stats = mStats;
 }
 
-static bool GatherCacheSize(void *cbck, std::string item_name, std::string itemPath) {
-  GatherStruct *out = (GatherStruct *)cbck;
-  if (!strncmp(out->prefix.c_str(), item_name.c_str(), out->prefix.size())) {
-    struct stat statbuf;
-    stat(itemPath.c_str(), &statbuf);
-    out->size += statbuf.st_size;
-    return true;
+std::list<DownloadManager::MemoryEntry> DownloadManager::EvictMemory() {
+  std::list<MemoryEntry> evicted;
+  while (mStats.memoryBytes > mMaxMemorySize && !mMemoryLRU.empty()) {
+    auto last = std::prev(mMemoryLRU.end());
+    mStats.memoryBytes -= last->buffer->size;
+    mStats.evictions++;
+    mMemoryIndex.erase(last->url);
+    // segments still being read keep the buffer alive by their own reference
+    evicted.splice(evicted.end(), mMemoryLRU, last);
   }
-  return false;
+  return evicted;
 }
 
-uint64_t DownloadManager::CacheGetSize(std::string directory) {
-  GatherStruct gat;
-  gat.prefix = mFilePrefix;
-  gat.size = 0;
-
-  enum_directory(directory.c_str(), false, GatherCacheSize, (void *)&gat, NULL);
-  return gat.size;
-}
-
-int DownloadManager::enum_directory(const char *dir, bool enum_directory, enum_dir_item enumDirFct, void *cbck,
-                                    const char *filter) {
-  unsigned char itemPath[MAX_PATH_COUNT];
-  unsigned char path[MAX_PATH_COUNT], *file;
-  DIR *currentDir;
-  struct dirent *currentFile;
-  struct stat st;
-
-  if (!dir || !enumDirFct) return ERROR_INVALID;
+void DownloadManager::SpillToDisk(std::list<MemoryEntry> &evicted) {
+  for (auto &entry : evicted) {
+    if (entry.buffer->size > mMaxCacheSize) continue;
 
-  strncpy((char *)path, dir, strlen(dir) + 1);
-  if (path[strlen((const char *)path) - 1] != '\\') strncat((char *)path, "\\", strlen("\\"));
-
-  currentDir = opendir((char *)path);
-  if (currentDir == NULL) return ERROR_INVALID;
-
-  currentFile = readdir(currentDir);
-  while (currentFile) {
-    if (!strcmp(currentFile->d_name, "..")) goto end;
-    if (currentFile->d_name[0] == '.') goto end;
-
-    if (filter) {
-      char *separate = strrchr(currentFile->d_name, '.');
-      if (!separate) goto end;
-      if (!strstr(filter, separate + 1)) goto end;
+    DiskEntry disk;
+    disk.url = entry.url;
+    disk.size = entry.buffer->size;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      disk.path = mCacheDir + "/" + mFilePrefix + "_seg" + std::to_string(m_count++) + ".mp4";
     }
 
-    strncpy((char *)itemPath, (const char *)path, strlen((const char *)path) + 1);
-    if (strlen(currentFile->d_name) < 1024 - strlen((const char *)itemPath))
-      strncat((char *)itemPath, currentFile->d_name, sizeof(currentFile->d_name));
-    if (stat((const char *)itemPath, &st) != 0) goto end;
-    if (enum_directory && ((st.st_mode & S_IFMT) != S_IFDIR)) {
-      goto end;
+    std::ofstream of(disk.path, std::ios::out | std::ios::binary);
+    for (auto &block : entry.buffer->blocks) {
+      of.write(block->cbuf(), block->size());
+    }
+    of.close();
+    if (!of) {
+      OMAF_LOG(LOG_WARNING, "Failed to spill the segment %s to file %s\n", disk.url.c_str(), disk.path.c_str());
+      DeleteCacheFile(disk.path);
+      continue;
     }
 
-    if (!enum_directory && ((st.st_mode & S_IFMT) == S_IFDIR)) goto end;
-    file = (unsigned char *)currentFile->d_name;
-
-    if (enumDirFct(cbck, (char *)file, (char *)itemPath)) {
-      break;
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mDiskIndex.find(disk.url) != mDiskIndex.end() || mMemoryIndex.find(disk.url) != mMemoryIndex.end()) {
+      DeleteCacheFile(disk.path);
+      continue;
+    }
+    mStats.diskBytes += disk.size;
+    mStats.spills++;
+    mDiskLRU.push_front(disk);
+    mDiskIndex[disk.url] = mDiskLRU.begin();
+    while (mStats.diskBytes > mMaxCacheSize && !mDiskLRU.empty()) {
+      RemoveDiskEntry(std::prev(mDiskLRU.end()));
     }
-  end:
-    currentFile = readdir(currentDir);
   }
-
-  return ERROR_NONE;
 }
 
-std::string DownloadManager::GetRandomString(int size) {
-  std::string str = "";
-  const char CCH[] = "_0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
-
-  // generate seed for random number with count
-  srand(m_count % INT32_MAX);
+void DownloadManager::RemoveDiskEntry(std::list<DiskEntry>::iterator it) {
+  DeleteCacheFile(it->path);
+  mStats.diskBytes -= it->size;
+  mDiskIndex.erase(it->url);
+  mDiskLRU.erase(it);
+}
 
-  for (int i = 0; i < size; ++i) {
-    int x = rand() / (RAND_MAX / (sizeof(CCH) - 1));
-    str += CCH[x];
+std::shared_ptr<SegmentBuffer> DownloadManager::LoadFromDisk(const DiskEntry &entry) {
+  std::ifstream in(entry.path, std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    OMAF_LOG(LOG_WARNING, "Failed to open the spilled segment file %s\n", entry.path.c_str());
+    return nullptr;
   }
-  str = mFilePrefix + "_" + str;
 
-  m_count++;
-  if (m_count == 0) m_count++;
+  std::unique_ptr<StreamBlock> block = make_unique_vcd<StreamBlock>();
+  if (block.get() == nullptr || block->resize(entry.size) == nullptr) {
+    return nullptr;
+  }
+  in.read(block->buf(), entry.size);
+  if (in.gcount() != static_cast<std::streamsize>(entry.size)) {
+    OMAF_LOG(LOG_WARNING, "The spilled segment file %s is truncated\n", entry.path.c_str());
+    return nullptr;
+  }
+  block->size(entry.size);
 
-  return str;
+  std::shared_ptr<SegmentBuffer> buffer = std::make_shared<SegmentBuffer>();
+  buffer->size = entry.size;
+  buffer->blocks.push_back(std::move(block));
+  return buffer;
 }
 
 VCD_OMAF_END
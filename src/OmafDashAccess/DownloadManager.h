@@ -28,8 +28,11 @@
 //!
 
 //! \file:   DownloadManager.h
-//! \brief:
-//! \detail:
+//! \brief:  in-memory LRU cache of the downloaded segments
+//! \detail: segments are kept by url within a memory budget, so seeking back
+//!          or revisiting tiles of the viewport hits memory instead of the
+//!          network. Least recently used segments are dropped, or spilled to
+//!          the cache folder when spilling is enabled.
 //!
 //! Created on May 28, 2019, 2:39 PM
 //!
@@ -38,12 +41,40 @@
 #define _DOWNLOADMANAGER_H
 
 #include "general.h"
-#include <mutex>
+#include "OmafDashDownload/Stream.h"
 
-typedef bool (*enum_dir_item)(void *cbck, std::string item_name, std::string item_path);
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 VCD_OMAF_BEGIN
 
+//!
+//! \struct: SegmentBuffer
+//! \brief:  downloaded data of one segment, shared by the cache and the
+//!          segments reading it, and never modified once the download ends
+//!
+typedef struct SegmentBuffer {
+    std::vector<std::unique_ptr<StreamBlock>> blocks;
+    uint64_t                                  size = 0;
+} SegmentBuffer;
+
+//!
+//! \struct: SegmentCacheStatistics
+//! \brief:  hit and eviction counters of the segment cache
+//!
+typedef struct SegmentCacheStatistics {
+    uint64_t hits;          //<! lookups served from memory
+    uint64_t diskHits;      //<! lookups served from spilled files
+    uint64_t misses;        //<! lookups which need the download
+    uint64_t evictions;     //<! segments dropped from memory for the budget
+    uint64_t spills;        //<! evicted segments written to the cache folder
+    uint64_t memoryBytes;   //<! bytes of segments in memory
+    uint64_t diskBytes;     //<! bytes of spilled segments
+} SegmentCacheStatistics;
+
 class DownloadManager {
 public:
     DownloadManager();
@@ -56,26 +87,29 @@ public:
     int DeleteCacheFile(std::string url);
 
     //!
-    //! \brief  Delete a all cached files from cache.
+    //! \brief  Delete all cached segments from memory and cache folder.
     //!
     void CleanCache();
 
     //!
-    //! \brief  Delete a all cached files from cache with condition that
-    //!         the file time is less than ...
+    //! \brief  Look up the segment of the url, a spilled segment is loaded
+    //!         back to memory
     //!
-    void DeleteCacheByTime( uint64_t interval );
+    //! \return std::shared_ptr<SegmentBuffer>
+    //!         the cached data, or nullptr when the segment is not cached
+    //!
+    std::shared_ptr<SegmentBuffer> LookupSegment(const std::string &url);
 
     //!
-    //! \brief  Delete a all cached files from cache with condition that
-    //!         the total cache size is large thanm MaxCacheSize
+    //! \brief  Add the downloaded segment of the url as the most recently
+    //!         used one, and evict the least recently used ones over budget
     //!
-    void DeleteCacheBySize( );
+    void InsertSegment(const std::string &url, std::shared_ptr<SegmentBuffer> buffer);
 
     //!
-    //! \brief  Get a Cache file name
+    //! \brief  Get the hit and eviction counters of the cache
     //!
-    std::string AssignCacheFileName();
+    void GetCacheStatistics(SegmentCacheStatistics *stats);
 
     //!
     //! \brief  Get a downloading bit rate
@@ -92,6 +126,8 @@ public:
     //!
     void        SetMaxCacheSize(uint64_t size)          { mMaxCacheSize = size;        };
     uint64_t    GetMaxCacheSize()                       { return mMaxCacheSize;        };
+    void        SetMaxMemorySize(uint64_t size)         { mMaxMemorySize = size;       };
+    uint64_t    GetMaxMemorySize()                      { return mMaxMemorySize;       };
     void        SetStartTime(uint64_t size)             { mStartTime = size;           };
     uint64_t    GetStartTime()                          { return mStartTime;           };
     uint64_t    GetDownloadBytes()                      { return mDownloadedBytes;     };
@@ -103,44 +139,37 @@ public:
     void        SetUseCache(bool bCache)                { mUseCache = bCache;          };
 
 private:
+    typedef struct MemoryEntry {
+        std::string                    url;
+        std::shared_ptr<SegmentBuffer> buffer;
+    } MemoryEntry;
 
-    //!
-    //! \brief  the implementation to delete all files
-    //!
-    void delete_all_cached_files( std::string directory );
+    typedef struct DiskEntry {
+        std::string                    url;
+        std::string                    path;
+        uint64_t                       size;
+    } DiskEntry;
 
     //!
-    //! \brief  the implementation to get cache size
+    //! \brief  drop the least recently used segments over the memory budget
+    //!         and return them for spilling, called with mMutex locked
     //!
-    uint64_t CacheGetSize( std::string directory );
+    std::list<MemoryEntry> EvictMemory();
 
     //!
-    //! \brief callback to delete file
+    //! \brief  write the evicted segments to the cache folder
     //!
-    //static bool delete_cache_files( void *cbck,
-    //                         std::string item_name,
-    //                         std::string item_path );
+    void SpillToDisk(std::list<MemoryEntry> &evicted);
 
     //!
-    //! \brief  callback to get size of each file
+    //! \brief  remove the spilled segment file, called with mMutex locked
     //!
-    //static bool GatherCacheSize( void *cbck,
-    //                      std::string item_name,
-     //                     std::string item_path );
+    void RemoveDiskEntry(std::list<DiskEntry>::iterator it);
 
     //!
-    //! \brief  enumerate all files in a directory
+    //! \brief  read the spilled segment file into one block
     //!
-    int enum_directory( const char *dir,
-                        bool enum_directory,
-                        enum_dir_item enum_dir_fct,
-                        void *cbck,
-                        const char *filter = NULL);
-
-    //!
-    //! \brief  generate a random string for assigning cache file name
-    //!
-    std::string GetRandomString(int size);
+    std::shared_ptr<SegmentBuffer> LoadFromDisk(const DiskEntry &entry);
 
 private:
     int                            mDownloadedBytes;    //<! the total downloaded bytes
@@ -149,10 +178,16 @@ private:
     std::string                    mFilePrefix;         //<! the prefix for each cached file
     std::mutex                     mMutex;              //<! for synchronization
     uint64_t                       mStartTime;          //<! the start time to caching in this process
-    uint64_t                       mMaxCacheSize;       //<! the threshold of total cache file size
-    bool                           mUseCache;           //<! the flag to indicate whether using file caching
-    int32_t                        m_count;             //<! count for random file name
-    std::mutex                     mCacheMtx;                //<! mutex for cache clear
+    uint64_t                       mMaxCacheSize;       //<! the threshold of total spilled file size
+    uint64_t                       mMaxMemorySize;      //<! the threshold of total segment size in memory
+    bool                           mUseCache;           //<! the flag to indicate whether spilling to files
+    int32_t                        m_count;             //<! count for spilled file name
+
+    std::list<MemoryEntry>         mMemoryLRU;          //<! segments in memory, most recently used first
+    std::unordered_map<std::string, std::list<MemoryEntry>::iterator> mMemoryIndex;
+    std::list<DiskEntry>           mDiskLRU;            //<! spilled segments, most recently spilled first
+    std::unordered_map<std::string, std::list<DiskEntry>::iterator> mDiskIndex;
+    SegmentCacheStatistics         mStats;              //<! hit and eviction counters
 };
 
 typedef VCD::VRVideo::Singleton<DownloadManager> DOWNLOADMANAGER;    //<! singleton of DownloadManager
@@ -160,4 +195,3 @@ typedef VCD::VRVideo::Singleton<DownloadManager> DOWNLOADMANAGER;    //<! single
 VCD_OMAF_END;
 
 #endif /* DOWNLOADMANAGER_H */
-
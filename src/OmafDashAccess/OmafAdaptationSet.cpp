@@ -62,6 +62,9 @@ OmafAdaptationSet::OmafAdaptationSet() {
   mActiveSegNum = 1;
   mSegNum = 1;
   mReEnable = false;
+  mSpeculative = false;
+  mDownloadPriority = TaskPriority::NORMAL;
+  mPackedEntryNum = 0;
   mPF = PF_UNKNOWN;
   mSegmentDuration = 0;
   mTrackNumber = 0;
@@ -128,6 +131,19 @@ int OmafAdaptationSet::Initialize(AdaptationSetElement* pAdaptationSet) {
         std::string id = *it;
         mDependIDs.push_back(atoi(id.c_str()));
       }
+
+      // the tile segment is also available as a byte range of the packed segment
+      for (auto property : mAdaptationSet->GetSupplementalProperties()) {
+        if (property && property->GetSchemeIdUri() == SCHEMEIDURI_PACKED_TILES) {
+          std::vector<std::string> splitValue;
+          SplitString(property->GetValue(), splitValue, ",");
+          if (splitValue.size() == 2) {
+            mPackedURLTemplate = splitValue[0];
+            mPackedEntryNum = static_cast<uint32_t>(atoi(splitValue[1].c_str()));
+          }
+          break;
+        }
+      }
   }
 
   mID = stoi(mAdaptationSet->GetId());
@@ -375,8 +391,10 @@ int OmafAdaptationSet::DownloadInitializeSegment() {
 
   DashSegmentSourceParams params;
   params.dash_url_ = seg->GenerateCompleteURL(mBaseURL, repID, 0);
-  params.priority_ = TaskPriority::NORMAL;
+  params.priority_ = TaskPriority::HIGH;
   params.timeline_point_ = static_cast<int64_t>(mSegNum);
+  // no segment can be parsed before the init segment, it is due at once
+  params.deadline_ms_ = 0;
 
   mInitSegment = std::make_shared<OmafSegment>(params, mSegNum, true);
 
@@ -435,8 +453,20 @@ int OmafAdaptationSet::DownloadSegment() {
   DashSegmentSourceParams params;
 
   params.dash_url_ = seg->GenerateCompleteURL(mBaseURL, repID, mActiveSegNum);
-  params.priority_ = TaskPriority::NORMAL;
+  bool speculative = IsSpeculative();
+  params.priority_ = speculative ? TaskPriority::LOW : mDownloadPriority;
   params.timeline_point_ = static_cast<int64_t>(mSegNum);
+  if (mSegmentDuration) params.deadline_ms_ = static_cast<int64_t>(mSegmentDuration * 1000);
+  if (!mPackedURLTemplate.empty()) {
+    // the packed segment is placed beside the tile segment
+    std::string packedName = mPackedURLTemplate;
+    size_t pos = packedName.find("$Number$");
+    if (pos != std::string::npos) packedName.replace(pos, strlen("$Number$"), std::to_string(mActiveSegNum));
+    size_t dirEnd = params.dash_url_.rfind('/');
+    params.packed_url_ = (dirEnd == std::string::npos ? "" : params.dash_url_.substr(0, dirEnd + 1)) + packedName;
+    params.packed_entry_num_ = mPackedEntryNum;
+    params.packed_track_id_ = static_cast<uint32_t>(mID);
+  }
 
   OmafSegment::Ptr pSegment = std::make_shared<OmafSegment>(params, mSegNum, false);
 
@@ -466,6 +496,8 @@ int OmafAdaptationSet::DownloadSegment() {
 
     pSegment->SetSegID(mSegNum);
     pSegment->SetTrackId(this->mInitSegment->GetTrackId());
+    pSegment->SetSpeculative(speculative);
+    KeepSpeculativeSegment(pSegment);
     ret = omaf_reader_mgr_->OpenSegment(std::move(pSegment), IsExtractor());
 
     if (ERROR_NONE != ret) {
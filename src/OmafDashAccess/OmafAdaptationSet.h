@@ -208,6 +208,51 @@ class OmafAdaptationSet {
   };
   bool IsEnabled() { return mEnable; };
 
+  //!
+  //! \brief  mark the adaptation set as speculatively enabled, i.e. enabled only
+  //!         because viewport prediction expects it to be needed soon. Its
+  //!         segments are downloaded with low priority and may be cancelled.
+  //!
+  void SetSpeculative(bool bSpeculative) {
+    std::lock_guard<std::mutex> lock(mSpeculativeMutex);
+    mSpeculative = bSpeculative;
+  };
+  bool IsSpeculative() {
+    std::lock_guard<std::mutex> lock(mSpeculativeMutex);
+    return mSpeculative;
+  };
+
+  //!
+  //! \brief  set the download priority of the segments, viewport tiles are
+  //!         downloaded before background tiles
+  //!
+  void SetDownloadPriority(TaskPriority priority) { mDownloadPriority = priority; };
+  TaskPriority GetDownloadPriority() { return mDownloadPriority; };
+
+  //!
+  //! \brief  take the last segment downloaded speculatively, the adaptation set
+  //!         releases the reference so each prefetch is evaluated only once
+  //!
+  OmafSegment::Ptr TakeSpeculativeSegment() {
+    std::lock_guard<std::mutex> lock(mSpeculativeMutex);
+    OmafSegment::Ptr seg = std::move(mSpeculativeSegment);
+    mSpeculativeSegment.reset();
+    return seg;
+  };
+
+  //!
+  //! \brief  keep the segment just downloaded if the adaptation set is
+  //!         speculative, otherwise drop the one kept for the last download
+  //!
+  //! \return bool
+  //!         true if the segment is kept for the prefetch evaluation
+  //!
+  bool KeepSpeculativeSegment(OmafSegment::Ptr segment) {
+    std::lock_guard<std::mutex> lock(mSpeculativeMutex);
+    mSpeculativeSegment = mSpeculative ? std::move(segment) : nullptr;
+    return mSpeculativeSegment.get() != nullptr;
+  };
+
   virtual OmafAdaptationSet* GetClassType() { return this; };
   TileDef*                   GetTileInfo()                               { return mTileInfo;            };
   virtual bool IsExtractor() { return mIsExtractorTrack; }
@@ -262,6 +307,12 @@ class OmafAdaptationSet {
   MediaType mType;                  //<! media type
   bool mEnable;                     //<! is Adaptation Set enabled
   bool mReEnable;                   //<! flag for Adaption Set is re-enabled
+  bool mSpeculative;                //<! is Adaption Set enabled for prefetch only
+  TaskPriority mDownloadPriority;   //<! download priority of the segments
+  OmafSegment::Ptr mSpeculativeSegment;  //<! last segment downloaded for prefetch
+  std::mutex mSpeculativeMutex;     //<! protects mSpeculative and mSpeculativeSegment
+  std::string mPackedURLTemplate;   //<! url template of the packed segment holding all tiles of the video
+  uint32_t mPackedEntryNum;         //<! tiles number in the index of the packed segment
   std::list<bool> mEnableRecord;    //<! record the last 3 enable changes
 
   std::shared_ptr<OmafReaderManager> omaf_reader_mgr_;
@@ -60,6 +60,10 @@ typedef struct _omafHttpParams {
   int32_t retry_times;
   int ssl_verify_peer;
   int ssl_verify_host;
+  int enable_event_loop;  // drive the downloads by socket events instead of polling
+  int enable_http2;       // multiplex tile requests to one origin over a single http/2 connection
+  int32_t max_concurrent_streams;  // http/2 streams per connection, 0 for the default
+  int enable_packed_tile_fetch;    // fetch the tiles of one video as byte ranges of its packed segment
 } OmafHttpParams;
 
 typedef struct _omafStatisticsParams {
@@ -76,8 +80,43 @@ typedef struct _omafPredictorParams {
   char* name;
   char* libpath;
   int enable;
+  uint32_t prefetch_tile_num;  // predicted tiles prefetched besides the viewport, 0 to disable
 } OmafPredictorParams;
 
+typedef enum {
+  OMAF_ABR_THROUGHPUT = 0,
+  OMAF_ABR_BOLA,
+} OmafAbrPolicy;
+
+typedef struct _omafAbrParams {
+  int enable;
+  OmafAbrPolicy policy;
+  int32_t buffer_target_ms;
+} OmafAbrParams;
+
+typedef struct _omafCacheParams {
+  int64_t memory_budget;  // bytes of segments kept in memory, 0 for the default
+  int spill_to_disk;      // keep segments evicted from memory in cache_path
+} OmafCacheParams;
+
+typedef struct _omafBufferParams {
+  int32_t max_parsed_segments;       // parsed segments not consumed yet, 0 for unlimited
+  int64_t max_packet_bytes;          // bytes of packets not consumed yet, 0 for unlimited
+  int32_t max_downloading_segments;  // segments downloading or waiting for parse, 0 for unlimited
+} OmafBufferParams;
+
+typedef struct _omafMetricsParams {
+  int enable_dump;           // append the metrics JSON to dump_path periodically
+  int32_t dump_interval_ms;  // dump interval, 0 for the default
+  char* dump_path;
+} OmafMetricsParams;
+
+typedef struct _omafLogParams {
+  int min_level;             // LogLevel, the calls below it are skipped
+  int enable_async;          // format the glog output on a background thread, not for log_callback
+  int32_t async_queue_size;  // records buffered for the background thread, 0 for the default
+} OmafLogParams;
+
 typedef struct _omafDashParams {
   //for download
   OmafHttpProxy proxy;
@@ -90,6 +129,18 @@ typedef struct _omafDashParams {
   //for stitch
   uint32_t max_decode_width;
   uint32_t max_decode_height;
+  //for tile quality adaptation in late binding mode
+  OmafAbrParams abr_params;
+  //for the in-memory segment cache
+  OmafCacheParams cache_params;
+  //for the backpressure from the consumption to the downloads
+  OmafBufferParams buffer_params;
+  //for the pipeline metrics dump
+  OmafMetricsParams metrics_params;
+  //for the logging level and the asynchronous logging
+  OmafLogParams log_params;
+  //for the tile selection, degrees the viewing direction moves before the tiles are selected again, 0 for any move
+  float viewport_hysteresis;
 } OmafParams;
 
 /*
@@ -188,6 +239,47 @@ int OmafAccess_GetMediaInfo(Handler hdl, DashMediaInfo* info);
 int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket* packet, int* size, uint64_t* pts, bool needParams,
                          bool clearBuf);
 
+/*
+ * description: API to get packets like OmafAccess_GetPacket, but the region wise packing and the
+ * source resolutions of the video packets are not copied for each packet. The packets output with
+ * the same layout share one immutable copy of them, packet->meta holds a reference to it and
+ * packet->rwpk / packet->qtyResolution point into it, so they must not be freed or modified.
+ * Use meta->retain to keep the metadata beyond the packet and meta->release to drop it.
+ * params: same as OmafAccess_GetPacket
+ * return: the error return from the API, ERROR_EOS means reach end of
+ *         stream for static source
+ */
+int OmafAccess_AcquirePacket(Handler hdl, int stream_id, DashPacket* packet, int* size, uint64_t* pts,
+                             bool needParams, bool clearBuf);
+
+/*
+ * description: API to release what a packet still holds: the payload if it is not moved out, the
+ * reference to the shared metadata for the packets of OmafAccess_AcquirePacket, else the copies
+ * of the region wise packing and source resolutions
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         packet - [in] the packet gotten by OmafAccess_AcquirePacket or OmafAccess_GetPacket
+ * return: the error return from the API
+ */
+int OmafAccess_ReleasePacket(Handler hdl, DashPacket* packet);
+
+/*
+ * description: API to wait until packets of the stream are available or the timeout expires, and
+ * get a batch of them in one call. The batch holds whole frames in pts order; a frame which
+ * doesn't fit in max_num is kept for the next call. The packets are output like the ones of
+ * OmafAccess_AcquirePacket and are released with OmafAccess_ReleasePacket.
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         stream_id - [in] the stream id the packets are gotten from
+ *         packet - [out] the array of at least max_num packets to hold the output
+ *         max_num - [in] the max number of packets to get
+ *         size - [out] the number of gotten packets
+ *         timeout_ms - [in] the max time to wait in ms, 0 to return at once
+ *         needParams - [bool] flag to include VPS/SPS/PPS in the first packet
+ *         clearBuf - [bool] flag to clear output packet buffer
+ * return: the error return from the API, ERROR_NULL_PACKET if timed out
+ */
+int OmafAccess_WaitPackets(Handler hdl, int stream_id, DashPacket* packet, int max_num, int* size, int32_t timeout_ms,
+                           bool needParams, bool clearBuf);
+
 /*
  * description: API to set InitViewport before downloading segment.
  * params: hdl - [in]handler created with DashStreaming_Init
@@ -212,6 +304,33 @@ int OmafAccess_ChangeViewport(Handler hdl, HeadPose* pose);
  */
 int OmafAccess_Statistic(Handler hdl, DashStatisticInfo* info);
 
+/*
+ * description: API to get the buffer level, which is the media duration downloaded and
+ *              parsed but not gotten by OmafAccess_GetPacket yet
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         buffer_level_ms - [out] the buffer level in ms
+ * return: the error return from the API
+ */
+int OmafAccess_GetBufferLevel(Handler hdl, int64_t* buffer_level_ms);
+
+/*
+ * description: API to get the pipeline metrics, such as the latency of download, parse,
+ *              tile selection, stitch, packet output and motion to high quality
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         info - [out] the snapshot of the metrics
+ * return: the error return from the API
+ */
+int OmafAccess_GetMetrics(Handler hdl, DashMetricsInfo* info);
+
+/*
+ * description: API to get the pipeline metrics as one JSON object
+ * params: hdl - [in] handler created with DashStreaming_Init
+ *         buf - [out] buffer for the JSON string, nullptr to query the size
+ *         size - [in/out] the size of buf; the size needed including the terminating null
+ * return: the error return from the API
+ */
+int OmafAccess_GetMetricsJson(Handler hdl, char* buf, size_t* size);
+
 /*
  * description: API to Close the Handle and release relative resources after dealing with
  * the media
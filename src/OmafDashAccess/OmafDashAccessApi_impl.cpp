@@ -92,6 +92,13 @@ Handler OmafAccess_Init(DashStreamingClient *pCtx) {
 
   omaf_dash_params.http_params_.bssl_verify_host_ = omaf_params.http_params.ssl_verify_host == 0 ? false : true;
 
+  omaf_dash_params.http_params_.event_loop_ = omaf_params.http_params.enable_event_loop == 0 ? false : true;
+  omaf_dash_params.http_params_.http2_ = omaf_params.http_params.enable_http2 == 0 ? false : true;
+  if (omaf_params.http_params.max_concurrent_streams > 0) {
+    omaf_dash_params.http_params_.max_concurrent_streams_ = omaf_params.http_params.max_concurrent_streams;
+  }
+  omaf_dash_params.http_params_.packed_tile_fetch_ = omaf_params.http_params.enable_packed_tile_fetch == 0 ? false : true;
+
   omaf_dash_params.prediector_params_.enable_ = omaf_params.predictor_params.enable == 0 ? false : true;
 
   if (omaf_params.predictor_params.name) {
@@ -100,6 +107,7 @@ Handler OmafAccess_Init(DashStreamingClient *pCtx) {
   if (omaf_params.predictor_params.libpath) {
     omaf_dash_params.prediector_params_.libpath_ = std::string(omaf_params.predictor_params.libpath);
   }
+  omaf_dash_params.prediector_params_.prefetch_tile_num_ = omaf_params.predictor_params.prefetch_tile_num;
 
   omaf_dash_params.stats_params_.enable_ = omaf_params.statistic_params.enable == 0 ? false : true;
   if (omaf_dash_params.stats_params_.enable_) {
@@ -111,6 +119,40 @@ Handler OmafAccess_Init(DashStreamingClient *pCtx) {
     omaf_dash_params.syncer_params_.segment_range_size_ = omaf_params.synchronizer_params.segment_range_size;
   }
 
+  omaf_dash_params.abr_params_.enable_ = omaf_params.abr_params.enable == 0 ? false : true;
+  if (omaf_dash_params.abr_params_.enable_) {
+    omaf_dash_params.abr_params_.policy_ =
+        omaf_params.abr_params.policy == OMAF_ABR_BOLA ? VCD::OMAF::AbrPolicy::BOLA : VCD::OMAF::AbrPolicy::THROUGHPUT;
+    if (omaf_params.abr_params.buffer_target_ms > 0) {
+      omaf_dash_params.abr_params_.buffer_target_ms_ = omaf_params.abr_params.buffer_target_ms;
+    }
+  }
+
+  if (omaf_params.cache_params.memory_budget > 0) {
+    omaf_dash_params.cache_params_.memory_budget_ = omaf_params.cache_params.memory_budget;
+  }
+  omaf_dash_params.cache_params_.spill_to_disk_ = omaf_params.cache_params.spill_to_disk == 0 ? false : true;
+
+  omaf_dash_params.buffer_params_.max_parsed_segments_ = omaf_params.buffer_params.max_parsed_segments;
+  omaf_dash_params.buffer_params_.max_packet_bytes_ = omaf_params.buffer_params.max_packet_bytes;
+  omaf_dash_params.buffer_params_.max_downloading_segments_ = omaf_params.buffer_params.max_downloading_segments;
+
+  omaf_dash_params.metrics_params_.enable_dump_ = omaf_params.metrics_params.enable_dump == 0 ? false : true;
+  if (omaf_params.metrics_params.dump_interval_ms > 0) {
+    omaf_dash_params.metrics_params_.dump_interval_ms_ = omaf_params.metrics_params.dump_interval_ms;
+  }
+  if (omaf_params.metrics_params.dump_path) {
+    omaf_dash_params.metrics_params_.dump_path_ = std::string(omaf_params.metrics_params.dump_path);
+  }
+
+  if (omaf_params.log_params.min_level >= LOG_INFO && omaf_params.log_params.min_level <= LOG_FATAL) {
+    omaf_dash_params.log_params_.min_level_ = (LogLevel)omaf_params.log_params.min_level;
+  }
+  omaf_dash_params.log_params_.async_ = omaf_params.log_params.enable_async == 0 ? false : true;
+  if (omaf_params.log_params.async_queue_size > 0) {
+    omaf_dash_params.log_params_.async_queue_size_ = omaf_params.log_params.async_queue_size;
+  }
+
   if (omaf_params.max_parallel_transfers > 0) {
     omaf_dash_params.max_parallel_transfers_ = omaf_params.max_parallel_transfers;
   }
@@ -118,6 +160,9 @@ Handler OmafAccess_Init(DashStreamingClient *pCtx) {
   if (omaf_params.segment_open_timeout_ms > 0) {
     omaf_dash_params.segment_open_timeout_ms_ = omaf_params.segment_open_timeout_ms;
   }
+  if (omaf_params.viewport_hysteresis > 0) {
+    omaf_dash_params.viewport_hysteresis_ = omaf_params.viewport_hysteresis;
+  }
   // for stitch
   if (omaf_params.max_decode_width > 0) {
     omaf_dash_params.max_decode_width_ = omaf_params.max_decode_width;
@@ -178,12 +223,9 @@ int OmafAccess_GetMediaInfo(Handler hdl, DashMediaInfo *info) {
   return ERROR_NONE;
 }
 
-int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket *packet, int *size, uint64_t *pts, bool needParams,
-                         bool clearBuf) {
-  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
-  std::list<MediaPacket *> pkts;
-  pSource->GetPacket(stream_id, &pkts, needParams, clearBuf);
-
+//! move the packets out to the DashPacket array, the region wise packing and source resolutions
+//! are copied for each packet, or referenced from the shared metadata if metaPool is set
+static int OutputPackets(std::list<MediaPacket *> &pkts, DashPacket *packet, int *size, OmafPacketMetaPool *metaPool) {
   if (0 == pkts.size()) {
     return ERROR_NULL_PACKET;
   }
@@ -200,16 +242,25 @@ int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket *packet, int *si
     if (!(pPkt->GetEOS())) {
       if (pPkt->GetMediaType() == MediaType_Video)
       {
-          RegionWisePacking *newRwpk = new RegionWisePacking;
-          const RegionWisePacking &pRwpk = pPkt->GetRwpk();
-          *newRwpk = pRwpk;
-          newRwpk->rectRegionPacking = new RectangularRegionWisePacking[newRwpk->numRegions];
-          memcpy_s(newRwpk->rectRegionPacking, pRwpk.numRegions * sizeof(RectangularRegionWisePacking),
-                   pRwpk.rectRegionPacking, pRwpk.numRegions * sizeof(RectangularRegionWisePacking));
-          SourceResolution *srcRes = new SourceResolution[pPkt->GetQualityNum()];
-          memcpy_s(srcRes, pPkt->GetQualityNum() * sizeof(SourceResolution), pPkt->GetSourceResolutions(),
-                   pPkt->GetQualityNum() * sizeof(SourceResolution));
-          packet[i].rwpk = newRwpk;
+          if (metaPool) {
+            DashPacketMeta *meta = metaPool->Acquire(pPkt->GetRwpk(), pPkt->GetSourceResolutions(), pPkt->GetQualityNum());
+            packet[i].meta = meta;
+            packet[i].rwpk = meta ? meta->rwpk : nullptr;
+            packet[i].qtyResolution = meta ? meta->qtyResolution : nullptr;
+          } else {
+            RegionWisePacking *newRwpk = new RegionWisePacking;
+            const RegionWisePacking &pRwpk = pPkt->GetRwpk();
+            *newRwpk = pRwpk;
+            newRwpk->rectRegionPacking = new RectangularRegionWisePacking[newRwpk->numRegions];
+            memcpy_s(newRwpk->rectRegionPacking, pRwpk.numRegions * sizeof(RectangularRegionWisePacking),
+                     pRwpk.rectRegionPacking, pRwpk.numRegions * sizeof(RectangularRegionWisePacking));
+            SourceResolution *srcRes = new SourceResolution[pPkt->GetQualityNum()];
+            memcpy_s(srcRes, pPkt->GetQualityNum() * sizeof(SourceResolution), pPkt->GetSourceResolutions(),
+                     pPkt->GetQualityNum() * sizeof(SourceResolution));
+            packet[i].meta = nullptr;
+            packet[i].rwpk = newRwpk;
+            packet[i].qtyResolution = srcRes;
+          }
           packet[i].buf = pPkt->MovePayload();
           packet[i].size = pPkt->Size();
           packet[i].segID = pPkt->GetSegID();
@@ -219,7 +270,6 @@ int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket *packet, int *si
           packet[i].height = pPkt->GetVideoHeight();
           packet[i].width = pPkt->GetVideoWidth();
           packet[i].numQuality = pPkt->GetQualityNum();
-          packet[i].qtyResolution = srcRes;
           packet[i].tileRowNum = pPkt->GetVideoTileRowNum();
           packet[i].tileColNum = pPkt->GetVideoTileColNum();
           packet[i].bEOS = pPkt->GetEOS();
@@ -255,6 +305,57 @@ int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket *packet, int *si
   return ERROR_NONE;
 }
 
+int OmafAccess_GetPacket(Handler hdl, int stream_id, DashPacket *packet, int *size, uint64_t *pts, bool needParams,
+                         bool clearBuf) {
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+  std::list<MediaPacket *> pkts;
+  pSource->GetPacket(stream_id, &pkts, needParams, clearBuf);
+
+  return OutputPackets(pkts, packet, size, nullptr);
+}
+
+int OmafAccess_AcquirePacket(Handler hdl, int stream_id, DashPacket *packet, int *size, uint64_t *pts, bool needParams,
+                             bool clearBuf) {
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+  std::list<MediaPacket *> pkts;
+  pSource->GetPacket(stream_id, &pkts, needParams, clearBuf);
+
+  return OutputPackets(pkts, packet, size, pSource->GetPacketMetaPool());
+}
+
+int OmafAccess_WaitPackets(Handler hdl, int stream_id, DashPacket *packet, int max_num, int *size, int32_t timeout_ms,
+                           bool needParams, bool clearBuf) {
+  if (!packet || !size || max_num <= 0) return ERROR_INVALID;
+
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+  std::list<MediaPacket *> pkts;
+  *size = 0;
+  int ret = pSource->WaitPackets(stream_id, &pkts, max_num, timeout_ms, needParams, clearBuf);
+  if (ret != ERROR_NONE) return ret;
+
+  return OutputPackets(pkts, packet, size, pSource->GetPacketMetaPool());
+}
+
+int OmafAccess_ReleasePacket(Handler hdl, DashPacket *packet) {
+  if (!packet) return ERROR_NULL_PTR;
+
+  if (packet->buf) {
+    free(packet->buf);
+    packet->buf = nullptr;
+  }
+  if (packet->meta) {
+    packet->meta->release(packet->meta);
+    packet->meta = nullptr;
+  } else {
+    if (packet->rwpk) delete[] packet->rwpk->rectRegionPacking;
+    delete packet->rwpk;
+    delete[] packet->qtyResolution;
+  }
+  packet->rwpk = nullptr;
+  packet->qtyResolution = nullptr;
+  return ERROR_NONE;
+}
+
 int OmafAccess_SetupHeadSetInfo(Handler hdl, HeadSetInfo *clientInfo) {
   OmafMediaSource *pSource = (OmafMediaSource *)hdl;
 
@@ -272,6 +373,36 @@ int OmafAccess_Statistic(Handler hdl, DashStatisticInfo *info) {
   return pSource->GetStatistic(info);
 }
 
+int OmafAccess_GetBufferLevel(Handler hdl, int64_t *buffer_level_ms) {
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+
+  return pSource->GetBufferLevel(buffer_level_ms);
+}
+
+int OmafAccess_GetMetrics(Handler hdl, DashMetricsInfo *info) {
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+
+  return pSource->GetMetrics(info);
+}
+
+int OmafAccess_GetMetricsJson(Handler hdl, char *buf, size_t *size) {
+  OmafMediaSource *pSource = (OmafMediaSource *)hdl;
+  if (size == nullptr) return ERROR_NULL_PTR;
+
+  std::string json;
+  int ret = pSource->GetMetricsJson(json);
+  if (ret != ERROR_NONE) return ret;
+
+  size_t needed = json.size() + 1;
+  if (buf == nullptr || *size < needed) {
+    *size = needed;
+    return buf == nullptr ? ERROR_NONE : ERROR_INVALID;
+  }
+  memcpy_s(buf, *size, json.c_str(), needed);
+  *size = needed;
+  return ERROR_NONE;
+}
+
 int OmafAccess_Close(Handler hdl) {
   OmafMediaSource *pSource = (OmafMediaSource *)hdl;
   delete pSource;
@@ -39,12 +39,26 @@
 //global logging callback function
 extern LogFunction logCallBack;
 
+//global logging level, the calls below it are skipped before their
+//arguments are evaluated
+extern LogLevel logMinLevel;
+
+//the calls below this level are removed at compile time
+#ifndef OMAF_LOG_COMPILE_LEVEL
+#define OMAF_LOG_COMPILE_LEVEL LOG_INFO
+#endif
+
 #define FILE_NAME(x) (strrchr(x, '/') ? strrchr(x, '/')+1:x)
 
 #define PRINT_LOG(logLevel, source, line, fmt, args...)   \
     logCallBack(logLevel, source, line, fmt, ##args);    \
 
-#define OMAF_LOG(logLevel, fmt, args...)                             \
-    PRINT_LOG(logLevel, FILE_NAME(__FILE__), __LINE__, fmt, ##args)  \
+#define OMAF_LOG(logLevel, fmt, args...)                                          \
+    do {                                                                          \
+        if ((logLevel) >= OMAF_LOG_COMPILE_LEVEL && (logLevel) >= logMinLevel)    \
+        {                                                                         \
+            PRINT_LOG(logLevel, FILE_NAME(__FILE__), __LINE__, fmt, ##args)       \
+        }                                                                         \
+    } while (0)                                                                   \
 
 #endif /* _DASHACCESSLOG_H_ */
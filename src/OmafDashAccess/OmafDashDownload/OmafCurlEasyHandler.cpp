@@ -102,6 +102,12 @@ OMAF_STATUS OmafCurlEasyHelper::setParams(CURL *easy_curl, CurlParams params) no
       curl_easy_setopt(easy_curl, CURLOPT_TIMEOUT_MS, params.http_params_.total_timeout_);
     }
 
+    if (params.http_params_.http2_) {
+      // http/2 over tls, and wait for an existing connection to multiplex on rather than opening a new one
+      curl_easy_setopt(easy_curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+      curl_easy_setopt(easy_curl, CURLOPT_PIPEWAIT, 1L);
+    }
+
     if (!params.http_proxy_.http_proxy_.empty()) {
       curl_easy_setopt(easy_curl, CURLOPT_PROXY, params.http_proxy_.http_proxy_.c_str());
       curl_easy_setopt(easy_curl, CURLOPT_PROXYTYPE, CURLPROXY_HTTP);
@@ -233,16 +239,18 @@ OMAF_STATUS OmafCurlEasyDownloader::start(int64_t offset, int64_t size, onData d
   try {
     std::lock_guard<std::mutex> lock(easy_curl_mutex_);
     if (offset > 0 || size > 0) {
+      // the range is [offset, offset + size - 1], open ended without size
       std::stringstream ss;
-      if (offset > 0) {
-        ss << offset;
-      }
+      ss << (offset > 0 ? offset : 0);
       ss << "-";
       if (size > 0) {
-        ss << size;
+        ss << (offset > 0 ? offset : 0) + size - 1;
       }
       // OMAF_LOG(LOG_INFO, "To download the range: %s\n", ss.str());
       curl_easy_setopt(easy_curl_, CURLOPT_RANGE, ss.str().c_str());
+    } else {
+      // the easy handler is reused from the pool, clear the range of last transfer
+      curl_easy_setopt(easy_curl_, CURLOPT_RANGE, NULL);
     }
     dcb_ = dcb;
     scb_ = scb;
@@ -112,6 +112,17 @@ class OmafCurlEasyHelper : public NonCopyable {
 
     return static_cast<long>(timev);
   };
+  // new connections opened by the last transfer, 0 when an existing one was reused
+  static long numConnects(CURL *easy_curl) noexcept {
+    long num = 0;
+    curl_easy_getinfo(easy_curl, CURLINFO_NUM_CONNECTS, &num);
+    return num;
+  };
+  static long httpVersion(CURL *easy_curl) noexcept {
+    long version = 0;
+    curl_easy_getinfo(easy_curl, CURLINFO_HTTP_VERSION, &version);
+    return version;
+  };
 };
 
 class OmafCurlEasyDownloader : public VCD::NonCopyable {
@@ -170,6 +181,18 @@ class OmafCurlEasyDownloader : public VCD::NonCopyable {
     }
     return 0;
   }
+  inline long numConnects() {
+    if (easy_curl_) {
+      return OmafCurlEasyHelper::numConnects(easy_curl_);
+    }
+    return 0;
+  }
+  inline long httpVersion() {
+    if (easy_curl_) {
+      return OmafCurlEasyHelper::httpVersion(easy_curl_);
+    }
+    return 0;
+  }
 
  private:
   void receiveSB(std::unique_ptr<StreamBlock>) noexcept;
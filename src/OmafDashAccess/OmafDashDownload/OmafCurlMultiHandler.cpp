@@ -32,9 +32,19 @@
 
 #include "OmafCurlMultiHandler.h"
 
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 namespace VCD {
 namespace OMAF {
 
+// max epoll events handled in one wait
+const int MAX_EPOLL_EVENTS = 64;
+// max wait in event loop mode while there are tasks, to abort stale tasks in time
+const int MAX_EVENT_WAIT_MS = 100;
+
 std::atomic_size_t OmafDownloadTask::TASK_ID(0);
 
 OmafCurlMultiDownloader::OmafCurlMultiDownloader(long max_parallel_transfers)
@@ -52,6 +62,14 @@ OMAF_STATUS OmafCurlMultiDownloader::init(const CurlParams& p, OmafDownloadTask:
     max_parallel_ = (max_parallel_transfers_ > 0) ? max_parallel_transfers_ : DEFAULT_MAX_PARALLER_TRANSFERS;
     OMAF_LOG(LOG_INFO, "Set max transfer to %ld\n", max_parallel_);
     curl_multi_setopt(curl_multi_, CURLMOPT_MAXCONNECTS, max_parallel_ << 1);
+    if (curl_params_.http_params_.http2_) {
+      curl_multi_setopt(curl_multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#if LIBCURL_VERSION_NUM >= 0x074300
+      curl_multi_setopt(curl_multi_, CURLMOPT_MAX_CONCURRENT_STREAMS, curl_params_.http_params_.max_concurrent_streams_);
+#endif
+      OMAF_LOG(LOG_INFO, "Enable http2 multiplexing, max concurrent streams %ld\n",
+               curl_params_.http_params_.max_concurrent_streams_);
+    }
 
     // 3. create the easy downloader pool
     downloader_pool_ = std::move(make_unique_vcd<OmafCurlEasyDownloaderPool>(max_parallel_ << 1));
@@ -61,9 +79,21 @@ OMAF_STATUS OmafCurlMultiDownloader::init(const CurlParams& p, OmafDownloadTask:
     }
     downloader_pool_->params(curl_params_);
 
-    // 4. create thread for multi runner
+    // 4. set up the event loop if enabled, or fall back to polling
+    event_mode_ = curl_params_.http_params_.event_loop_;
+    if (event_mode_ && ERROR_NONE != initEventLoop()) {
+      OMAF_LOG(LOG_WARNING, "Failed to init the event loop, fall back to polling mode!\n");
+      closeEventLoop();
+      event_mode_ = false;
+    }
+
+    // 5. create thread for multi runner
     bworking_ = true;
-    worker_ = std::thread(&OmafCurlMultiDownloader::threadRunner, this);
+    if (event_mode_) {
+      worker_ = std::thread(&OmafCurlMultiDownloader::eventRunner, this);
+    } else {
+      worker_ = std::thread(&OmafCurlMultiDownloader::threadRunner, this);
+    }
     return ERROR_NONE;
   } catch (const std::exception& ex) {
     OMAF_LOG(LOG_ERROR, "Exception when init curl multi handler, ex: %s\n", ex.what());
@@ -80,6 +110,7 @@ OMAF_STATUS OmafCurlMultiDownloader::close() noexcept {
     // 2. detach the thread
     if (worker_.joinable()) {
       bworking_ = false;
+      wakeup();
       worker_.join();
     }
     // 3. clean up
@@ -87,6 +118,7 @@ OMAF_STATUS OmafCurlMultiDownloader::close() noexcept {
       curl_multi_cleanup(curl_multi_);
       curl_multi_ = nullptr;
     }
+    closeEventLoop();
     return ERROR_NONE;
   } catch (const std::exception& ex) {
     OMAF_LOG(LOG_ERROR, "Exception when close curl multi handler, ex: %s\n", ex.what());
@@ -102,11 +134,9 @@ OMAF_STATUS OmafCurlMultiDownloader::addTask(OmafDownloadTask::Ptr task) noexcep
     }
     OMAF_LOG(LOG_INFO, "01-task id %lld, task count=%d\n", task->id(), task.use_count());
     task->state(OmafDownloadTask::State::READY);
-    {
-      std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
-      ready_task_list_.push_back(task);
-    }
+    insertReadyTask(task);
     task_size_.fetch_add(1);
+    wakeup();
     OMAF_LOG(LOG_INFO, "02-task id %lld,  task count=%d\n", task->id(), task.use_count());
     return ERROR_NONE;
   } catch (const std::exception& ex) {
@@ -127,7 +157,17 @@ OMAF_STATUS OmafCurlMultiDownloader::removeTask(OmafDownloadTask::Ptr task) noex
     }
 
     if (task->state() == OmafDownloadTask::State::RUNNING) {
-      removeRunningTask(task);
+      if (event_mode_) {
+        // the multi handle is only touched by the event loop thread
+        task->remove_requested_ = true;
+        {
+          std::lock_guard<std::mutex> lock(pending_remove_mutex_);
+          pending_remove_list_.push_back(task);
+        }
+        wakeup();
+      } else {
+        removeRunningTask(task);
+      }
     }
     task_size_.fetch_sub(1);
     return ERROR_NONE;
@@ -137,6 +177,19 @@ OMAF_STATUS OmafCurlMultiDownloader::removeTask(OmafDownloadTask::Ptr task) noex
   }
 }
 
+void OmafCurlMultiDownloader::tightenDeadline(int64_t timeline_point,
+                                              std::chrono::steady_clock::time_point deadline) noexcept {
+  try {
+    {
+      std::lock_guard<std::mutex> lock(pending_deadline_mutex_);
+      pending_deadline_list_.push_back(std::make_pair(timeline_point, deadline));
+    }
+    wakeup();
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when tighten the deadline, ex: %s\n", ex.what());
+  }
+}
+
 OMAF_STATUS OmafCurlMultiDownloader::createTransfer(OmafDownloadTask::Ptr task) noexcept {
   try {
     if (task.get() == nullptr || downloader_pool_.get() == nullptr) {
@@ -180,12 +233,45 @@ OMAF_STATUS OmafCurlMultiDownloader::startTransfer(OmafDownloadTask::Ptr task) n
 
     OMAF_STATUS ret = ERROR_NONE;
     auto offset = task->streamSize();
+    task->transfer_offset_ = static_cast<size_t>(offset);
+    task->transfer_received_ = 0;
+    task->transfer_skip_ = 0;
+    // only a range request can be answered with other bytes than asked
+    task->transfer_checked_ = offset == 0 && !task->hasRange();
+    int64_t size = -1;
+    if (task->hasRange()) {
+      size = task->range_size_ - offset;
+      offset += task->range_offset_;
+    }
     // multi hanlder will manager the life cycle of curl easy hanlder,
     // so, we won't send the state callback to downloader.
     ret = downloader->start(
-        offset, -1,
+        offset, size,
         [task](std::unique_ptr<StreamBlock> sb) {
           if (task->dcb_) {
+            task->transfer_received_ += sb->size();
+            if (!task->transfer_checked_) {
+              task->transfer_checked_ = true;
+              long status = task->easy_downloader_->header().http_status_code_;
+              if (status != 206) {
+                // the range is ignored and the body starts from offset 0 of the resource, so
+                // skip the bytes the consumer has, or all of them for a range of the resource
+                bool restart = !task->hasRange() && OmafCurlEasyHelper::success(status);
+                task->transfer_skip_ = restart ? task->transfer_offset_ : SIZE_MAX;
+                OMAF_LOG(LOG_WARNING, "Range request is answered with the whole resource, url=%s\n",
+                         task->url_.c_str());
+              }
+            }
+            if (task->transfer_skip_ > 0) {
+              size_t skip = std::min(task->transfer_skip_, static_cast<size_t>(sb->size()));
+              task->transfer_skip_ -= task->transfer_skip_ == SIZE_MAX ? 0 : skip;
+              if (skip == static_cast<size_t>(sb->size())) return;
+              std::unique_ptr<StreamBlock> tail = make_unique_vcd<StreamBlock>();
+              if (!tail->resize(sb->size() - skip)) return;
+              memcpy_s(tail->buf(), tail->capacity(), sb->cbuf() + skip, sb->size() - skip);
+              tail->size(sb->size() - skip);
+              sb = std::move(tail);
+            }
             task->stream_size_ += sb->size();
             task->dcb_(std::move(sb));
           }
@@ -209,8 +295,11 @@ OMAF_STATUS OmafCurlMultiDownloader::startTransfer(OmafDownloadTask::Ptr task) n
       }
     }
 
-    int still_alive = 0;
-    curl_multi_perform(curl_multi_, &still_alive);
+    // in event loop mode, the transfer is kicked off by the timer callback of adding handle
+    if (!event_mode_) {
+      int still_alive = 0;
+      curl_multi_perform(curl_multi_, &still_alive);
+    }
     return ERROR_NONE;
   } catch (const std::exception& ex) {
     OMAF_LOG(LOG_ERROR, "Exception when start curl transfer task, ex: %s\n", ex.what());
@@ -241,7 +330,7 @@ OMAF_STATUS OmafCurlMultiDownloader::removeReadyTask(OmafDownloadTask::Ptr task)
     std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
     std::list<OmafDownloadTask::Ptr>::iterator it = ready_task_list_.begin();
     for (; it != ready_task_list_.end(); ++it) {
-      if ((*it)->url() == task->url()) {
+      if ((*it)->key() == task->key()) {
         break;
       }
     }
@@ -367,34 +456,206 @@ void OmafCurlMultiDownloader::threadRunner(void) noexcept {
   }
 }
 
+OMAF_STATUS OmafCurlMultiDownloader::initEventLoop(void) noexcept {
+  try {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to create epoll, errno=%d\n", errno);
+      return ERROR_INVALID;
+    }
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to create eventfd, errno=%d\n", errno);
+      return ERROR_INVALID;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = event_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) != 0) {
+      OMAF_LOG(LOG_ERROR, "Failed to watch eventfd, errno=%d\n", errno);
+      return ERROR_INVALID;
+    }
+
+    curl_multi_setopt(curl_multi_, CURLMOPT_SOCKETFUNCTION, &OmafCurlMultiDownloader::onCurlSocket);
+    curl_multi_setopt(curl_multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(curl_multi_, CURLMOPT_TIMERFUNCTION, &OmafCurlMultiDownloader::onCurlTimer);
+    curl_multi_setopt(curl_multi_, CURLMOPT_TIMERDATA, this);
+    OMAF_LOG(LOG_INFO, "Curl multi downloader works in event loop mode\n");
+    return ERROR_NONE;
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when init event loop, ex: %s\n", ex.what());
+    return ERROR_INVALID;
+  }
+}
+
+void OmafCurlMultiDownloader::closeEventLoop(void) noexcept {
+  if (event_fd_ >= 0) {
+    ::close(event_fd_);
+    event_fd_ = -1;
+  }
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+}
+
+void OmafCurlMultiDownloader::wakeup(void) noexcept {
+  if (event_fd_ >= 0) {
+    uint64_t one = 1;
+    ssize_t ret = write(event_fd_, &one, sizeof(one));
+    UNUSED(ret);
+  }
+}
+
+int OmafCurlMultiDownloader::onCurlSocket(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp) {
+  UNUSED(easy);
+  OmafCurlMultiDownloader* self = static_cast<OmafCurlMultiDownloader*>(userp);
+  if (self == nullptr) return -1;
+
+  if (what == CURL_POLL_REMOVE) {
+    epoll_ctl(self->epoll_fd_, EPOLL_CTL_DEL, s, nullptr);
+    return 0;
+  }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = s;
+  if (what & CURL_POLL_IN) ev.events |= EPOLLIN;
+  if (what & CURL_POLL_OUT) ev.events |= EPOLLOUT;
+  // socketp is only set once the socket is watched
+  int op = (socketp == nullptr) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+  if (epoll_ctl(self->epoll_fd_, op, s, &ev) != 0) {
+    OMAF_LOG(LOG_ERROR, "Failed to watch socket %d, errno=%d\n", s, errno);
+    return -1;
+  }
+  if (socketp == nullptr) {
+    curl_multi_assign(self->curl_multi_, s, self);
+  }
+  return 0;
+}
+
+int OmafCurlMultiDownloader::onCurlTimer(CURLM* multi, long timeout_ms, void* userp) {
+  UNUSED(multi);
+  OmafCurlMultiDownloader* self = static_cast<OmafCurlMultiDownloader*>(userp);
+  if (self == nullptr) return -1;
+
+  // -1 means to delete the timer
+  self->curl_timer_set_ = (timeout_ms >= 0);
+  if (self->curl_timer_set_) {
+    self->curl_timer_expire_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  }
+  return 0;
+}
+
+void OmafCurlMultiDownloader::onCurlTimeout(void) noexcept {
+  if (curl_timer_set_ && std::chrono::steady_clock::now() >= curl_timer_expire_) {
+    curl_timer_set_ = false;
+    int running = 0;
+    curl_multi_socket_action(curl_multi_, CURL_SOCKET_TIMEOUT, 0, &running);
+  }
+}
+
+void OmafCurlMultiDownloader::processPendingRemove(void) noexcept {
+  std::list<OmafDownloadTask::Ptr> tasks;
+  {
+    std::lock_guard<std::mutex> lock(pending_remove_mutex_);
+    tasks.swap(pending_remove_list_);
+  }
+  for (auto& task : tasks) {
+    if (task->state() == OmafDownloadTask::State::RUNNING) {
+      removeRunningTask(task);
+    }
+  }
+}
+
+void OmafCurlMultiDownloader::eventRunner(void) noexcept {
+  try {
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    while (bworking_) {
+      processPendingRemove();
+      retriveDoneTask();
+      startTaskDownload();
+      // adding handles may set a timer which expired already
+      onCurlTimeout();
+      retriveDoneTask();
+
+      int timeout = -1;
+      if (curl_timer_set_) {
+        auto remain = std::chrono::duration_cast<std::chrono::milliseconds>(curl_timer_expire_ - std::chrono::steady_clock::now());
+        timeout = remain.count() > 0 ? static_cast<int>(remain.count()) : 0;
+      }
+      if (size() > 0 && (timeout < 0 || timeout > MAX_EVENT_WAIT_MS)) {
+        timeout = MAX_EVENT_WAIT_MS;
+      }
+      // transfers done just now leave slots for the ready tasks
+      if (run_task_map_.size() < static_cast<size_t>(max_parallel_) && ready_task_list_.size() > 0) {
+        timeout = 0;
+      }
+
+      int num = epoll_wait(epoll_fd_, events, MAX_EPOLL_EVENTS, timeout);
+      if (num < 0) {
+        if (errno == EINTR) continue;
+        OMAF_LOG(LOG_ERROR, "Failed to wait the events, errno=%d\n", errno);
+        break;
+      }
+
+      for (int i = 0; i < num; i++) {
+        int fd = events[i].data.fd;
+        if (fd == event_fd_) {
+          uint64_t value = 0;
+          ssize_t ret = read(event_fd_, &value, sizeof(value));
+          UNUSED(ret);
+          continue;
+        }
+        int action = 0;
+        if (events[i].events & EPOLLIN) action |= CURL_CSELECT_IN;
+        if (events[i].events & EPOLLOUT) action |= CURL_CSELECT_OUT;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) action |= CURL_CSELECT_ERR;
+        int running = 0;
+        curl_multi_socket_action(curl_multi_, fd, action, &running);
+      }
+      onCurlTimeout();
+    }
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception in the multi event loop worker, ex: %s\n", ex.what());
+  }
+}
+
 OMAF_STATUS OmafCurlMultiDownloader::startTaskDownload(void) noexcept {
   try {
-    // start a new task
-    if ((run_task_map_.size() < static_cast<size_t>(max_parallel_transfers_)) && (ready_task_list_.size() > 0)) {
-      OmafDownloadTask::Ptr task = NULL;
+    processPendingDeadline();
+    abortStaleTasks();
+
+    // admit the most urgent ready tasks while there are free transfer slots,
+    // or while a running task with lower priority can be preempted for them
+    while (ready_task_list_.size() > 0) {
+      OmafDownloadTask::Ptr task;
       {
         std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
-        task = std::move(ready_task_list_.front());
+        if (ready_task_list_.empty()) break;
+        task = ready_task_list_.front();
+      }
+      if (run_task_map_.size() >= static_cast<size_t>(max_parallel_) && !preemptRunningTask(task)) {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+        // the task may be removed in the meantime
+        if (ready_task_list_.empty() || ready_task_list_.front() != task) continue;
         OMAF_LOG(LOG_INFO, "1-task id %lld, task count=%d\n", task->id(),  task.use_count());
         ready_task_list_.pop_front();
       }
-      OMAF_STATUS ret = ERROR_NONE;
-      if (task != NULL) {
-        ret = createTransfer(task);
-        if (ret == ERROR_NONE) {
-          ret = startTransfer(task);
-          if (ret != ERROR_NONE) {
-            OMAF_LOG(LOG_ERROR, "Failed to start the transfer!\n");
-            removeRunningTask(task);
-          }
-        } else {
-          OMAF_LOG(LOG_ERROR, "Failed to create the transfer!\n");
+      // a preempted task resumes from the bytes already received
+      OMAF_STATUS ret = createTransfer(task);
+      if (ret == ERROR_NONE) {
+        ret = startTransfer(task);
+        if (ret != ERROR_NONE) {
+          OMAF_LOG(LOG_ERROR, "Failed to start the transfer!\n");
+          removeRunningTask(task);
         }
-      }
-      else
-      {
-        OMAF_LOG(LOG_ERROR, "Download task failed to create!\n");
-        return ERROR_NULL_PTR;
+      } else {
+        OMAF_LOG(LOG_ERROR, "Failed to create the transfer!\n");
       }
       OMAF_LOG(LOG_INFO, "2-task id %lld, task count=%d\n", task->id(), task.use_count());
     }
@@ -405,6 +666,142 @@ OMAF_STATUS OmafCurlMultiDownloader::startTaskDownload(void) noexcept {
   }
 }
 
+void OmafCurlMultiDownloader::insertReadyTask(OmafDownloadTask::Ptr task) noexcept {
+  std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+  // keep the ready list ordered by urgency, tasks with the same urgency stay in fifo order
+  auto it = ready_task_list_.begin();
+  while (it != ready_task_list_.end() && !task->moreUrgentThan(*(*it))) {
+    it++;
+  }
+  ready_task_list_.insert(it, std::move(task));
+}
+
+bool OmafCurlMultiDownloader::preemptRunningTask(OmafDownloadTask::Ptr task) noexcept {
+  try {
+    // only a less urgent running task of a lower priority class can be
+    // preempted, the least urgent one is chosen. So the preempted task is
+    // always queued behind the new one and can't preempt it back
+    OmafDownloadTask::Ptr victim;
+    {
+      std::lock_guard<std::mutex> lock(run_task_map_mutex_);
+      for (auto& running : run_task_map_) {
+        auto& candidate = running.second;
+        if (static_cast<int>(candidate->priority()) <= static_cast<int>(task->priority())) continue;
+        if (!task->moreUrgentThan(*candidate)) continue;
+        if (victim.get() == nullptr || victim->moreUrgentThan(*candidate)) {
+          victim = candidate;
+        }
+      }
+    }
+    if (victim.get() == nullptr) {
+      return false;
+    }
+
+    OMAF_LOG(LOG_INFO, "Preempt task id %lld for task id %lld, received %lld bytes\n", victim->id(), task->id(), victim->streamSize());
+    // the easy handle can't be reused while it is still in the multi handle
+    if (ERROR_NONE != removeTransfer(victim)) {
+      OMAF_LOG(LOG_ERROR, "Failed to preempt task id %lld!\n", victim->id());
+      return false;
+    }
+    moveTaskFromRun(victim, OmafDownloadTask::State::READY);
+    // drop the data callback holding the task before the handle goes back to pool
+    victim->easy_downloader_->stop();
+    if (downloader_pool_) {
+      downloader_pool_->push(std::move(victim->easy_downloader_));
+    } else {
+      victim->easy_downloader_->close();
+    }
+    victim->easy_downloader_.reset();
+    insertReadyTask(std::move(victim));
+    return true;
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when preempt a running task, ex: %s\n", ex.what());
+    return false;
+  }
+}
+
+void OmafCurlMultiDownloader::processPendingDeadline(void) noexcept {
+  std::list<std::pair<int64_t, std::chrono::steady_clock::time_point>> deadlines;
+  {
+    std::lock_guard<std::mutex> lock(pending_deadline_mutex_);
+    deadlines.swap(pending_deadline_list_);
+  }
+  if (deadlines.empty()) return;
+
+  {
+    std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+    bool tightened = false;
+    for (auto& d : deadlines) {
+      for (auto& task : ready_task_list_) {
+        if (task->timelinePoint() == d.first && d.second < task->deadline()) {
+          task->deadline(d.second);
+          tightened = true;
+        }
+      }
+    }
+    // the sort is stable, tasks with the same urgency stay in fifo order
+    if (tightened) {
+      ready_task_list_.sort([](const OmafDownloadTask::Ptr& a, const OmafDownloadTask::Ptr& b) {
+        return a->moreUrgentThan(*b);
+      });
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(run_task_map_mutex_);
+    for (auto& d : deadlines) {
+      for (auto& running : run_task_map_) {
+        if (running.second->timelinePoint() == d.first && d.second < running.second->deadline()) {
+          running.second->deadline(d.second);
+        }
+      }
+    }
+  }
+}
+
+void OmafCurlMultiDownloader::abortStaleTasks(void) noexcept {
+  try {
+    // low priority tasks are speculative, they are useless once their deadline passed
+    auto now = std::chrono::steady_clock::now();
+    std::list<OmafDownloadTask::Ptr> stale_ready_tasks;
+    std::list<OmafDownloadTask::Ptr> stale_running_tasks;
+    {
+      std::lock_guard<std::mutex> lock(ready_task_list_mutex_);
+      auto it = ready_task_list_.begin();
+      while (it != ready_task_list_.end()) {
+        if ((*it)->priority() == TaskPriority::LOW && (*it)->deadline() < now) {
+          stale_ready_tasks.push_back(std::move(*it));
+          it = ready_task_list_.erase(it);
+        } else {
+          it++;
+        }
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(run_task_map_mutex_);
+      for (auto& running : run_task_map_) {
+        if (running.second->remove_requested_) continue;
+        if (running.second->priority() == TaskPriority::LOW && running.second->deadline() < now) {
+          stale_running_tasks.push_back(running.second);
+        }
+      }
+    }
+
+    for (auto& task : stale_ready_tasks) {
+      OMAF_LOG(LOG_INFO, "Abort stale ready task, url=%s\n", task->url().c_str());
+      task->state(OmafDownloadTask::State::STOPPED);
+      processTaskDone(std::move(task));
+    }
+    for (auto& task : stale_running_tasks) {
+      OMAF_LOG(LOG_INFO, "Abort stale running task, url=%s\n", task->url().c_str());
+      removeTransfer(task);
+      moveTaskFromRun(task, OmafDownloadTask::State::STOPPED);
+      processTaskDone(std::move(task));
+    }
+  } catch (const std::exception& ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when abort stale tasks, ex: %s\n", ex.what());
+  }
+}
+
 size_t OmafCurlMultiDownloader::retriveDoneTask(int msgNum) noexcept {
   try {
     UNUSED(msgNum);
@@ -425,12 +822,20 @@ size_t OmafCurlMultiDownloader::retriveDoneTask(int msgNum) noexcept {
           }
         }
 
-        if (task.get() != nullptr) {
+        if (task.get() != nullptr && task->remove_requested_) {
+          // the task is removed by user, drop it silently
+          removeRunningTask(task);
+        } else if (task.get() != nullptr) {
           OMAF_LOG(LOG_INFO, "3-task id %lld, task count=%d\n", task->id(), task.use_count());
           removeTransfer(task);
           auto header = task->easy_downloader_->header();
           OMAF_LOG(LOG_INFO, "Header content length=%lld\n", header.content_length_);
-          if (OmafCurlEasyHelper::success(header.http_status_code_) && (header.content_length_ == task->streamSize())) {
+          // a resumed or range request must get the asked bytes, except that a resumed
+          // request of the whole resource answered from offset 0 has its known head skipped
+          bool range_ok = header.http_status_code_ == 206 ||
+                          (!task->hasRange() && task->streamSize() == header.content_length_);
+          if (OmafCurlEasyHelper::success(header.http_status_code_) && range_ok &&
+              (header.content_length_ == task->transferSize())) {
             markTaskFinish(std::move(task));
           } else {
             // FIXME how to check timeout
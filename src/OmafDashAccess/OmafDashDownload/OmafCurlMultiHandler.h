@@ -74,6 +74,10 @@ class OmafDownloadTaskPerfCounter : public VCD::NonCopyable {
   inline void downloadTime(long t) { download_time_ = t; }
   inline double downloadSpeed() const { return download_speed_; }
   inline void downloadSpeed(double s) { download_speed_ = s; }
+  inline long newConnects() const { return new_connects_; }
+  inline void newConnects(long n) { new_connects_ = n; }
+  inline long httpVersion() const { return http_version_; }
+  inline void httpVersion(long v) { http_version_ = v; }
 
  private:
   std::chrono::steady_clock::time_point create_time_;
@@ -81,6 +85,8 @@ class OmafDownloadTaskPerfCounter : public VCD::NonCopyable {
   std::chrono::steady_clock::time_point stop_transfer_;
   long download_time_ = 0;
   double download_speed_ = 0.0;
+  long new_connects_ = 0;
+  long http_version_ = 0;
 };
 
 class OmafDownloadTask : public VCD::NonCopyable {
@@ -121,12 +127,46 @@ class OmafDownloadTask : public VCD::NonCopyable {
 
  public:
   inline const std::string &url() const noexcept { return url_; }
+  // unique key of the task, the url with the byte range if any
+  inline const std::string &key() const noexcept { return key_.empty() ? url_ : key_; }
+  inline void range(int64_t offset, int64_t size) noexcept {
+    range_offset_ = offset;
+    range_size_ = size;
+    if (size > 0) {
+      std::stringstream ss;
+      ss << url_ << "#" << offset << "-" << (offset + size - 1);
+      key_ = ss.str();
+    } else {
+      key_.clear();
+    }
+  }
+  inline bool hasRange() const noexcept { return range_size_ > 0; }
   inline int64_t streamSize(void) const noexcept { return stream_size_; }
+  // body bytes received by the last transfer, with the ones skipped
+  inline int64_t transferSize(void) const noexcept { return transfer_received_; }
   inline size_t id() const noexcept { return id_; }
+  inline TaskPriority priority() const noexcept { return priority_; }
+  inline void priority(TaskPriority p) noexcept { priority_ = p; }
+  inline std::chrono::steady_clock::time_point deadline() const noexcept { return deadline_; }
+  inline void deadline(std::chrono::steady_clock::time_point d) noexcept { deadline_ = d; }
+  inline bool hasDeadline() const noexcept { return deadline_ != std::chrono::steady_clock::time_point::max(); }
+  inline int64_t timelinePoint() const noexcept { return timeline_point_; }
+  inline void timelinePoint(int64_t t) noexcept { timeline_point_ = t; }
+
+  //
+  // @brief whether this task should be admitted to download before the other,
+  //        the earlier deadline wins, then the higher priority
+  //
+  inline bool moreUrgentThan(const OmafDownloadTask &other) const noexcept {
+    if (deadline_ != other.deadline_) return deadline_ < other.deadline_;
+    return static_cast<int>(priority_) < static_cast<int>(other.priority_);
+  }
+
   std::string to_string() const noexcept {
     std::stringstream ss;
     ss << "task, id=" << id_;
-    ss << ", url=" << url_;
+    ss << ", url=" << key();
+    ss << ", priority=" << VCD::OMAF::priority(priority_);
     ss << ", stream_size=" << stream_size_;
     ss << ", state=" << static_cast<int>(state_);
     return ss.str();
@@ -147,6 +187,8 @@ class OmafDownloadTask : public VCD::NonCopyable {
         if (perf_counter_) {
           perf_counter_->downloadTime(easy_downloader_->downloadTime());
           perf_counter_->downloadSpeed(easy_downloader_->speed());
+          perf_counter_->newConnects(easy_downloader_->numConnects());
+          perf_counter_->httpVersion(easy_downloader_->httpVersion());
         }
         break;
       default:
@@ -188,6 +230,14 @@ class OmafDownloadTask : public VCD::NonCopyable {
     if (perf_counter_) return perf_counter_->downloadSpeed();
     return 0.0f;
   }
+  long newConnects() const {
+    if (perf_counter_) return perf_counter_->newConnects();
+    return 0;
+  }
+  long httpVersion() const {
+    if (perf_counter_) return perf_counter_->httpVersion();
+    return 0;
+  }
 
  public:
   void perfCounter(OmafDownloadTaskPerfCounter::Ptr s) { perf_counter_ = s; }
@@ -202,6 +252,25 @@ class OmafDownloadTask : public VCD::NonCopyable {
   int transfer_times_ = 0;
   size_t id_ = 0;
   size_t stream_size_ = 0;
+  // stream size when the current transfer starts, transfers resumed after
+  // timeout or preemption only request the remaining bytes
+  size_t transfer_offset_ = 0;
+  // body bytes received by the current transfer
+  size_t transfer_received_ = 0;
+  // body bytes the consumer already has, when the server answers a resumed
+  // transfer with the whole resource
+  size_t transfer_skip_ = 0;
+  // whether the response status of the current transfer is checked
+  bool transfer_checked_ = false;
+  // byte range of the url to download, size 0 for the whole resource
+  int64_t range_offset_ = 0;
+  int64_t range_size_ = 0;
+  std::string key_;
+  // removal requested by other thread, done by the event loop thread
+  std::atomic_bool remove_requested_{false};
+  TaskPriority priority_ = TaskPriority::NORMAL;
+  std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+  int64_t timeline_point_ = -1;
   OmafDownloadTaskPerfCounter::Ptr perf_counter_;
 
  private:
@@ -229,6 +298,11 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
  public:
   OMAF_STATUS addTask(OmafDownloadTask::Ptr task) noexcept;
   OMAF_STATUS removeTask(OmafDownloadTask::Ptr task) noexcept;
+  //
+  // @brief tighten the deadline of the added tasks of the timeline point, the
+  //        ready tasks are reordered by the worker thread
+  //
+  void tightenDeadline(int64_t timeline_point, std::chrono::steady_clock::time_point deadline) noexcept;
 
   inline size_t size() const noexcept {  // return ready_task_list_.size() + run_task_map_.size();
     int size = task_size_.load();
@@ -244,9 +318,21 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
   OMAF_STATUS moveTaskFromRun(OmafDownloadTask::Ptr task, OmafDownloadTask::State to_state) noexcept;
   OMAF_STATUS markTaskFinish(OmafDownloadTask::Ptr task) noexcept;
   OMAF_STATUS markTaskTimeout(OmafDownloadTask::Ptr task) noexcept;
+  void insertReadyTask(OmafDownloadTask::Ptr task) noexcept;
+  bool preemptRunningTask(OmafDownloadTask::Ptr task) noexcept;
+  void abortStaleTasks(void) noexcept;
+  void processPendingDeadline(void) noexcept;
 
  private:
   void threadRunner(void) noexcept;
+  void eventRunner(void) noexcept;
+  OMAF_STATUS initEventLoop(void) noexcept;
+  void closeEventLoop(void) noexcept;
+  void wakeup(void) noexcept;
+  void onCurlTimeout(void) noexcept;
+  void processPendingRemove(void) noexcept;
+  static int onCurlSocket(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp);
+  static int onCurlTimer(CURLM *multi, long timeout_ms, void *userp);
   OMAF_STATUS startTaskDownload(void) noexcept;
   size_t retriveDoneTask(int msgNum = -1) noexcept;
   OMAF_STATUS createTransfer(OmafDownloadTask::Ptr task) noexcept;
@@ -268,6 +354,20 @@ class OmafCurlMultiDownloader : public VCD::NonCopyable {
   std::atomic_int32_t task_size_{0};
   long max_parallel_ = DEFAULT_MAX_PARALLER_TRANSFERS;
   bool bworking_ = false;
+
+  // event loop mode, curl reports the sockets and the timeout to watch through
+  // callbacks and the worker sleeps in epoll until one of them is ready, or the
+  // eventfd is signaled for new or removed tasks
+  bool event_mode_ = false;
+  int epoll_fd_ = -1;
+  int event_fd_ = -1;
+  bool curl_timer_set_ = false;
+  std::chrono::steady_clock::time_point curl_timer_expire_;
+  std::mutex pending_remove_mutex_;
+  std::list<OmafDownloadTask::Ptr> pending_remove_list_;
+  // deadlines tightened by other thread, applied by the worker thread
+  std::mutex pending_deadline_mutex_;
+  std::list<std::pair<int64_t, std::chrono::steady_clock::time_point>> pending_deadline_list_;
 };
 
 }  // namespace OMAF
@@ -32,8 +32,10 @@
 
 #include "OmafDownloader.h"
 #include "OmafCurlMultiHandler.h"
+#include "OmafPackedSegmentFetcher.h"
 #include "performance.h"
 
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <map>
@@ -51,6 +53,9 @@ struct _taskList {
   using Ptr = std::shared_ptr<struct _taskList>;
 
   int64_t timeline_point_ = -1;
+  // shared by all tasks of the timeline point, so the downloader serves the
+  // timeline points in order and the priorities inside one timeline point
+  std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
   std::list<OmafDownloadTask::Ptr> tasks_[PRIORITYTASKSIZE];
 };
 using TaskList = struct _taskList;
@@ -82,6 +87,10 @@ class OmafDashSegmentHttpClientImpl : public OmafDashSegmentHttpClient {
   OMAF_STATUS check(const SourceParams &ds_params) noexcept override;
   inline void setStatisticsWindows(int32_t time_window) noexcept override;
   inline std::unique_ptr<PerfStatistics> statistics(void) noexcept override;
+  void setTransferObserver(OnTransfer tcb) noexcept override {
+    std::lock_guard<std::mutex> lock(transfer_cb_mutex_);
+    transfer_cb_ = tcb;
+  };
 
  public:
   // set policy based on the priority
@@ -99,6 +108,8 @@ class OmafDashSegmentHttpClientImpl : public OmafDashSegmentHttpClient {
   };
 
  private:
+  OMAF_STATUS openTask(const SourceParams &ds_params, OnData dcb, OnState scb) noexcept;
+  OMAF_STATUS removeTask(const SourceParams &ds_params) noexcept;
   void threadRunner(void) noexcept;
   OmafDownloadTask::Ptr fetchReadyTask(void) noexcept;
   void processDoneTask(OmafDownloadTask::Ptr task) noexcept;
@@ -117,7 +128,11 @@ class OmafDashSegmentHttpClientImpl : public OmafDashSegmentHttpClient {
   bool bworking_ = false;
 
   std::unique_ptr<OmafDashSegmentHttpClientPerf> perf_stats_;
+  std::mutex transfer_cb_mutex_;
+  OnTransfer transfer_cb_ = nullptr;
   OmafCurlMultiDownloader *tmpMultiDownloader_;
+  // tile segments of packed segments are fetched as byte ranges through it
+  OmafPackedSegmentFetcher::Ptr packed_fetcher_;
 };
 
 class OmafDashSegmentHttpClientPerf : public VCD::NonCopyable {
@@ -134,6 +149,7 @@ class OmafDashSegmentHttpClientPerf : public VCD::NonCopyable {
   void addDownloadTime(OmafDownloadTask::State, long) noexcept;
   void add(OmafDownloadTask::State state, const std::chrono::milliseconds &duration, size_t transfer_size,
            long download, double network_spped);
+  void addConnection(long new_connects, long http_version) noexcept;
 
  private:
   void copyPerf(WindowCounter<size_t> &time_counter, WindowCounter<size_t> &transfer_counter,
@@ -150,6 +166,9 @@ class OmafDashSegmentHttpClientPerf : public VCD::NonCopyable {
   WindowCounter<long> timeout_task_download_counter_;
   WindowCounter<long> failure_task_download_counter_;
   WindowCounter<double> network_speed_counter_;
+  std::atomic_size_t new_connections_{0};
+  std::atomic_size_t reused_connections_{0};
+  std::atomic_size_t http2_transfers_{0};
 };
 
 /******************************************************************************
@@ -172,7 +191,7 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::start() noexcept {
     curl_global_init(CURL_GLOBAL_ALL);
 
     // 1. create the multi downloader
-    tmpMultiDownloader_ = new OmafCurlMultiDownloader;
+    tmpMultiDownloader_ = new OmafCurlMultiDownloader(max_parallel_transfers_);
     if (tmpMultiDownloader_ == NULL) return ERROR_INVALID;
     segment_downloader_.reset(tmpMultiDownloader_);
     if (segment_downloader_.get() == nullptr) {
@@ -198,7 +217,15 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::start() noexcept {
       return ERROR_INVALID;
     }
 
-    // 3. start the worker
+    // 3. create the packed segment fetcher, which opens range requests on this client
+    if (curl_params_.http_params_.packed_tile_fetch_) {
+      packed_fetcher_ = std::make_shared<OmafPackedSegmentFetcher>(
+          [this](const SourceParams &params, OnData dcb, OnState scb) { return this->openTask(params, dcb, scb); },
+          [this](const SourceParams &params) { return this->removeTask(params); },
+          curl_params_.http_params_.packed_range_gap_);
+    }
+
+    // 4. start the worker
     bworking_ = true;
     download_worker_ = std::thread(&OmafDashSegmentHttpClientImpl::threadRunner, this);
     return ERROR_NONE;
@@ -231,6 +258,10 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::stop() noexcept {
       downloading_tasks_.clear();
     }
 
+    if (packed_fetcher_.get() != nullptr) {
+      packed_fetcher_->clear();
+    }
+
     if (download_worker_.joinable()) {
       bworking_ = false;
       download_worker_.join();
@@ -247,24 +278,60 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::stop() noexcept {
 }
 
 OMAF_STATUS OmafDashSegmentHttpClientImpl::open(const SourceParams &ds_params, OnData dcb, OnState scb) noexcept {
+  if (packed_fetcher_.get() != nullptr && !ds_params.packed_url_.empty()) {
+    return packed_fetcher_->open(ds_params, dcb, scb);
+  }
+  return openTask(ds_params, dcb, scb);
+}
+
+OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params) noexcept {
+  if (packed_fetcher_.get() != nullptr && !ds_params.packed_url_.empty()) {
+    return packed_fetcher_->remove(ds_params);
+  }
+  return removeTask(ds_params);
+}
+
+OMAF_STATUS OmafDashSegmentHttpClientImpl::openTask(const SourceParams &ds_params, OnData dcb, OnState scb) noexcept {
   try {
     OmafDownloadTask::Ptr task = OmafDownloadTask::createTask(ds_params.dash_url_, dcb, scb);
     if (task.get() == nullptr) {
       OMAF_LOG(LOG_ERROR, "Failed to create the task\n");
       return ERROR_INVALID;
     }
-    if (perf_stats_.get() != nullptr) {
+    task->range(ds_params.range_offset_, ds_params.range_size_);
+    bool need_perf = perf_stats_.get() != nullptr;
+    if (!need_perf) {
+      std::lock_guard<std::mutex> lock(transfer_cb_mutex_);
+      need_perf = transfer_cb_ != nullptr;
+    }
+    if (need_perf) {
       OmafDownloadTaskPerfCounter::Ptr t_perf = std::make_shared<OmafDownloadTaskPerfCounter>();
       task->perfCounter(std::move(t_perf));
     }
 
+    task->priority(ds_params.priority_);
+    task->timelinePoint(ds_params.timeline_point_);
     OMAF_LOG(LOG_INFO, "Open the task count=%d. %s\n", task.use_count(), task->to_string().c_str());
     bool new_timeline = true;
+    bool tightened = false;
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (ds_params.deadline_ms_ >= 0) {
+      deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ds_params.deadline_ms_);
+    }
 
-    std::lock_guard<std::mutex> lock(task_queue_mutex_);
+    std::unique_lock<std::mutex> lock(task_queue_mutex_);
     for (auto &tl : task_queue_) {
       if (ds_params.timeline_point_ == tl->timeline_point_) {
         new_timeline = false;
+        if (deadline < tl->deadline_) {
+          tl->deadline_ = deadline;
+          // the tasks of the timeline point which are not dispatched follow the new deadline
+          for (auto &tasks : tl->tasks_) {
+            for (auto &t : tasks) t->deadline(deadline);
+          }
+          tightened = true;
+        }
+        task->deadline(tl->deadline_);
         auto &tasks = tl->tasks_[static_cast<int>(ds_params.priority_)];
         tasks.push_back(task);
         break;
@@ -279,6 +346,8 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::open(const SourceParams &ds_params, O
         return ERROR_NULL_PTR;
       }
       tl->timeline_point_ = ds_params.timeline_point_;
+      tl->deadline_ = deadline;
+      task->deadline(deadline);
       int priority = static_cast<int>(ds_params.priority_);
       if (priority < PRIORITYTASKSIZE){
         tl->tasks_[priority].push_back(task);
@@ -298,13 +367,19 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::open(const SourceParams &ds_params, O
       task_queue_.push_back(tl);
     }
     task_queue_cv_.notify_all();
+    lock.unlock();
+
+    // and the dispatched ones are reordered in the downloader
+    if (tightened && segment_downloader_) {
+      segment_downloader_->tightenDeadline(ds_params.timeline_point_, deadline);
+    }
     return ERROR_NONE;
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Exception when open the dash source, ex: %s\n", ex.what());
     return ERROR_INVALID;
   }
 }
-OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params) noexcept {
+OMAF_STATUS OmafDashSegmentHttpClientImpl::removeTask(const SourceParams &ds_params) noexcept {
   try {
     OmafDownloadTask::Ptr to_remove_task;
 
@@ -319,13 +394,14 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params)
           std::list<OmafDownloadTask::Ptr>::iterator it = tasks.begin();
           while (it != tasks.end()) {
             auto &task = *it;
-            if (task->url() == ds_params.dash_url_) {
+            if (task->key() == ds_params.key()) {
               if (task->state() == OmafDownloadTask::State::CREATE) {
                 to_remove_task = *it;
                 tasks.erase(it);
-                break;
               }
+              break;
             }
+            it++;
           }
           break;
         }
@@ -336,7 +412,7 @@ OMAF_STATUS OmafDashSegmentHttpClientImpl::remove(const SourceParams &ds_params)
     if (to_remove_task.get() == nullptr) {
       {
         std::lock_guard<std::mutex> lock(downloading_task_mutex_);
-        auto it = downloading_tasks_.find(ds_params.dash_url_);
+        auto it = downloading_tasks_.find(ds_params.key());
         if (it != downloading_tasks_.end()) {
           to_remove_task = std::move(it->second);
           downloading_tasks_.erase(it);
@@ -402,7 +478,7 @@ void OmafDashSegmentHttpClientImpl::threadRunner(void) noexcept {
           // 2.1.2 cache in the downloading list to support remove
 
           std::lock_guard<std::mutex> lock(downloading_task_mutex_);
-          downloading_tasks_[task->url()] = task;
+          downloading_tasks_[task->key()] = task;
         }
         OMAF_LOG(LOG_INFO, "Start download for task count=%d. %s\n", task.use_count(), task->to_string().c_str());
       }
@@ -452,7 +528,7 @@ void OmafDashSegmentHttpClientImpl::processDoneTask(OmafDownloadTask::Ptr task)
     // remove from downloading list
     {
       std::lock_guard<std::mutex> lock(downloading_task_mutex_);
-      auto it = downloading_tasks_.find(task->url());
+      auto it = downloading_tasks_.find(task->key());
       if (it != downloading_tasks_.end()) {
         downloading_tasks_.erase(it);
         OMAF_LOG(LOG_INFO, "Done the task count=%d. %s\n", task.use_count(), task->to_string().c_str());
@@ -461,10 +537,25 @@ void OmafDashSegmentHttpClientImpl::processDoneTask(OmafDownloadTask::Ptr task)
 
     if (perf_stats_) {
       auto duration = task->transferDuration();
-      auto transfer_size = task->streamSize();
+      // the download time is the one of the last transfer, so are the bytes
+      auto transfer_size = task->transferSize();
       auto download_time = task->downloadTime();
       auto network_speed = task->downloadSpeed();
       perf_stats_->add(state, duration, transfer_size, download_time, network_speed);
+      if (state == OmafDownloadTask::State::FINISH) {
+        perf_stats_->addConnection(task->newConnects(), task->httpVersion());
+      }
+    }
+
+    if (state == OmafDownloadTask::State::FINISH) {
+      OnTransfer transfer_cb;
+      {
+        std::lock_guard<std::mutex> lock(transfer_cb_mutex_);
+        transfer_cb = transfer_cb_;
+      }
+      if (transfer_cb) {
+        transfer_cb(task->transferSize(), task->downloadTime());
+      }
     }
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Exception when process the done task, ex: %s\n", ex.what());
@@ -546,6 +637,16 @@ void OmafDashSegmentHttpClientPerf::add(OmafDownloadTask::State state, const std
   }
   network_speed_counter_.add(network_speed);
 }
+void OmafDashSegmentHttpClientPerf::addConnection(long new_connects, long http_version) noexcept {
+  if (new_connects > 0) {
+    new_connections_ += static_cast<size_t>(new_connects);
+  } else {
+    reused_connections_++;
+  }
+  if (http_version == CURL_HTTP_VERSION_2_0) {
+    http2_transfers_++;
+  }
+}
 
 void OmafDashSegmentHttpClientPerf::setStatisticsWindows(int32_t time_window) noexcept {
   try {
@@ -569,6 +670,9 @@ std::unique_ptr<OmafDashSegmentClient::PerfStatistics> OmafDashSegmentHttpClient
   copyPerf(failure_task_time_counter_, failure_task_transfer_counter_, failure_task_download_counter_, perf->failure_);
 
   perf->download_speed_bps_ = network_speed_counter_.count().avr_value_window_;
+  perf->new_connections_ = new_connections_.load();
+  perf->reused_connections_ = reused_connections_.load();
+  perf->http2_transfers_ = http2_transfers_.load();
   return perf;
 }
 
@@ -82,6 +82,10 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
     PerfNode timeout_;
     PerfNode failure_;
     float download_speed_bps_ = 0.0f;
+    // finished transfers which opened a new connection or reused a kept-alive / multiplexed one
+    size_t new_connections_ = 0;
+    size_t reused_connections_ = 0;
+    size_t http2_transfers_ = 0;
 
     std::string serializeTimePoint(const std::chrono::system_clock::time_point &time) {
       auto t_sec = std::chrono::time_point_cast<std::chrono::seconds>(time);
@@ -102,6 +106,8 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
       ss << "success segment transfer: " << success_.to_string() << std::endl;
       ss << "timeout segment transfer: " << timeout_.to_string() << std::endl;
       ss << "failure segment transfer: " << failure_.to_string() << std::endl;
+      ss << "connections: { new=" << new_connections_ << ", reused=" << reused_connections_;
+      ss << ", http2 transfers=" << http2_transfers_ << "}" << std::endl;
       return ss.str();
     }
   };
@@ -110,6 +116,8 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
   using PerfStatistics = struct _perfStatistics;
   using OnData = std::function<void(std::unique_ptr<VCD::OMAF::StreamBlock>)>;
   using OnState = std::function<void(State)>;
+  // transferred bytes and transfer time in microsecond of one finished segment
+  using OnTransfer = std::function<void(size_t, long)>;
 
  protected:
   OmafDashSegmentClient() = default;
@@ -127,6 +135,7 @@ class OmafDashSegmentClient : public VCD::NonCopyable {
   virtual OMAF_STATUS check(const SourceParams &dash_source) noexcept = 0;
   virtual void setStatisticsWindows(int32_t time_window) noexcept = 0;
   virtual std::unique_ptr<PerfStatistics> statistics(void) noexcept = 0;
+  virtual void setTransferObserver(OnTransfer tcb) noexcept = 0;
 };
 
 class OmafDashSegmentHttpClient : public OmafDashSegmentClient {
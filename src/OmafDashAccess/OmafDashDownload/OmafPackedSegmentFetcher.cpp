@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafPackedSegmentFetcher.cpp
+//! \brief:  fetch tile segments from packed segments by byte ranges
+//!
+
+#include "OmafPackedSegmentFetcher.h"
+
+#include <algorithm>
+
+namespace VCD {
+namespace OMAF {
+
+// packed segments whose index is kept for tiles opened later
+const size_t MAX_CACHED_PACKED_INDEX = 64;
+
+static uint32_t readUint32BE(const char *data) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+OMAF_STATUS OmafPackedSegmentFetcher::open(const SourceParams &ds_params, OnData dcb, OnState scb) noexcept {
+  try {
+    Tile::Ptr tile = std::make_shared<Tile>();
+    tile->params_ = ds_params;
+    tile->dcb_ = dcb;
+    tile->scb_ = scb;
+
+    const std::string &packed_url = ds_params.packed_url_;
+    SourceParams index_params;
+    bool fetch_index = false;
+    std::vector<RangeRequest::Ptr> requests;
+    std::list<Tile::Ptr> missed;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = segments_.find(packed_url);
+      if (it == segments_.end()) {
+        PackedSegment::Ptr segment = std::make_shared<PackedSegment>();
+        segment->timeline_point_ = ds_params.timeline_point_;
+        segment->pending_.push_back(tile);
+        segments_[packed_url] = segment;
+
+        // the index is tiny and blocks all tiles of the packed segment
+        index_params = ds_params;
+        index_params.dash_url_ = packed_url;
+        index_params.range_offset_ = 0;
+        index_params.range_size_ =
+            PACKED_TILES_INDEX_HEADER_SIZE + PACKED_TILES_INDEX_ENTRY_SIZE * static_cast<int64_t>(ds_params.packed_entry_num_);
+        index_params.priority_ = TaskPriority::HIGH;
+        index_params.packed_url_.clear();
+        fetch_index = true;
+        evictIndex();
+      } else if (it->second->state_ == IndexState::FETCHING) {
+        // batched into the range requests once the index arrives
+        it->second->pending_.push_back(tile);
+      } else {
+        std::list<Tile::Ptr> tiles;
+        tiles.push_back(tile);
+        requests = buildRequests(it->second, packed_url, tiles, missed);
+      }
+    }
+
+    if (fetch_index) {
+      OMAF_LOG(LOG_INFO, "Fetch the tile index of packed segment %s\n", packed_url.c_str());
+      OMAF_STATUS ret = opener_(
+          index_params,
+          [this, packed_url](std::unique_ptr<StreamBlock> sb) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = segments_.find(packed_url);
+            if (it != segments_.end() && sb.get() != nullptr) {
+              it->second->index_data_.append(sb->cbuf(), sb->size());
+            }
+          },
+          [this, packed_url](OmafDashSegmentClient::State state) { this->onIndexState(packed_url, state); });
+      if (ERROR_NONE != ret) {
+        OMAF_LOG(LOG_ERROR, "Failed to open the index request of packed segment %s\n", packed_url.c_str());
+        std::lock_guard<std::mutex> lock(mutex_);
+        segments_.erase(packed_url);
+        return ret;
+      }
+      return ERROR_NONE;
+    }
+
+    for (auto &request : requests) {
+      OMAF_STATUS ret = startRequest(request);
+      if (ERROR_NONE != ret) return ret;
+    }
+    if (!missed.empty()) {
+      OMAF_LOG(LOG_ERROR, "No tile track %u in the index of packed segment %s\n", ds_params.packed_track_id_,
+               packed_url.c_str());
+      return ERROR_INVALID;
+    }
+    return ERROR_NONE;
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when open the packed tile, ex: %s\n", ex.what());
+    return ERROR_INVALID;
+  }
+}
+
+OMAF_STATUS OmafPackedSegmentFetcher::remove(const SourceParams &ds_params) noexcept {
+  try {
+    RangeRequest::Ptr to_remove;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = segments_.find(ds_params.packed_url_);
+      if (it != segments_.end()) {
+        auto &pending = it->second->pending_;
+        for (auto pit = pending.begin(); pit != pending.end(); pit++) {
+          if ((*pit)->params_.dash_url_ == ds_params.dash_url_) {
+            pending.erase(pit);
+            return ERROR_NONE;
+          }
+        }
+      }
+
+      for (auto rit = requests_.begin(); rit != requests_.end(); rit++) {
+        auto &request = rit->second;
+        bool found = false;
+        bool all_removed = true;
+        for (auto &tile : request->tiles_) {
+          if (tile->params_.dash_url_ == ds_params.dash_url_) {
+            tile->removed_ = true;
+            found = true;
+          }
+          all_removed = all_removed && tile->removed_;
+        }
+        if (found) {
+          if (all_removed) {
+            to_remove = request;
+            requests_.erase(rit);
+            break;
+          }
+          return ERROR_NONE;
+        }
+      }
+    }
+
+    if (to_remove.get() == nullptr) {
+      OMAF_LOG(LOG_ERROR, "Failed to remove the packed tile: %s\n", ds_params.dash_url_.c_str());
+      return ERROR_INVALID;
+    }
+    // nobody waits for the range any more
+    return remover_(to_remove->params_);
+  } catch (const std::exception &ex) {
+    OMAF_LOG(LOG_ERROR, "Exception when remove the packed tile, ex: %s\n", ex.what());
+    return ERROR_INVALID;
+  }
+}
+
+void OmafPackedSegmentFetcher::clear() noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  segments_.clear();
+  requests_.clear();
+}
+
+OMAF_STATUS OmafPackedSegmentFetcher::parseIndex(const std::string &data, uint32_t entry_num,
+                                                 std::map<uint32_t, IndexEntry> &index) noexcept {
+  if (data.size() < PACKED_TILES_INDEX_HEADER_SIZE) {
+    OMAF_LOG(LOG_ERROR, "The packed tiles index is too short, size=%lu\n", data.size());
+    return ERROR_INVALID;
+  }
+  const char *p = data.data();
+  uint32_t box_size = readUint32BE(p);
+  if (memcmp(p + 4, PACKED_TILES_INDEX_TYPE, 4) != 0) {
+    OMAF_LOG(LOG_ERROR, "The packed segment doesn't start with the tiles index!\n");
+    return ERROR_INVALID;
+  }
+  uint32_t count = readUint32BE(p + 12);
+  uint64_t expect_size = PACKED_TILES_INDEX_HEADER_SIZE + static_cast<uint64_t>(PACKED_TILES_INDEX_ENTRY_SIZE) * count;
+  if (box_size != expect_size || data.size() < expect_size) {
+    OMAF_LOG(LOG_ERROR, "Invalid packed tiles index, box size=%u, entry count=%u, data size=%lu\n", box_size, count,
+             data.size());
+    return ERROR_INVALID;
+  }
+  if (entry_num != 0 && count != entry_num) {
+    OMAF_LOG(LOG_WARNING, "The packed tiles index has %u entries, while %u are declared in mpd\n", count, entry_num);
+  }
+
+  index.clear();
+  p += PACKED_TILES_INDEX_HEADER_SIZE;
+  for (uint32_t i = 0; i < count; i++, p += PACKED_TILES_INDEX_ENTRY_SIZE) {
+    IndexEntry entry;
+    entry.track_id_ = readUint32BE(p);
+    entry.offset_ = readUint32BE(p + 4);
+    entry.size_ = readUint32BE(p + 8);
+    if (entry.offset_ < static_cast<int64_t>(expect_size) || entry.size_ == 0) {
+      OMAF_LOG(LOG_ERROR, "Invalid tiles index entry of track %u, offset=%ld, size=%ld\n", entry.track_id_,
+               entry.offset_, entry.size_);
+      return ERROR_INVALID;
+    }
+    index[entry.track_id_] = entry;
+  }
+  return ERROR_NONE;
+}
+
+std::vector<std::vector<OmafPackedSegmentFetcher::IndexEntry>> OmafPackedSegmentFetcher::coalesce(
+    std::vector<IndexEntry> entries, int64_t gap) noexcept {
+  std::vector<std::vector<IndexEntry>> ranges;
+  std::sort(entries.begin(), entries.end(),
+            [](const IndexEntry &a, const IndexEntry &b) { return a.offset_ < b.offset_; });
+  int64_t range_end = 0;
+  for (auto &entry : entries) {
+    if (ranges.empty() || entry.offset_ - range_end > gap) {
+      ranges.emplace_back();
+    }
+    ranges.back().push_back(entry);
+    range_end = std::max(range_end, entry.offset_ + entry.size_);
+  }
+  return ranges;
+}
+
+void OmafPackedSegmentFetcher::onIndexState(const std::string &packed_url,
+                                            OmafDashSegmentClient::State state) noexcept {
+  std::vector<RangeRequest::Ptr> requests;
+  std::list<Tile::Ptr> failed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = segments_.find(packed_url);
+    if (it == segments_.end()) return;
+    PackedSegment::Ptr segment = it->second;
+
+    OMAF_STATUS ret = ERROR_INVALID;
+    if (state == OmafDashSegmentClient::State::SUCCESS) {
+      uint32_t entry_num = segment->pending_.empty() ? 0 : segment->pending_.front()->params_.packed_entry_num_;
+      ret = parseIndex(segment->index_data_, entry_num, segment->index_);
+    }
+    segment->index_data_.clear();
+    if (ERROR_NONE != ret) {
+      OMAF_LOG(LOG_ERROR, "Failed to fetch the tile index of packed segment %s\n", packed_url.c_str());
+      failed.swap(segment->pending_);
+      segments_.erase(it);
+      if (state == OmafDashSegmentClient::State::SUCCESS) state = OmafDashSegmentClient::State::FAILURE;
+    } else {
+      segment->state_ = IndexState::READY;
+      std::list<Tile::Ptr> pending;
+      pending.swap(segment->pending_);
+      requests = buildRequests(segment, packed_url, pending, failed);
+      state = OmafDashSegmentClient::State::FAILURE;
+    }
+  }
+
+  for (auto &request : requests) {
+    if (ERROR_NONE != startRequest(request)) {
+      onRangeState(request, OmafDashSegmentClient::State::FAILURE);
+    }
+  }
+  for (auto &tile : failed) {
+    if (tile->scb_) tile->scb_(state);
+  }
+}
+
+std::vector<OmafPackedSegmentFetcher::RangeRequest::Ptr> OmafPackedSegmentFetcher::buildRequests(
+    PackedSegment::Ptr segment, const std::string &packed_url, std::list<Tile::Ptr> &tiles,
+    std::list<Tile::Ptr> &missed) noexcept {
+  std::map<uint32_t, std::vector<Tile::Ptr>> track_tiles;
+  std::vector<IndexEntry> entries;
+  for (auto &tile : tiles) {
+    auto it = segment->index_.find(tile->params_.packed_track_id_);
+    if (it == segment->index_.end()) {
+      missed.push_back(tile);
+      continue;
+    }
+    tile->entry_ = it->second;
+    auto &same_track = track_tiles[it->second.track_id_];
+    if (same_track.empty()) entries.push_back(it->second);
+    same_track.push_back(tile);
+  }
+
+  std::vector<RangeRequest::Ptr> requests;
+  for (auto &range : coalesce(entries, range_gap_)) {
+    RangeRequest::Ptr request = std::make_shared<RangeRequest>();
+    int64_t range_end = 0;
+    for (auto &entry : range) {
+      for (auto &tile : track_tiles[entry.track_id_]) {
+        if (request->tiles_.empty()) {
+          request->params_ = tile->params_;
+        } else if (tile->params_.priority_ < request->params_.priority_) {
+          // served as the most urgent tile in it
+          request->params_.priority_ = tile->params_.priority_;
+        }
+        request->tiles_.push_back(tile);
+      }
+      range_end = std::max(range_end, entry.offset_ + entry.size_);
+    }
+    request->params_.dash_url_ = packed_url;
+    request->params_.range_offset_ = range.front().offset_;
+    request->params_.range_size_ = range_end - range.front().offset_;
+    request->params_.packed_url_.clear();
+    requests_[request->params_.key()] = request;
+    requests.push_back(request);
+  }
+  return requests;
+}
+
+OMAF_STATUS OmafPackedSegmentFetcher::startRequest(RangeRequest::Ptr request) noexcept {
+  OMAF_LOG(LOG_INFO, "Fetch %lu tiles by range request %s\n", request->tiles_.size(),
+           request->params_.key().c_str());
+  return opener_(
+      request->params_,
+      [this, request](std::unique_ptr<StreamBlock> sb) { this->onRangeData(request, std::move(sb)); },
+      [this, request](OmafDashSegmentClient::State state) { this->onRangeState(request, state); });
+}
+
+void OmafPackedSegmentFetcher::onRangeData(RangeRequest::Ptr request, std::unique_ptr<StreamBlock> sb) noexcept {
+  if (sb.get() == nullptr || sb->size() <= 0) return;
+
+  std::vector<std::pair<OnData, std::unique_ptr<StreamBlock>>> slices;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // absolute byte range of the packed segment carried by this block
+    int64_t block_begin = request->params_.range_offset_ + request->received_;
+    int64_t block_end = block_begin + sb->size();
+    request->received_ += sb->size();
+
+    for (auto &tile : request->tiles_) {
+      if (tile->removed_) continue;
+      int64_t begin = std::max(block_begin, tile->entry_.offset_);
+      int64_t end = std::min(block_end, tile->entry_.offset_ + tile->entry_.size_);
+      if (begin >= end) continue;
+
+      std::unique_ptr<StreamBlock> slice = make_unique_vcd<StreamBlock>();
+      if (slice.get() == nullptr || slice->resize(end - begin) == nullptr) {
+        OMAF_LOG(LOG_ERROR, "Failed to allocate the stream block for the packed tile!\n");
+        continue;
+      }
+      memcpy_s(slice->buf(), slice->capacity(), sb->cbuf() + (begin - block_begin), end - begin);
+      slice->size(end - begin);
+      slices.emplace_back(tile->dcb_, std::move(slice));
+    }
+  }
+
+  for (auto &slice : slices) {
+    if (slice.first) slice.first(std::move(slice.second));
+  }
+}
+
+void OmafPackedSegmentFetcher::onRangeState(RangeRequest::Ptr request, OmafDashSegmentClient::State state) noexcept {
+  std::vector<std::pair<OnState, OmafDashSegmentClient::State>> states;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = requests_.find(request->params_.key());
+    if (it != requests_.end() && it->second == request) {
+      requests_.erase(it);
+    }
+    int64_t received_end = request->params_.range_offset_ + request->received_;
+    for (auto &tile : request->tiles_) {
+      if (tile->removed_) continue;
+      OmafDashSegmentClient::State tile_state = state;
+      // a tile only succeeds when all its bytes arrived
+      if (state == OmafDashSegmentClient::State::SUCCESS &&
+          received_end < tile->entry_.offset_ + tile->entry_.size_) {
+        tile_state = OmafDashSegmentClient::State::FAILURE;
+      }
+      states.emplace_back(tile->scb_, tile_state);
+    }
+  }
+
+  for (auto &s : states) {
+    if (s.first) s.first(s.second);
+  }
+}
+
+void OmafPackedSegmentFetcher::evictIndex(void) noexcept {
+  while (segments_.size() > MAX_CACHED_PACKED_INDEX) {
+    auto oldest = segments_.end();
+    for (auto it = segments_.begin(); it != segments_.end(); it++) {
+      if (it->second->state_ != IndexState::READY) continue;
+      if (oldest == segments_.end() || it->second->timeline_point_ < oldest->second->timeline_point_) {
+        oldest = it;
+      }
+    }
+    if (oldest == segments_.end()) break;
+    segments_.erase(oldest);
+  }
+}
+
+}  // namespace OMAF
+}  // namespace VCD
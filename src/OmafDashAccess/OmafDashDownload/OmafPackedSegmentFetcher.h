@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafPackedSegmentFetcher.h
+//! \brief:  fetch tile segments from packed segments by byte ranges
+//! \detail: The packed segment of one video holds the segments of all its
+//!          tiles and starts with an index of their byte ranges. Tiles of
+//!          one packed segment opened together share one index request,
+//!          then are fetched by a few coalesced range requests, whose data
+//!          is demultiplexed back to the per tile callbacks.
+//!
+
+#ifndef OMAFPACKEDSEGMENTFETCHER_H
+#define OMAFPACKEDSEGMENTFETCHER_H
+
+#include "../common.h"  // VCD::NonCopyable
+#include "OmafDownloader.h"
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VCD {
+namespace OMAF {
+
+class OmafPackedSegmentFetcher : public VCD::NonCopyable {
+ public:
+  using Ptr = std::shared_ptr<OmafPackedSegmentFetcher>;
+  using SourceParams = DashSegmentSourceParams;
+  using OnData = OmafDashSegmentClient::OnData;
+  using OnState = OmafDashSegmentClient::OnState;
+  // open or remove a plain request on the segment client
+  using Opener = std::function<OMAF_STATUS(const SourceParams &, OnData, OnState)>;
+  using Remover = std::function<OMAF_STATUS(const SourceParams &)>;
+
+  struct _indexEntry {
+    uint32_t track_id_ = 0;
+    int64_t offset_ = 0;
+    int64_t size_ = 0;
+  };
+  using IndexEntry = struct _indexEntry;
+
+ public:
+  OmafPackedSegmentFetcher(Opener opener, Remover remover, int64_t range_gap)
+      : opener_(opener), remover_(remover), range_gap_(range_gap){};
+  virtual ~OmafPackedSegmentFetcher() { clear(); };
+
+ public:
+  OMAF_STATUS open(const SourceParams &ds_params, OnData dcb, OnState scb) noexcept;
+  OMAF_STATUS remove(const SourceParams &ds_params) noexcept;
+  void clear() noexcept;
+
+ public:
+  //
+  // @brief parse the tile index at the head of a packed segment
+  //
+  static OMAF_STATUS parseIndex(const std::string &data, uint32_t entry_num,
+                                std::map<uint32_t, IndexEntry> &index) noexcept;
+  //
+  // @brief group the entries into byte ranges to request, entries sorted by
+  //        offset and closer than the gap bytes share one range
+  //
+  static std::vector<std::vector<IndexEntry>> coalesce(std::vector<IndexEntry> entries, int64_t gap) noexcept;
+
+ private:
+  struct _tile {
+    using Ptr = std::shared_ptr<struct _tile>;
+    SourceParams params_;
+    OnData dcb_;
+    OnState scb_;
+    IndexEntry entry_;
+    bool removed_ = false;
+  };
+  using Tile = struct _tile;
+
+  struct _rangeRequest {
+    using Ptr = std::shared_ptr<struct _rangeRequest>;
+    SourceParams params_;
+    std::vector<Tile::Ptr> tiles_;
+    int64_t received_ = 0;
+  };
+  using RangeRequest = struct _rangeRequest;
+
+  enum class IndexState { FETCHING, READY };
+  struct _packedSegment {
+    using Ptr = std::shared_ptr<struct _packedSegment>;
+    IndexState state_ = IndexState::FETCHING;
+    int64_t timeline_point_ = -1;
+    std::string index_data_;
+    std::map<uint32_t, IndexEntry> index_;
+    std::list<Tile::Ptr> pending_;
+  };
+  using PackedSegment = struct _packedSegment;
+
+ private:
+  void onIndexState(const std::string &packed_url, OmafDashSegmentClient::State state) noexcept;
+  std::vector<RangeRequest::Ptr> buildRequests(PackedSegment::Ptr segment, const std::string &packed_url,
+                                               std::list<Tile::Ptr> &tiles,
+                                               std::list<Tile::Ptr> &missed) noexcept;
+  OMAF_STATUS startRequest(RangeRequest::Ptr request) noexcept;
+  void onRangeData(RangeRequest::Ptr request, std::unique_ptr<StreamBlock> sb) noexcept;
+  void onRangeState(RangeRequest::Ptr request, OmafDashSegmentClient::State state) noexcept;
+  void evictIndex(void) noexcept;
+
+ private:
+  Opener opener_;
+  Remover remover_;
+  const int64_t range_gap_;
+  std::mutex mutex_;
+  std::map<std::string, PackedSegment::Ptr> segments_;
+  std::map<std::string, RangeRequest::Ptr> requests_;
+};
+
+}  // namespace OMAF
+}  // namespace VCD
+
+#endif  // !OMAFPACKEDSEGMENTFETCHER_H
@@ -27,7 +27,9 @@
  */
 
 #include "OmafDashSource.h"
+#include "../utils/AsyncLog.h"
 #include <dirent.h>
+#include <chrono>
 #include <math.h>
 #include <string.h>
 #include "OmafExtractorTracksSelector.h"
@@ -45,6 +47,7 @@
 VCD_OMAF_BEGIN
 
 #define MAX_CACHE_SIZE 100 * 1024 * 1024
+#define BUFFER_SPACE_WAIT_MS 100
 
 OmafDashSource::OmafDashSource() {
   mMPDParser = nullptr;
@@ -61,6 +64,8 @@ OmafDashSource::OmafDashSource() {
   mPreExtractorID = 0;
   m_stitch = nullptr;
   mIsLocalMedia = false;
+  mAsyncLog = false;
+  metrics_ = std::make_shared<OmafMetrics>();
 }
 
 OmafDashSource::~OmafDashSource() {
@@ -71,6 +76,7 @@ OmafDashSource::~OmafDashSource() {
   mViewPorts.clear();
   ClearStreams();
   SAFE_DELETE(m_stitch);
+  if (mAsyncLog) StopAsyncLog();
 }
 
 int OmafDashSource::SyncTime(std::string url) {
@@ -102,10 +108,16 @@ int OmafDashSource::SyncTime(std::string url) {
 
 int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, void* externalLog, PluginDef i360scvp_plugin, bool enableExtractor,
                               bool enablePredictor, std::string predictPluginName, std::string libPath) {
-  if (externalLog)
+  logMinLevel = omaf_dash_params_.log_params_.min_level_;
+  if (externalLog) {
     logCallBack = (LogFunction)externalLog;
-  else
+  } else if (omaf_dash_params_.log_params_.async_ &&
+             (mAsyncLog || StartAsyncLog(omaf_dash_params_.log_params_.async_queue_size_) == ERROR_NONE)) {
+    mAsyncLog = true;
+    logCallBack = AsyncLogFunction;
+  } else {
     logCallBack = GlogFunction;
+  }
 
   DIR* dir = opendir(cacheDir.c_str());
   if (dir) {
@@ -139,8 +151,15 @@ int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, void* exter
   int ret = ERROR_NONE;
   DownloadManager* pDM = DOWNLOADMANAGER::GetInstance();
 
+  metrics_->Reset();
+  if (omaf_dash_params_.metrics_params_.enable_dump_) {
+    metrics_->StartDump(omaf_dash_params_.metrics_params_.dump_path_, omaf_dash_params_.metrics_params_.dump_interval_ms_);
+  }
+
   if (!mIsLocalMedia) {
     pDM->SetMaxCacheSize(MAX_CACHE_SIZE);
+    pDM->SetMaxMemorySize(static_cast<uint64_t>(omaf_dash_params_.cache_params_.memory_budget_));
+    pDM->SetUseCache(omaf_dash_params_.cache_params_.spill_to_disk_);
 
     pDM->SetCacheFolder(cacheDir);
 
@@ -238,12 +257,19 @@ int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, void* exter
     }
     params.proj_fmt_ = projFmt;
     params.segment_timeout_ms_ = mMPDinfo->max_segment_duration;
+    params.segment_duration_ms_ = mMPDinfo->max_segment_duration;
+    const OmafDashBufferParams& buffer_params = omaf_dash_params_.buffer_params_;
+    params.max_parsed_segments_ = buffer_params.max_parsed_segments_ > 0 ? buffer_params.max_parsed_segments_ : 0;
+    params.max_packet_bytes_ = buffer_params.max_packet_bytes_ > 0 ? buffer_params.max_packet_bytes_ : 0;
+    params.max_downloading_segments_ =
+        buffer_params.max_downloading_segments_ > 0 ? buffer_params.max_downloading_segments_ : 0;
 
     OMAF_LOG(LOG_INFO, "media stream type=%s\n", mMPDinfo->type.c_str());
     OMAF_LOG(LOG_INFO, "media stream duration=%lld\n", mMPDinfo->media_presentation_duration);
     OMAF_LOG(LOG_INFO, "media stream extractor=%d\n", enableExtractor);
 
     OmafReaderManager::Ptr omaf_reader_mgr = std::make_shared<OmafReaderManager>(dash_client_, params);
+    omaf_reader_mgr->SetMetrics(metrics_);
     ret = omaf_reader_mgr->Initialize(this);
     if (ERROR_NONE != ret) {
       OMAF_LOG(LOG_ERROR, "Failed to start the omaf reader manager, err=%d\n", ret);
@@ -284,10 +310,25 @@ int OmafDashSource::OpenMedia(std::string url, std::string cacheDir, void* exter
   {
     m_selector->SetTwoDQualityInfos(mMPDParser->GetTwoDQualityInfos());
   }
-  if (enablePredictor) m_selector->EnablePosePrediction(predictPluginName, libPath, enableExtractor);
+  if (enablePredictor) {
+    m_selector->EnablePosePrediction(predictPluginName, libPath, enableExtractor);
+    // prefetch is only for tile tracks, extractor tracks are always fully selected
+    if (!enableExtractor) m_selector->SetPrefetchTileNum(omaf_dash_params_.prediector_params_.prefetch_tile_num_);
+  }
   m_selector->SetSegmentDuration(mMPDinfo->max_segment_duration);
+  m_selector->SetViewportHysteresis(omaf_dash_params_.viewport_hysteresis_);
   m_selector->SetI360SCVPPlugin(i360scvp_plugin);
 
+  if (!enableExtractor && omaf_dash_params_.abr_params_.enable_ && dash_client_) {
+    m_rateAdaptation = OmafRateAdaptation::Create(omaf_dash_params_.abr_params_);
+    m_rateAdaptation->SetSegmentDuration(mMPDinfo->max_segment_duration);
+    OmafRateAdaptation::Ptr rateAdaptation = m_rateAdaptation;
+    dash_client_->setTransferObserver([rateAdaptation](size_t bytes, long download_time_us) {
+      rateAdaptation->AddSegmentThroughput(bytes, download_time_us);
+    });
+    m_selector->SetRateAdaptation(m_rateAdaptation);
+  }
+
   for (auto it =  mMapStream.begin(); it != mMapStream.end(); it++)
   {
     if ((it->second)->GetStreamMediaType() == MediaType_Video)
@@ -340,10 +381,102 @@ int OmafDashSource::CloseMedia() {
     stream->Close();
   }
 
+  {
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    for (auto& pending : mPendingPackets) {
+      for (auto packet : pending.second.packets) {
+        SAFE_DELETE(packet);
+      }
+    }
+    mPendingPackets.clear();
+  }
+
+  if (!mIsLocalMedia) {
+    DOWNLOADMANAGER::GetInstance()->CleanCache();
+  }
+
+  metrics_->StopDump();
+
+  // the logger keeps running for the other sessions, and once the last one
+  // stops it AsyncLogFunction writes synchronously
+  if (mAsyncLog) {
+    mAsyncLog = false;
+    StopAsyncLog();
+  }
+
   return ERROR_NONE;
 }
 
+bool OmafDashSource::TakePendingPackets(int streamID, std::list<MediaPacket*>* pkts, bool needParams) {
+  std::lock_guard<std::mutex> lock(mPendingMutex);
+  auto it = mPendingPackets.find(streamID);
+  if (it == mPendingPackets.end()) return false;
+  bool taken = !needParams || it->second.hasParams;
+  if (taken) {
+    pkts->splice(pkts->end(), it->second.packets);
+  } else {
+    // the params can't be added to the frame after reading, so get the next one with them
+    OMAF_LOG(LOG_WARNING, "Drop the kept frame of stream %d got without the params!\n", streamID);
+    for (auto packet : it->second.packets) {
+      SAFE_DELETE(packet);
+    }
+  }
+  mPendingPackets.erase(it);
+  return taken;
+}
+
+int OmafDashSource::WaitPackets(int streamID, std::list<MediaPacket*>* pkts, uint32_t maxNum, int32_t timeoutMs,
+                                bool needParams, bool clearBuf) {
+  if (pkts == nullptr || maxNum == 0) return ERROR_INVALID;
+  if (this->GetStream(streamID) == nullptr || omaf_reader_mgr_ == nullptr) return ERROR_INVALID;
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0);
+  while (true) {
+    // read the epoch before checking, so a frame coming during the check wakes up the wait
+    uint64_t epoch = omaf_reader_mgr_->GetPacketReadyEpoch();
+    bool eos = false;
+    while (!eos && pkts->size() < maxNum) {
+      std::list<MediaPacket*> frame;
+      // every frame asks for the params as the caller does, since the track may switch
+      // inside the batch, while the buffer is only cleared before the first frame
+      bool first = pkts->empty();
+      int ret = GetPacket(streamID, &frame, needParams, clearBuf && first);
+      if (ret != ERROR_NONE || frame.empty()) break;
+
+      for (auto packet : frame) {
+        if (packet && packet->GetEOS()) eos = true;
+      }
+      if (pkts->size() + frame.size() > maxNum) {
+        if (!first) {
+          // keep the whole frame to the next call rather than splitting it
+          std::lock_guard<std::mutex> lock(mPendingMutex);
+          PendingFrame& pending = mPendingPackets[streamID];
+          pending.packets.swap(frame);
+          pending.hasParams = needParams;
+          break;
+        }
+        OMAF_LOG(LOG_ERROR, "Frame of %lld packets exceeds the max number %d, drop it!\n", frame.size(), maxNum);
+        for (auto packet : frame) {
+          SAFE_DELETE(packet);
+        }
+        continue;
+      }
+      pkts->splice(pkts->end(), frame);
+    }
+    if (!pkts->empty()) return ERROR_NONE;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) return ERROR_NULL_PACKET;
+    int32_t remainMs = static_cast<int32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+    omaf_reader_mgr_->WaitPacketReady(epoch, remainMs);
+  }
+}
+
 int OmafDashSource::GetPacket(int streamID, std::list<MediaPacket*>* pkts, bool needParams, bool clearBuf) {
+  if (TakePendingPackets(streamID, pkts, needParams)) return ERROR_NONE;
+
+  ScopedLatency latency(metrics_.get(), MetricHistogram::GET_PACKET_LATENCY);
   OmafMediaStream* pStream = this->GetStream(streamID);
 
   MediaPacket* pkt = nullptr;
@@ -406,6 +539,13 @@ int OmafDashSource::GetPacket(int streamID, std::list<MediaPacket*>* pkts, bool
     }
   }
 
+  metrics_->Add(MetricCounter::PACKETS_OUTPUT, pkts->size());
+  if (pStream->GetStreamMediaType() == MediaType_Video) {
+    for (auto packet : *pkts) {
+      if (packet && !packet->GetEOS()) metrics_->OnPacketOutput(packet->GetSegID());
+    }
+  }
+
   return ERROR_NONE;
 }
 
@@ -415,17 +555,59 @@ int OmafDashSource::GetStatistic(DashStatisticInfo* dsInfo) {
   dsInfo->avg_bandwidth = pDM->GetAverageBitrate();
   dsInfo->immediate_bandwidth = pDM->GetImmediateBitrate();
 #else
+  if (dsInfo) {
+    dsInfo->new_connections = 0;
+    dsInfo->reused_connections = 0;
+    dsInfo->immediate_bandwidth =
+        static_cast<int32_t>(metrics_->Get(MetricGauge::LAST_SEGMENT_BANDWIDTH));
+  }
   if (dsInfo && dash_client_) {
     std::unique_ptr<OmafDashSegmentClient::PerfStatistics> perf_stats = dash_client_->statistics();
     if (perf_stats) {
       dsInfo->avg_bandwidth = static_cast<int32_t>(perf_stats->download_speed_bps_);
+      dsInfo->new_connections = perf_stats->new_connections_;
+      dsInfo->reused_connections = perf_stats->reused_connections_;
     }
   }
+  if (dsInfo) {
+    dsInfo->prefetch_bytes = 0;
+    dsInfo->prefetch_wasted_bytes = 0;
+    dsInfo->prefetch_hit_tiles = 0;
+    for (auto& it : mMapStream) {
+      PrefetchMetrics metrics = it.second->GetPrefetchMetrics();
+      dsInfo->prefetch_bytes += metrics.prefetchedBytes;
+      dsInfo->prefetch_wasted_bytes += metrics.wastedBytes;
+      dsInfo->prefetch_hit_tiles += metrics.hitTiles;
+    }
+
+    SegmentCacheStatistics cacheStats;
+    DOWNLOADMANAGER::GetInstance()->GetCacheStatistics(&cacheStats);
+    dsInfo->cache_hits = cacheStats.hits + cacheStats.diskHits;
+    dsInfo->cache_misses = cacheStats.misses;
+    dsInfo->cache_bytes = cacheStats.memoryBytes;
+  }
 
 #endif
   return ERROR_NONE;
 }
 
+int OmafDashSource::GetBufferLevel(int64_t* levelMs) {
+  if (levelMs == nullptr) return ERROR_NULL_PTR;
+  *levelMs = omaf_reader_mgr_ ? omaf_reader_mgr_->GetBufferLevelMs() : 0;
+  return ERROR_NONE;
+}
+
+int OmafDashSource::GetMetrics(DashMetricsInfo* info) {
+  if (info == nullptr) return ERROR_NULL_PTR;
+  metrics_->GetMetrics(info);
+  return ERROR_NONE;
+}
+
+int OmafDashSource::GetMetricsJson(std::string& json) {
+  json = metrics_->ToJson();
+  return ERROR_NONE;
+}
+
 int OmafDashSource::SetupHeadSetInfo(HeadSetInfo* clientInfo) {
   memcpy_s(&mHeadSetInfo, sizeof(HeadSetInfo), clientInfo, sizeof(HeadSetInfo));
   return ERROR_NONE;
@@ -433,6 +615,9 @@ int OmafDashSource::SetupHeadSetInfo(HeadSetInfo* clientInfo) {
 
 int OmafDashSource::ChangeViewport(HeadPose* pose) {
   int ret = m_selector->UpdateViewport(pose);
+  if (ret == ERROR_NONE) {
+    metrics_->OnViewportChanged();
+  }
 
   return ret;
 }
@@ -524,7 +709,7 @@ int OmafDashSource::TimedDownloadSegment(bool bFirst) {
 #if 0
   std::unique_ptr<OmafDashSegmentClient::PerfStatistics> perf = dash_client_->statistics();
   if (perf) {
-    OMAF_LOG(LOG_INFO, perf->to_string());
+    OMAF_LOG(LOG_INFO, "%s\n", perf->to_string().c_str());
   }
 #endif
   return ERROR_NONE;
@@ -571,6 +756,15 @@ int OmafDashSource::TimedSelectSegements() {
   int ret = ERROR_NONE;
   if (nullptr == m_selector) return ERROR_NULL_PTR;
 
+  if (omaf_reader_mgr_) {
+    int64_t bufferLevel = omaf_reader_mgr_->GetBufferLevelMs();
+    metrics_->Set(MetricGauge::BUFFER_LEVEL_MS, bufferLevel);
+    if (m_rateAdaptation) {
+      m_rateAdaptation->SetBufferLevel(static_cast<uint32_t>(bufferLevel));
+    }
+  }
+
+  ScopedLatency latency(metrics_.get(), MetricHistogram::SELECTION_LATENCY);
   std::map<int, OmafMediaStream*>::iterator it;
   for (it = this->mMapStream.begin(); it != this->mMapStream.end(); it++) {
     OmafMediaStream* pStream = it->second;
@@ -578,6 +772,7 @@ int OmafDashSource::TimedSelectSegements() {
     ret = m_selector->SelectTracks(pStream);
     if (ERROR_NONE != ret) break;
   }
+  metrics_->Add(MetricCounter::TILE_SELECTIONS);
   return ret;
 }
 
@@ -686,6 +881,11 @@ void OmafDashSource::thread_dynamic() {
       break;
     }
 
+    WaitForBufferSpace();
+    if (STATUS_EXITING == GetStatus()) {
+      break;
+    }
+
     // Update viewport and select Adaption Set according to pose change
     ret = TimedSelectSegements();
 
@@ -776,6 +976,11 @@ void OmafDashSource::thread_static() {
       break;
     }
 
+    WaitForBufferSpace();
+    if (STATUS_EXITING == GetStatus()) {
+      break;
+    }
+
     // Update viewport and select Adaption Set according to pose change
     ret = TimedSelectSegements();
 
@@ -822,4 +1027,25 @@ void OmafDashSource::thread_static() {
 
 int OmafDashSource::TimedUpdateMPD() { return ERROR_NONE; }
 
+void OmafDashSource::WaitForBufferSpace() {
+  if (omaf_reader_mgr_ == nullptr) return;
+
+  bool paused = false;
+  while (STATUS_EXITING != GetStatus()) {
+    uint64_t epoch = omaf_reader_mgr_->GetBufferSpaceEpoch();
+    if (!omaf_reader_mgr_->IsBufferFull()) break;
+    if (!paused) {
+      OMAF_LOG(LOG_INFO, "Pause the download, buffer level %ld ms, packet bytes %lu\n",
+               omaf_reader_mgr_->GetBufferLevelMs(), omaf_reader_mgr_->GetBufferedPacketBytes());
+      paused = true;
+    }
+    // woken up once packets are consumed or segment sets are released, the
+    // timeout only bounds the check of the exiting status
+    omaf_reader_mgr_->WaitBufferSpace(epoch, BUFFER_SPACE_WAIT_MS);
+  }
+  if (paused) {
+    OMAF_LOG(LOG_INFO, "Resume the download, buffer level %ld ms\n", omaf_reader_mgr_->GetBufferLevelMs());
+  }
+}
+
 VCD_OMAF_END
@@ -43,7 +43,9 @@
 #include "OmafMPDParser.h"
 #include "DownloadManager.h"
 #include "OmafTracksSelector.h"
+#include "OmafRateAdaptation.h"
 #include "OmafTilesStitch.h"
+#include "OmafMetrics.h"
 #include <mutex>
 
 using namespace VCD::OMAF;
@@ -73,7 +75,12 @@ class OmafDashSource : public OmafMediaSource, Threadable {
   virtual int StartStreaming();
   virtual int CloseMedia();
   virtual int GetPacket(int streamID, std::list<MediaPacket*>* pkts, bool needParams, bool clearBuf);
+  virtual int WaitPackets(int streamID, std::list<MediaPacket*>* pkts, uint32_t maxNum, int32_t timeoutMs,
+                          bool needParams, bool clearBuf);
   virtual int GetStatistic(DashStatisticInfo* dsInfo);
+  virtual int GetBufferLevel(int64_t* levelMs);
+  virtual int GetMetrics(DashMetricsInfo* info);
+  virtual int GetMetricsJson(std::string& json);
   virtual int SetupHeadSetInfo(HeadSetInfo* clientInfo);
   virtual int ChangeViewport(HeadPose* pose);
   virtual int GetMediaInfo(DashMediaInfo* media_info);
@@ -105,6 +112,12 @@ class OmafDashSource : public OmafMediaSource, Threadable {
   //!
   int TimedDownloadSegment(bool bFirst);
 
+  //!
+  //! \brief  Wait until the buffered segments are within the budgets of
+  //!         buffer params, so the downloads don't run ahead of consumption
+  //!
+  void WaitForBufferSpace();
+
   //!
   //! \brief run thread for dynamic mpd processing
   //!
@@ -162,6 +175,15 @@ class OmafDashSource : public OmafMediaSource, Threadable {
 
   int StartReadThread();
 
+ protected:
+  //!
+  //! \brief Take the frame kept by WaitPackets because it didn't fit in the batch,
+  //!        a frame got without the params is dropped if the params are needed now
+  //!
+  bool TakePendingPackets(int streamID, std::list<MediaPacket*>* pkts, bool needParams);
+
+  std::shared_ptr<OmafReaderManager> omaf_reader_mgr_;
+
 private:
     OmafDashSource& operator=(const OmafDashSource& other) { return *this; };
     OmafDashSource(const OmafDashSource& other) { /* do not create copies */ };
@@ -170,14 +192,22 @@ private:
   OmafMPDParser* mMPDParser;       //<! the MPD parser
   DASH_STATUS mStatus;             //<! the status of the source
   OmafTracksSelector* m_selector;  //<! tracks selector basing on viewport
+  OmafRateAdaptation::Ptr m_rateAdaptation;  //<! tile quality adaptation for late binding mode
   std::mutex mMutex;               //<! for synchronization
   MPDInfo* mMPDinfo;               //<! MPD information
   int dcount;
   int mPreExtractorID;
   OmafTilesStitch* m_stitch = nullptr;
   std::shared_ptr<OmafDashSegmentClient> dash_client_;
-  std::shared_ptr<OmafReaderManager> omaf_reader_mgr_;
+  OmafMetrics::Ptr metrics_;  //<! metrics of this source, shared with the reader manager
+  std::mutex mPendingMutex;         //<! for synchronization of mPendingPackets
+  struct PendingFrame {
+    std::list<MediaPacket*> packets;
+    bool hasParams;  //<! whether the frame was got with the params
+  };
+  std::map<int, PendingFrame> mPendingPackets;  //<! frame per stream to be output by next get
   bool mIsLocalMedia;
+  bool mAsyncLog;  //<! this source holds one start of the asynchronous logging
 };
 
 VCD_OMAF_END;
@@ -38,6 +38,7 @@
 #define _MEDIASOURCE_H
 
 #include "OmafMediaStream.h"
+#include "OmafPacketMeta.h"
 #include "OmafTypes.h"
 #include "general.h"
 
@@ -108,6 +109,30 @@ class OmafMediaSource {
   //!
   virtual int GetPacket(int streamID, std::list<MediaPacket*>* pkts, bool needParams, bool clearBuf) = 0;
 
+  //!
+  //! \brief  Wait until packets of the stream are available or the timeout
+  //!         expires, and get up to maxNum of them in one call
+  //!
+  //! \param  [in] streamID
+  //!         the ID of the stream to be operated
+  //! \param  [out] pkts
+  //!         the packets of whole frames got
+  //! \param  [in] maxNum
+  //!         the max number of packets to get
+  //! \param  [in] timeoutMs
+  //!         the max time to wait in ms, 0 to return at once
+  //!
+  //! \return
+  //!         ERROR_NONE if any packet is got, ERROR_NULL_PACKET if timed out,
+  //!         else fail reason
+  //!
+  virtual int WaitPackets(int streamID, std::list<MediaPacket*>* pkts, uint32_t maxNum, int32_t timeoutMs,
+                          bool needParams, bool clearBuf) {
+    int ret = GetPacket(streamID, pkts, needParams, clearBuf);
+    if (ret != ERROR_NONE) return ret;
+    return pkts->empty() ? ERROR_NULL_PACKET : ERROR_NONE;
+  };
+
   //!
   //! \brief  Open Media from special url. it's pure interface
   //!
@@ -176,6 +201,38 @@ class OmafMediaSource {
   //!
   virtual int GetStatistic(DashStatisticInfo* dsInfo) = 0;
 
+  //!
+  //! \brief  Get the media duration downloaded and parsed but not consumed yet
+  //! \param  [out] levelMs
+  //!         the buffer level in ms
+  //! \return
+  //!         ERROR_NONE if success, else fail reason
+  //!
+  virtual int GetBufferLevel(int64_t* levelMs) {
+    if (levelMs) *levelMs = 0;
+    return ERROR_NONE;
+  };
+
+  //!
+  //! \brief  Get the snapshot of the pipeline metrics
+  //! \param  [out] info
+  //!         counters, gauges and latency summaries of the pipeline
+  //! \return
+  //!         ERROR_NONE if success, else fail reason
+  //!
+  virtual int GetMetrics(DashMetricsInfo* info) {
+    if (info) memset(info, 0, sizeof(DashMetricsInfo));
+    return ERROR_NONE;
+  };
+
+  //!
+  //! \brief  Get the snapshot of the pipeline metrics as one JSON object
+  //!
+  virtual int GetMetricsJson(std::string& json) {
+    json = "{}";
+    return ERROR_NONE;
+  };
+
   //!
   //! \brief  seek to special position of the media in VOD mode
   //!
@@ -227,6 +284,12 @@ class OmafMediaSource {
 
   virtual int SelectSpecialSegments(int extractorTrackIdx) = 0;
 
+  //!
+  //! \brief  Get the pool of the region wise packing and source resolutions
+  //!         shared by the packets output with the same layout
+  //!
+  OmafPacketMetaPool* GetPacketMetaPool() { return &mPacketMetaPool; };
+
  public:
   void SetOmafDashParams(OmafDashParams params) { omaf_dash_params_ = params; };
   OmafDashParams GetOmafParams() { return omaf_dash_params_; };
@@ -242,6 +305,7 @@ class OmafMediaSource {
   HeadSetInfo mHeadSetInfo;                    //!<
   HeadPose mPose;                              //!<
   bool mViewPortChanged;                       //!<
+  OmafPacketMetaPool mPacketMetaPool;          //!< metadata shared by the packets output
 };
 
 VCD_OMAF_END;
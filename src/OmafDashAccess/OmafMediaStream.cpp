@@ -29,6 +29,7 @@
 #include "OmafReaderManager.h"
 #include "OmafTileTracksSelector.h"
 #include "OmafMediaStream.h"
+#include "OmafMetrics.h"
 #ifndef _ANDROID_NDK_OPTION_
 #ifdef _USE_TRACE_
 #include "../trace/MtHQ_tp.h"
@@ -52,17 +53,21 @@ OmafMediaStream::OmafMediaStream() {
   m_status = STATUS_UNKNOWN;
   m_activeSegmentNum = 0;
   m_tileSelTimeLine  = 0;
+  memset_s(&mPrefetchMetrics, sizeof(PrefetchMetrics), 0);
 }
 
 OmafMediaStream::~OmafMediaStream() {
-  SAFE_DELETE(m_pStreamInfo->codec);
-  SAFE_DELETE(m_pStreamInfo->mime_type);
-  if (m_pStreamInfo->stream_type == MediaType_Video)
-  {
-    SAFE_DELETE(m_pStreamInfo->source_resolution);
-    SAFE_FREE(mMainAdaptationSet);
+  // the stream info is only allocated by InitStream
+  if (m_pStreamInfo) {
+    SAFE_DELETE(m_pStreamInfo->codec);
+    SAFE_DELETE(m_pStreamInfo->mime_type);
+    if (m_pStreamInfo->stream_type == MediaType_Video)
+    {
+      SAFE_DELETE(m_pStreamInfo->source_resolution);
+      SAFE_FREE(mMainAdaptationSet);
+    }
+    SAFE_FREE(m_pStreamInfo);
   }
-  SAFE_FREE(m_pStreamInfo);
   std::map<uint64_t, std::map<int, OmafAdaptationSet*>>::iterator itSel;
   for (itSel = m_selectedTileTracks.begin(); itSel != m_selectedTileTracks.end(); )
   {
@@ -408,6 +413,12 @@ OMAF_STATUS OmafMediaStream::UpdateStreamInfo() {
           }
         }
       }
+
+      int32_t ret = mTileIndex.Build(mMediaAdaptationSet, (ProjectionFormat)m_pStreamInfo->mProjFormat);
+      if (ret) {
+        OMAF_LOG(LOG_ERROR, "Failed to build tile index !\n");
+        return ret;
+      }
   }
 
   return ERROR_NONE;
@@ -565,13 +576,15 @@ int OmafMediaStream::EnableAllAudioTracks() {
     std::lock_guard<std::mutex> lock(mMutex);
     for (auto as_it1 = mMediaAdaptationSet.begin(); as_it1 != mMediaAdaptationSet.end(); as_it1++) {
       OmafAdaptationSet* pAS = (OmafAdaptationSet*)(as_it1->second);
+      pAS->SetDownloadPriority(TaskPriority::HIGH);
       pAS->Enable(true);
     }
   }
 
   return ret;
 }
-int OmafMediaStream::UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> selectedTiles) {
+int OmafMediaStream::UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> selectedTiles,
+                                             std::map<int, OmafAdaptationSet*> prefetchTiles) {
   if (selectedTiles.empty()) return ERROR_INVALID;
 
   int ret = ERROR_NONE;
@@ -587,14 +600,50 @@ int OmafMediaStream::UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> s
       extractor->Enable(false);
     }
 
+    // evaluate the segments prefetched for the last selection: a hit if the
+    // track is selected now, otherwise the downloaded bytes are wasted and any
+    // download still in flight is cancelled unless the track is still predicted
+    for (auto itPrefetch = m_prefetchTileTracks.begin(); itPrefetch != m_prefetchTileTracks.end(); itPrefetch++) {
+      OmafAdaptationSet* adaptationSet = itPrefetch->second;
+      OmafSegment::Ptr segment = adaptationSet->TakeSpeculativeSegment();
+      if (segment.get() == nullptr) continue;
+
+      uint64_t segSize = static_cast<uint64_t>(segment->GetStreamSize());
+      mPrefetchMetrics.prefetchedTiles++;
+      mPrefetchMetrics.prefetchedBytes += segSize;
+      if (selectedTiles.find(itPrefetch->first) != selectedTiles.end()) {
+        mPrefetchMetrics.hitTiles++;
+        continue;
+      }
+      mPrefetchMetrics.wastedBytes += segSize;
+      if (prefetchTiles.find(itPrefetch->first) != prefetchTiles.end()) continue;
+
+      OmafSegment::State state = segment->GetState();
+      if (state == OmafSegment::State::CREATE || state == OmafSegment::State::OPEN) {
+        OMAF_LOG(LOG_INFO, "Cancel prefetch of track %d for segment %d\n", itPrefetch->first, segment->GetSegID());
+        segment->Stop();
+        mPrefetchMetrics.cancelledTiles++;
+      }
+    }
+    m_prefetchTileTracks.clear();
+
     {
       std::lock_guard<std::mutex> lock(mCurrentMutex);
       //m_selectedTileTracks.clear();
       OMAF_LOG(LOG_INFO, "Will insert tiles selection for time line %ld\n", m_tileSelTimeLine);
       std::map<int, OmafAdaptationSet*> oneSelection;
+      // tiles of the best selected quality cover the viewport, download them
+      // before the background tiles of lower quality
+      int32_t viewportQuality = INT32_MAX;
+      for (auto itAS = selectedTiles.begin(); itAS != selectedTiles.end(); itAS++) {
+        viewportQuality = std::min(viewportQuality, static_cast<int32_t>(itAS->second->GetRepresentationQualityRanking()));
+      }
       for (auto itAS = selectedTiles.begin(); itAS != selectedTiles.end(); itAS++) {
         OmafAdaptationSet* adaptationSet = itAS->second;
+        bool isViewport = static_cast<int32_t>(adaptationSet->GetRepresentationQualityRanking()) == viewportQuality;
+        adaptationSet->SetDownloadPriority(isViewport ? TaskPriority::HIGH : TaskPriority::NORMAL);
         adaptationSet->Enable(true);
+        adaptationSet->SetSpeculative(false);
         OMAF_LOG(LOG_INFO, "Insert track %d for time line %ld\n", itAS->first, m_tileSelTimeLine);
         oneSelection.insert(make_pair(itAS->first, itAS->second));
       }
@@ -603,6 +652,16 @@ int OmafMediaStream::UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> s
       m_tileSelTimeLine++;
       m_hasTileTracksSelected = true;
     }
+
+    // prefetch tracks are downloaded, but never put into the selection used by stitching
+    for (auto itAS = prefetchTiles.begin(); itAS != prefetchTiles.end(); itAS++) {
+      if (selectedTiles.find(itAS->first) != selectedTiles.end()) continue;
+      OmafAdaptationSet* adaptationSet = itAS->second;
+      adaptationSet->Enable(true);
+      adaptationSet->SetSpeculative(true);
+      m_prefetchTileTracks.insert(make_pair(itAS->first, adaptationSet));
+      OMAF_LOG(LOG_INFO, "Prefetch track %d for time line %ld\n", itAS->first, m_tileSelTimeLine - 1);
+    }
   }
 
   return ret;
@@ -1129,13 +1188,22 @@ int32_t OmafMediaStream::TilesStitching() {
         mergedPackets.push_back(packet);
       }
     } else {
+      uint64_t stitchStartUs = OmafMetrics::NowUs();
       mergedPackets = m_stitch->GetTilesMergedPackets();
+      OmafMetrics::Ptr metrics = omaf_reader_mgr_ ? omaf_reader_mgr_->GetMetrics() : nullptr;
+      if (metrics) {
+        metrics->Record(MetricHistogram::STITCH_LATENCY, OmafMetrics::NowUs() - stitchStartUs);
+        metrics->Add(MetricCounter::STITCHED_FRAMES);
+      }
     }
 
     {
       std::lock_guard<std::mutex> lock(m_packetsMutex);
       m_mergedPackets.push_back(mergedPackets);
     }
+    if (omaf_reader_mgr_) {
+      omaf_reader_mgr_->NotifyPacketReady();
+    }
     std::list<MediaPacket*>::iterator it = mergedPackets.begin();
     if (it == mergedPackets.end())
     {
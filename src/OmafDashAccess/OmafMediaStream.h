@@ -43,6 +43,7 @@
 #include "OmafAdaptationSet.h"
 #include "OmafExtractor.h"
 #include "OmafReader.h"
+#include "OmafTileIndex.h"
 #include "OmafTilesStitch.h"
 #include <mutex>
 
@@ -131,6 +132,12 @@ class OmafMediaStream {
   //!
   std::map<int, OmafAdaptationSet*> GetMediaAdaptationSet() { return mMediaAdaptationSet; };
 
+  //!
+  //! \brief  get the spatial index of tile Adaptation sets, which is built
+  //!         once the stream is initialized
+  //!
+  const OmafTileIndex* GetTileIndex() { return &mTileIndex; };
+
   //!
   //! \brief  Update selected extractor after viewport changed
   //!
@@ -139,7 +146,23 @@ class OmafMediaStream {
   //!
   //! \brief  Update selected tile tracks after viewport changed
   //!
-  int UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> selectedTiles);
+  //! \param  [in] selectedTiles
+  //!         tile tracks covering the viewport, which are used for stitching
+  //! \param  [in] prefetchTiles
+  //!         tile tracks predicted to enter the viewport soon, which are only
+  //!         downloaded speculatively with low priority. Prefetched tracks
+  //!         which are neither selected nor predicted any more are cancelled
+  //!
+  int UpdateEnabledTileTracks(std::map<int, OmafAdaptationSet*> selectedTiles,
+                              std::map<int, OmafAdaptationSet*> prefetchTiles = std::map<int, OmafAdaptationSet*>());
+
+  //!
+  //! \brief  get the statistics of speculative tile prefetch
+  //!
+  PrefetchMetrics GetPrefetchMetrics() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPrefetchMetrics;
+  };
 
   int EnableAllAudioTracks();
 
@@ -260,6 +283,8 @@ private:
  private:
   //<! Adaptation Set list for tiles
   std::map<int, OmafAdaptationSet*> mMediaAdaptationSet;
+  //<! index from tile position and quality to Adaptation Set
+  OmafTileIndex mTileIndex;
   //<! Adaptation Set list for extractor
   std::map<int, OmafExtractor*> mExtractors;
   //<! the current extractors to be dealt with
@@ -286,6 +311,10 @@ private:
   //std::list<std::map<int, OmafAdaptationSet*>> m_selectedTileTracks;
   uint64_t m_tileSelTimeLine;
   std::map<uint64_t, std::map<int, OmafAdaptationSet*>> m_selectedTileTracks;
+  //<! tile tracks enabled for prefetch only in the last tiles selection
+  std::map<int, OmafAdaptationSet*> m_prefetchTileTracks;
+  //<! statistics of speculative tile prefetch
+  PrefetchMetrics mPrefetchMetrics;
 
   bool m_hasTileTracksSelected;
   //<! map of video sources for the media stream
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafMetrics.cpp
+//! \brief:  Implementation of the client pipeline metrics registry
+//!
+
+#include "OmafMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+VCD_OMAF_BEGIN
+
+LatencyHistogram::LatencyHistogram() { Reset(); }
+
+void LatencyHistogram::Reset() {
+  for (uint32_t i = 0; i < BUCKET_NUM; i++) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < SUB_BUCKET_NUM) return static_cast<uint32_t>(value);
+
+  uint32_t exponent = 63 - __builtin_clzll(value);
+  if (exponent > MAX_EXPONENT) return BUCKET_NUM - 1;
+
+  uint32_t mantissa = static_cast<uint32_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_NUM - 1);
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_NUM + mantissa;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(uint32_t index) {
+  if (index < SUB_BUCKET_NUM) return index;
+
+  uint32_t exponent = index / SUB_BUCKET_NUM + SUB_BUCKET_BITS - 1;
+  uint64_t mantissa = index % SUB_BUCKET_NUM;
+  return (SUB_BUCKET_NUM + mantissa) << (exponent - SUB_BUCKET_BITS);
+}
+
+void LatencyHistogram::Record(uint64_t valueUs) {
+  buckets_[BucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(valueUs, std::memory_order_relaxed);
+
+  uint64_t prevMax = max_.load(std::memory_order_relaxed);
+  while (valueUs > prevMax && !max_.compare_exchange_weak(prevMax, valueUs, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::Percentile(const uint64_t* counts, uint64_t total, double ratio) const {
+  uint64_t target = static_cast<uint64_t>(ratio * total + 0.5);
+  if (target == 0) target = 1;
+
+  uint64_t accumulated = 0;
+  for (uint32_t i = 0; i < BUCKET_NUM; i++) {
+    accumulated += counts[i];
+    if (accumulated >= target) {
+      // report the middle of the bucket
+      uint64_t lower = BucketLowerBound(i);
+      uint64_t upper = (i + 1 < BUCKET_NUM) ? BucketLowerBound(i + 1) : lower + 1;
+      return lower + (upper - lower) / 2;
+    }
+  }
+  return 0;
+}
+
+void LatencyHistogram::Summarize(LatencySummary* summary) const {
+  if (summary == nullptr) return;
+
+  uint64_t counts[BUCKET_NUM];
+  uint64_t total = 0;
+  // buckets are read one by one while recording goes on, so the percentiles
+  // come from the bucket counts and not from count_
+  for (uint32_t i = 0; i < BUCKET_NUM; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  summary->count = count_.load(std::memory_order_relaxed);
+  summary->max_us = max_.load(std::memory_order_relaxed);
+  summary->mean_us = summary->count ? sum_.load(std::memory_order_relaxed) / summary->count : 0;
+  if (total == 0) {
+    summary->p50_us = summary->p90_us = summary->p99_us = 0;
+    return;
+  }
+  summary->p50_us = std::min(Percentile(counts, total, 0.50), summary->max_us);
+  summary->p90_us = std::min(Percentile(counts, total, 0.90), summary->max_us);
+  summary->p99_us = std::min(Percentile(counts, total, 0.99), summary->max_us);
+}
+
+OmafMetrics::OmafMetrics() { Reset(); }
+
+OmafMetrics::~OmafMetrics() { StopDump(); }
+
+uint64_t OmafMetrics::NowUs() {
+  // monotonic, the latencies must not jump with the wall clock
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void OmafMetrics::Reset() {
+  for (auto& counter : counters_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  for (auto& gauge : gauges_) {
+    gauge.store(0, std::memory_order_relaxed);
+  }
+  for (auto& histogram : histograms_) {
+    histogram.Reset();
+  }
+  pose_change_us_.store(0, std::memory_order_relaxed);
+  pose_change_seg_.store(-1, std::memory_order_relaxed);
+}
+
+void OmafMetrics::OnViewportChanged() {
+  Add(MetricCounter::VIEWPORT_CHANGES);
+
+  uint64_t expected = 0;
+  pose_change_us_.compare_exchange_strong(expected, NowUs());
+}
+
+void OmafMetrics::OnSegmentRequested(uint32_t segID) {
+  if (pose_change_us_.load(std::memory_order_acquire) == 0) return;
+
+  int64_t unbound = -1;
+  pose_change_seg_.compare_exchange_strong(unbound, static_cast<int64_t>(segID));
+}
+
+void OmafMetrics::OnPacketOutput(uint32_t segID) {
+  int64_t boundSeg = pose_change_seg_.load(std::memory_order_acquire);
+  if (boundSeg < 0 || static_cast<int64_t>(segID) < boundSeg) return;
+
+  // only the thread which wins the unbind records the latency
+  if (!pose_change_seg_.compare_exchange_strong(boundSeg, -1)) return;
+
+  uint64_t start = pose_change_us_.exchange(0);
+  if (start != 0) {
+    Record(MetricHistogram::MOTION_TO_HQ_LATENCY, NowUs() - start);
+  }
+}
+
+void OmafMetrics::GetMetrics(DashMetricsInfo* info) const {
+  if (info == nullptr) return;
+
+  info->segments_downloaded = Get(MetricCounter::SEGMENTS_DOWNLOADED);
+  info->download_failures = Get(MetricCounter::DOWNLOAD_FAILURES);
+  info->downloaded_bytes = Get(MetricCounter::DOWNLOADED_BYTES);
+  info->segments_parsed = Get(MetricCounter::SEGMENTS_PARSED);
+  info->parse_failures = Get(MetricCounter::PARSE_FAILURES);
+  info->viewport_changes = Get(MetricCounter::VIEWPORT_CHANGES);
+  info->tile_selections = Get(MetricCounter::TILE_SELECTIONS);
+  info->stitched_frames = Get(MetricCounter::STITCHED_FRAMES);
+  info->packets_output = Get(MetricCounter::PACKETS_OUTPUT);
+  info->last_segment_bandwidth = Get(MetricGauge::LAST_SEGMENT_BANDWIDTH);
+  info->buffer_level_ms = Get(MetricGauge::BUFFER_LEVEL_MS);
+
+  histograms_[static_cast<int>(MetricHistogram::DOWNLOAD_LATENCY)].Summarize(&info->download_latency);
+  histograms_[static_cast<int>(MetricHistogram::PARSE_LATENCY)].Summarize(&info->parse_latency);
+  histograms_[static_cast<int>(MetricHistogram::SELECTION_LATENCY)].Summarize(&info->selection_latency);
+  histograms_[static_cast<int>(MetricHistogram::STITCH_LATENCY)].Summarize(&info->stitch_latency);
+  histograms_[static_cast<int>(MetricHistogram::GET_PACKET_LATENCY)].Summarize(&info->get_packet_latency);
+  histograms_[static_cast<int>(MetricHistogram::MOTION_TO_HQ_LATENCY)].Summarize(&info->motion_to_hq_latency);
+}
+
+static void LatencyToJson(std::stringstream& ss, const char* name, const LatencySummary& summary) {
+  ss << "\"" << name << "\":{\"count\":" << summary.count << ",\"mean_us\":" << summary.mean_us
+     << ",\"p50_us\":" << summary.p50_us << ",\"p90_us\":" << summary.p90_us << ",\"p99_us\":" << summary.p99_us
+     << ",\"max_us\":" << summary.max_us << "}";
+}
+
+std::string OmafMetrics::ToJson() const {
+  DashMetricsInfo info;
+  GetMetrics(&info);
+
+  std::stringstream ss;
+  ss << "{\"timestamp_us\":" << NowUs();
+  ss << ",\"counters\":{";
+  ss << "\"segments_downloaded\":" << info.segments_downloaded;
+  ss << ",\"download_failures\":" << info.download_failures;
+  ss << ",\"downloaded_bytes\":" << info.downloaded_bytes;
+  ss << ",\"segments_parsed\":" << info.segments_parsed;
+  ss << ",\"parse_failures\":" << info.parse_failures;
+  ss << ",\"viewport_changes\":" << info.viewport_changes;
+  ss << ",\"tile_selections\":" << info.tile_selections;
+  ss << ",\"stitched_frames\":" << info.stitched_frames;
+  ss << ",\"packets_output\":" << info.packets_output;
+  ss << "},\"gauges\":{";
+  ss << "\"last_segment_bandwidth\":" << info.last_segment_bandwidth;
+  ss << ",\"buffer_level_ms\":" << info.buffer_level_ms;
+  ss << "},\"latencies\":{";
+  LatencyToJson(ss, "download", info.download_latency);
+  ss << ",";
+  LatencyToJson(ss, "parse", info.parse_latency);
+  ss << ",";
+  LatencyToJson(ss, "selection", info.selection_latency);
+  ss << ",";
+  LatencyToJson(ss, "stitch", info.stitch_latency);
+  ss << ",";
+  LatencyToJson(ss, "get_packet", info.get_packet_latency);
+  ss << ",";
+  LatencyToJson(ss, "motion_to_hq", info.motion_to_hq_latency);
+  ss << "}}";
+  return ss.str();
+}
+
+int32_t OmafMetrics::StartDump(const std::string& path, int32_t intervalMs) {
+  if (path.empty() || intervalMs <= 0) return ERROR_INVALID;
+
+  StopDump();
+
+  std::lock_guard<std::mutex> lock(dump_mutex_);
+  dump_path_ = path;
+  dump_interval_ms_ = intervalMs;
+  dump_running_ = true;
+  dump_thread_ = std::thread(&OmafMetrics::DumpLoop, this);
+  OMAF_LOG(LOG_INFO, "Dump metrics to %s every %d ms\n", path.c_str(), intervalMs);
+  return ERROR_NONE;
+}
+
+void OmafMetrics::StopDump() {
+  {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    if (!dump_running_) return;
+    dump_running_ = false;
+  }
+  dump_cv_.notify_all();
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+  DumpOnce();
+}
+
+void OmafMetrics::DumpLoop() {
+  std::unique_lock<std::mutex> lock(dump_mutex_);
+  while (dump_running_) {
+    dump_cv_.wait_for(lock, std::chrono::milliseconds(dump_interval_ms_));
+    if (!dump_running_) break;
+    lock.unlock();
+    DumpOnce();
+    lock.lock();
+  }
+}
+
+int32_t OmafMetrics::DumpOnce() {
+  // one JSON object per line, so the file can be tailed while playing
+  std::ofstream out(dump_path_, std::ios::app);
+  if (!out.is_open()) {
+    OMAF_LOG(LOG_ERROR, "Failed to open the metrics dump file %s\n", dump_path_.c_str());
+    return ERROR_INVALID;
+  }
+  out << ToJson() << std::endl;
+  return ERROR_NONE;
+}
+
+VCD_OMAF_END;
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafMetrics.h
+//! \brief:  Lock-free registry of the client pipeline metrics
+//! \detail: Counters, gauges and latency histograms updated from the download,
+//!          parse, tile selection, stitch and packet output paths. Every
+//!          metric is a fixed slot of atomics, so recording never takes a
+//!          lock. The registry can be read as DashMetricsInfo, serialized as
+//!          JSON or dumped to a file periodically.
+//!
+
+#ifndef OMAFMETRICS_H
+#define OMAFMETRICS_H
+
+#include "general.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+VCD_OMAF_BEGIN
+
+enum class MetricCounter {
+  SEGMENTS_DOWNLOADED = 0,
+  DOWNLOAD_FAILURES,
+  DOWNLOADED_BYTES,
+  SEGMENTS_PARSED,
+  PARSE_FAILURES,
+  VIEWPORT_CHANGES,
+  TILE_SELECTIONS,
+  STITCHED_FRAMES,
+  PACKETS_OUTPUT,
+  COUNT,
+};
+
+enum class MetricGauge {
+  LAST_SEGMENT_BANDWIDTH = 0,
+  BUFFER_LEVEL_MS,
+  COUNT,
+};
+
+enum class MetricHistogram {
+  DOWNLOAD_LATENCY = 0,
+  PARSE_LATENCY,
+  SELECTION_LATENCY,
+  STITCH_LATENCY,
+  GET_PACKET_LATENCY,
+  MOTION_TO_HQ_LATENCY,
+  COUNT,
+};
+
+//!
+//! \class: LatencyHistogram
+//! \brief: log-linear histogram of microsecond values in the spirit of
+//!         HdrHistogram, 16 linear buckets per power of two which keeps the
+//!         relative error of the percentiles within 1/16
+//!
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void Record(uint64_t valueUs);
+
+  void Reset();
+
+  //!
+  //! \brief  Get the summary of the recorded values
+  //!
+  void Summarize(LatencySummary* summary) const;
+
+  //!
+  //! \brief  Get the bucket index of one value, exposed for the tests
+  //!
+  static uint32_t BucketIndex(uint64_t value);
+
+  //!
+  //! \brief  Get the smallest value of one bucket
+  //!
+  static uint64_t BucketLowerBound(uint32_t index);
+
+ private:
+  static const uint32_t SUB_BUCKET_BITS = 4;
+  static const uint32_t SUB_BUCKET_NUM = 1 << SUB_BUCKET_BITS;
+  // values up to 2^40 us, beyond that they land in the last bucket
+  static const uint32_t MAX_EXPONENT = 40;
+  static const uint32_t BUCKET_NUM = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_NUM;
+
+  uint64_t Percentile(const uint64_t* counts, uint64_t total, double ratio) const;
+
+  std::atomic<uint64_t> buckets_[BUCKET_NUM];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+//!
+//! \class: OmafMetrics
+//! \brief: metrics of one dash source, shared with its reader manager,
+//!         segments and streams
+//!
+class OmafMetrics {
+ public:
+  using Ptr = std::shared_ptr<OmafMetrics>;
+
+ public:
+  OmafMetrics();
+
+  virtual ~OmafMetrics();
+
+  void Add(MetricCounter counter, uint64_t value = 1) {
+    counters_[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+  };
+
+  void Set(MetricGauge gauge, int64_t value) {
+    gauges_[static_cast<int>(gauge)].store(value, std::memory_order_relaxed);
+  };
+
+  void Record(MetricHistogram histogram, uint64_t valueUs) {
+    histograms_[static_cast<int>(histogram)].Record(valueUs);
+  };
+
+  uint64_t Get(MetricCounter counter) const {
+    return counters_[static_cast<int>(counter)].load(std::memory_order_relaxed);
+  };
+
+  int64_t Get(MetricGauge gauge) const { return gauges_[static_cast<int>(gauge)].load(std::memory_order_relaxed); };
+
+  //!
+  //! \brief  Clear all metrics, called when the owning source opens a media
+  //!
+  void Reset();
+
+  //!
+  //! \brief  Mark a viewport change, the oldest change not served yet is kept
+  //!         as the start of the motion to high quality latency
+  //!
+  void OnViewportChanged();
+
+  //!
+  //! \brief  Bind the pending viewport change to the first segment requested
+  //!         after it, which is downloaded with the new selection
+  //!
+  void OnSegmentRequested(uint32_t segID);
+
+  //!
+  //! \brief  Close the pending viewport change once a packet of its segment
+  //!         or a later one is output
+  //!
+  void OnPacketOutput(uint32_t segID);
+
+  //!
+  //! \brief  Get the snapshot of all metrics
+  //!
+  void GetMetrics(DashMetricsInfo* info) const;
+
+  //!
+  //! \brief  Serialize the snapshot of all metrics as one JSON object
+  //!
+  std::string ToJson() const;
+
+  //!
+  //! \brief  Start to append the JSON snapshot to the file every interval
+  //!
+  int32_t StartDump(const std::string& path, int32_t intervalMs);
+
+  //!
+  //! \brief  Stop the periodic dump, a last snapshot is written
+  //!
+  void StopDump();
+
+  static uint64_t NowUs();
+
+ private:
+  void DumpLoop();
+
+  int32_t DumpOnce();
+
+  std::atomic<uint64_t> counters_[static_cast<int>(MetricCounter::COUNT)];
+  std::atomic<int64_t> gauges_[static_cast<int>(MetricGauge::COUNT)];
+  LatencyHistogram histograms_[static_cast<int>(MetricHistogram::COUNT)];
+
+  // motion to high quality, 0 for no pending viewport change
+  std::atomic<uint64_t> pose_change_us_;
+  // -1 before the pending change is bound to a segment
+  std::atomic<int64_t> pose_change_seg_;
+
+  // the periodic dump is the only part which takes a lock
+  std::mutex dump_mutex_;
+  std::condition_variable dump_cv_;
+  std::thread dump_thread_;
+  std::string dump_path_;
+  int32_t dump_interval_ms_ = 0;
+  bool dump_running_ = false;
+};
+
+//!
+//! \class: ScopedLatency
+//! \brief: record the lifetime of the object into one histogram
+//!
+class ScopedLatency {
+ public:
+  ScopedLatency(OmafMetrics* metrics, MetricHistogram histogram)
+      : metrics_(metrics), histogram_(histogram), start_us_(OmafMetrics::NowUs()){};
+  ~ScopedLatency() {
+    if (metrics_) metrics_->Record(histogram_, OmafMetrics::NowUs() - start_us_);
+  };
+
+ private:
+  OmafMetrics* metrics_;
+  MetricHistogram histogram_;
+  uint64_t start_us_;
+};
+
+VCD_OMAF_END;
+
+#endif /* OMAFMETRICS_H */
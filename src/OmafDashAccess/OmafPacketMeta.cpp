@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   OmafPacketMeta.cpp
+//! \brief:  Implementation of the pool of shared packet metadata
+//!
+
+#include "OmafPacketMeta.h"
+
+#include <atomic>
+#include <vector>
+
+VCD_OMAF_BEGIN
+
+//! the metadata of one layout, the public part points into the owned arrays
+struct SharedPacketMeta : public DashPacketMeta {
+  RegionWisePacking layout;
+  std::vector<RectangularRegionWisePacking> regions;
+  std::vector<SourceResolution> resolutions;
+  std::atomic<int32_t> refCount;
+};
+
+static void RetainPacketMeta(DashPacketMeta* meta) {
+  if (meta) static_cast<SharedPacketMeta*>(meta)->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void ReleasePacketMeta(DashPacketMeta* meta) {
+  if (!meta) return;
+  SharedPacketMeta* shared = static_cast<SharedPacketMeta*>(meta);
+  if (shared->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete shared;
+  }
+}
+
+static bool IsSameRegion(const RectangularRegionWisePacking& a, const RectangularRegionWisePacking& b) {
+  return a.transformType == b.transformType && a.guardBandFlag == b.guardBandFlag &&
+         a.projRegWidth == b.projRegWidth && a.projRegHeight == b.projRegHeight && a.projRegTop == b.projRegTop &&
+         a.projRegLeft == b.projRegLeft && a.packedRegWidth == b.packedRegWidth &&
+         a.packedRegHeight == b.packedRegHeight && a.packedRegTop == b.packedRegTop &&
+         a.packedRegLeft == b.packedRegLeft && a.leftGbWidth == b.leftGbWidth && a.rightGbWidth == b.rightGbWidth &&
+         a.topGbHeight == b.topGbHeight && a.bottomGbHeight == b.bottomGbHeight &&
+         a.gbNotUsedForPredFlag == b.gbNotUsedForPredFlag && a.gbType0 == b.gbType0 && a.gbType1 == b.gbType1 &&
+         a.gbType2 == b.gbType2 && a.gbType3 == b.gbType3;
+}
+
+static bool IsSameLayout(const SharedPacketMeta* meta, const RegionWisePacking& rwpk, const SourceResolution* qtyRes,
+                         int32_t numQuality) {
+  const RegionWisePacking& layout = meta->layout;
+  if (layout.constituentPicMatching != rwpk.constituentPicMatching || layout.numRegions != rwpk.numRegions ||
+      layout.projPicWidth != rwpk.projPicWidth || layout.projPicHeight != rwpk.projPicHeight ||
+      layout.packedPicWidth != rwpk.packedPicWidth || layout.packedPicHeight != rwpk.packedPicHeight ||
+      layout.numHiRegions != rwpk.numHiRegions || layout.lowResPicWidth != rwpk.lowResPicWidth ||
+      layout.lowResPicHeight != rwpk.lowResPicHeight) {
+    return false;
+  }
+  if ((rwpk.rectRegionPacking ? rwpk.numRegions : 0) != meta->regions.size()) return false;
+  for (size_t i = 0; i < meta->regions.size(); i++) {
+    if (!IsSameRegion(meta->regions[i], rwpk.rectRegionPacking[i])) return false;
+  }
+  if ((qtyRes ? numQuality : 0) != (int32_t)meta->resolutions.size()) return false;
+  for (size_t i = 0; i < meta->resolutions.size(); i++) {
+    const SourceResolution& a = meta->resolutions[i];
+    const SourceResolution& b = qtyRes[i];
+    if (a.qualityRanking != b.qualityRanking || a.top != b.top || a.left != b.left || a.width != b.width ||
+        a.height != b.height) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static SharedPacketMeta* CreatePacketMeta(const RegionWisePacking& rwpk, const SourceResolution* qtyRes,
+                                          int32_t numQuality) {
+  SharedPacketMeta* meta = new SharedPacketMeta;
+  meta->layout = rwpk;
+  // the layout is shared by the frames, so it keeps no frame timestamp
+  meta->layout.timeStamp = 0;
+  if (rwpk.rectRegionPacking) {
+    meta->regions.assign(rwpk.rectRegionPacking, rwpk.rectRegionPacking + rwpk.numRegions);
+  }
+  if (qtyRes && numQuality > 0) {
+    meta->resolutions.assign(qtyRes, qtyRes + numQuality);
+  }
+  meta->layout.rectRegionPacking = meta->regions.empty() ? nullptr : meta->regions.data();
+  meta->rwpk = &meta->layout;
+  meta->numQuality = meta->resolutions.size();
+  meta->qtyResolution = meta->resolutions.empty() ? nullptr : meta->resolutions.data();
+  meta->retain = RetainPacketMeta;
+  meta->release = ReleasePacketMeta;
+  meta->refCount = 1;
+  return meta;
+}
+
+OmafPacketMetaPool::OmafPacketMetaPool(uint32_t capacity) {
+  m_capacity = capacity ? capacity : 1;
+}
+
+OmafPacketMetaPool::~OmafPacketMetaPool() {
+  Clear();
+}
+
+DashPacketMeta* OmafPacketMetaPool::Acquire(const RegionWisePacking& rwpk, const SourceResolution* qtyRes,
+                                            int32_t numQuality) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_metas.begin(); it != m_metas.end(); it++) {
+    SharedPacketMeta* meta = static_cast<SharedPacketMeta*>(*it);
+    if (IsSameLayout(meta, rwpk, qtyRes, numQuality)) {
+      if (it != m_metas.begin()) m_metas.splice(m_metas.begin(), m_metas, it);
+      RetainPacketMeta(meta);
+      return meta;
+    }
+  }
+
+  SharedPacketMeta* meta = CreatePacketMeta(rwpk, qtyRes, numQuality);
+  // one reference for the pool, one for the caller
+  RetainPacketMeta(meta);
+  m_metas.push_front(meta);
+  while (m_metas.size() > m_capacity) {
+    ReleasePacketMeta(m_metas.back());
+    m_metas.pop_back();
+  }
+  return meta;
+}
+
+void OmafPacketMetaPool::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto meta : m_metas) {
+    ReleasePacketMeta(meta);
+  }
+  m_metas.clear();
+}
+
+uint32_t OmafPacketMetaPool::GetSize() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_metas.size();
+}
+
+VCD_OMAF_END;
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   OmafPacketMeta.h
+//! \brief:  Pool of the packet metadata shared across frames
+//! \detail: The region wise packing and the source resolutions of the
+//!          video packets only change with the tile layout, so the packets
+//!          output with one layout share one immutable, reference counted
+//!          copy of them instead of a copy per packet.
+//!
+
+#ifndef OMAFPACKETMETA_H
+#define OMAFPACKETMETA_H
+
+#include "general.h"
+
+#include <list>
+#include <mutex>
+
+VCD_OMAF_BEGIN
+
+//! layouts kept by the pool for the packets to come
+#define PACKET_META_POOL_CAPACITY 8
+
+class OmafPacketMetaPool {
+ public:
+  //!
+  //! \brief  construct
+  //!
+  //! \param  [in] capacity
+  //!         the most recently used layouts kept by the pool
+  //!
+  OmafPacketMetaPool(uint32_t capacity = PACKET_META_POOL_CAPACITY);
+
+  //!
+  //! \brief  de-construct, the metadata still referenced by packets
+  //!         outlives the pool
+  //!
+  virtual ~OmafPacketMetaPool();
+
+  //!
+  //! \brief  Get a reference to the metadata of the layout, the metadata is
+  //!         shared with the earlier packets of the same layout if the pool
+  //!         still has it, else created
+  //!
+  //! \param  [in] rwpk
+  //!         the region wise packing of the packet
+  //! \param  [in] qtyRes
+  //!         the source resolutions of the packet
+  //! \param  [in] numQuality
+  //!         the number of source resolutions
+  //!
+  //! \return DashPacketMeta*
+  //!         the metadata with one reference for the caller, which drops it
+  //!         with release(), or NULL if failed
+  //!
+  DashPacketMeta* Acquire(const RegionWisePacking& rwpk, const SourceResolution* qtyRes, int32_t numQuality);
+
+  //!
+  //! \brief  Drop the references of the pool to all layouts
+  //!
+  void Clear();
+
+  uint32_t GetSize();
+
+ private:
+  OmafPacketMetaPool& operator=(const OmafPacketMetaPool& other) { return *this; };
+  OmafPacketMetaPool(const OmafPacketMetaPool& other) { /* do not create copies */ };
+
+ private:
+  //<! the layouts with a reference of the pool, the most recently used first
+  std::list<DashPacketMeta*> m_metas;
+  //<! the most layouts kept in m_metas
+  uint32_t m_capacity;
+  std::mutex m_mutex;
+};
+
+VCD_OMAF_END;
+
+#endif /* OMAFPACKETMETA_H */
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafRateAdaptation.cpp
+//! \brief:  Implementation of tile quality rate adaptation engines
+//!
+
+#include "OmafRateAdaptation.h"
+
+#include <math.h>
+
+VCD_OMAF_BEGIN
+
+#define MIN_BOLA_BUFFER_MS 1000
+
+OmafRateAdaptation::OmafRateAdaptation(const OmafDashAbrParams& params) : m_params(params) {
+  m_segmentDuration = 0;
+  m_bufferLevel = 0;
+  m_updateCount = 0;
+  m_lastQuality = INVALID_QUALITY_RANKING;
+  if (m_params.throughput_samples_ <= 0) m_params.throughput_samples_ = 1;
+  if (m_params.safety_factor_ <= 0.0f || m_params.safety_factor_ > 1.0f) m_params.safety_factor_ = 1.0f;
+}
+
+OmafRateAdaptation::~OmafRateAdaptation() { m_throughputs.clear(); }
+
+OmafRateAdaptation::Ptr OmafRateAdaptation::Create(const OmafDashAbrParams& params) {
+  if (params.policy_ == AbrPolicy::BOLA) {
+    return std::make_shared<OmafBolaRateAdaptation>(params);
+  }
+  return std::make_shared<OmafThroughputRateAdaptation>(params);
+}
+
+void OmafRateAdaptation::AddSegmentThroughput(size_t bytes, long downloadTimeUs) {
+  if (!bytes || downloadTimeUs <= 0) return;
+
+  double throughput = (double)bytes * 8 * 1000000 / downloadTimeUs;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_throughputs.push_back(throughput);
+  while (m_throughputs.size() > (size_t)m_params.throughput_samples_) m_throughputs.pop_front();
+  m_updateCount++;
+}
+
+void OmafRateAdaptation::SetBufferLevel(uint32_t bufferLevelMs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_bufferLevel == bufferLevelMs) return;
+  m_bufferLevel = bufferLevelMs;
+  m_updateCount++;
+}
+
+void OmafRateAdaptation::SetSegmentDuration(uint32_t segDurMs) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_segmentDuration = segDurMs;
+}
+
+double OmafRateAdaptation::GetEstimatedThroughput() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_throughputs.empty()) return 0;
+
+  // harmonic mean is robust against a few outlier fast downloads
+  double invSum = 0;
+  for (auto throughput : m_throughputs) invSum += 1.0 / throughput;
+  return m_throughputs.size() / invSum;
+}
+
+uint32_t OmafRateAdaptation::GetBufferLevel() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_bufferLevel;
+}
+
+uint64_t OmafRateAdaptation::GetUpdateCount() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_updateCount;
+}
+
+QualityRank OmafRateAdaptation::SelectQuality(const std::vector<RateOption>& options) {
+  if (options.empty()) return INVALID_QUALITY_RANKING;
+
+  double throughput = GetEstimatedThroughput();
+  uint32_t bufferLevel = GetBufferLevel();
+
+  size_t index = SelectOption(options, throughput, bufferLevel);
+  if (index >= options.size()) index = options.size() - 1;
+
+  QualityRank quality = options[index].quality;
+  if (quality != m_lastQuality) {
+    OMAF_LOG(LOG_INFO, "Tile quality changes from %d to %d, bitrate %llu bps, throughput %.0f bps, buffer %u ms\n",
+             m_lastQuality, quality, (unsigned long long)options[index].bitrate, throughput, bufferLevel);
+    m_lastQuality = quality;
+  }
+  return quality;
+}
+
+static size_t SelectByThroughput(const std::vector<RateOption>& options, double throughput, float safetyFactor) {
+  // no measurement yet, keep the best quality as before
+  if (throughput <= 0) return 0;
+
+  double budget = throughput * safetyFactor;
+  for (size_t i = 0; i < options.size(); i++) {
+    if ((double)options[i].bitrate <= budget) return i;
+  }
+  return options.size() - 1;
+}
+
+size_t OmafThroughputRateAdaptation::SelectOption(const std::vector<RateOption>& options, double throughput,
+                                                  uint32_t bufferLevelMs) {
+  return SelectByThroughput(options, throughput, m_params.safety_factor_);
+}
+
+size_t OmafBolaRateAdaptation::SelectOption(const std::vector<RateOption>& options, double throughput,
+                                            uint32_t bufferLevelMs) {
+  // nothing buffered yet, start up with the throughput rule
+  if (bufferLevelMs == 0) {
+    size_t index = SelectByThroughput(options, throughput, m_params.safety_factor_);
+    m_lastBitrate = options[index].bitrate;
+    return index;
+  }
+
+  uint64_t minBitrate = UINT64_MAX;
+  uint64_t maxBitrate = 0;
+  for (auto& option : options) {
+    if (option.bitrate < minBitrate) minBitrate = option.bitrate;
+    if (option.bitrate > maxBitrate) maxBitrate = option.bitrate;
+  }
+  if (minBitrate == 0 || minBitrate == maxBitrate) return 0;
+
+  double minBuffer = (double)(m_segmentDuration > MIN_BOLA_BUFFER_MS ? m_segmentDuration : MIN_BOLA_BUFFER_MS) / 1000;
+  double targetBuffer = (double)m_params.buffer_target_ms_ / 1000;
+  if (targetBuffer < minBuffer * 2) targetBuffer = minBuffer * 2;
+
+  // utility of the lowest bitrate is 1
+  double maxUtility = log((double)maxBitrate / minBitrate) + 1;
+  double gp = (maxUtility - 1) / (targetBuffer / minBuffer - 1);
+  double vp = minBuffer / gp;
+  double buffer = (double)bufferLevelMs / 1000;
+
+  size_t best = 0;
+  double bestScore = 0;
+  for (size_t i = 0; i < options.size(); i++) {
+    double utility = log((double)options[i].bitrate / minBitrate) + 1;
+    double score = (vp * (utility + gp) - buffer) / options[i].bitrate;
+    if (i == 0 || score > bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+
+  // BOLA-O: don't switch up beyond what the throughput or the last choice
+  // can sustain, which avoids oscillation around the buffer thresholds
+  if (m_lastBitrate && throughput > 0 && options[best].bitrate > m_lastBitrate) {
+    double limit = throughput > (double)m_lastBitrate ? throughput : (double)m_lastBitrate;
+    size_t capped = options.size() - 1;
+    for (size_t i = 0; i < options.size(); i++) {
+      if ((double)options[i].bitrate <= limit) {
+        capped = i;
+        break;
+      }
+    }
+    if (capped > best) best = capped;
+  }
+  m_lastBitrate = options[best].bitrate;
+  return best;
+}
+
+VCD_OMAF_END
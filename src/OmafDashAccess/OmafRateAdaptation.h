@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafRateAdaptation.h
+//! \brief:  Tile quality rate adaptation engines
+//! \detail: Choose the quality ranking of viewport tiles in late binding mode
+//!          from measured segment throughput and buffer level. Throughput
+//!          based and buffer based (BOLA) policies are provided.
+//!
+
+#ifndef OMAFRATEADAPTATION_H
+#define OMAFRATEADAPTATION_H
+
+#include "general.h"
+#include "OmafTypes.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+VCD_OMAF_BEGIN
+
+//!
+//! \struct: RateOption
+//! \brief:  one candidate quality and the total bitrate of all selected
+//!          tiles if viewport tiles use this quality
+//!
+typedef struct RATEOPTION {
+  QualityRank quality;
+  uint64_t bitrate;  //<! bps
+} RateOption;
+
+class OmafRateAdaptation {
+ public:
+  using Ptr = std::shared_ptr<OmafRateAdaptation>;
+
+  //!
+  //! \brief  construct
+  //!
+  OmafRateAdaptation(const OmafDashAbrParams& params);
+
+  //!
+  //! \brief  de-construct
+  //!
+  virtual ~OmafRateAdaptation();
+
+  //!
+  //! \brief  Create the rate adaptation engine of the policy in params
+  //!
+  static Ptr Create(const OmafDashAbrParams& params);
+
+  //!
+  //! \brief  Add the measurement of one finished segment download
+  //!
+  //! \param  [in] bytes
+  //!         transferred bytes of the segment
+  //! \param  [in] downloadTimeUs
+  //!         transfer time of the segment in microsecond
+  //!
+  void AddSegmentThroughput(size_t bytes, long downloadTimeUs);
+
+  //!
+  //! \brief  Set the current buffered media duration in ms
+  //!
+  void SetBufferLevel(uint32_t bufferLevelMs);
+
+  //!
+  //! \brief  Set the segment duration in ms
+  //!
+  void SetSegmentDuration(uint32_t segDurMs);
+
+  //!
+  //! \brief  Get the estimated throughput in bps, which is the harmonic mean
+  //!         of the latest segment throughputs, 0 if there is no sample yet
+  //!
+  double GetEstimatedThroughput();
+
+  uint32_t GetBufferLevel();
+
+  //!
+  //! \brief  Get the number of throughput samples and buffer level changes
+  //!         so far; selection is evaluated again once it has changed
+  //!
+  uint64_t GetUpdateCount();
+
+  //!
+  //! \brief  Select the quality of viewport tiles
+  //!
+  //! \param  [in] options
+  //!         candidate qualities, sorted from the best quality to the worst
+  //!
+  //! \return QualityRank
+  //!         the selected quality, INVALID_QUALITY_RANKING if options is empty
+  //!
+  QualityRank SelectQuality(const std::vector<RateOption>& options);
+
+ protected:
+  //!
+  //! \brief  Policy specific selection, options is not empty
+  //!
+  //! \return the index in options
+  //!
+  virtual size_t SelectOption(const std::vector<RateOption>& options, double throughput, uint32_t bufferLevelMs) = 0;
+
+ protected:
+  OmafDashAbrParams m_params;
+  uint32_t m_segmentDuration;  //<! ms
+
+ private:
+  std::mutex m_mutex;
+  std::deque<double> m_throughputs;  //<! bps of latest segments
+  uint32_t m_bufferLevel;            //<! ms
+  uint64_t m_updateCount;            //<! throughput samples and buffer level changes
+  QualityRank m_lastQuality;
+};
+
+//!
+//! \class:  OmafThroughputRateAdaptation
+//! \brief:  select the best quality whose bitrate fits into the safe part of
+//!          the estimated throughput
+//!
+class OmafThroughputRateAdaptation : public OmafRateAdaptation {
+ public:
+  OmafThroughputRateAdaptation(const OmafDashAbrParams& params) : OmafRateAdaptation(params){};
+  virtual ~OmafThroughputRateAdaptation(){};
+
+ protected:
+  size_t SelectOption(const std::vector<RateOption>& options, double throughput, uint32_t bufferLevelMs) override;
+};
+
+//!
+//! \class:  OmafBolaRateAdaptation
+//! \brief:  BOLA: maximize (V * (utility + gp) - buffer) / bitrate so that
+//!          quality rises with the buffer level; fall back to the throughput
+//!          rule before any buffer is built up
+//!
+class OmafBolaRateAdaptation : public OmafRateAdaptation {
+ public:
+  OmafBolaRateAdaptation(const OmafDashAbrParams& params) : OmafRateAdaptation(params), m_lastBitrate(0){};
+  virtual ~OmafBolaRateAdaptation(){};
+
+ protected:
+  size_t SelectOption(const std::vector<RateOption>& options, double throughput, uint32_t bufferLevelMs) override;
+
+ private:
+  uint64_t m_lastBitrate;  //<! bps of the last selected option
+};
+
+VCD_OMAF_END;
+
+#endif /* OMAFRATEADAPTATION_H */
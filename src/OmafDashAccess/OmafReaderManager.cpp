@@ -156,6 +156,7 @@ class OmafSegmentNode : public VCD::NonCopyable {
   // int getPacket(std::unique_ptr<MediaPacket> &pPacket, bool needParams) noexcept;
   int getPacket(MediaPacket *&pPacket, bool requireParams) noexcept;
   int packetQueueSize(void) const noexcept { return media_packets_.size(); }
+  uint64_t packetBytes(void) const noexcept { return packet_bytes_; }
   std::string to_string() const noexcept {
     std::stringstream ss;
 
@@ -182,6 +183,13 @@ class OmafSegmentNode : public VCD::NonCopyable {
     return 0;
   }
 
+  bool isSpeculative() const noexcept {
+    if (segment_.get() != nullptr) {
+      return segment_->IsSpeculative();
+    }
+    return false;
+  }
+
   uint32_t getInitSegId() const noexcept {
     if (segment_.get() != nullptr) {
       return segment_->GetInitSegID();
@@ -208,6 +216,7 @@ class OmafSegmentNode : public VCD::NonCopyable {
       }
       if (packet)
       {
+          packet_bytes_ -= packet->GetRealSize();
           delete packet;
           packet = NULL;
       }
@@ -318,6 +327,9 @@ class OmafSegmentNode : public VCD::NonCopyable {
   const bool bExtractor_ = false;
 
   size_t samples_num_ = 0;
+
+  // bytes of the packets in media_packets_
+  uint64_t packet_bytes_ = 0;
 };
 
 uint32_t buildDashTrackId(uint32_t id) noexcept { return id & static_cast<uint32_t>(0xffff); }
@@ -375,6 +387,10 @@ OMAF_STATUS OmafReaderManager::Close() noexcept {
       segment_reader_worker_.join();
     }
 
+    // the callers waiting for packets get the end of the media at once
+    NotifyPacketReady();
+    NotifyBufferSpace();
+
     return ERROR_NONE;
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Failed to close the client reader, ex: %s\n", ex.what());
@@ -403,6 +419,7 @@ OMAF_STATUS OmafReaderManager::OpenInitSegment(std::shared_ptr<OmafSegment> pIni
     pInitSeg->RegisterStateChange([this](std::shared_ptr<OmafSegment> pInitSeg, OmafSegment::State state) {
       this->initSegmentStateChange(std::move(pInitSeg), state);
     });
+    pInitSeg->SetMetrics(metrics_);
     OMAF_STATUS ret = pInitSeg->Open(dash_client_);
     if (ret != ERROR_NONE) {
       OMAF_LOG(LOG_ERROR, "Failed to open the init segment, code= %d\n", ret);
@@ -443,6 +460,7 @@ OMAF_STATUS OmafReaderManager::OpenSegment(std::shared_ptr<OmafSegment> pSeg, bo
     pSeg->RegisterStateChange([this](std::shared_ptr<OmafSegment> segment, OmafSegment::State state) {
       this->normalSegmentStateChange(std::move(segment), state);
     });
+    pSeg->SetMetrics(metrics_);
 
     OmafSegmentNode::Ptr new_node = std::make_shared<OmafSegmentNode>(shared_from_this(), work_params_.mode_, work_params_.proj_fmt_, reader_,
                                                                       std::move(pSeg), depends_size, isExtracotr);
@@ -580,6 +598,9 @@ OMAF_STATUS OmafReaderManager::GetNextPacket(uint32_t trackID, MediaPacket *&pPa
         it = segment_parsed_list_.erase(it);  // 'it' will move to next when calling erase
       }
     }
+    if (bpacket_readed || timeline_point_ != -1) {
+      NotifyBufferSpace();
+    }
     return ret;
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Failed to read frame for trackid=%u, ex: %s\n", trackID, ex.what());
@@ -651,6 +672,9 @@ OMAF_STATUS OmafReaderManager::GetNextPacketWithPTS(uint32_t trackID, uint64_t p
         it = segment_parsed_list_.erase(it);  // 'it' will move to next when calling erase
       }
     }
+    if (bpacket_readed || timeline_point_ != -1) {
+      NotifyBufferSpace();
+    }
     return ret;
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Failed to read frame for trackid=%u, ex: %s\n", trackID, ex.what());
@@ -750,6 +774,99 @@ OMAF_STATUS OmafReaderManager::GetPacketQueueSize(uint32_t trackID, size_t &size
     return ERROR_INVALID;
   }
 }
+size_t OmafReaderManager::GetDownloadingSegmentNum() noexcept {
+  size_t num = 0;
+  {
+    std::lock_guard<std::mutex> lock(segment_opening_mutex_);
+    num += segment_opening_list_.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(segment_opened_mutex_);
+    num += segment_opened_list_.size();
+  }
+  return num;
+}
+
+uint64_t OmafReaderManager::GetBufferedPacketBytes() noexcept {
+  std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
+  uint64_t bytes = 0;
+  for (auto &nodeset : segment_parsed_list_) {
+    for (auto &node : nodeset.segment_nodes_) {
+      bytes += node->packetBytes();
+    }
+  }
+  return bytes;
+}
+
+int64_t OmafReaderManager::GetBufferLevelMs() noexcept {
+  std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
+  double level_ms = 0;
+  for (auto &nodeset : segment_parsed_list_) {
+    // the segment set lasts as long as its least consumed track, the tracks
+    // only prefetched are not consumed, so they don't count
+    double remain = 0;
+    for (auto &node : nodeset.segment_nodes_) {
+      if (node->GetSamplesNum() == 0 || node->isSpeculative()) continue;
+      double ratio = static_cast<double>(node->packetQueueSize()) / static_cast<double>(node->GetSamplesNum());
+      remain = std::max(remain, std::min(ratio, 1.0));
+    }
+    level_ms += remain * static_cast<double>(work_params_.segment_duration_ms_);
+  }
+  return static_cast<int64_t>(level_ms);
+}
+
+bool OmafReaderManager::IsBufferFull() noexcept {
+  if (work_params_.max_parsed_segments_ && GetBufferedSegmentNum() >= work_params_.max_parsed_segments_) {
+    return true;
+  }
+  if (work_params_.max_packet_bytes_ && GetBufferedPacketBytes() >= work_params_.max_packet_bytes_) {
+    return true;
+  }
+  if (work_params_.max_downloading_segments_ &&
+      GetDownloadingSegmentNum() >= work_params_.max_downloading_segments_) {
+    return true;
+  }
+  return false;
+}
+
+void OmafReaderManager::NotifyPacketReady() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(packet_ready_mutex_);
+    packet_ready_epoch_++;
+  }
+  packet_ready_cv_.notify_all();
+}
+
+void OmafReaderManager::NotifyBufferSpace() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(buffer_space_mutex_);
+    buffer_space_epoch_++;
+  }
+  buffer_space_cv_.notify_all();
+}
+
+uint64_t OmafReaderManager::GetBufferSpaceEpoch() noexcept {
+  std::lock_guard<std::mutex> lock(buffer_space_mutex_);
+  return buffer_space_epoch_;
+}
+
+bool OmafReaderManager::WaitBufferSpace(uint64_t epoch, int32_t timeoutMs) noexcept {
+  std::unique_lock<std::mutex> lock(buffer_space_mutex_);
+  return buffer_space_cv_.wait_for(lock, std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0),
+                                   [this, epoch] { return buffer_space_epoch_ != epoch; });
+}
+
+uint64_t OmafReaderManager::GetPacketReadyEpoch() noexcept {
+  std::lock_guard<std::mutex> lock(packet_ready_mutex_);
+  return packet_ready_epoch_;
+}
+
+bool OmafReaderManager::WaitPacketReady(uint64_t epoch, int32_t timeoutMs) noexcept {
+  std::unique_lock<std::mutex> lock(packet_ready_mutex_);
+  return packet_ready_cv_.wait_for(lock, std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0),
+                                   [this, epoch] { return packet_ready_epoch_ != epoch; });
+}
+
 uint64_t OmafReaderManager::GetOldestPacketPTSForTrack(int trackId) {
   try {
     uint64_t oldestPTS = 0;
@@ -791,6 +908,8 @@ void OmafReaderManager::RemoveOutdatedPacketForTrack(int trackId, uint64_t currP
         }
       }
     }
+    lock.unlock();
+    NotifyBufferSpace();
   } catch (const std::exception &ex) {
     OMAF_LOG(LOG_ERROR, "Failed to read packet size for trackid=%d, ex: %s\n", trackId, ex.what());
   }
@@ -1125,7 +1244,12 @@ void OmafReaderManager::threadRunner() noexcept {
       tracepoint(mthq_tp_provider, T4_parse_start_time, timeline_point);
 #endif
 #endif
+      uint64_t parseStartUs = OmafMetrics::NowUs();
       OMAF_STATUS ret = ready_dash_node->parse();
+      if (metrics_) {
+        metrics_->Record(MetricHistogram::PARSE_LATENCY, OmafMetrics::NowUs() - parseStartUs);
+        metrics_->Add(ret == ERROR_NONE ? MetricCounter::SEGMENTS_PARSED : MetricCounter::PARSE_FAILURES);
+      }
 
       if (ready_dash_node->getMediaType() == MediaType_Video)
       {
@@ -1164,9 +1288,13 @@ void OmafReaderManager::threadRunner() noexcept {
           segment_parsed_list_.emplace_back(nodeset);
         }
         segment_parsed_cv_.notify_all();
+        lock.unlock();
+        NotifyPacketReady();
       } else {
         OMAF_LOG(LOG_ERROR, "Failed to parse %s\n", ready_dash_node->to_string().c_str());
       }
+      // the segment left the downloading list
+      NotifyBufferSpace();
 
       // 4. clear dash set whose timeline point older than current ready segment/dash_node
       // we use simple logic to main the dash node sets
@@ -1602,6 +1730,7 @@ int OmafSegmentNode::getPacket(MediaPacket *&pPacket, bool requireParams) noexce
 
     pPacket = media_packets_.front();
     media_packets_.pop();
+    packet_bytes_ -= pPacket->GetRealSize();
     if (pPacket->GetMediaType() == MediaType_Video)
     {
       if (requireParams) {
@@ -1787,6 +1916,7 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
         packet->SetSegID(track_info->sampleProperties[sample].segmentId);
 
         media_packets_.push(packet);
+        packet_bytes_ += packet->GetRealSize();
         OMAF_LOG(LOG_INFO, "Push packet with PTS %ld for track %d\n", packet->GetPTS(), segment_->GetTrackId());
       }
     }
@@ -1843,6 +1973,7 @@ int OmafSegmentNode::cachePackets(std::shared_ptr<OmafReader> reader) noexcept {
         packet->SetSegID(track_info->sampleProperties[sample].segmentId);
 
         media_packets_.push(packet);
+        packet_bytes_ += packet->GetRealSize();
         OMAF_LOG(LOG_INFO, "Push packet with PTS %ld for audio track %d\n", packet->GetPTS(), segment_->GetTrackId());
         OMAF_LOG(LOG_INFO, "Add packet size %d\n", packet_size);
       }
@@ -41,6 +41,7 @@
 
 #include "OmafMediaSource.h"
 #include "OmafReader.h"
+#include "OmafMetrics.h"
 
 #include <atomic>
 #include <chrono>
@@ -78,6 +79,11 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
     size_t duration_ = 0;
     int32_t segment_timeout_ms_ = 3000;  // ms
     ProjectionFormat proj_fmt_  = ProjectionFormat::PF_ERP;
+    size_t segment_duration_ms_ = 0;
+    // budgets of the segments ahead of the consumption, 0 for unlimited
+    size_t max_parsed_segments_ = 0;
+    uint64_t max_packet_bytes_ = 0;
+    size_t max_downloading_segments_ = 0;
   };
 
   using OmafReaderParams = struct _params;
@@ -99,6 +105,11 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   //!
   OMAF_STATUS Close() noexcept;
 
+  //!  \brief set the metrics of the owning source, shared with the opened segments
+  //!
+  void SetMetrics(OmafMetrics::Ptr metrics) noexcept { metrics_ = std::move(metrics); }
+  OmafMetrics::Ptr GetMetrics() const noexcept { return metrics_; }
+
   //!  \brief add init Segment for reading after it is downloaded
   //!
   OMAF_STATUS OpenInitSegment(std::shared_ptr<OmafSegment> pInitSeg) noexcept;
@@ -124,6 +135,59 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   //!
   inline bool IsInitSegmentsParsed() { return bInitSeg_all_ready_.load(); };
 
+  // number of parsed segment sets whose packets are not consumed yet
+  size_t GetBufferedSegmentNum() noexcept {
+    std::lock_guard<std::mutex> lock(segment_parsed_mutex_);
+    return segment_parsed_list_.size();
+  }
+
+  // number of segment sets downloading or waiting for parse
+  size_t GetDownloadingSegmentNum() noexcept;
+
+  // bytes of the parsed packets not consumed yet
+  uint64_t GetBufferedPacketBytes() noexcept;
+
+  //!  \brief Get the media duration in ms of the packets not consumed yet
+  //!
+  int64_t GetBufferLevelMs() noexcept;
+
+  //!  \brief Check whether any stage is over its budget, the downloads
+  //!         should pause until the packets are consumed
+  //!
+  bool IsBufferFull() noexcept;
+
+  //!  \brief Wake up the callers of WaitPacketReady, called when new packets
+  //!         can be gotten: a segment is parsed or a frame is stitched
+  //!
+  void NotifyPacketReady() noexcept;
+
+  //!  \brief Get the count of NotifyPacketReady calls, read it before checking
+  //!         for packets so that no notification is missed by the wait
+  //!
+  uint64_t GetPacketReadyEpoch() noexcept;
+
+  //!  \brief Wait until NotifyPacketReady is called after the epoch or the timeout
+  //!
+  //!  \return true if notified, false if timed out
+  //!
+  bool WaitPacketReady(uint64_t epoch, int32_t timeoutMs) noexcept;
+
+  //!  \brief Wake up the callers of WaitBufferSpace, called when the buffered
+  //!         data shrinks: packets are consumed or segment sets are released
+  //!
+  void NotifyBufferSpace() noexcept;
+
+  //!  \brief Get the count of NotifyBufferSpace calls, read it before checking
+  //!         IsBufferFull so that no notification is missed by the wait
+  //!
+  uint64_t GetBufferSpaceEpoch() noexcept;
+
+  //!  \brief Wait until NotifyBufferSpace is called after the epoch or the timeout
+  //!
+  //!  \return true if notified, false if timed out
+  //!
+  bool WaitBufferSpace(uint64_t epoch, int32_t timeoutMs) noexcept;
+
   uint64_t GetOldestPacketPTSForTrack(int trackId);
   void RemoveOutdatedPacketForTrack(int trackId, uint64_t currPTS);
   size_t GetSamplesNumPerSegmentForTimeLine(uint64_t currTimeLine)
@@ -183,6 +247,7 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   std::shared_ptr<OmafDashSegmentClient> dash_client_;
 
   OmafReaderParams work_params_;
+  OmafMetrics::Ptr metrics_;
   int64_t timeline_point_ = -1;
   // omaf reader
   std::thread segment_reader_worker_;
@@ -202,6 +267,14 @@ class OmafReaderManager : public VCD::NonCopyable, public enable_shared_from_thi
   std::condition_variable segment_parsed_cv_;
   std::list<OmafSegmentNodeTimedSet> segment_parsed_list_;
 
+  std::mutex packet_ready_mutex_;
+  std::condition_variable packet_ready_cv_;
+  uint64_t packet_ready_epoch_ = 0;
+
+  std::mutex buffer_space_mutex_;
+  std::condition_variable buffer_space_cv_;
+  uint64_t buffer_space_epoch_ = 0;
+
   OmafMediaSource *media_source_ = nullptr;
   std::map<uint32_t, std::shared_ptr<OmafPacketParams>> omaf_packet_params_;
 
@@ -33,7 +33,6 @@
  * Created on May 24, 2019, 11:07 AM
  */
 
-#include "DownloadManager.h"
 #include "OmafSegment.h"
 
 #include <fstream>
@@ -70,23 +69,52 @@ int OmafSegment::Open(std::shared_ptr<OmafDashSegmentClient> dash_client) noexce
     dash_client_ = std::move(dash_client);
 
     state_ = State::CREATE;
+    open_time_us_ = OmafMetrics::NowUs();
+    if (metrics_ && !bInit_segment_) {
+      metrics_->OnSegmentRequested(seg_id_);
+    }
+
+    // revisited segments are served from memory
+    std::shared_ptr<SegmentBuffer> cached = DOWNLOADMANAGER::GetInstance()->LookupSegment(ds_params_.dash_url_);
+    if (cached.get() != nullptr) {
+      OMAF_LOG(LOG_INFO, "Segment cache hit for %s\n", ds_params_.dash_url_.c_str());
+      AttachBuffer(std::move(cached));
+      bcache_hit_ = true;
+      state_ = State::OPEN_SUCCES;
+      if (state_change_cb_) {
+        state_change_cb_(shared_from_this(), state_);
+      }
+      return ERROR_NONE;
+    }
 
+    seg_buffer_ = std::make_shared<SegmentBuffer>();
     // mSegElement->StartDownloadSegment((OmafDownloaderObserver *)this);
     dash_client_->open(
-        ds_params_, [this](std::unique_ptr<VCD::OMAF::StreamBlock> sb) { this->dash_stream_.push_back(std::move(sb)); },
+        ds_params_,
+        [this](std::unique_ptr<VCD::OMAF::StreamBlock> sb) {
+          // the block stays in the shared buffer, the stream reads it by reference
+          std::unique_ptr<StreamBlock> ref = make_unique_vcd<StreamBlock>(sb->buf(), sb->size());
+          this->seg_buffer_->size += sb->size();
+          this->seg_buffer_->blocks.push_back(std::move(sb));
+          this->dash_stream_.push_back(std::move(ref));
+        },
         [this](OmafDashSegmentClient::State s) {
           switch (s) {
             case OmafDashSegmentClient::State::SUCCESS:
               this->state_ = State::OPEN_SUCCES;
+              DOWNLOADMANAGER::GetInstance()->InsertSegment(this->ds_params_.dash_url_, this->seg_buffer_);
+              this->RecordDownloadMetrics();
               break;
             case OmafDashSegmentClient::State::STOPPED:
               this->state_ = State::OPEN_STOPPED;
               break;
             case OmafDashSegmentClient::State::TIMEOUT:
               this->state_ = State::OPEN_TIMEOUT;
+              if (this->metrics_) this->metrics_->Add(MetricCounter::DOWNLOAD_FAILURES);
               break;
             case OmafDashSegmentClient::State::FAILURE:
               this->state_ = State::OPEN_FAILED;
+              if (this->metrics_) this->metrics_->Add(MetricCounter::DOWNLOAD_FAILURES);
               break;
             default:
               break;
@@ -102,11 +130,27 @@ int OmafSegment::Open(std::shared_ptr<OmafDashSegmentClient> dash_client) noexce
   }
 }
 
+void OmafSegment::RecordDownloadMetrics() {
+  OmafMetrics* metrics = metrics_.get();
+  if (metrics == nullptr) return;
+  uint64_t elapsedUs = OmafMetrics::NowUs() - open_time_us_;
+  metrics->Add(MetricCounter::SEGMENTS_DOWNLOADED);
+  metrics->Add(MetricCounter::DOWNLOADED_BYTES, seg_buffer_->size);
+  metrics->Record(MetricHistogram::DOWNLOAD_LATENCY, elapsedUs);
+  if (elapsedUs > 0) {
+    metrics->Set(MetricGauge::LAST_SEGMENT_BANDWIDTH, static_cast<int64_t>(seg_buffer_->size * 8 * 1000000 / elapsedUs));
+  }
+}
+
 int OmafSegment::Stop() noexcept {
   try {
     if (dash_client_.get() == nullptr) {
       return ERROR_NULL_PTR;
     }
+    // nothing is downloading for the cached segment
+    if (bcache_hit_) {
+      return ERROR_NONE;
+    }
     dash_client_->remove(ds_params_);
     return ERROR_NONE;
   } catch (const std::exception& ex) {
@@ -152,25 +196,11 @@ int OmafSegment::Close() {
   return ERROR_NONE;
 }
 #endif
-int OmafSegment::CacheToFile() noexcept {
-  try {
-    std::string fileName =
-        ds_params_.dash_url_.substr(ds_params_.dash_url_.find_last_of('/') + 1,
-                                    ds_params_.dash_url_.length() - ds_params_.dash_url_.find_last_of('/') - 1);
-    cache_file_ = DOWNLOADMANAGER::GetInstance()->GetCacheFolder() + "/" +
-                  DOWNLOADMANAGER::GetInstance()->AssignCacheFileName() + fileName;
-    if (!dash_stream_.cacheToFile(cache_file_)) {
-      OMAF_LOG(LOG_ERROR, "Failed to cache the dash to file: %s\n", cache_file_.c_str());
-      return OMAF_ERROR_FILE_WRITE;
-    }
-
-    OMAF_LOG(LOG_INFO, "Success to cache dash to file: %s. url=%s\n", cache_file_.c_str(), ds_params_.dash_url_.c_str());
-    OMAF_LOG(LOG_INFO, "And file size=%ld\n", dash_stream_.GetStreamSize());
-    return ERROR_NONE;
-  } catch (const std::exception& ex) {
-    OMAF_LOG(LOG_ERROR, "Exception when cache dash to file: %s\n", cache_file_.c_str());
-    return ERROR_INVALID;
+void OmafSegment::AttachBuffer(std::shared_ptr<SegmentBuffer> buffer) noexcept {
+  for (auto &block : buffer->blocks) {
+    dash_stream_.push_back(make_unique_vcd<StreamBlock>(block->buf(), block->size()));
   }
+  seg_buffer_ = std::move(buffer);
 }
 
 std::string OmafSegment::to_string() const noexcept {
@@ -39,6 +39,8 @@
 #include "OmafDashParser/Common.h"
 #include "OmafDashDownload/Stream.h"
 #include "OmafDashDownload/OmafDownloader.h"
+#include "DownloadManager.h"
+#include "OmafMetrics.h"
 #include "../isolib/dash_parser/Mp4StreamIO.h"
 #include "general.h"
 #include "iso_structure.h"
@@ -197,6 +199,13 @@ class OmafSegment : public VCD::NonCopyable, public VCD::MP4::StreamIO, public e
   // @brief
   inline void SetInitSegment(bool bInit) noexcept { bInit_segment_ = bInit; };
 
+  //
+  // @brief set the segment downloaded for prefetch only, whose packets are
+  //        not consumed unless the track is selected afterwards
+  //
+  inline void SetSpeculative(bool bSpeculative) noexcept { bspeculative_ = bSpeculative; };
+  inline bool IsSpeculative() const noexcept { return bspeculative_; }
+
   //
   // @brief open this segment, which will trigger the dash download
   //
@@ -249,17 +258,32 @@ class OmafSegment : public VCD::NonCopyable, public VCD::MP4::StreamIO, public e
 
   uint32_t GetAudioSampleRate() { return mSampleRate; };
 
+  void SetMetrics(OmafMetrics::Ptr metrics) noexcept { metrics_ = std::move(metrics); };
+
  private:
   //!
-  //!  \brief save the memory data to file.
+  //!  \brief read the segment from the cached buffer without copy
+  //!
+  void AttachBuffer(std::shared_ptr<SegmentBuffer> buffer) noexcept;
+
+  //!
+  //!  \brief add the finished download to the download metrics
   //!
-  int CacheToFile() noexcept;
+  void RecordDownloadMetrics();
 
  private:
   std::shared_ptr<OmafDashSegmentClient> dash_client_;
   DashSegmentSourceParams ds_params_;
 
   StreamBlocks dash_stream_;
+  //<! downloaded blocks owned with the segment cache, dash_stream_ only refers to them
+  std::shared_ptr<SegmentBuffer> seg_buffer_;
+  //<! the segment is served by the segment cache without download
+  bool bcache_hit_ = false;
+  //<! time of the download request, for the download latency metric
+  uint64_t open_time_us_ = 0;
+  //<! metrics of the owning source, null for no recording
+  OmafMetrics::Ptr metrics_;
 
   // SegmentElement* mSegElement;  //<! SegmentElement
   //<! flag to indicate whether the segment should be stored
@@ -285,6 +309,8 @@ class OmafSegment : public VCD::NonCopyable, public VCD::MP4::StreamIO, public e
   //<! flag to indicate whether this segment is initialize
   // MP4
   bool bInit_segment_ = false;
+  //<! flag to indicate whether this segment is downloaded for prefetch
+  bool bspeculative_ = false;
   QualityRank mQualityRanking;  //<! quality ranking of the segment
   SRDInfo mSRDInfo;             //<! top/left/width/height info for the tile track segment
 
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafTileIndex.cpp
+//! \brief:  Implementation of the tile adaptation set spatial index
+//!
+
+#include "OmafTileIndex.h"
+
+VCD_OMAF_BEGIN
+
+#define TILE_INDEX_MIN_CAPACITY 64
+// quality ranking has 8 bits in the key, as quality_ranking in OMAF
+#define TILE_INDEX_MAX_QUALITY 0xFF
+
+OmafTileIndex::OmafTileIndex() {
+  m_size = 0;
+}
+
+OmafTileIndex::~OmafTileIndex() {
+  Clear();
+}
+
+void OmafTileIndex::Clear() {
+  m_slots.clear();
+  m_size = 0;
+  m_qualityTiles.clear();
+  m_lowQualityTiles.clear();
+}
+
+uint64_t OmafTileIndex::MakeKey(int32_t faceId, int32_t x, int32_t y, uint32_t quality) {
+  // 8 bits face | 8 bits quality | 24 bits x | 24 bits y
+  return ((uint64_t)(faceId & 0xFF) << 56) | ((uint64_t)(quality & 0xFF) << 48) |
+         ((uint64_t)(x & 0xFFFFFF) << 24) | (uint64_t)(y & 0xFFFFFF);
+}
+
+uint32_t OmafTileIndex::HashKey(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+void OmafTileIndex::Rehash(uint32_t capacity) {
+  std::vector<IndexEntry> oldSlots;
+  oldSlots.swap(m_slots);
+  m_slots.assign(capacity, IndexEntry{0, NULL});
+
+  uint32_t mask = capacity - 1;
+  for (auto& entry : oldSlots) {
+    if (!entry.as) continue;
+    uint32_t pos = HashKey(entry.key) & mask;
+    while (m_slots[pos].as) pos = (pos + 1) & mask;
+    m_slots[pos] = entry;
+  }
+}
+
+int OmafTileIndex::Insert(int32_t faceId, int32_t x, int32_t y, uint32_t quality, OmafAdaptationSet* as) {
+  if (!as) return OMAF_ERROR_NULL_PTR;
+  if (quality > TILE_INDEX_MAX_QUALITY) {
+    OMAF_LOG(LOG_ERROR, "Quality ranking %u of track %d is out of range!\n", quality, as->GetID());
+    return OMAF_ERROR_INVALID_DATA;
+  }
+
+  // keep load factor under 0.5 so that probing stays short
+  if (m_slots.empty() || (m_size + 1) * 2 > m_slots.size()) {
+    Rehash(m_slots.empty() ? TILE_INDEX_MIN_CAPACITY : (uint32_t)m_slots.size() * 2);
+  }
+
+  uint64_t key = MakeKey(faceId, x, y, quality);
+  uint32_t mask = (uint32_t)m_slots.size() - 1;
+  uint32_t pos = HashKey(key) & mask;
+  while (m_slots[pos].as) {
+    if (m_slots[pos].key == key) return ERROR_NONE;
+    pos = (pos + 1) & mask;
+  }
+  m_slots[pos].key = key;
+  m_slots[pos].as = as;
+  m_size++;
+
+  if (quality >= m_qualityTiles.size()) m_qualityTiles.resize(quality + 1);
+  m_qualityTiles[quality].push_back(as);
+  if (quality > HIGHEST_QUALITY_RANKING) m_lowQualityTiles.push_back(as);
+
+  return ERROR_NONE;
+}
+
+int OmafTileIndex::Build(const std::map<int, OmafAdaptationSet*>& asMap, ProjectionFormat pf) {
+  Clear();
+
+  for (auto& it : asMap) {
+    OmafAdaptationSet* as = it.second;
+    if (!as) continue;
+
+    uint32_t quality = as->GetRepresentationQualityRanking();
+    int ret = ERROR_NONE;
+    if (pf == ProjectionFormat::PF_CUBEMAP) {
+      TileDef* tileInfo = as->GetTileInfo();
+      if (!tileInfo) {
+        OMAF_LOG(LOG_ERROR, "NULL tile information for Cubemap track %d !\n", as->GetID());
+        continue;
+      }
+      ret = Insert(tileInfo->faceId, tileInfo->x, tileInfo->y, quality, as);
+    } else {
+      OmafSrd* srd = as->GetSRD();
+      if (!srd) continue;
+      ret = Insert(0, srd->get_X(), srd->get_Y(), quality, as);
+    }
+    if (ret) return ret;
+  }
+
+  OMAF_LOG(LOG_INFO, "Tile index built with %u tiles\n", m_size);
+  return ERROR_NONE;
+}
+
+OmafAdaptationSet* OmafTileIndex::Find(int32_t faceId, int32_t x, int32_t y, uint32_t quality) const {
+  if (!m_size || quality > TILE_INDEX_MAX_QUALITY) return NULL;
+
+  uint64_t key = MakeKey(faceId, x, y, quality);
+  uint32_t mask = (uint32_t)m_slots.size() - 1;
+  uint32_t pos = HashKey(key) & mask;
+  while (m_slots[pos].as) {
+    if (m_slots[pos].key == key) return m_slots[pos].as;
+    pos = (pos + 1) & mask;
+  }
+  return NULL;
+}
+
+const std::vector<OmafAdaptationSet*>& OmafTileIndex::GetTilesOfQuality(uint32_t quality) const {
+  if (quality >= m_qualityTiles.size()) return m_emptyTiles;
+  return m_qualityTiles[quality];
+}
+
+VCD_OMAF_END
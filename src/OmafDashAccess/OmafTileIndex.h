@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   OmafTileIndex.h
+//! \brief:  Spatial index of tile adaptation sets
+//! \detail: Flat open-addressing table keyed by (face, tile x, tile y,
+//!          quality ranking) to locate the adaptation set of a tile in O(1).
+//!          It is built once after the MPD is parsed and is read-only
+//!          during tile selection.
+//!
+
+#ifndef OMAFTILEINDEX_H
+#define OMAFTILEINDEX_H
+
+#include "OmafAdaptationSet.h"
+
+#include <vector>
+
+VCD_OMAF_BEGIN
+
+class OmafTileIndex {
+ public:
+  //!
+  //! \brief  construct
+  //!
+  OmafTileIndex();
+
+  //!
+  //! \brief  de-construct
+  //!
+  virtual ~OmafTileIndex();
+
+  //!
+  //! \brief  Rebuild the index from all tile adaptation sets of the stream.
+  //!         For cube-map, the face-local tile position in TileDef is used,
+  //!         otherwise the SRD position with face 0.
+  //!
+  //! \param  [in] asMap
+  //!         tile adaptation sets of the stream
+  //! \param  [in] pf
+  //!         projection format of the stream
+  //!
+  //! \return int
+  //!         ERROR_NONE if success, else failed reason
+  //!
+  int Build(const std::map<int, OmafAdaptationSet*>& asMap, ProjectionFormat pf);
+
+  //!
+  //! \brief  Add one tile adaptation set into the index; the first one
+  //!         inserted for a key wins. Quality ranking above 255 is rejected
+  //!
+  int Insert(int32_t faceId, int32_t x, int32_t y, uint32_t quality, OmafAdaptationSet* as);
+
+  //!
+  //! \brief  Find the adaptation set of the tile
+  //!
+  //! \return OmafAdaptationSet*
+  //!         the adaptation set, or NULL if no tile matches
+  //!
+  OmafAdaptationSet* Find(int32_t faceId, int32_t x, int32_t y, uint32_t quality) const;
+
+  //!
+  //! \brief  Get all tile adaptation sets of the quality ranking, in
+  //!         insertion order
+  //!
+  const std::vector<OmafAdaptationSet*>& GetTilesOfQuality(uint32_t quality) const;
+
+  //!
+  //! \brief  Get all tile adaptation sets whose quality ranking is lower
+  //!         than the highest one
+  //!
+  const std::vector<OmafAdaptationSet*>& GetLowQualityTiles() const { return m_lowQualityTiles; };
+
+  //!
+  //! \brief  Remove all tiles from the index
+  //!
+  void Clear();
+
+  uint32_t GetSize() const { return m_size; };
+
+ private:
+  struct IndexEntry {
+    uint64_t key;
+    OmafAdaptationSet* as;
+  };
+
+  static uint64_t MakeKey(int32_t faceId, int32_t x, int32_t y, uint32_t quality);
+
+  static uint32_t HashKey(uint64_t key);
+
+  void Rehash(uint32_t capacity);
+
+ private:
+  //<! open-addressing slots, capacity is always a power of 2
+  std::vector<IndexEntry> m_slots;
+  //<! number of valid entries in m_slots
+  uint32_t m_size;
+  //<! tiles grouped by quality ranking, index is the quality ranking
+  std::vector<std::vector<OmafAdaptationSet*>> m_qualityTiles;
+  //<! tiles with quality ranking lower than HIGHEST_QUALITY_RANKING
+  std::vector<OmafAdaptationSet*> m_lowQualityTiles;
+  //<! returned for unknown quality ranking
+  std::vector<OmafAdaptationSet*> m_emptyTiles;
+};
+
+VCD_OMAF_END;
+
+#endif /* OMAFTILEINDEX_H */
@@ -91,6 +91,31 @@ bool IsSelectionChanged(TracksMap selection1, TracksMap selection2)
     return isChanged;
 }
 
+TracksMap OmafTileTracksSelector::GetPrefetchTracks(const std::map<int, std::pair<uint32_t, OmafAdaptationSet*>>& predictedConfidence)
+{
+    TracksMap prefetchTracks;
+    if (!mPrefetchTileNum || predictedConfidence.empty())
+        return prefetchTracks;
+
+    // predicted tracks which are not selected, the most confident ones first
+    std::vector<std::pair<uint32_t, int>> candidates;
+    for (auto it = predictedConfidence.begin(); it != predictedConfidence.end(); it++)
+    {
+        if (m_currentTracks.find(it->first) == m_currentTracks.end())
+            candidates.push_back(std::make_pair(it->second.first, it->first));
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), \
+        [](const std::pair<uint32_t, int>& c1, const std::pair<uint32_t, int>& c2) { return c1.first > c2.first; });
+
+    for (uint32_t i = 0; i < candidates.size() && i < mPrefetchTileNum; i++)
+    {
+        int trackID = candidates[i].second;
+        prefetchTracks.insert(std::make_pair(trackID, predictedConfidence.at(trackID).second));
+    }
+
+    return prefetchTracks;
+}
+
 int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream)
 {
     DashStreamInfo *streamInfo = pStream->GetStreamInfo();
@@ -98,6 +123,8 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream)
     if (streamInfo->stream_type == MediaType_Video)
     {
         TracksMap selectedTracks;
+        // confidence of predicted tracks, used to choose tracks for prefetch
+        std::map<int, std::pair<uint32_t, OmafAdaptationSet*>> predictedConfidence;
         uint32_t rowSize = pStream->GetRowSize();
         uint32_t colSize = pStream->GetColSize();
         if (mUsePrediction && mPoseHistory.size() >= POSE_SIZE) // using prediction
@@ -115,8 +142,15 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream)
                 for (uint32_t i = 0; i < predictedTracksArray.size(); i++)
                 {
                     TracksMap oneTracks = predictedTracksArray[i].second;
+                    uint32_t weight = (predictedTracksArray[i].first == HIGH) ? 2 : 1;
                     TracksMap::iterator iter = oneTracks.begin();
                     for ( ; iter != oneTracks.end(); iter++)
+                    {
+                        auto &confidence = predictedConfidence[iter->first];
+                        confidence.first += weight;
+                        confidence.second = iter->second;
+                    }
+                    for (iter = oneTracks.begin(); iter != oneTracks.end(); iter++)
                     {
                         // ignore when key is identical and have tracks selection limitation.
                         if (selectedTracks.size() <= rowSize * colSize / 2 || selectedTracks.size() < oneTracks.size())
@@ -157,7 +191,8 @@ int OmafTileTracksSelector::SelectTracks(OmafMediaStream* pStream)
         }
         selectedTracks.clear();
 
-        ret = pStream->UpdateEnabledTileTracks(m_currentTracks);
+        TracksMap prefetchTracks = GetPrefetchTracks(predictedConfidence);
+        ret = pStream->UpdateEnabledTileTracks(m_currentTracks, prefetchTracks);
     }
     else if (streamInfo->stream_type == MediaType_Audio)
     {
@@ -185,15 +220,20 @@ TracksMap OmafTileTracksSelector::GetTileTracksByPose(OmafMediaStream* pStream)
     HeadPose* previousPose = NULL;
     {
         std::lock_guard<std::mutex> lock(mMutex);
+        previousPose = mPose;
         if(mPoseHistory.size() == 0)
         {
-            return selectedTracks;
+            // no new pose, but the tile quality follows every segment throughput and buffer level
+            if (!mPose || !IsRateAdaptationUpdated())
+            {
+                return selectedTracks;
+            }
+        }
+        else
+        {
+            mPose = mPoseHistory.front();
+            mPoseHistory.pop_front();
         }
-
-        previousPose = mPose;
-
-        mPose = mPoseHistory.front();
-        mPoseHistory.pop_front();
 
         if(!mPose)
         {
@@ -204,7 +244,8 @@ TracksMap OmafTileTracksSelector::GetTileTracksByPose(OmafMediaStream* pStream)
     }
 
     // won't get viewport if pose hasn't changed
-    if( previousPose && mPose && !IsPoseChanged( previousPose, mPose ) && historySize > 1 && !mUsePrediction)
+    if( previousPose && mPose && !IsPoseChanged( previousPose, mPose ) && historySize > 1 && !mUsePrediction &&
+        !IsRateAdaptationUpdated())
     {
         OMAF_LOG(LOG_INFO,"pose hasn't changed!\n");
 #ifndef _ANDROID_NDK_OPTION_
@@ -225,7 +266,7 @@ TracksMap OmafTileTracksSelector::GetTileTracksByPose(OmafMediaStream* pStream)
 #endif
 #endif
 
-    selectedTracks = SelectTileTracks(pStream, mPose);
+    selectedTracks = SelectTileTracks(pStream, mPose, true);
     if (selectedTracks.size() && previousPose)
     {
         OMAF_LOG(LOG_INFO,"pose has changed from yaw %f, pitch %f\n", previousPose->yaw, previousPose->pitch);
@@ -246,25 +287,70 @@ TracksMap OmafTileTracksSelector::GetTileTracksByPose(OmafMediaStream* pStream)
 
 TracksMap OmafTileTracksSelector::SelectTileTracks(
     OmafMediaStream* pStream,
-    HeadPose* pose)
+    HeadPose* pose,
+    bool incremental)
 {
     TracksMap selectedTracks;
 
-    // to select tile tracks
-    int ret = I360SCVP_setViewPortEx(m360ViewPortHandle, pose);
-    if (ret)
-        return selectedTracks;
-
-    ret = I360SCVP_process(mParamViewport, m360ViewPortHandle);
-    if (ret)
-        return selectedTracks;
-    TileDef *tilesInViewport = new TileDef[1024];
-    if (!tilesInViewport)
-        return selectedTracks;
+    if (m_tilesInViewport.size() < MAX_TILES_IN_VIEWPORT)
+        m_tilesInViewport.resize(MAX_TILES_IN_VIEWPORT);
+    TileDef *tilesInViewport = m_tilesInViewport.data();
 
     Param_ViewportOutput paramViewportOutput;
-    int32_t selectedTilesNum = I360SCVP_getTilesInViewport(
-            tilesInViewport, &paramViewportOutput, m360ViewPortHandle);
+    int32_t selectedTilesNum = 0;
+    if (incremental)
+    {
+        if (m_selectedTiles.size() < MAX_TILES_IN_VIEWPORT)
+            m_selectedTiles.resize(MAX_TILES_IN_VIEWPORT);
+
+        Param_TilesDelta tilesDelta;
+        memset_s(&tilesDelta, sizeof(Param_TilesDelta), 0);
+        tilesDelta.pPrevPose = m_selectedTilesNum ? &m_selectedPose : NULL;
+        tilesDelta.pPrevTiles = m_selectedTiles.data();
+        tilesDelta.prevTilesNum = m_selectedTilesNum;
+        tilesDelta.hysteresis = mViewportHysteresis;
+        tilesDelta.pTiles = tilesInViewport;
+        selectedTilesNum = I360SCVP_getTilesInViewportDelta(
+                pose, &tilesDelta, &paramViewportOutput, m360ViewPortHandle);
+        if (selectedTilesNum > 0 && !tilesDelta.bReselected)
+        {
+            if (!IsRateAdaptationUpdated())
+            {
+                OMAF_LOG(LOG_INFO, "pose moved inside the viewport hysteresis, keep the selected tiles!\n");
+                return selectedTracks;
+            }
+            // keep the selected tiles, only their quality is chosen again
+            OMAF_LOG(LOG_INFO, "rate adaptation updated, select the quality of the kept tiles again!\n");
+            tilesInViewport = m_selectedTiles.data();
+            selectedTilesNum = m_selectedTilesNum;
+        }
+        else if (selectedTilesNum > 0 && selectedTilesNum <= MAX_TILES_IN_VIEWPORT)
+        {
+            // the delta selection has set the viewport, the rest of the per pose process is the same as below
+            int ret = I360SCVP_process(mParamViewport, m360ViewPortHandle);
+            if (ret)
+                return selectedTracks;
+
+            OMAF_LOG(LOG_INFO, "tiles reselected, %d added and %d removed\n", tilesDelta.addedTilesNum, tilesDelta.removedTilesNum);
+            m_selectedPose = *pose;
+            m_selectedTilesNum = selectedTilesNum;
+            memcpy_s(m_selectedTiles.data(), selectedTilesNum * sizeof(TileDef), tilesInViewport, selectedTilesNum * sizeof(TileDef));
+        }
+    }
+    else
+    {
+        // to select tile tracks
+        int ret = I360SCVP_setViewPortEx(m360ViewPortHandle, pose);
+        if (ret)
+            return selectedTracks;
+
+        ret = I360SCVP_process(mParamViewport, m360ViewPortHandle);
+        if (ret)
+            return selectedTracks;
+
+        selectedTilesNum = I360SCVP_getTilesInViewport(
+                tilesInViewport, &paramViewportOutput, m360ViewPortHandle);
+    }
 
     // in planar projection format
     if (abs(pose->zoomFactor) < 1e-3 && mProjFmt == ProjectionFormat::PF_PLANAR)
@@ -272,15 +358,13 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         return selectedTracks;
     }
 
-    if (selectedTilesNum <= 0 || selectedTilesNum > 1024)
+    if (selectedTilesNum <= 0 || selectedTilesNum > MAX_TILES_IN_VIEWPORT)
     {
         OMAF_LOG(LOG_ERROR, "Failed to get tiles information in viewport !\n");
-        DELETE_ARRAY(tilesInViewport);
         return selectedTracks;
     }
 
-    std::map<int, OmafAdaptationSet*> asMap = pStream->GetMediaAdaptationSet();
-    std::map<int, OmafAdaptationSet*>::iterator itAS;
+    const OmafTileIndex *tileIndex = pStream->GetTileIndex();
 
     // insert all tile tracks in viewport into selected tile tracks map
     uint32_t sqrtedSize = (uint32_t)sqrt(selectedTilesNum);
@@ -291,61 +375,27 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         OMAF_LOG(LOG_INFO,"need additional tile is true! original selected tile num of high quality is %d\n", selectedTilesNum);
         needAddtionalTile = true;
     }
-    if (mProjFmt == ProjectionFormat::PF_ERP)
+    uint32_t additionalQualityRanking = HIGHEST_QUALITY_RANKING;
+    QualityRank viewportQuality = HIGHEST_QUALITY_RANKING;
+    if (mRateAdaptation && mProjFmt != ProjectionFormat::PF_PLANAR)
     {
-        for (int32_t index = 0; index < selectedTilesNum; index++)
-        {
-            int32_t left = tilesInViewport[index].x;
-            int32_t top  = tilesInViewport[index].y;
-
-            for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
-            {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                OmafSrd *srd = adaptationSet->GetSRD();
-                int32_t tileLeft = srd->get_X();
-                int32_t tileTop  = srd->get_Y();
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if ((qualityRanking == HIGHEST_QUALITY_RANKING) && (tileLeft == left) && (tileTop == top))
-                {
-                    int trackID = adaptationSet->GetID();
-                    selectedTracks.insert(make_pair(trackID, adaptationSet));
-                    break;
-                }
-            }
-        }
+        viewportQuality = SelectViewportQuality(tileIndex, tilesInViewport, selectedTilesNum);
+        if (viewportQuality != HIGHEST_QUALITY_RANKING)
+            needAddtionalTile = false;
     }
-    else if (mProjFmt == ProjectionFormat::PF_CUBEMAP)
+    // with a lower viewport quality, the viewport is covered by the low quality tiles added below
+    if ((mProjFmt == ProjectionFormat::PF_ERP || mProjFmt == ProjectionFormat::PF_CUBEMAP) &&
+        viewportQuality == HIGHEST_QUALITY_RANKING)
     {
         for (int32_t index = 0; index < selectedTilesNum; index++)
         {
-            int32_t left = tilesInViewport[index].x;
-            int32_t top  = tilesInViewport[index].y;
-            int32_t faceId = tilesInViewport[index].faceId;
-            for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
+            // ERP tiles are all indexed on face 0
+            int32_t faceId = (mProjFmt == ProjectionFormat::PF_CUBEMAP) ? tilesInViewport[index].faceId : 0;
+            OmafAdaptationSet *adaptationSet = tileIndex->Find(
+                faceId, tilesInViewport[index].x, tilesInViewport[index].y, HIGHEST_QUALITY_RANKING);
+            if (adaptationSet)
             {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if (qualityRanking == HIGHEST_QUALITY_RANKING)
-                {
-                    TileDef *tileInfo = adaptationSet->GetTileInfo();
-                    if (!tileInfo)
-                    {
-                        OMAF_LOG(LOG_ERROR, "NULL tile information for Cubemap !\n");
-                        DELETE_ARRAY(tilesInViewport);
-                        return selectedTracks;
-                    }
-                    int32_t tileLeft = tileInfo->x;
-                    int32_t tileTop  = tileInfo->y;
-                    int32_t tileFaceId = tileInfo->faceId;
-                    if ((tileLeft == left) && (tileTop == top) && (tileFaceId == faceId))
-                    {
-                        int trackID = adaptationSet->GetID();
-                        selectedTracks.insert(make_pair(trackID, adaptationSet));
-                        break;
-                    }
-                }
+                selectedTracks.insert(make_pair(adaptationSet->GetID(), adaptationSet));
             }
         }
     }
@@ -354,63 +404,37 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
         uint32_t corresQualityRanking = 0;
         for (int32_t index = 0; index < selectedTilesNum; index++)
         {
-            int32_t left = tilesInViewport[index].x;
-            int32_t top  = tilesInViewport[index].y;
             int32_t strId = tilesInViewport[index].streamId;
             map<int32_t, int32_t>::iterator itStrQua;
             itStrQua = mTwoDStreamQualityMap.find(strId);
             if (itStrQua == mTwoDStreamQualityMap.end())
             {
                 OMAF_LOG(LOG_ERROR, "Can't find corresponding quality ranking for stream index %d !\n", strId);
-                DELETE_ARRAY(tilesInViewport);
                 return selectedTracks;
             }
 
             corresQualityRanking = itStrQua->second;
             OMAF_LOG(LOG_INFO, "Selected tile from stream %d with quality ranking %d\n", strId, corresQualityRanking);
 
-            for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
-            {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                OmafSrd *srd = adaptationSet->GetSRD();
-                int32_t tileLeft = srd->get_X();
-                int32_t tileTop  = srd->get_Y();
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-
-                if ((qualityRanking == (uint32_t)(corresQualityRanking)) && (tileLeft == left) && (tileTop == top))
-                {
-                    int trackID = adaptationSet->GetID();
-                    OMAF_LOG(LOG_INFO, "Selected track %d\n", trackID);
-                    selectedTracks.insert(make_pair(trackID, adaptationSet));
-                    break;
-                }
-            }
-        }
-
-        if (needAddtionalTile)
-        {
-            for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
+            OmafAdaptationSet *adaptationSet = tileIndex->Find(
+                0, tilesInViewport[index].x, tilesInViewport[index].y, corresQualityRanking);
+            if (adaptationSet)
             {
-                OmafAdaptationSet *adaptationSet = itAS->second;
-                uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
                 int trackID = adaptationSet->GetID();
-                if (selectedTracks.find(trackID) == selectedTracks.end() && qualityRanking == corresQualityRanking)
-                {
-                    selectedTracks.insert(make_pair(trackID, adaptationSet));
-                    break;
-                }
+                OMAF_LOG(LOG_INFO, "Selected track %d\n", trackID);
+                selectedTracks.insert(make_pair(trackID, adaptationSet));
             }
         }
+        additionalQualityRanking = corresQualityRanking;
     }
 
-    if (needAddtionalTile && (mProjFmt != ProjectionFormat::PF_PLANAR))
+    if (needAddtionalTile)
     {
-        for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
+        const std::vector<OmafAdaptationSet*>& candidates = tileIndex->GetTilesOfQuality(additionalQualityRanking);
+        for (auto adaptationSet : candidates)
         {
-            OmafAdaptationSet *adaptationSet = itAS->second;
-            uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
             int trackID = adaptationSet->GetID();
-            if (selectedTracks.find(trackID) == selectedTracks.end() && qualityRanking == HIGHEST_QUALITY_RANKING)
+            if (selectedTracks.find(trackID) == selectedTracks.end())
             {
                 selectedTracks.insert(make_pair(trackID, adaptationSet));
                 break;
@@ -420,21 +444,76 @@ TracksMap OmafTileTracksSelector::SelectTileTracks(
     // insert all tile tracks from low qulity video into selected tile tracks map when projection type is not PF_PLANAR
     if (mProjFmt != ProjectionFormat::PF_PLANAR)
     {
-        for (itAS = asMap.begin(); itAS != asMap.end(); itAS++)
+        for (auto adaptationSet : tileIndex->GetLowQualityTiles())
         {
-            OmafAdaptationSet *adaptationSet = itAS->second;
-            uint32_t qualityRanking = adaptationSet->GetRepresentationQualityRanking();
-            if (qualityRanking > HIGHEST_QUALITY_RANKING)
+            selectedTracks.insert(make_pair(adaptationSet->GetID(), adaptationSet));
+        }
+    }
+
+    return selectedTracks;
+}
+
+bool OmafTileTracksSelector::IsRateAdaptationUpdated()
+{
+    if (!mRateAdaptation || mProjFmt == ProjectionFormat::PF_PLANAR)
+        return false;
+
+    return mRateAdaptation->GetUpdateCount() != m_abrUpdateCount;
+}
+
+QualityRank OmafTileTracksSelector::SelectViewportQuality(
+    const OmafTileIndex *tileIndex,
+    TileDef *tilesInViewport,
+    int32_t tilesNum)
+{
+    // updates coming in during the selection trigger the next one
+    m_abrUpdateCount = mRateAdaptation->GetUpdateCount();
+
+    // low quality tiles are always selected
+    uint64_t lowQualityBitrate = 0;
+    for (auto adaptationSet : tileIndex->GetLowQualityTiles())
+    {
+        lowQualityBitrate += adaptationSet->GetVideoInfo().bit_rate;
+    }
+
+    std::vector<RateOption> options;
+    for (uint32_t quality = HIGHEST_QUALITY_RANKING; quality < INVALID_QUALITY_RANKING; quality++)
+    {
+        if (tileIndex->GetTilesOfQuality(quality).empty())
+            continue;
+
+        uint64_t bitrate = 0;
+        bool covered = true;
+        for (int32_t index = 0; index < tilesNum; index++)
+        {
+            int32_t faceId = (mProjFmt == ProjectionFormat::PF_CUBEMAP) ? tilesInViewport[index].faceId : 0;
+            OmafAdaptationSet *adaptationSet = tileIndex->Find(
+                faceId, tilesInViewport[index].x, tilesInViewport[index].y, quality);
+            if (!adaptationSet)
             {
-                int trackID = adaptationSet->GetID();
-                selectedTracks.insert(make_pair(trackID, adaptationSet));
+                covered = false;
+                break;
             }
+            if (quality == HIGHEST_QUALITY_RANKING)
+                bitrate += adaptationSet->GetVideoInfo().bit_rate;
         }
+        if (!covered)
+            continue;
+
+        RateOption option;
+        option.quality = (QualityRank)quality;
+        option.bitrate = bitrate + lowQualityBitrate;
+        options.push_back(option);
+        // all lower qualities cost the same since low quality tiles are always selected
+        if (quality != HIGHEST_QUALITY_RANKING)
+            break;
     }
 
-    DELETE_ARRAY(tilesInViewport);
+    // the highest quality is always kept when the viewport can't be covered by other qualities
+    if (options.size() < 2)
+        return HIGHEST_QUALITY_RANKING;
 
-    return selectedTracks;
+    return mRateAdaptation->SelectQuality(options);
 }
 
 std::vector<std::pair<ViewportPriority, TracksMap>> OmafTileTracksSelector::GetTileTracksByPosePrediction(
@@ -44,6 +44,8 @@ using namespace VCD::OMAF;
 
 VCD_OMAF_BEGIN
 
+#define MAX_TILES_IN_VIEWPORT 1024
+
 typedef std::map<int, OmafAdaptationSet*> TracksMap;
 
 class OmafTileTracksSelector : public OmafTracksSelector
@@ -54,6 +56,9 @@ public:
     //!
     OmafTileTracksSelector(int size = POSE_SIZE) : OmafTracksSelector(size)
     {
+        m_selectedTilesNum = 0;
+        m_abrUpdateCount = 0;
+        memset_s(&m_selectedPose, sizeof(HeadPose), 0);
     };
 
     //!
@@ -103,10 +108,42 @@ private:
 
     //TracksMap GetCoveredTileTracks(OmafMediaStream* pStream, CCDef* outCC);
 
-    TracksMap SelectTileTracks(OmafMediaStream* pStream, HeadPose* pose);
+    //!
+    //! \brief  Select the tile tracks for the pose. With incremental, the
+    //!         tiles are selected again only when the pose moves out of the
+    //!         viewport hysteresis from the last incremental selection, else
+    //!         no tracks are returned and the current tracks are kept
+    //!
+    TracksMap SelectTileTracks(OmafMediaStream* pStream, HeadPose* pose, bool incremental = false);
+
+    //!
+    //! \brief  Choose the quality of the tiles in viewport through the rate
+    //!         adaptation engine. Viewport tiles either use the highest
+    //!         quality or are covered by the lower quality tiles at the same
+    //!         positions, which are always selected
+    //!
+    QualityRank SelectViewportQuality(const OmafTileIndex* tileIndex, TileDef* tilesInViewport, int32_t tilesNum);
+
+    //!
+    //! \brief  Check whether the rate adaptation got new throughput or buffer
+    //!         level since the last quality selection, then the tiles are
+    //!         selected again even if the pose is not changed
+    //!
+    bool IsRateAdaptationUpdated();
+
+    //!
+    //! \brief  Choose the predicted but unselected tile tracks to prefetch,
+    //!         ordered by how many predicted viewports cover them
+    //!
+    TracksMap GetPrefetchTracks(const std::map<int, std::pair<uint32_t, OmafAdaptationSet*>>& predictedConfidence);
 
 private:
     TracksMap                 m_currentTracks;
+    std::vector<TileDef>      m_tilesInViewport;  //<! scratch buffer reused by SelectTileTracks
+    HeadPose                  m_selectedPose;     //<! pose of the last incremental selection
+    std::vector<TileDef>      m_selectedTiles;    //<! tiles of the last incremental selection
+    int32_t                   m_selectedTilesNum;
+    uint64_t                  m_abrUpdateCount;   //<! rate adaptation update count of the last quality selection
 };
 
 VCD_OMAF_END;
@@ -48,6 +48,8 @@ OmafTracksSelector::OmafTracksSelector(int size) {
   mProjFmt = ProjectionFormat::PF_ERP;
   mSegmentDur = 0;
   mQualityRanksNum = 0;
+  mPrefetchTileNum = 0;
+  mViewportHysteresis = 0;
   memset_s(&(mI360ScvpPlugin), sizeof(PluginDef), 0);
 }
 
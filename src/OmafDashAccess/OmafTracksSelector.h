@@ -37,6 +37,7 @@
 
 #include "360SCVPViewportAPI.h"
 #include "OmafMediaStream.h"
+#include "OmafRateAdaptation.h"
 #include "OmafViewportPredict/ViewportPredictPlugin.h"
 #include "general.h"
 #include <mutex>
@@ -112,6 +113,24 @@ class OmafTracksSelector {
   //!
   void SetSegmentDuration(uint32_t segDur) { mSegmentDur = segDur; };
 
+  //!
+  //! \brief  Set rate adaptation engine used to choose the quality of
+  //!         viewport tiles, no adaptation if it is not set
+  //!
+  void SetRateAdaptation(OmafRateAdaptation::Ptr rateAdaptation) { mRateAdaptation = std::move(rateAdaptation); };
+
+  //!
+  //! \brief  Set the max number of predicted tile tracks prefetched besides
+  //!         the selected ones, 0 means no prefetch
+  //!
+  void SetPrefetchTileNum(uint32_t tileNum) { mPrefetchTileNum = tileNum; };
+
+  //!
+  //! \brief  Set the angle in degree which the viewing direction can move
+  //!         before the tiles are selected again, 0 to select for any move
+  //!
+  void SetViewportHysteresis(float hysteresis) { mViewportHysteresis = hysteresis; };
+
   //!
   //! \brief  Set 360SCVP library plugin
   //!
@@ -149,6 +168,9 @@ private:
   map<int32_t, int32_t>         mTwoDStreamQualityMap;
   uint32_t                      mSegmentDur;
   PluginDef                     mI360ScvpPlugin;
+  OmafRateAdaptation::Ptr       mRateAdaptation;
+  uint32_t                      mPrefetchTileNum;
+  float                         mViewportHysteresis;
 };
 
 VCD_OMAF_END;
@@ -40,6 +40,7 @@
 extern "C" {
 #include "safestringlib/safe_mem_lib.h"
 }
+#include "../utils/common_data.h"
 
 namespace VCD {
 namespace OMAF {
@@ -74,6 +75,15 @@ class OmafDashHttpParams {
   int32_t retry_times_ = -1;
   bool bssl_verify_peer_ = false;
   bool bssl_verify_host_ = false;
+  // drive the curl multi handle by socket events with epoll instead of polling
+  bool event_loop_ = false;
+  // negotiate http/2 and multiplex tile requests to one origin over a single connection
+  bool http2_ = false;
+  long max_concurrent_streams_ = 100;
+  // fetch the selected tiles of one video from its packed segment by coalesced
+  // byte range requests, ranges closer than the gap bytes are merged into one
+  bool packed_tile_fetch_ = false;
+  int64_t packed_range_gap_ = 4096;
   std::string to_string() {
     std::stringstream ss;
     ss << "http params: {" << std::endl;
@@ -82,6 +92,11 @@ class OmafDashHttpParams {
     ss << "\tretry times: " << retry_times_ << "" << std::endl;
     ss << "\tssl verify peer state: " << bssl_verify_peer_ << "" << std::endl;
     ss << "\tssl verify host state: " << bssl_verify_host_ << "" << std::endl;
+    ss << "\tevent loop state: " << event_loop_ << "" << std::endl;
+    ss << "\thttp2 state: " << http2_ << "" << std::endl;
+    ss << "\tmax concurrent streams: " << max_concurrent_streams_ << "" << std::endl;
+    ss << "\tpacked tile fetch state: " << packed_tile_fetch_ << "" << std::endl;
+    ss << "\tpacked range gap: " << packed_range_gap_ << "" << std::endl;
     ss << "}";
     return ss.str();
   }
@@ -119,18 +134,121 @@ struct _omafDashPredictorParams {
   std::string name_;
   std::string libpath_;
   bool enable_ = false;
+  // max number of predicted but unselected tile tracks to prefetch, 0 to disable
+  uint32_t prefetch_tile_num_ = 0;
   std::string to_string() {
     std::stringstream ss;
     ss << "dash statistics params: {" << std::endl;
     ss << "\tstate: " << enable_ << std::endl;
     ss << "\tname: " << name_ << std::endl;
     ss << "\tlib path: " << libpath_ << std::endl;
+    ss << "\tprefetch tile num: " << prefetch_tile_num_ << std::endl;
     ss << "}" << std::endl;
     return ss.str();
   }
 };
 using OmafDashPredictorParams = struct _omafDashPredictorParams;
 
+enum class AbrPolicy {
+  THROUGHPUT = 0,
+  BOLA = 1,
+};
+
+class OmafDashAbrParams {
+ public:
+  bool enable_ = false;
+  AbrPolicy policy_ = AbrPolicy::THROUGHPUT;
+  // number of latest segment downloads used for throughput estimation
+  int32_t throughput_samples_ = 5;
+  // fraction of the estimated throughput the selected tiles may use
+  float safety_factor_ = 0.9f;
+  // buffer level which BOLA policy tries to keep, in ms
+  int32_t buffer_target_ms_ = 6000;
+  std::string to_string() {
+    std::stringstream ss;
+    ss << "dash abr params: {" << std::endl;
+    ss << "	state: " << enable_ << std::endl;
+    ss << "	policy: " << (policy_ == AbrPolicy::BOLA ? "bola" : "throughput") << std::endl;
+    ss << "	throughput samples: " << throughput_samples_ << std::endl;
+    ss << "	safety factor: " << safety_factor_ << std::endl;
+    ss << "	buffer target: " << buffer_target_ms_ << " ms" << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+  }
+};
+
+class OmafDashCacheParams {
+ public:
+  // bytes of downloaded segments kept in memory for revisits
+  int64_t memory_budget_ = 64 * 1024 * 1024;
+  // write the segments evicted from memory to the cache folder
+  bool spill_to_disk_ = false;
+  std::string to_string() {
+    std::stringstream ss;
+    ss << "dash segment cache params: {" << std::endl;
+    ss << "\tmemory budget: " << memory_budget_ << " bytes" << std::endl;
+    ss << "\tspill to disk: " << spill_to_disk_ << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+  }
+};
+
+class OmafDashBufferParams {
+ public:
+  // budgets of how far the download runs ahead of the consumption, the
+  // downloads pause while any of them is reached. 0 for unlimited
+  // segment sets parsed into packets and not consumed yet
+  int32_t max_parsed_segments_ = 0;
+  // bytes of the parsed packets not consumed yet
+  int64_t max_packet_bytes_ = 0;
+  // segment sets downloading or waiting for parse
+  int32_t max_downloading_segments_ = 0;
+  std::string to_string() {
+    std::stringstream ss;
+    ss << "dash buffer params: {" << std::endl;
+    ss << "\tmax parsed segments: " << max_parsed_segments_ << std::endl;
+    ss << "\tmax packet bytes: " << max_packet_bytes_ << std::endl;
+    ss << "\tmax downloading segments: " << max_downloading_segments_ << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+  }
+};
+
+class OmafDashMetricsParams {
+ public:
+  // append the JSON snapshot of the pipeline metrics to dump_path_
+  bool enable_dump_ = false;
+  int32_t dump_interval_ms_ = 1000;
+  std::string dump_path_;
+  std::string to_string() {
+    std::stringstream ss;
+    ss << "dash metrics params: {" << std::endl;
+    ss << "\tenable dump: " << enable_dump_ << std::endl;
+    ss << "\tdump interval: " << dump_interval_ms_ << " ms" << std::endl;
+    ss << "\tdump path: " << dump_path_ << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+  }
+};
+
+class OmafDashLogParams {
+ public:
+  // the calls below this level are skipped
+  LogLevel min_level_ = LOG_INFO;
+  // format the default glog output on a background thread
+  bool async_ = false;
+  uint32_t async_queue_size_ = 4096;
+  std::string to_string() {
+    std::stringstream ss;
+    ss << "dash log params: {" << std::endl;
+    ss << "\tmin level: " << min_level_ << std::endl;
+    ss << "\tasync: " << async_ << std::endl;
+    ss << "\tasync queue size: " << async_queue_size_ << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+  }
+};
+
 class OmafDashParams {
  public:
  public:
@@ -140,8 +258,15 @@ class OmafDashParams {
   OmafDashStatisticsParams stats_params_;
   OmafDashSynchronizerParams syncer_params_;
   OmafDashPredictorParams prediector_params_;
+  OmafDashAbrParams abr_params_;
+  OmafDashCacheParams cache_params_;
+  OmafDashBufferParams buffer_params_;
+  OmafDashMetricsParams metrics_params_;
+  OmafDashLogParams log_params_;
   long max_parallel_transfers_ = DEFAULT_MAX_PARALLEL_TRANSFERS;
   int32_t segment_open_timeout_ms_ = DEFAULT_SEGMENT_OPEN_TIMEOUT;
+  // degrees the viewing direction moves before the tiles are selected again
+  float viewport_hysteresis_ = 0;
   // for stitch
   uint32_t max_decode_width_;
   uint32_t max_decode_height_;
@@ -151,9 +276,15 @@ class OmafDashParams {
     ss << http_proxy_.to_string();
     ss << http_params_.to_string();
     ss << "\tmax parallel transfers: " << max_parallel_transfers_ << ", " << std::endl;
+    ss << "\tviewport hysteresis: " << viewport_hysteresis_ << " degree" << std::endl;
     ss << stats_params_.to_string();
     ss << syncer_params_.to_string();
     ss << prediector_params_.to_string();
+    ss << abr_params_.to_string();
+    ss << cache_params_.to_string();
+    ss << buffer_params_.to_string();
+    ss << metrics_params_.to_string();
+    ss << log_params_.to_string();
     return ss.str();
   }
 };
@@ -183,11 +314,35 @@ class DashSegmentSourceParams {
   int64_t timeline_point_ = -1;
   std::string dash_url_;  // unique in the system
   TaskPriority priority_ = TaskPriority::LOW;
+  // time budget in ms for the segments of the timeline point since the first one
+  // is opened, the download scheduler serves earlier deadlines first. 0 for due
+  // at once, -1 for none
+  int64_t deadline_ms_ = -1;
+  // byte range of the url to fetch, size 0 for the whole resource
+  int64_t range_offset_ = 0;
+  int64_t range_size_ = 0;
+  // packed segment with all tile segments of the video, which is indexed by the
+  // track id. when packed fetch is enabled, the tile segment is fetched as a byte
+  // range of it instead of the dash url
+  std::string packed_url_;
+  uint32_t packed_entry_num_ = 0;
+  uint32_t packed_track_id_ = 0;
+  // unique key of the request, ranges of one url are different requests
+  std::string key() const noexcept {
+    if (range_size_ <= 0) return dash_url_;
+    std::stringstream ss;
+    ss << dash_url_ << "#" << range_offset_ << "-" << (range_offset_ + range_size_ - 1);
+    return ss.str();
+  }
   std::string to_string() const noexcept {
     std::stringstream ss;
-    ss << "url=" << dash_url_;
+    ss << "url=" << key();
     ss << ", priority=" << priority(priority_);
     ss << ", timeline_point=" << timeline_point_;
+    ss << ", deadline_ms=" << deadline_ms_;
+    if (!packed_url_.empty()) {
+      ss << ", packed_url=" << packed_url_ << ", packed_track_id=" << packed_track_id_;
+    }
     return ss.str();
   }
 };
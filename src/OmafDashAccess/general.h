@@ -99,6 +99,14 @@ typedef struct AUDIOINFO {
   uint32_t sample_rate;    /// for audio
 } AudioInfo;
 
+typedef struct PREFETCHMETRICS {
+  uint32_t prefetchedTiles;   /// tile segments downloaded speculatively
+  uint32_t hitTiles;          /// prefetched tile segments selected afterwards
+  uint32_t cancelledTiles;    /// prefetched tile segments cancelled in flight
+  uint64_t prefetchedBytes;   /// bytes downloaded speculatively
+  uint64_t wastedBytes;       /// prefetched bytes of tiles never selected
+} PrefetchMetrics;
+
 //!
 //! \brief function to parse string to data type
 //!
@@ -8,15 +8,33 @@ g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testOmafReade
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testOmafReaderManager.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testDownloader.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testDownloaderPerf.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testTileIndex.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testPacketMeta.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testRateAdaptation.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testMetrics.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testAsyncLog.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testPrefetch.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c testWaitPackets.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c rateAdaptationSimulator.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I../../isolib -I../../google_test -std=c++11 -I../util/ -g -c downloaderLatencyBench.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 
 LD_FLAGS="-I/usr/local/include/ -lcurl -lstdc++ -lOmafDashAccess -lsafestring_shared -llttng-ust -ldl -lpthread -lglog -l360SCVP -lm -L/usr/local/lib"
-g++ -L/usr/local/lib testDownloaderPerf.o testDownloader.o testMediaSource.o testMPDParser.o testOmafReader.o testOmafReaderManager.o libgtest.a -o testLib ${LD_FLAGS}
+g++ -L/usr/local/lib testDownloaderPerf.o testDownloader.o testMediaSource.o testMPDParser.o testOmafReader.o testOmafReaderManager.o testTileIndex.o testPacketMeta.o testRateAdaptation.o testMetrics.o testAsyncLog.o testPrefetch.o testWaitPackets.o libgtest.a -o testLib ${LD_FLAGS}
 g++ -L/usr/local/lib testMediaSource.o libgtest.a -o testMediaSource ${LD_FLAGS}
 g++ -L/usr/local/lib testMPDParser.o libgtest.a -o testMPDParser ${LD_FLAGS}
 g++ -L/usr/local/lib testOmafReader.o libgtest.a -o testOmafReader ${LD_FLAGS}
 g++ -L/usr/local/lib testOmafReaderManager.o libgtest.a -o testOmafReaderManager ${LD_FLAGS}
 g++ -L/usr/local/lib testDownloader.o libgtest.a -o testDownloader ${LD_FLAGS}
 g++ -L/usr/local/lib testDownloaderPerf.o libgtest.a -o testDownloaderPerf ${LD_FLAGS}
+g++ -L/usr/local/lib testTileIndex.o libgtest.a -o testTileIndex ${LD_FLAGS}
+g++ -L/usr/local/lib testPacketMeta.o libgtest.a -o testPacketMeta ${LD_FLAGS}
+g++ -L/usr/local/lib testRateAdaptation.o libgtest.a -o testRateAdaptation ${LD_FLAGS}
+g++ -L/usr/local/lib testMetrics.o libgtest.a -o testMetrics ${LD_FLAGS}
+g++ -L/usr/local/lib testAsyncLog.o libgtest.a -o testAsyncLog ${LD_FLAGS}
+g++ -L/usr/local/lib testPrefetch.o libgtest.a -o testPrefetch ${LD_FLAGS}
+g++ -L/usr/local/lib testWaitPackets.o libgtest.a -o testWaitPackets ${LD_FLAGS}
+g++ -L/usr/local/lib rateAdaptationSimulator.o -o rateAdaptationSimulator ${LD_FLAGS}
+g++ -L/usr/local/lib downloaderLatencyBench.o -o downloaderLatencyBench ${LD_FLAGS}
 
 ./run.sh
 if [ $? -ne 0 ]; then exit 1; fi
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   downloaderLatencyBench.cpp
+//! \brief:  Loopback benchmark of the segment downloader start latency
+//! \detail: Serves fixed size segments from an in-process HTTP stand-in on
+//!          127.0.0.1 and requests them in bursts, as tile segments are
+//!          requested every segment interval. The latency from opening a
+//!          request to its first received byte, and the cpu time used, are
+//!          reported for the polling and the event loop downloader,
+//!          together with how many transfers reused a connection.
+//!          When an origin url is given, e.g. an nghttpd or nginx with h2
+//!          serving seg_<interval>_<index>.mp4 files, segments are fetched
+//!          from it instead and an http/2 multiplexing run is added.
+//!
+//!          usage: downloaderLatencyBench [requests_per_interval]
+//!                 [interval_num] [segment_bytes] [interval_ms] [origin_url]
+//!
+
+#include "../OmafDashDownload/OmafDownloader.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace VCD::OMAF;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class LoopbackHttpServer {
+ public:
+  bool start(size_t body_size) {
+    // header and body are sent in one buffer, to avoid nagle delays on loopback
+    char header[256];
+    snprintf(header, sizeof(header),
+             "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+             "Content-Length: %zu\r\nConnection: keep-alive\r\n\r\n",
+             body_size);
+    response_ = std::string(header) + std::string(body_size, 'x');
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+    int on = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(listen_fd_, (struct sockaddr *)&addr, sizeof(addr)) != 0) return false;
+    if (listen(listen_fd_, 1024) != 0) return false;
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, (struct sockaddr *)&addr, &len);
+    port_ = ntohs(addr.sin_port);
+    running_ = true;
+    acceptor_ = std::thread(&LoopbackHttpServer::acceptLoop, this);
+    return true;
+  }
+
+  void stop() {
+    if (listen_fd_ < 0) return;
+    running_ = false;
+    shutdown(listen_fd_, SHUT_RDWR);
+    if (acceptor_.joinable()) acceptor_.join();
+    close(listen_fd_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (int fd : client_fds_) shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &worker : workers_) {
+      if (worker.joinable()) worker.join();
+    }
+  }
+
+  int port() const { return port_; }
+
+ private:
+  void acceptLoop() {
+    while (running_) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) break;
+      std::lock_guard<std::mutex> lock(mutex_);
+      client_fds_.push_back(fd);
+      workers_.emplace_back(&LoopbackHttpServer::serve, this, fd);
+    }
+  }
+
+  // answer every request on the connection with the same response, keep alive
+  void serve(int fd) {
+    std::string request;
+    char buf[4096];
+    while (true) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) break;
+      request.append(buf, n);
+      size_t end = 0;
+      while ((end = request.find("\r\n\r\n")) != std::string::npos) {
+        request.erase(0, end + 4);
+        if (!sendAll(fd, response_.data(), response_.size())) {
+          close(fd);
+          return;
+        }
+      }
+    }
+    close(fd);
+  }
+
+  static bool sendAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+      ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+      if (n <= 0) return false;
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+ private:
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::string response_;
+  std::atomic_bool running_{false};
+  std::thread acceptor_;
+  std::mutex mutex_;
+  std::vector<int> client_fds_;
+  std::vector<std::thread> workers_;
+};
+
+struct BenchResult {
+  std::vector<double> latency_us;
+  size_t failed = 0;
+  double cpu_ms = 0;
+  double wall_ms = 0;
+  size_t new_connections = 0;
+  size_t reused_connections = 0;
+  size_t http2_transfers = 0;
+};
+
+double cpuTimeMs() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+BenchResult runBench(bool event_loop, bool http2, const std::string &origin, int requests, int intervals,
+                     int interval_ms) {
+  BenchResult result;
+  OmafDashSegmentHttpClient::Ptr client = OmafDashSegmentHttpClient::create(requests);
+  OmafDashHttpParams params;
+  params.conn_timeout_ = 3000;
+  params.total_timeout_ = 10000;
+  params.retry_times_ = 1;
+  params.event_loop_ = event_loop;
+  params.http2_ = http2;
+  client->setParams(params);
+  client->setStatisticsWindows(interval_ms * intervals);
+  if (client->start() != ERROR_NONE) {
+    fprintf(stderr, "Failed to start the dash client!\n");
+    return result;
+  }
+
+  const size_t total = static_cast<size_t>(requests) * intervals;
+  std::vector<Clock::time_point> open_time(total);
+  std::vector<Clock::time_point> first_byte_time(total);
+  std::unique_ptr<std::atomic_bool[]> received(new std::atomic_bool[total]);
+  std::atomic_size_t done(0);
+  std::atomic_size_t failed(0);
+
+  double cpu_start = cpuTimeMs();
+  Clock::time_point wall_start = Clock::now();
+  for (int interval = 0; interval < intervals; interval++) {
+    Clock::time_point interval_start = Clock::now();
+    for (int i = 0; i < requests; i++) {
+      size_t index = static_cast<size_t>(interval) * requests + i;
+      received[index] = false;
+      DashSegmentSourceParams ds;
+      ds.dash_url_ = origin + "/seg_" + std::to_string(interval) + "_" + std::to_string(i) + ".mp4";
+      ds.timeline_point_ = interval + 1;
+      ds.priority_ = TaskPriority::NORMAL;
+      open_time[index] = Clock::now();
+      client->open(
+          ds,
+          [&, index](std::unique_ptr<StreamBlock> sb) {
+            if (!received[index].exchange(true)) first_byte_time[index] = Clock::now();
+          },
+          [&](OmafDashSegmentClient::State state) {
+            if (state != OmafDashSegmentClient::State::SUCCESS) failed++;
+            done++;
+          });
+    }
+    // wait the burst to be done, then idle until the next interval
+    while (done.load() < static_cast<size_t>(interval + 1) * requests) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    std::this_thread::sleep_until(interval_start + std::chrono::milliseconds(interval_ms));
+  }
+  result.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - wall_start).count();
+  result.cpu_ms = cpuTimeMs() - cpu_start;
+  std::unique_ptr<OmafDashSegmentClient::PerfStatistics> perf = client->statistics();
+  if (perf) {
+    result.new_connections = perf->new_connections_;
+    result.reused_connections = perf->reused_connections_;
+    result.http2_transfers = perf->http2_transfers_;
+  }
+  client->stop();
+
+  for (size_t i = 0; i < total; i++) {
+    if (!received[i]) continue;
+    result.latency_us.push_back(std::chrono::duration<double, std::micro>(first_byte_time[i] - open_time[i]).count());
+  }
+  result.failed = failed.load();
+  return result;
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[index];
+}
+
+void report(const char *mode, BenchResult &result) {
+  std::sort(result.latency_us.begin(), result.latency_us.end());
+  double sum = 0;
+  for (double l : result.latency_us) sum += l;
+  double mean = result.latency_us.empty() ? 0 : sum / result.latency_us.size();
+  printf("%-8s %8zu %6zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %8zu %8zu %8zu\n", mode, result.latency_us.size(),
+         result.failed, mean, percentile(result.latency_us, 0.5), percentile(result.latency_us, 0.99),
+         result.latency_us.empty() ? 0 : result.latency_us.back(), result.cpu_ms, result.wall_ms,
+         result.new_connections, result.reused_connections, result.http2_transfers);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int requests = (argc > 1) ? atoi(argv[1]) : 100;
+  int intervals = (argc > 2) ? atoi(argv[2]) : 20;
+  int segment_bytes = (argc > 3) ? atoi(argv[3]) : 32 * 1024;
+  int interval_ms = (argc > 4) ? atoi(argv[4]) : 100;
+  std::string origin = (argc > 5) ? argv[5] : "";
+  if (requests <= 0 || intervals <= 0 || segment_bytes <= 0 || interval_ms < 0) {
+    fprintf(stderr, "usage: %s [requests_per_interval] [interval_num] [segment_bytes] [interval_ms] [origin_url]\n",
+            argv[0]);
+    return 1;
+  }
+
+  LoopbackHttpServer server;
+  if (origin.empty()) {
+    if (!server.start(static_cast<size_t>(segment_bytes))) {
+      fprintf(stderr, "Failed to start the loopback http server!\n");
+      return 1;
+    }
+    origin = "http://127.0.0.1:" + std::to_string(server.port());
+  }
+
+  printf("requests per interval %d, intervals %d, segment bytes %d, interval %d ms\n", requests, intervals,
+         segment_bytes, interval_ms);
+  printf("%-8s %8s %6s %10s %10s %10s %10s %10s %10s %8s %8s %8s\n", "mode", "requests", "failed", "mean_us", "p50_us",
+         "p99_us", "max_us", "cpu_ms", "wall_ms", "new_conn", "reused", "h2");
+  BenchResult polling = runBench(false, false, origin, requests, intervals, interval_ms);
+  report("polling", polling);
+  BenchResult event = runBench(true, false, origin, requests, intervals, interval_ms);
+  report("event", event);
+  if (server.port() == 0) {
+    // the loopback stand-in only speaks http/1.1
+    BenchResult h2 = runBench(true, true, origin, requests, intervals, interval_ms);
+    report("http2", h2);
+  }
+
+  server.stop();
+  return 0;
+}
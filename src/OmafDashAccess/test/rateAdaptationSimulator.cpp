@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   rateAdaptationSimulator.cpp
+//! \brief:  Trace driven simulator for tile quality rate adaptation
+//! \detail: Replays a bandwidth log offline against the rate adaptation
+//!          policies. Each line of the trace is "<duration_ms> <kbps>", and
+//!          the trace is looped until all segments are downloaded.
+//!
+//!          usage: rateAdaptationSimulator trace.log [throughput|bola]
+//!                 [segment_ms] [segment_num] [high_kbps] [low_kbps]
+//!
+
+#include "../OmafRateAdaptation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+VCD_USE_VROMAF;
+
+// pairs of duration in ms and bandwidth in bps
+typedef std::vector<std::pair<double, double>> BandwidthTrace;
+
+static bool LoadTrace(const char *path, BandwidthTrace &trace) {
+  std::ifstream in(path);
+  if (!in.is_open()) return false;
+
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    double duration = 0, kbps = 0;
+    if (!(ss >> duration >> kbps) || duration <= 0 || kbps < 0) continue;
+    trace.push_back(std::make_pair(duration, kbps * 1000));
+  }
+  return !trace.empty();
+}
+
+// download the bytes from time "now" and return the download time in ms
+static double Download(const BandwidthTrace &trace, double now, uint64_t bytes) {
+  double period = 0;
+  for (auto &slot : trace) period += slot.first;
+
+  double bits = (double)bytes * 8;
+  double elapsed = 0;
+  double t = now - period * (uint64_t)(now / period);
+  size_t i = 0;
+  double slotStart = 0;
+  while (i < trace.size() && slotStart + trace[i].first <= t) slotStart += trace[i++].first;
+  if (i == trace.size()) {
+    i = 0;
+    slotStart = 0;
+  }
+
+  while (bits > 0) {
+    double slotLeft = trace[i].first - (t - slotStart);
+    double slotBits = trace[i].second * slotLeft / 1000;
+    if (slotBits >= bits) {
+      elapsed += bits * 1000 / trace[i].second;
+      break;
+    }
+    bits -= slotBits;
+    elapsed += slotLeft;
+    slotStart += trace[i].first;
+    t = slotStart;
+    if (++i == trace.size()) {
+      i = 0;
+      slotStart = 0;
+      t = 0;
+    }
+  }
+  return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cout << "usage: " << argv[0] << " trace.log [throughput|bola] [segment_ms] [segment_num] [high_kbps] [low_kbps]"
+              << std::endl;
+    return -1;
+  }
+
+  BandwidthTrace trace;
+  if (!LoadTrace(argv[1], trace)) {
+    std::cout << "Failed to load bandwidth trace " << argv[1] << std::endl;
+    return -1;
+  }
+  double period = 0, bandwidth = 0;
+  for (auto &slot : trace) {
+    period += slot.first;
+    bandwidth += slot.first * slot.second;
+  }
+  if (bandwidth <= 0) {
+    std::cout << "No bandwidth in trace " << argv[1] << std::endl;
+    return -1;
+  }
+
+  OmafDashAbrParams params;
+  params.enable_ = true;
+  params.policy_ = (argc > 2 && !strcmp(argv[2], "bola")) ? AbrPolicy::BOLA : AbrPolicy::THROUGHPUT;
+  uint32_t segDur = argc > 3 ? atoi(argv[3]) : 1000;
+  uint32_t segNum = argc > 4 ? atoi(argv[4]) : 300;
+  uint64_t highBitrate = (argc > 5 ? atoi(argv[5]) : 20000) * 1000ULL;
+  uint64_t lowBitrate = (argc > 6 ? atoi(argv[6]) : 4000) * 1000ULL;
+  if (!segDur || !segNum || !lowBitrate || highBitrate < lowBitrate) {
+    std::cout << "Invalid simulation parameters" << std::endl;
+    return -1;
+  }
+
+  // the low quality tiles are always downloaded, as in late binding mode
+  std::vector<RateOption> options;
+  RateOption high = {HIGHEST_QUALITY_RANKING, highBitrate + lowBitrate};
+  RateOption low = {SECOND_QUALITY_RANKING, lowBitrate};
+  options.push_back(high);
+  options.push_back(low);
+
+  OmafRateAdaptation::Ptr abr = OmafRateAdaptation::Create(params);
+  abr->SetSegmentDuration(segDur);
+  double maxBuffer = (double)params.buffer_target_ms_ + segDur;
+
+  double now = 0;
+  double buffer = 0;
+  double rebuffer = 0;
+  uint64_t bitrateSum = 0;
+  uint32_t switches = 0;
+  QualityRank lastQuality = INVALID_QUALITY_RANKING;
+
+  std::cout << "segment,time_ms,quality,bitrate_kbps,download_ms,buffer_ms,throughput_kbps" << std::endl;
+  for (uint32_t seg = 0; seg < segNum; seg++) {
+    // wait for the room of one more segment in buffer
+    if (buffer + segDur > maxBuffer) {
+      double wait = buffer + segDur - maxBuffer;
+      now += wait;
+      buffer -= wait;
+    }
+
+    abr->SetBufferLevel((uint32_t)buffer);
+    QualityRank quality = abr->SelectQuality(options);
+    uint64_t bitrate = (quality == HIGHEST_QUALITY_RANKING) ? high.bitrate : low.bitrate;
+    uint64_t bytes = bitrate * segDur / 8000;
+
+    double downloadTime = Download(trace, now, bytes);
+    abr->AddSegmentThroughput(bytes, (long)(downloadTime * 1000));
+    now += downloadTime;
+    // playback starts after the first segment
+    if (seg > 0) {
+      if (downloadTime > buffer) {
+        rebuffer += downloadTime - buffer;
+        buffer = 0;
+      } else {
+        buffer -= downloadTime;
+      }
+    }
+    buffer += segDur;
+
+    if (lastQuality != INVALID_QUALITY_RANKING && quality != lastQuality) switches++;
+    lastQuality = quality;
+    bitrateSum += bitrate;
+
+    std::cout << seg << "," << (uint64_t)now << "," << quality << "," << bitrate / 1000 << ","
+              << (uint64_t)downloadTime << "," << (uint64_t)buffer << ","
+              << (uint64_t)(abr->GetEstimatedThroughput() / 1000) << std::endl;
+  }
+
+  std::cout << "policy: " << (params.policy_ == AbrPolicy::BOLA ? "bola" : "throughput") << std::endl;
+  std::cout << "average trace bandwidth: " << (uint64_t)(bandwidth / period / 1000) << " kbps" << std::endl;
+  std::cout << "average bitrate: " << bitrateSum / segNum / 1000 << " kbps" << std::endl;
+  std::cout << "quality switches: " << switches << std::endl;
+  std::cout << "rebuffer time: " << (uint64_t)rebuffer << " ms" << std::endl;
+  return 0;
+}
@@ -7,6 +7,27 @@ curl -ukang1:AP2hWmPtk4RkLXUn2SMWfocyUq2 -O "https://ubit-artifactory-sh.intel.c
 # Run test cases
 ################################
 
+./testTileIndex
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testPacketMeta
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testRateAdaptation
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testMetrics
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testAsyncLog
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testPrefetch
+if [ $? -ne 0 ]; then exit 1; fi
+
+./testWaitPackets
+if [ $? -ne 0 ]; then exit 1; fi
+
 ./testOmafReaderManager
 if [ $? -ne 0 ]; then exit 1; fi
 
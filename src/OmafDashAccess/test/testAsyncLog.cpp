@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   testAsyncLog.cpp
+//! \brief:  Asynchronous logging backend unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafDashAccessLog.h"
+#include "../../utils/AsyncLog.h"
+#include "../../utils/error.h"
+
+#include <unistd.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::mutex g_linesMutex;
+std::vector<std::string> g_lines;
+std::thread::id g_writerId;
+
+void CaptureSink(LogLevel logLevel, const char* sourceFile, uint64_t line, const char* message) {
+  std::lock_guard<std::mutex> lock(g_linesMutex);
+  g_lines.push_back(message);
+  g_writerId = std::this_thread::get_id();
+}
+
+std::mutex g_blockMutex;
+
+void BlockingSink(LogLevel logLevel, const char* sourceFile, uint64_t line, const char* message) {
+  std::lock_guard<std::mutex> lock(g_blockMutex);
+}
+
+size_t WaitLines(size_t expected) {
+  for (int i = 0; i < 1000; i++) {
+    {
+      std::lock_guard<std::mutex> lock(g_linesMutex);
+      if (g_lines.size() >= expected) return g_lines.size();
+    }
+    usleep(1000);
+  }
+  std::lock_guard<std::mutex> lock(g_linesMutex);
+  return g_lines.size();
+}
+
+class AsyncLogTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    g_lines.clear();
+    SetAsyncLogSink(CaptureSink);
+    EXPECT_EQ(StartAsyncLog(64), ERROR_NONE);
+  }
+  virtual void TearDown() {
+    StopAsyncLog();
+    SetAsyncLogSink(nullptr);
+    logMinLevel = LOG_INFO;
+  }
+};
+
+TEST_F(AsyncLogTest, formatArgs) {
+  char name[32] = "tile_1.mp4";
+  AsyncLogFunction(LOG_INFO, "test.cpp", 1, "Open %s with id %d and size %lld\n", name, -3, (long long)1 << 40);
+  // the string is copied when the record is captured
+  name[0] = 'X';
+  AsyncLogFunction(LOG_INFO, "test.cpp", 2, "%5.2f%% %-4u| %*d %.*s %c %lx\n", 3.14159, 7u, 6, 42, 3, "abcdef", 'z',
+                   0xbeefUL);
+  AsyncLogFunction(LOG_WARNING, "test.cpp", 3, "no args\n");
+
+  ASSERT_EQ(WaitLines(3), 3);
+  EXPECT_EQ(g_lines[0], "Open tile_1.mp4 with id -3 and size 1099511627776");
+  EXPECT_EQ(g_lines[1], " 3.14% 7   |     42 abc z beef");
+  EXPECT_EQ(g_lines[2], "no args");
+}
+
+TEST_F(AsyncLogTest, dropWhenFull) {
+  SetAsyncLogSink(BlockingSink);
+  uint64_t dropped = GetAsyncLogDroppedNum();
+  {
+    std::lock_guard<std::mutex> lock(g_blockMutex);
+    for (int i = 0; i < 200; i++) {
+      AsyncLogFunction(LOG_INFO, "test.cpp", 1, "record %d\n", i);
+    }
+  }
+  // 64 records in the ring and one more held by the blocked sink at most
+  EXPECT_GE(GetAsyncLogDroppedNum() - dropped, 200 - 64 - 1);
+  StopAsyncLog();
+}
+
+int g_evaluated = 0;
+
+int Evaluate() { return ++g_evaluated; }
+
+TEST_F(AsyncLogTest, levelGating) {
+  LogFunction prevCallBack = logCallBack;
+  logCallBack = AsyncLogFunction;
+  logMinLevel = LOG_WARNING;
+
+  g_evaluated = 0;
+  OMAF_LOG(LOG_INFO, "skipped %d\n", Evaluate());
+  EXPECT_EQ(g_evaluated, 0);
+  OMAF_LOG(LOG_ERROR, "written %d\n", Evaluate());
+  EXPECT_EQ(g_evaluated, 1);
+
+  logCallBack = prevCallBack;
+  ASSERT_EQ(WaitLines(1), 1);
+  EXPECT_EQ(g_lines[0], "written 1");
+}
+TEST_F(AsyncLogTest, nestedStartStop) {
+  // a second user starts and stops, the first one keeps the writer running
+  EXPECT_EQ(StartAsyncLog(64), ERROR_NONE);
+  StopAsyncLog();
+
+  // let the writer go idle, the record must wake it up
+  usleep(20000);
+  AsyncLogFunction(LOG_INFO, "test.cpp", 1, "still async\n");
+  ASSERT_EQ(WaitLines(1), 1);
+  EXPECT_EQ(g_lines[0], "still async");
+  EXPECT_NE(g_writerId, std::this_thread::get_id());
+
+  // the last stop, later records are written at once
+  StopAsyncLog();
+  AsyncLogFunction(LOG_INFO, "test.cpp", 2, "sync\n");
+  std::lock_guard<std::mutex> lock(g_linesMutex);
+  ASSERT_EQ(g_lines.size(), 2);
+  EXPECT_EQ(g_writerId, std::this_thread::get_id());
+}
+}  // namespace
@@ -29,8 +29,17 @@
 #include <thread>
 #include <memory>
 #include <pwd.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <condition_variable>
 
 #include "../OmafDashDownload/OmafDownloader.h"
+#include "../OmafDashDownload/OmafCurlMultiHandler.h"
+#include "../OmafDashDownload/OmafPackedSegmentFetcher.h"
+#include "../DownloadManager.h"
 
 using namespace VCD::OMAF;
 
@@ -218,4 +227,430 @@ TEST_F(DownloaderTest, no_proxy_success) {
   }
 }
 
+TEST(DownloadTaskTest, urgency) {
+  auto now = std::chrono::steady_clock::now();
+  OmafDownloadTask::Ptr early_low = OmafDownloadTask::createTask("early_low", nullptr, nullptr);
+  early_low->priority(TaskPriority::LOW);
+  early_low->deadline(now + std::chrono::milliseconds(1000));
+  OmafDownloadTask::Ptr late_high = OmafDownloadTask::createTask("late_high", nullptr, nullptr);
+  late_high->priority(TaskPriority::HIGH);
+  late_high->deadline(now + std::chrono::milliseconds(2000));
+  OmafDownloadTask::Ptr late_normal = OmafDownloadTask::createTask("late_normal", nullptr, nullptr);
+  late_normal->priority(TaskPriority::NORMAL);
+  late_normal->deadline(late_high->deadline());
+  OmafDownloadTask::Ptr no_deadline = OmafDownloadTask::createTask("no_deadline", nullptr, nullptr);
+  no_deadline->priority(TaskPriority::HIGH);
+
+  // earlier deadline first, then higher priority
+  EXPECT_TRUE(early_low->moreUrgentThan(*late_high));
+  EXPECT_TRUE(late_high->moreUrgentThan(*late_normal));
+  EXPECT_FALSE(late_normal->moreUrgentThan(*late_high));
+  EXPECT_TRUE(late_normal->moreUrgentThan(*no_deadline));
+  EXPECT_FALSE(no_deadline->hasDeadline());
+  // same urgency keeps the fifo order
+  EXPECT_FALSE(late_high->moreUrgentThan(*late_high));
+}
+
+// http server on the loopback serving /fast and /slow, the slow one sends a
+// block every 10ms. The open ended byte range of a resumed transfer is honored
+class LocalHttpServer {
+ public:
+  static const size_t BODY_SIZE = 64 * 1024;
+  static const size_t BLOCK_SIZE = 1024;
+
+  LocalHttpServer() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr), len) == 0 && listen(listen_fd_, 16) == 0 &&
+        getsockname(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr), &len) == 0) {
+      port_ = ntohs(addr.sin_port);
+      worker_ = std::thread(&LocalHttpServer::run, this);
+    }
+  }
+  ~LocalHttpServer() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+    if (worker_.joinable()) worker_.join();
+    for (auto &conn : connections_) conn.join();
+  }
+
+  bool valid() const { return port_ != 0; }
+  std::string url(const std::string &name) const { return "http://127.0.0.1:" + std::to_string(port_) + "/" + name; }
+  int rangeRequests() const { return range_requests_.load(); }
+
+  static std::string body() {
+    std::string data(BODY_SIZE, 0);
+    for (size_t i = 0; i < BODY_SIZE; i++) data[i] = static_cast<char>(i % 251);
+    return data;
+  }
+
+ private:
+  void run() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) break;
+      connections_.emplace_back(&LocalHttpServer::serve, this, fd);
+    }
+  }
+
+  void serve(int fd) {
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        close(fd);
+        return;
+      }
+      request.append(buf, n);
+    }
+    bool slow = request.find("GET /slow") == 0;
+    size_t offset = 0;
+    size_t range = request.find("Range: bytes=");
+    if (range != std::string::npos) {
+      range_requests_++;
+      // the resources named norange are always sent whole
+      if (request.find("norange") != std::string::npos) {
+        range = std::string::npos;
+      } else {
+        offset = std::stoul(request.substr(range + strlen("Range: bytes=")));
+      }
+    }
+
+    std::string data = body().substr(offset);
+    std::stringstream header;
+    if (range != std::string::npos) {
+      header << "HTTP/1.1 206 Partial Content\r\n";
+      header << "Content-Range: bytes " << offset << "-" << (BODY_SIZE - 1) << "/" << BODY_SIZE << "\r\n";
+    } else {
+      header << "HTTP/1.1 200 OK\r\n";
+    }
+    header << "Content-Length: " << data.size() << "\r\nConnection: close\r\n\r\n";
+    data = header.str() + data;
+
+    for (size_t pos = 0; pos < data.size(); pos += BLOCK_SIZE) {
+      size_t size = data.size() - pos;
+      if (size > BLOCK_SIZE) size = BLOCK_SIZE;
+      // the client closed the connection of a preempted transfer
+      if (send(fd, data.data() + pos, size, MSG_NOSIGNAL) <= 0) break;
+      if (slow) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    close(fd);
+  }
+
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread worker_;
+  std::vector<std::thread> connections_;
+  std::atomic_int range_requests_{0};
+};
+
+static void preemptAndResume(const std::string &low_name) {
+  LocalHttpServer server;
+  ASSERT_TRUE(server.valid());
+
+  std::mutex done_mutex;
+  std::condition_variable done_cv;
+  std::vector<OmafDownloadTask::Ptr> done_tasks;
+  CurlParams params;
+  params.http_params_.conn_timeout_ = 5000;
+  params.http_params_.total_timeout_ = 30000;
+  params.http_params_.retry_times_ = 3;
+  // one transfer slot, so the high priority task has to preempt the low one
+  OmafCurlMultiDownloader downloader(1);
+  ASSERT_EQ(ERROR_NONE, downloader.init(params, [&](OmafDownloadTask::Ptr task) {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    done_tasks.push_back(task);
+    done_cv.notify_all();
+  }));
+
+  std::string low_data;
+  std::atomic_size_t low_received{0};
+  OmafDownloadTask::Ptr low = OmafDownloadTask::createTask(
+      server.url(low_name),
+      [&low_data, &low_received](std::unique_ptr<StreamBlock> sb) {
+        low_data.append(sb->cbuf(), sb->size());
+        low_received += sb->size();
+      },
+      nullptr);
+  low->priority(TaskPriority::LOW);
+  EXPECT_EQ(ERROR_NONE, downloader.addTask(low));
+  for (int i = 0; i < 5000 && low_received.load() == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(low_received.load() > 0);
+
+  std::string high_data;
+  OmafDownloadTask::Ptr high = OmafDownloadTask::createTask(
+      server.url("fast"), [&high_data](std::unique_ptr<StreamBlock> sb) { high_data.append(sb->cbuf(), sb->size()); },
+      nullptr);
+  high->priority(TaskPriority::HIGH);
+  EXPECT_EQ(ERROR_NONE, downloader.addTask(high));
+
+  {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait_for(lock, std::chrono::seconds(10), [&done_tasks] { return done_tasks.size() >= 2; });
+    ASSERT_EQ(2, done_tasks.size());
+    // the preempted task is queued again and completes after the high priority one
+    EXPECT_TRUE(done_tasks[0] == high);
+    EXPECT_TRUE(done_tasks[1] == low);
+  }
+  downloader.close();
+
+  EXPECT_TRUE(high->state() == OmafDownloadTask::State::FINISH);
+  EXPECT_TRUE(low->state() == OmafDownloadTask::State::FINISH);
+  EXPECT_EQ(LocalHttpServer::body(), high_data);
+  // resumed from the bytes received before the preemption
+  EXPECT_EQ(LocalHttpServer::body(), low_data);
+  EXPECT_EQ(1, server.rangeRequests());
+}
+
+TEST(DownloadTaskTest, preemptAndResume) { preemptAndResume("slow"); }
+
+// a server ignoring the range sends the whole resource again, whose head is skipped
+TEST(DownloadTaskTest, preemptAndResumeRangeIgnored) { preemptAndResume("slow_norange"); }
+
+TEST(DownloadTaskTest, tightenDeadline) {
+  LocalHttpServer server;
+  ASSERT_TRUE(server.valid());
+
+  std::mutex done_mutex;
+  std::condition_variable done_cv;
+  std::vector<OmafDownloadTask::Ptr> done_tasks;
+  CurlParams params;
+  params.http_params_.conn_timeout_ = 5000;
+  params.http_params_.total_timeout_ = 30000;
+  OmafDownloadTask::Ptr busy = OmafDownloadTask::createTask(server.url("slow"), nullptr, nullptr);
+  busy->priority(TaskPriority::HIGH);
+  OmafDownloadTask::Ptr late = OmafDownloadTask::createTask(server.url("fast?late"), nullptr, nullptr);
+  late->timelinePoint(1);
+  OmafDownloadTask::Ptr early = OmafDownloadTask::createTask(server.url("fast?early"), nullptr, nullptr);
+  early->timelinePoint(2);
+
+  OmafCurlMultiDownloader downloader(1);
+  ASSERT_EQ(ERROR_NONE, downloader.init(params, [&](OmafDownloadTask::Ptr task) {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    done_tasks.push_back(task);
+    done_cv.notify_all();
+  }));
+  // the only transfer slot is taken, so the other tasks wait in the ready list
+  EXPECT_EQ(ERROR_NONE, downloader.addTask(busy));
+  for (int i = 0; i < 5000 && busy->state() != OmafDownloadTask::State::RUNNING; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto now = std::chrono::steady_clock::now();
+  late->deadline(now + std::chrono::seconds(20));
+  early->deadline(now + std::chrono::seconds(10));
+  EXPECT_EQ(ERROR_NONE, downloader.addTask(late));
+  EXPECT_EQ(ERROR_NONE, downloader.addTask(early));
+  downloader.tightenDeadline(1, now + std::chrono::seconds(5));
+
+  {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait_for(lock, std::chrono::seconds(10), [&done_tasks] { return done_tasks.size() >= 3; });
+    ASSERT_EQ(3, done_tasks.size());
+    EXPECT_TRUE(done_tasks[0] == busy);
+    EXPECT_TRUE(done_tasks[1] == late);
+    EXPECT_TRUE(done_tasks[2] == early);
+  }
+  downloader.close();
+  EXPECT_TRUE(late->deadline() == now + std::chrono::seconds(5));
+}
+
+static void appendUint32BE(std::string &data, uint32_t value) {
+  data.push_back(static_cast<char>((value >> 24) & 0xff));
+  data.push_back(static_cast<char>((value >> 16) & 0xff));
+  data.push_back(static_cast<char>((value >> 8) & 0xff));
+  data.push_back(static_cast<char>(value & 0xff));
+}
+
+// packed segment of tiles with track id 1..3, the tile segment i is 'a'+i repeated
+static std::string makePackedSegment(uint32_t tile_size) {
+  std::string data;
+  uint32_t index_size = PACKED_TILES_INDEX_HEADER_SIZE + PACKED_TILES_INDEX_ENTRY_SIZE * 3;
+  appendUint32BE(data, index_size);
+  data.append(PACKED_TILES_INDEX_TYPE);
+  appendUint32BE(data, 0);
+  appendUint32BE(data, 3);
+  for (uint32_t i = 0; i < 3; i++) {
+    appendUint32BE(data, i + 1);
+    appendUint32BE(data, index_size + i * tile_size);
+    appendUint32BE(data, tile_size);
+  }
+  for (uint32_t i = 0; i < 3; i++) {
+    data.append(tile_size, static_cast<char>('a' + i));
+  }
+  return data;
+}
+
+TEST(PackedSegmentFetcherTest, parseIndex) {
+  std::string data = makePackedSegment(100);
+  std::map<uint32_t, OmafPackedSegmentFetcher::IndexEntry> index;
+  EXPECT_EQ(ERROR_NONE, OmafPackedSegmentFetcher::parseIndex(data, 3, index));
+  EXPECT_EQ(3, index.size());
+  EXPECT_EQ(52 + 100, index[2].offset_);
+  EXPECT_EQ(100, index[2].size_);
+
+  EXPECT_NE(ERROR_NONE, OmafPackedSegmentFetcher::parseIndex(data.substr(0, 40), 3, index));
+  data[4] = 'x';
+  EXPECT_NE(ERROR_NONE, OmafPackedSegmentFetcher::parseIndex(data, 3, index));
+}
+
+TEST(PackedSegmentFetcherTest, coalesce) {
+  std::vector<OmafPackedSegmentFetcher::IndexEntry> entries(3);
+  entries[0].track_id_ = 1;
+  entries[0].offset_ = 1000;
+  entries[0].size_ = 100;
+  entries[1].track_id_ = 2;
+  entries[1].offset_ = 100;
+  entries[1].size_ = 100;
+  entries[2].track_id_ = 3;
+  entries[2].offset_ = 250;
+  entries[2].size_ = 100;
+
+  auto ranges = OmafPackedSegmentFetcher::coalesce(entries, 100);
+  EXPECT_EQ(2, ranges.size());
+  EXPECT_EQ(2, ranges[0].size());
+  EXPECT_EQ(2, ranges[0][0].track_id_);
+  EXPECT_EQ(1, ranges[1][0].track_id_);
+
+  EXPECT_EQ(3, OmafPackedSegmentFetcher::coalesce(entries, 0).size());
+}
+
+TEST(PackedSegmentFetcherTest, fetchTiles) {
+  const uint32_t tile_size = 100;
+  std::string packed = makePackedSegment(tile_size);
+
+  struct Request {
+    DashSegmentSourceParams params_;
+    OmafDashSegmentClient::OnData dcb_;
+    OmafDashSegmentClient::OnState scb_;
+  };
+  std::vector<Request> requests;
+  auto opener = [&requests](const DashSegmentSourceParams &params, OmafDashSegmentClient::OnData dcb,
+                            OmafDashSegmentClient::OnState scb) {
+    requests.push_back(Request{params, dcb, scb});
+    return ERROR_NONE;
+  };
+  auto remover = [](const DashSegmentSourceParams &) { return ERROR_NONE; };
+  // respond the range request with blocks of 30 bytes
+  auto respond = [&packed](Request &request) {
+    for (int64_t pos = 0; pos < request.params_.range_size_; pos += 30) {
+      int64_t size = std::min<int64_t>(30, request.params_.range_size_ - pos);
+      std::unique_ptr<StreamBlock> sb = make_unique_vcd<StreamBlock>();
+      sb->resize(size);
+      memcpy(sb->buf(), packed.data() + request.params_.range_offset_ + pos, size);
+      sb->size(size);
+      request.dcb_(std::move(sb));
+    }
+    request.scb_(OmafDashSegmentClient::State::SUCCESS);
+  };
+
+  OmafPackedSegmentFetcher fetcher(opener, remover, 0);
+  std::map<uint32_t, std::string> tile_data;
+  std::map<uint32_t, OmafDashSegmentClient::State> tile_state;
+  for (uint32_t track_id : {1, 3}) {
+    DashSegmentSourceParams params;
+    params.dash_url_ = "http://localhost/test_track" + std::to_string(track_id) + ".1.mp4";
+    params.timeline_point_ = 1;
+    params.packed_url_ = "http://localhost/test_packed1.1.mp4";
+    params.packed_entry_num_ = 3;
+    params.packed_track_id_ = track_id;
+    EXPECT_EQ(ERROR_NONE, fetcher.open(
+                              params,
+                              [&tile_data, track_id](std::unique_ptr<StreamBlock> sb) {
+                                tile_data[track_id].append(sb->cbuf(), sb->size());
+                              },
+                              [&tile_state, track_id](OmafDashSegmentClient::State state) {
+                                tile_state[track_id] = state;
+                              }));
+  }
+
+  // one index request for both tiles
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ(0, requests[0].params_.range_offset_);
+  EXPECT_EQ(52, requests[0].params_.range_size_);
+  EXPECT_EQ(TaskPriority::HIGH, requests[0].params_.priority_);
+  Request index_request = requests[0];
+  respond(index_request);
+
+  // not adjacent, so one range request for each tile
+  ASSERT_EQ(3, requests.size());
+  respond(requests[1]);
+  respond(requests[2]);
+  EXPECT_EQ(std::string(tile_size, 'a'), tile_data[1]);
+  EXPECT_EQ(std::string(tile_size, 'c'), tile_data[3]);
+  EXPECT_EQ(OmafDashSegmentClient::State::SUCCESS, tile_state[1]);
+  EXPECT_EQ(OmafDashSegmentClient::State::SUCCESS, tile_state[3]);
+}
+
+static std::shared_ptr<SegmentBuffer> makeSegmentBuffer(char value, uint64_t size) {
+  std::shared_ptr<SegmentBuffer> buffer = std::make_shared<SegmentBuffer>();
+  std::unique_ptr<StreamBlock> block = make_unique_vcd<StreamBlock>();
+  block->resize(size);
+  memset(block->buf(), value, size);
+  block->size(size);
+  buffer->blocks.push_back(std::move(block));
+  buffer->size = size;
+  return buffer;
+}
+
+TEST(SegmentCacheTest, lruBudget) {
+  DownloadManager cache;
+  cache.SetMaxMemorySize(250);
+  cache.InsertSegment("seg1", makeSegmentBuffer('a', 100));
+  cache.InsertSegment("seg2", makeSegmentBuffer('b', 100));
+  // seg1 is used again, so seg2 is the least recently used one
+  std::shared_ptr<SegmentBuffer> seg1 = cache.LookupSegment("seg1");
+  ASSERT_NE(nullptr, seg1.get());
+  cache.InsertSegment("seg3", makeSegmentBuffer('c', 100));
+
+  EXPECT_EQ(nullptr, cache.LookupSegment("seg2").get());
+  EXPECT_NE(nullptr, cache.LookupSegment("seg3").get());
+  // shared without copy
+  EXPECT_EQ(seg1.get(), cache.LookupSegment("seg1").get());
+  // larger than the whole budget
+  cache.InsertSegment("seg4", makeSegmentBuffer('d', 300));
+  EXPECT_EQ(nullptr, cache.LookupSegment("seg4").get());
+
+  SegmentCacheStatistics stats;
+  cache.GetCacheStatistics(&stats);
+  EXPECT_EQ(3, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(200, stats.memoryBytes);
+}
+
+TEST(SegmentCacheTest, spillToDisk) {
+  std::string cache_dir = "/tmp/omaf_segment_cache_test";
+  DownloadManager cache;
+  cache.SetMaxMemorySize(100);
+  cache.SetMaxCacheSize(1000);
+  cache.SetUseCache(true);
+  EXPECT_EQ(ERROR_NONE, cache.SetCacheFolder(cache_dir));
+  cache.InsertSegment("seg1", makeSegmentBuffer('a', 100));
+  cache.InsertSegment("seg2", makeSegmentBuffer('b', 100));
+
+  // seg1 is loaded back from the spilled file, which spills seg2
+  std::shared_ptr<SegmentBuffer> seg1 = cache.LookupSegment("seg1");
+  ASSERT_NE(nullptr, seg1.get());
+  EXPECT_EQ(100, seg1->size);
+  EXPECT_EQ(std::string(100, 'a'), std::string(seg1->blocks[0]->cbuf(), seg1->blocks[0]->size()));
+
+  SegmentCacheStatistics stats;
+  cache.GetCacheStatistics(&stats);
+  EXPECT_EQ(1, stats.diskHits);
+  EXPECT_EQ(2, stats.spills);
+  EXPECT_EQ(100, stats.diskBytes);
+  cache.CleanCache();
+  rmdir(cache_dir.c_str());
+}
+
 }  // namespace
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   testMetrics.cpp
+//! \brief:  Pipeline metrics registry unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafMetrics.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+TEST(MetricsTest, histogramBuckets) {
+  // small values are exact, larger ones keep 16 buckets per power of two
+  for (uint64_t v = 0; v < 16; v++) {
+    EXPECT_EQ(LatencyHistogram::BucketIndex(v), v);
+    EXPECT_EQ(LatencyHistogram::BucketLowerBound(v), v);
+  }
+  uint64_t values[] = {16, 17, 31, 32, 33, 1000, 123456, 999999999};
+  for (auto v : values) {
+    uint32_t idx = LatencyHistogram::BucketIndex(v);
+    uint64_t lower = LatencyHistogram::BucketLowerBound(idx);
+    uint64_t upper = LatencyHistogram::BucketLowerBound(idx + 1);
+    EXPECT_LE(lower, v);
+    EXPECT_GT(upper, v);
+    EXPECT_LE((upper - lower) * 16, upper);
+  }
+}
+
+TEST(MetricsTest, histogramPercentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t v = 1; v <= 1000; v++) {
+    histogram.Record(v);
+  }
+  LatencySummary summary;
+  histogram.Summarize(&summary);
+  EXPECT_EQ(summary.count, 1000);
+  EXPECT_EQ(summary.max_us, 1000);
+  EXPECT_EQ(summary.mean_us, 500);
+  EXPECT_NEAR(summary.p50_us, 500, 500 / 16);
+  EXPECT_NEAR(summary.p90_us, 900, 900 / 16);
+  EXPECT_NEAR(summary.p99_us, 990, 990 / 16);
+}
+
+TEST(MetricsTest, concurrentRecord) {
+  OmafMetrics metrics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&metrics]() {
+      for (int i = 0; i < 10000; i++) {
+        metrics.Add(MetricCounter::PACKETS_OUTPUT);
+        metrics.Record(MetricHistogram::GET_PACKET_LATENCY, i);
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  DashMetricsInfo info;
+  metrics.GetMetrics(&info);
+  EXPECT_EQ(info.packets_output, 40000);
+  EXPECT_EQ(info.get_packet_latency.count, 40000);
+  EXPECT_EQ(info.get_packet_latency.max_us, 9999);
+}
+
+TEST(MetricsTest, motionToHighQuality) {
+  OmafMetrics metrics;
+  // packets before the change are not counted
+  metrics.OnPacketOutput(3);
+  metrics.OnViewportChanged();
+  metrics.OnViewportChanged();
+  metrics.OnSegmentRequested(5);
+  metrics.OnSegmentRequested(6);
+  usleep(2000);
+  // packets of the segments selected before the change
+  metrics.OnPacketOutput(4);
+
+  DashMetricsInfo info;
+  metrics.GetMetrics(&info);
+  EXPECT_EQ(info.viewport_changes, 2);
+  EXPECT_EQ(info.motion_to_hq_latency.count, 0);
+
+  metrics.OnPacketOutput(5);
+  metrics.OnPacketOutput(5);
+  metrics.GetMetrics(&info);
+  EXPECT_EQ(info.motion_to_hq_latency.count, 1);
+  EXPECT_GE(info.motion_to_hq_latency.max_us, 2000);
+}
+
+TEST(MetricsTest, scopedLatencyPerInstance) {
+  OmafMetrics first;
+  OmafMetrics second;
+  {
+    ScopedLatency latency(&first, MetricHistogram::SELECTION_LATENCY);
+    usleep(1000);
+  }
+  { ScopedLatency latency(nullptr, MetricHistogram::SELECTION_LATENCY); }
+  second.Reset();
+
+  DashMetricsInfo info;
+  first.GetMetrics(&info);
+  EXPECT_EQ(info.selection_latency.count, 1);
+  EXPECT_GE(info.selection_latency.max_us, 1000);
+  second.GetMetrics(&info);
+  EXPECT_EQ(info.selection_latency.count, 0);
+}
+
+TEST(MetricsTest, jsonDump) {
+  const std::string path = "./metrics_dump.json";
+  remove(path.c_str());
+
+  OmafMetrics metrics;
+  metrics.Add(MetricCounter::SEGMENTS_DOWNLOADED, 3);
+  metrics.Set(MetricGauge::BUFFER_LEVEL_MS, 1500);
+  std::string json = metrics.ToJson();
+  EXPECT_NE(json.find("\"segments_downloaded\":3"), std::string::npos);
+  EXPECT_NE(json.find("\"buffer_level_ms\":1500"), std::string::npos);
+  EXPECT_NE(json.find("\"motion_to_hq\":{"), std::string::npos);
+
+  EXPECT_EQ(metrics.StartDump(path, 20), ERROR_NONE);
+  usleep(100000);
+  metrics.StopDump();
+
+  std::ifstream in(path);
+  std::string line;
+  int lines = 0;
+  while (std::getline(in, line)) {
+    EXPECT_EQ(line.front(), '{');
+    EXPECT_EQ(line.back(), '}');
+    lines++;
+  }
+  EXPECT_GE(lines, 2);
+  remove(path.c_str());
+}
+}  // namespace
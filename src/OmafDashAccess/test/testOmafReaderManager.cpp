@@ -36,6 +36,9 @@
 #include "../OmafReaderManager.h"
 #include "gtest/gtest.h"
 
+#include <chrono>
+#include <thread>
+
 VCD_USE_VROMAF;
 VCD_USE_VRVIDEO;
 
@@ -311,4 +314,39 @@ TEST_F(OmafReaderManagerTest, ReaderTrackSegments) {
     fpGen = NULL;
   }
 }
+
+TEST_F(OmafReaderManagerTest, WaitPacketReady) {
+  uint64_t epoch = m_readerMgr->GetPacketReadyEpoch();
+  EXPECT_FALSE(m_readerMgr->WaitPacketReady(epoch, 10));
+
+  std::thread notifier([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    m_readerMgr->NotifyPacketReady();
+  });
+  EXPECT_TRUE(m_readerMgr->WaitPacketReady(epoch, 5000));
+  notifier.join();
+
+  // a notification before the wait is not missed
+  epoch = m_readerMgr->GetPacketReadyEpoch();
+  m_readerMgr->NotifyPacketReady();
+  EXPECT_TRUE(m_readerMgr->WaitPacketReady(epoch, 0));
+}
+
+TEST_F(OmafReaderManagerTest, WaitBufferSpace) {
+  uint64_t epoch = m_readerMgr->GetBufferSpaceEpoch();
+  EXPECT_FALSE(m_readerMgr->WaitBufferSpace(epoch, 10));
+
+  // consuming packets releases the buffer space
+  std::thread consumer([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    m_readerMgr->RemoveOutdatedPacketForTrack(1, 0);
+  });
+  EXPECT_TRUE(m_readerMgr->WaitBufferSpace(epoch, 5000));
+  consumer.join();
+
+  // a notification before the wait is not missed
+  epoch = m_readerMgr->GetBufferSpaceEpoch();
+  m_readerMgr->NotifyBufferSpace();
+  EXPECT_TRUE(m_readerMgr->WaitBufferSpace(epoch, 0));
+}
 }  // namespace
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+//!
+//! \file:   testPacketMeta.cpp
+//! \brief:  Shared packet metadata pool unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafPacketMeta.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+class PacketMetaTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    memset(&m_rwpk, 0, sizeof(m_rwpk));
+    memset(m_regions, 0, sizeof(m_regions));
+    memset(m_resolutions, 0, sizeof(m_resolutions));
+    m_rwpk.numRegions = REGION_NUM;
+    m_rwpk.packedPicWidth = 3840;
+    m_rwpk.packedPicHeight = 1920;
+    m_rwpk.rectRegionPacking = m_regions;
+    for (int i = 0; i < REGION_NUM; i++) {
+      m_regions[i].packedRegWidth = 960;
+      m_regions[i].packedRegHeight = 960;
+      m_regions[i].packedRegLeft = (i % 4) * 960;
+      m_regions[i].packedRegTop = (i / 4) * 960;
+      m_regions[i].projRegLeft = i * 960;
+    }
+    m_resolutions[0].qualityRanking = HIGHEST_QUALITY_RANKING;
+    m_resolutions[0].width = 7680;
+    m_resolutions[0].height = 3840;
+    m_resolutions[1].qualityRanking = SECOND_QUALITY_RANKING;
+    m_resolutions[1].width = 1920;
+    m_resolutions[1].height = 960;
+  }
+
+  static const int REGION_NUM = 8;
+  RegionWisePacking m_rwpk;
+  RectangularRegionWisePacking m_regions[REGION_NUM];
+  SourceResolution m_resolutions[2];
+};
+
+TEST_F(PacketMetaTest, ShareSameLayout) {
+  OmafPacketMetaPool pool;
+  DashPacketMeta *meta1 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  // the frames of one layout differ only in the timestamp
+  m_rwpk.timeStamp = 1;
+  DashPacketMeta *meta2 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  ASSERT_TRUE(meta1 != NULL);
+  EXPECT_EQ(meta1, meta2);
+  EXPECT_EQ(pool.GetSize(), 1u);
+
+  // the metadata is a copy, not the input arrays
+  EXPECT_NE(meta1->rwpk->rectRegionPacking, m_regions);
+  EXPECT_EQ((int)meta1->rwpk->numRegions, (int)REGION_NUM);
+  EXPECT_EQ(meta1->rwpk->rectRegionPacking[5].projRegLeft, 5u * 960);
+  EXPECT_EQ(meta1->numQuality, 2);
+  EXPECT_EQ(meta1->qtyResolution[1].width, 1920u);
+
+  meta1->release(meta1);
+  meta2->release(meta2);
+}
+
+TEST_F(PacketMetaTest, NewLayout) {
+  OmafPacketMetaPool pool;
+  DashPacketMeta *meta1 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  m_regions[3].projRegLeft += 960;
+  DashPacketMeta *meta2 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  EXPECT_NE(meta1, meta2);
+  EXPECT_EQ(meta2->rwpk->rectRegionPacking[3].projRegLeft, 4u * 960);
+  m_resolutions[1].width = 3840;
+  DashPacketMeta *meta3 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  EXPECT_NE(meta2, meta3);
+
+  // back to the first layout
+  m_regions[3].projRegLeft -= 960;
+  m_resolutions[1].width = 1920;
+  DashPacketMeta *meta4 = pool.Acquire(m_rwpk, m_resolutions, 2);
+  EXPECT_EQ(meta1, meta4);
+  EXPECT_EQ(pool.GetSize(), 3u);
+
+  meta1->release(meta1);
+  meta2->release(meta2);
+  meta3->release(meta3);
+  meta4->release(meta4);
+}
+
+TEST_F(PacketMetaTest, EvictedLayoutOutlivesPool) {
+  DashPacketMeta *first = NULL;
+  {
+    OmafPacketMetaPool pool(2);
+    first = pool.Acquire(m_rwpk, m_resolutions, 2);
+    for (uint32_t i = 1; i <= 4; i++) {
+      m_rwpk.projPicWidth = i;
+      DashPacketMeta *meta = pool.Acquire(m_rwpk, m_resolutions, 2);
+      meta->release(meta);
+    }
+    EXPECT_EQ(pool.GetSize(), 2u);
+
+    // the evicted layout is created again
+    m_rwpk.projPicWidth = 0;
+    DashPacketMeta *again = pool.Acquire(m_rwpk, m_resolutions, 2);
+    EXPECT_NE(first, again);
+    again->release(again);
+  }
+  // still valid with the reference of the packet
+  first->retain(first);
+  EXPECT_EQ(first->rwpk->rectRegionPacking[7].projRegLeft, 7u * 960);
+  first->release(first);
+  first->release(first);
+}
+}  // namespace
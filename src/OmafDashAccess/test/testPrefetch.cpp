@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   testPrefetch.cpp
+//! \brief:  Speculative tile prefetch unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafAdaptationSet.h"
+
+#include <thread>
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+class PrefetchTest : public testing::Test {
+ public:
+  virtual void SetUp() { m_as = new OmafAdaptationSet(); }
+  virtual void TearDown() { SAFE_DELETE(m_as); }
+
+  OmafSegment::Ptr CreateSegment(int segCnt) {
+    DashSegmentSourceParams params;
+    params.dash_url_ = "http://localhost/track1." + std::to_string(segCnt) + ".mp4";
+    params.priority_ = TaskPriority::LOW;
+    params.timeline_point_ = segCnt;
+    OmafSegment::Ptr segment = std::make_shared<OmafSegment>(params, segCnt, false);
+    segment->SetSegID(segCnt);
+    return segment;
+  }
+
+  OmafAdaptationSet *m_as;
+};
+
+TEST_F(PrefetchTest, KeepOnlySpeculativeSegment) {
+  EXPECT_FALSE(m_as->IsSpeculative());
+  EXPECT_FALSE(m_as->KeepSpeculativeSegment(CreateSegment(1)));
+  EXPECT_TRUE(m_as->TakeSpeculativeSegment().get() == nullptr);
+
+  m_as->SetSpeculative(true);
+  EXPECT_TRUE(m_as->IsSpeculative());
+  OmafSegment::Ptr segment = CreateSegment(2);
+  EXPECT_TRUE(m_as->KeepSpeculativeSegment(segment));
+
+  // the prefetched segment is evaluated only once
+  EXPECT_TRUE(m_as->TakeSpeculativeSegment() == segment);
+  EXPECT_TRUE(m_as->TakeSpeculativeSegment().get() == nullptr);
+
+  // the download after the track is selected drops the stale prefetch
+  EXPECT_TRUE(m_as->KeepSpeculativeSegment(CreateSegment(3)));
+  m_as->SetSpeculative(false);
+  EXPECT_FALSE(m_as->KeepSpeculativeSegment(CreateSegment(4)));
+  EXPECT_TRUE(m_as->TakeSpeculativeSegment().get() == nullptr);
+}
+
+TEST_F(PrefetchTest, PrefetchedSegmentState) {
+  m_as->SetSpeculative(true);
+  m_as->KeepSpeculativeSegment(CreateSegment(1));
+
+  // a prefetch that is never opened can still be cancelled
+  OmafSegment::Ptr segment = m_as->TakeSpeculativeSegment();
+  ASSERT_TRUE(segment.get() != nullptr);
+  EXPECT_TRUE(segment->GetState() == OmafSegment::State::CREATE);
+  EXPECT_TRUE(segment->GetSegID() == 1);
+}
+
+TEST_F(PrefetchTest, ConcurrentKeepAndTake) {
+  const int LOOP_NUM = 10000;
+  int taken = 0;
+
+  m_as->SetSpeculative(true);
+  std::thread downloader([this, LOOP_NUM]() {
+    for (int i = 0; i < LOOP_NUM; i++) {
+      m_as->KeepSpeculativeSegment(CreateSegment(i));
+    }
+  });
+  for (int i = 0; i < LOOP_NUM; i++) {
+    if (m_as->TakeSpeculativeSegment().get() != nullptr) taken++;
+  }
+  downloader.join();
+  if (m_as->TakeSpeculativeSegment().get() != nullptr) taken++;
+
+  EXPECT_TRUE(taken > 0);
+  EXPECT_TRUE(taken <= LOOP_NUM);
+}
+}  // namespace
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   testRateAdaptation.cpp
+//! \brief:  Tile quality rate adaptation unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafRateAdaptation.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+
+std::vector<RateOption> buildOptions() {
+  std::vector<RateOption> options;
+  RateOption high = {HIGHEST_QUALITY_RANKING, 20000000};
+  RateOption low = {SECOND_QUALITY_RANKING, 4000000};
+  options.push_back(high);
+  options.push_back(low);
+  return options;
+}
+
+// 1 second download of the bytes for the given bitrate
+void addSamples(OmafRateAdaptation::Ptr abr, uint64_t bps, int num) {
+  for (int i = 0; i < num; i++) {
+    abr->AddSegmentThroughput(bps / 8, 1000000);
+  }
+}
+
+TEST(RateAdaptationTest, ThroughputEstimate) {
+  OmafDashAbrParams params;
+  params.throughput_samples_ = 2;
+  OmafRateAdaptation::Ptr abr = OmafRateAdaptation::Create(params);
+  EXPECT_TRUE(abr->GetEstimatedThroughput() == 0);
+
+  abr->AddSegmentThroughput(0, 1000);
+  abr->AddSegmentThroughput(1000, 0);
+  EXPECT_TRUE(abr->GetEstimatedThroughput() == 0);
+
+  addSamples(abr, 1000000, 1);
+  addSamples(abr, 4000000, 1);
+  // harmonic mean of 1 and 4 Mbps
+  EXPECT_NEAR(abr->GetEstimatedThroughput(), 1600000, 1);
+
+  // only the latest 2 samples are used
+  addSamples(abr, 4000000, 1);
+  EXPECT_NEAR(abr->GetEstimatedThroughput(), 4000000, 1);
+}
+
+TEST(RateAdaptationTest, ThroughputPolicy) {
+  OmafDashAbrParams params;
+  params.policy_ = AbrPolicy::THROUGHPUT;
+  OmafRateAdaptation::Ptr abr = OmafRateAdaptation::Create(params);
+  std::vector<RateOption> options = buildOptions();
+
+  EXPECT_TRUE(abr->SelectQuality(std::vector<RateOption>()) == INVALID_QUALITY_RANKING);
+  // keep the best quality before any measurement
+  EXPECT_TRUE(abr->SelectQuality(options) == HIGHEST_QUALITY_RANKING);
+
+  addSamples(abr, 10000000, 5);
+  EXPECT_TRUE(abr->SelectQuality(options) == SECOND_QUALITY_RANKING);
+
+  addSamples(abr, 50000000, 5);
+  EXPECT_TRUE(abr->SelectQuality(options) == HIGHEST_QUALITY_RANKING);
+
+  // 20 Mbps doesn't fit into 90% of 21 Mbps
+  addSamples(abr, 21000000, 5);
+  EXPECT_TRUE(abr->SelectQuality(options) == SECOND_QUALITY_RANKING);
+}
+
+TEST(RateAdaptationTest, BolaPolicy) {
+  OmafDashAbrParams params;
+  params.policy_ = AbrPolicy::BOLA;
+  params.buffer_target_ms_ = 6000;
+  OmafRateAdaptation::Ptr abr = OmafRateAdaptation::Create(params);
+  abr->SetSegmentDuration(1000);
+  std::vector<RateOption> options = buildOptions();
+
+  // start up with the throughput rule
+  addSamples(abr, 50000000, 5);
+  EXPECT_TRUE(abr->SelectQuality(options) == HIGHEST_QUALITY_RANKING);
+
+  // quality follows the buffer level whatever the throughput is
+  abr->SetBufferLevel(1000);
+  EXPECT_TRUE(abr->SelectQuality(options) == SECOND_QUALITY_RANKING);
+  abr->SetBufferLevel(6000);
+  EXPECT_TRUE(abr->SelectQuality(options) == HIGHEST_QUALITY_RANKING);
+  abr->SetBufferLevel(2000);
+  EXPECT_TRUE(abr->SelectQuality(options) == SECOND_QUALITY_RANKING);
+}
+
+TEST(RateAdaptationTest, UpdateCount) {
+  OmafDashAbrParams params;
+  OmafRateAdaptation::Ptr abr = OmafRateAdaptation::Create(params);
+  EXPECT_TRUE(abr->GetUpdateCount() == 0);
+
+  // every segment throughput is an update, invalid samples are not
+  addSamples(abr, 10000000, 2);
+  abr->AddSegmentThroughput(0, 1000);
+  EXPECT_TRUE(abr->GetUpdateCount() == 2);
+
+  // the buffer level is set on every selection, only a change is an update
+  abr->SetBufferLevel(1000);
+  abr->SetBufferLevel(1000);
+  EXPECT_TRUE(abr->GetUpdateCount() == 3);
+  abr->SetBufferLevel(2000);
+  EXPECT_TRUE(abr->GetUpdateCount() == 4);
+}
+}  // namespace
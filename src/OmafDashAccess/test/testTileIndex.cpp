@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   testTileIndex.cpp
+//! \brief:  Tile adaptation set spatial index unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafTileIndex.h"
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+class TileIndexTest : public testing::Test {
+ public:
+  virtual void SetUp() {
+    for (int i = 0; i < TILE_NUM; i++) {
+      m_as[i] = new OmafAdaptationSet();
+    }
+  }
+  virtual void TearDown() {
+    for (int i = 0; i < TILE_NUM; i++) {
+      SAFE_DELETE(m_as[i]);
+    }
+  }
+
+  static const int TILE_NUM = 200;
+  OmafAdaptationSet *m_as[TILE_NUM];
+};
+
+TEST_F(TileIndexTest, FindTiles) {
+  OmafTileIndex index;
+  // 10x10 high quality tiles of 384x192 and 10x10 low quality tiles
+  for (int i = 0; i < TILE_NUM; i++) {
+    uint32_t quality = (i < 100) ? HIGHEST_QUALITY_RANKING : SECOND_QUALITY_RANKING;
+    int32_t x = (i % 10) * 384;
+    int32_t y = ((i % 100) / 10) * 192;
+    EXPECT_TRUE(index.Insert(0, x, y, quality, m_as[i]) == ERROR_NONE);
+  }
+  EXPECT_TRUE(index.GetSize() == TILE_NUM);
+
+  for (int i = 0; i < TILE_NUM; i++) {
+    uint32_t quality = (i < 100) ? HIGHEST_QUALITY_RANKING : SECOND_QUALITY_RANKING;
+    int32_t x = (i % 10) * 384;
+    int32_t y = ((i % 100) / 10) * 192;
+    EXPECT_TRUE(index.Find(0, x, y, quality) == m_as[i]);
+  }
+  EXPECT_TRUE(index.Find(0, 1, 0, HIGHEST_QUALITY_RANKING) == NULL);
+  EXPECT_TRUE(index.Find(1, 0, 0, HIGHEST_QUALITY_RANKING) == NULL);
+  EXPECT_TRUE(index.Find(0, 0, 0, THIRD_QUALITY_RANKING) == NULL);
+
+  EXPECT_TRUE(index.GetTilesOfQuality(HIGHEST_QUALITY_RANKING).size() == 100);
+  EXPECT_TRUE(index.GetTilesOfQuality(HIGHEST_QUALITY_RANKING)[0] == m_as[0]);
+  EXPECT_TRUE(index.GetTilesOfQuality(THIRD_QUALITY_RANKING).empty());
+  EXPECT_TRUE(index.GetLowQualityTiles().size() == 100);
+  EXPECT_TRUE(index.GetLowQualityTiles()[0] == m_as[100]);
+}
+
+TEST_F(TileIndexTest, CubemapFacesAndDuplicates) {
+  OmafTileIndex index;
+  for (int face = 0; face < 6; face++) {
+    EXPECT_TRUE(index.Insert(face, 0, 0, HIGHEST_QUALITY_RANKING, m_as[face]) == ERROR_NONE);
+  }
+  // the first adaptation set inserted for a tile is kept
+  EXPECT_TRUE(index.Insert(3, 0, 0, HIGHEST_QUALITY_RANKING, m_as[10]) == ERROR_NONE);
+  EXPECT_TRUE(index.Insert(0, 0, 0, HIGHEST_QUALITY_RANKING, NULL) != ERROR_NONE);
+  // quality ranking 257 would alias to 1 in the key
+  EXPECT_TRUE(index.Insert(0, 0, 0, 257, m_as[11]) != ERROR_NONE);
+  EXPECT_TRUE(index.Find(0, 0, 0, 257) == NULL);
+  EXPECT_TRUE(index.GetTilesOfQuality(257).empty());
+
+  EXPECT_TRUE(index.GetSize() == 6);
+  for (int face = 0; face < 6; face++) {
+    EXPECT_TRUE(index.Find(face, 0, 0, HIGHEST_QUALITY_RANKING) == m_as[face]);
+  }
+
+  index.Clear();
+  EXPECT_TRUE(index.GetSize() == 0);
+  EXPECT_TRUE(index.Find(0, 0, 0, HIGHEST_QUALITY_RANKING) == NULL);
+  EXPECT_TRUE(index.GetLowQualityTiles().empty());
+}
+}  // namespace
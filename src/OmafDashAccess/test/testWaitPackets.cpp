@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file:   testWaitPackets.cpp
+//! \brief:  Batched packet waiting of the dash source unit test
+//!
+
+#include "gtest/gtest.h"
+#include "../OmafDashSource.h"
+#include "../OmafReaderManager.h"
+
+#include <chrono>
+#include <deque>
+#include <thread>
+
+VCD_USE_VROMAF;
+VCD_USE_VRVIDEO;
+
+namespace {
+// a dash source outputting the frames queued by the test, instead of reading segments
+class QueuedDashSource : public OmafDashSource {
+ public:
+  QueuedDashSource() {
+    mMapStream[0] = new OmafMediaStream();
+    OmafReaderManager::OmafReaderParams params;
+    omaf_reader_mgr_ = std::make_shared<OmafReaderManager>(nullptr, params);
+  }
+
+  virtual ~QueuedDashSource() {
+    for (auto& frame : m_frames) {
+      for (auto packet : frame) {
+        SAFE_DELETE(packet);
+      }
+    }
+  }
+
+  void QueueFrame(uint64_t pts, uint32_t packetsNum) {
+    std::list<MediaPacket*> frame;
+    for (uint32_t i = 0; i < packetsNum; i++) {
+      MediaPacket* packet = new MediaPacket();
+      packet->SetPTS(pts);
+      frame.push_back(packet);
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_framesMutex);
+      m_frames.push_back(frame);
+    }
+    omaf_reader_mgr_->NotifyPacketReady();
+  }
+
+  virtual int GetPacket(int streamID, std::list<MediaPacket*>* pkts, bool needParams, bool clearBuf) {
+    if (TakePendingPackets(streamID, pkts, needParams)) return ERROR_NONE;
+
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    if (m_frames.empty()) return ERROR_NONE;
+    pkts->splice(pkts->end(), m_frames.front());
+    m_frames.pop_front();
+    m_needParams.push_back(needParams);
+    return ERROR_NONE;
+  }
+
+  std::vector<bool> m_needParams;  //<! the needParams of each frame read
+
+ private:
+  std::mutex m_framesMutex;
+  std::deque<std::list<MediaPacket*>> m_frames;
+};
+
+class WaitPacketsTest : public testing::Test {
+ public:
+  virtual void SetUp() { m_source = new QueuedDashSource(); }
+
+  virtual void TearDown() {
+    ReleasePackets();
+    SAFE_DELETE(m_source);
+  }
+
+  void ReleasePackets() {
+    for (auto packet : m_pkts) {
+      SAFE_DELETE(packet);
+    }
+    m_pkts.clear();
+  }
+
+  QueuedDashSource* m_source;
+  std::list<MediaPacket*> m_pkts;
+};
+
+TEST_F(WaitPacketsTest, WholeFrames) {
+  m_source->QueueFrame(0, 3);
+  m_source->QueueFrame(1, 3);
+  m_source->QueueFrame(2, 3);
+
+  // the third frame doesn't fit in 8 packets, so it is kept for the next call
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 8, 0, true, false), ERROR_NONE);
+  ASSERT_EQ(m_pkts.size(), 6u);
+  EXPECT_EQ(m_pkts.front()->GetPTS(), 0u);
+  EXPECT_EQ(m_pkts.back()->GetPTS(), 1u);
+  // every frame is read with the params, not only the first one
+  ASSERT_EQ(m_source->m_needParams.size(), 3u);
+  EXPECT_TRUE(m_source->m_needParams[1]);
+  EXPECT_TRUE(m_source->m_needParams[2]);
+  ReleasePackets();
+
+  m_source->QueueFrame(3, 3);
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 8, 0, true, false), ERROR_NONE);
+  ASSERT_EQ(m_pkts.size(), 6u);
+  EXPECT_EQ(m_pkts.front()->GetPTS(), 2u);
+  EXPECT_EQ(m_pkts.back()->GetPTS(), 3u);
+}
+
+TEST_F(WaitPacketsTest, KeptFrameWithoutParams) {
+  m_source->QueueFrame(0, 3);
+  m_source->QueueFrame(1, 3);
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 4, 0, false, false), ERROR_NONE);
+  EXPECT_EQ(m_pkts.size(), 3u);
+  ReleasePackets();
+
+  // the kept frame was read without the params, so the next frame is read with them
+  m_source->QueueFrame(2, 3);
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 4, 0, true, false), ERROR_NONE);
+  ASSERT_EQ(m_pkts.size(), 3u);
+  EXPECT_EQ(m_pkts.front()->GetPTS(), 2u);
+  ASSERT_EQ(m_source->m_needParams.size(), 3u);
+  EXPECT_TRUE(m_source->m_needParams[2]);
+}
+
+TEST_F(WaitPacketsTest, DropOversizedFrame) {
+  m_source->QueueFrame(0, 10);
+  m_source->QueueFrame(1, 2);
+
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 8, 0, false, false), ERROR_NONE);
+  ASSERT_EQ(m_pkts.size(), 2u);
+  EXPECT_EQ(m_pkts.front()->GetPTS(), 1u);
+}
+
+TEST_F(WaitPacketsTest, Timeout) {
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 8, 50, false, false), ERROR_NULL_PACKET);
+  auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_GE(waitMs, 50);
+  EXPECT_TRUE(m_pkts.empty());
+
+  // a frame coming during the wait ends it before the timeout
+  std::thread producer([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    m_source->QueueFrame(0, 2);
+  });
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(m_source->WaitPackets(0, &m_pkts, 8, 5000, false, false), ERROR_NONE);
+  waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  producer.join();
+  EXPECT_LT(waitMs, 5000);
+  EXPECT_EQ(m_pkts.size(), 2u);
+
+  EXPECT_EQ(m_source->WaitPackets(1, &m_pkts, 8, 0, false, false), ERROR_INVALID);
+}
+}  // namespace
@@ -251,6 +251,11 @@ int32_t DashSegmenter::WriteSegment(VCD::MP4::SegmentList& aSegment)
     fclose(m_file);
     m_file = NULL;
 
+    if (m_config.keepSegmentData)
+    {
+        m_lastSegData = std::move(frameString);
+    }
+
     return ERROR_NONE;
 }
 
@@ -363,4 +368,93 @@ int32_t DashSegmenter::PackExtractors(
      return ERROR_NONE;
 }
 
+static void WriteUint32BE(std::string &out, uint32_t value)
+{
+    out.push_back((char)((value >> 24) & 0xFF));
+    out.push_back((char)((value >> 16) & 0xFF));
+    out.push_back((char)((value >> 8) & 0xFF));
+    out.push_back((char)(value & 0xFF));
+}
+
+DashPackedSegmenter::DashPackedSegmenter(const char *baseName)
+    : m_baseName(baseName ? baseName : "")
+{
+}
+
+DashPackedSegmenter::~DashPackedSegmenter()
+{
+    m_trackSegs.clear();
+}
+
+void DashPackedSegmenter::AddTrackSegment(VCD::MP4::TrackId trackId, const std::string *segData)
+{
+    m_trackSegs.push_back(std::make_pair(trackId.GetIndex(), segData));
+}
+
+int32_t DashPackedSegmenter::WritePackedSegment(uint64_t segNum)
+{
+    if (m_trackSegs.empty())
+        return OMAF_ERROR_INVALID_DATA;
+
+    uint32_t indexSize = PACKED_TILES_INDEX_HEADER_SIZE + PACKED_TILES_INDEX_ENTRY_SIZE * m_trackSegs.size();
+
+    // index box: size, type, version and flags, entry count, then
+    // track id, offset from segment start and size of each tile segment
+    std::string index;
+    index.reserve(indexSize);
+    WriteUint32BE(index, indexSize);
+    index.append(PACKED_TILES_INDEX_TYPE, 4);
+    WriteUint32BE(index, 0);
+    WriteUint32BE(index, (uint32_t)(m_trackSegs.size()));
+
+    uint64_t offset = indexSize;
+    for (auto &trackSeg : m_trackSegs)
+    {
+        if (!trackSeg.second)
+        {
+            m_trackSegs.clear();
+            return OMAF_ERROR_NULL_PTR;
+        }
+        if ((offset + trackSeg.second->size()) > UINT32_MAX)
+        {
+            OMAF_LOG(LOG_ERROR, "Packed segment is too large for 32 bits index !\n");
+            m_trackSegs.clear();
+            return OMAF_ERROR_INVALID_DATA;
+        }
+        WriteUint32BE(index, trackSeg.first);
+        WriteUint32BE(index, (uint32_t)offset);
+        WriteUint32BE(index, (uint32_t)(trackSeg.second->size()));
+        offset += trackSeg.second->size();
+    }
+
+    char segName[1024];
+    snprintf(segName, 1024, "%s.%ld.mp4", m_baseName.c_str(), segNum);
+    FILE *file = fopen(segName, "wb+");
+    if (!file)
+    {
+        m_trackSegs.clear();
+        return OMAF_ERROR_NULL_PTR;
+    }
+
+    fwrite(index.c_str(), 1, index.size(), file);
+    for (auto &trackSeg : m_trackSegs)
+    {
+        fwrite(trackSeg.second->c_str(), 1, trackSeg.second->size(), file);
+    }
+    fclose(file);
+    file = NULL;
+
+    m_trackSegs.clear();
+    m_segNum = segNum;
+
+    return ERROR_NONE;
+}
+
+void DashPackedSegmenter::RemovePackedSegment(uint64_t segNum)
+{
+    char segName[1024];
+    snprintf(segName, 1024, "%s.%ld.mp4", m_baseName.c_str(), segNum);
+    remove(segName);
+}
+
 VCD_NS_END
@@ -39,6 +39,8 @@
 #include <fstream>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "../isolib/dash_writer/SegmentWriter.h"
 #include "../isolib/dash_writer/AcquireTrackData.h"
@@ -198,6 +200,8 @@ struct GeneralSegConfig
 
     std::list<uint32_t> streamsIdx;
 
+    bool keepSegmentData = false; //!< keep the last written segment data for packing tile segments
+
     //std::shared_ptr<Log> log;
 
     char trackSegBaseName[1024];
@@ -636,6 +640,15 @@ public:
     //!
     uint64_t GetSegmentSize() { return m_segSize; };
 
+    //!
+    //! \brief  Get the data of last written segment, which is
+    //!         only kept when keepSegmentData is set in config
+    //!
+    //! \return const std::string&
+    //!         data of last written segment
+    //!
+    const std::string& GetLastSegmentData() { return m_lastSegData; };
+
 protected:
 
     //!
@@ -735,6 +748,84 @@ private:
     FILE                                                              *m_file = NULL;          //!< file pointer to write segments
     char                                                              m_segName[1024];           //!< segment file name string
     uint64_t                                                          m_segSize = 0;
+    std::string                                                       m_lastSegData;           //!< data of last written segment
+};
+
+//!
+//! \class DashPackedSegmenter
+//! \brief Define the operation of packing the data segments of all
+//!        tile tracks in one video stream into one segment. The
+//!        segment starts with a 'ptix' box which indexes the byte
+//!        range of each tile track segment, so that the client can
+//!        fetch only the selected tiles by range requests
+//!
+
+class DashPackedSegmenter
+{
+public:
+
+    //!
+    //! \brief  Copy Constructor
+    //!
+    //! \param  [in] baseName
+    //!         packed segment base name
+    //!
+    DashPackedSegmenter(const char *baseName);
+
+    //!
+    //! \brief  Destructor
+    //!
+    ~DashPackedSegmenter();
+
+    //!
+    //! \brief  Add the data segment of one tile track into
+    //!         current packed segment
+    //!
+    //! \param  [in] trackId
+    //!         the index of the tile track
+    //! \param  [in] segData
+    //!         pointer to the segment data of the tile track,
+    //!         which should be kept until the packed segment
+    //!         is written
+    //!
+    //! \return void
+    //!
+    void AddTrackSegment(VCD::MP4::TrackId trackId, const std::string *segData);
+
+    //!
+    //! \brief  Write the index and all added tile track segments
+    //!         into the packed segment
+    //!
+    //! \param  [in] segNum
+    //!         the segment number
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t WritePackedSegment(uint64_t segNum);
+
+    //!
+    //! \brief  Remove the specified packed segment file
+    //!
+    //! \param  [in] segNum
+    //!         the segment number
+    //!
+    //! \return void
+    //!
+    void RemovePackedSegment(uint64_t segNum);
+
+    //!
+    //! \brief  Get totally written packed segments number
+    //!
+    //! \return uint64_t
+    //!         totally written packed segments number
+    //!
+    uint64_t GetSegmentsNum() { return m_segNum; };
+
+private:
+    std::string                                                       m_baseName;              //!< packed segment base name
+    std::vector<std::pair<uint32_t, const std::string*>>              m_trackSegs;             //!< added tile track index and its segment data
+    uint64_t                                                          m_segNum = 0;            //!< written packed segments number
 };
 
 VCD_NS_END;
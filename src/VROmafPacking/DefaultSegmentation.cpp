@@ -84,6 +84,13 @@ DefaultSegmentation::~DefaultSegmentation()
     }
     m_streamSegCtx.clear();
 
+    std::map<MediaStream*, DashPackedSegmenter*>::iterator itPacked;
+    for (itPacked = m_packedSegmenters.begin(); itPacked != m_packedSegmenters.end(); itPacked++)
+    {
+        DELETE_MEMORY(itPacked->second);
+    }
+    m_packedSegmenters.clear();
+
     if (m_extractorSegCtx.size())
     {
         std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itExtractorCtx;
@@ -332,6 +339,7 @@ int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
                 trackSegCtxs[i].dashCfg.tracks.insert(std::make_pair(trackSegCtxs[i].trackIdx, trackMeta));
 
                 trackSegCtxs[i].dashCfg.useSeparatedSidx = false;
+                trackSegCtxs[i].dashCfg.keepSegmentData = m_segInfo->packTileSegments;
                 trackSegCtxs[i].dashCfg.streamsIdx.push_back(it->first);
                 snprintf(trackSegCtxs[i].dashCfg.trackSegBaseName, 1024, "%s%s_track%ld", m_segInfo->dirName, m_segInfo->outName, m_trackIdStarter + i);
 
@@ -442,6 +450,26 @@ int32_t DefaultSegmentation::ConstructTileTrackSegCtx()
                 m_trackSegCtx.insert(std::make_pair(trackSegCtxs[i].trackIdx, &(trackSegCtxs[i])));
             }
             m_trackIdStarter += tilesNum;
+
+            if (m_segInfo->packTileSegments)
+            {
+                char packedBaseName[1024];
+                snprintf(packedBaseName, 1024, "%s%s_packed%d", m_segInfo->dirName, m_segInfo->outName, qualityLevel);
+                DashPackedSegmenter *packedSegmenter = new DashPackedSegmenter(packedBaseName);
+                if (!packedSegmenter)
+                {
+                    for (uint32_t id = 0; id < tilesNum; id++)
+                    {
+                        DELETE_MEMORY(trackSegCtxs[id].initSegmenter);
+                        DELETE_MEMORY(trackSegCtxs[id].dashSegmenter);
+                    }
+
+                    DELETE_ARRAY(trackSegCtxs);
+                    return OMAF_ERROR_NULL_PTR;
+                }
+                m_packedSegmenters.insert(std::make_pair(stream, packedSegmenter));
+            }
+
             m_streamSegCtx.insert(std::make_pair(stream, trackSegCtxs));
             m_framesIsKey.insert(std::make_pair(stream, true));
             m_streamsIsEOS.insert(std::make_pair(stream, false));
@@ -856,6 +884,25 @@ int32_t DefaultSegmentation::WriteSegmentForEachVideo(MediaStream *stream, bool
 #endif
     }
 
+    // pack the new segments of all tile tracks into one indexed segment
+    std::map<MediaStream*, DashPackedSegmenter*>::iterator itPacked = m_packedSegmenters.find(stream);
+    if (itPacked != m_packedSegmenters.end())
+    {
+        DashPackedSegmenter *packedSegmenter = itPacked->second;
+        uint64_t tileSegNum = trackSegCtxs[0].dashSegmenter->GetSegmentsNum();
+        if (tileSegNum > packedSegmenter->GetSegmentsNum())
+        {
+            for (uint32_t tileIdx = 0; tileIdx < tilesNum; tileIdx++)
+            {
+                DashSegmenter *dashSegmenter = trackSegCtxs[tileIdx].dashSegmenter;
+                packedSegmenter->AddTrackSegment(trackSegCtxs[tileIdx].trackIdx, &(dashSegmenter->GetLastSegmentData()));
+            }
+            int32_t ret = packedSegmenter->WritePackedSegment(tileSegNum);
+            if (ret)
+                return ret;
+        }
+    }
+
     return ERROR_NONE;
 }
 
@@ -1652,6 +1699,11 @@ int32_t DefaultSegmentation::VideoSegmentation()
                         snprintf(rmFile, 1024, "%s%s_track%d.%d.mp4", m_segInfo->dirName, m_segInfo->outName, trackIndex.GetIndex(), removeCnt);
                         remove(rmFile);
                     }
+                    std::map<MediaStream*, DashPackedSegmenter*>::iterator itPacked;
+                    for (itPacked = m_packedSegmenters.begin(); itPacked != m_packedSegmenters.end(); itPacked++)
+                    {
+                        itPacked->second->RemovePackedSegment(removeCnt);
+                    }
                     if (m_extractorSegCtx.size())
                     {
                         std::map<ExtractorTrack*, TrackSegmentCtx*>::iterator itOneExtractorTrack;
@@ -425,6 +425,7 @@ private:
     uint64_t                                       m_currSegedFrmNum;    //!< newest number of frames which have been segmented for their tile tracks
     uint64_t                                       m_currProcessedFrmNum;//!< newest number of frames which have been segmented for both tiles tracks and extractor tracks
     bool                                           m_isMpdGenInit;       //!< flag for whether MPD generator has been initialized
+    std::map<MediaStream*, DashPackedSegmenter*>   m_packedSegmenters;   //!< map of video stream and its segmenter for packed tile segments
 };
 
 VCD_NS_END;
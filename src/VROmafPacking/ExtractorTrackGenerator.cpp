@@ -116,44 +116,24 @@ ExtractorTrackGenerator::~ExtractorTrackGenerator()
     DELETE_MEMORY(m_newPPSNalu);
     m_360scvpParam = NULL;
     m_360scvpHandle = NULL;
+    if (m_360scvpContext)
+    {
+        I360SCVP_DestroyContext(m_360scvpContext);
+        m_360scvpContext = NULL;
+    }
 }
 
 int32_t ExtractorTrackGenerator::SelectTilesInView(
-    float yaw, float pitch,
+    TileDef *selectedTiles, int32_t selectedTilesNum,
+    Param_ViewportOutput *paramViewport, CCDef *viewportCC,
     uint8_t tileInRow, uint8_t tileInCol)
 {
-    if (!m_360scvpParam || !m_360scvpHandle)
+    if (!selectedTiles || !paramViewport || !viewportCC)
     {
-        OMAF_LOG(LOG_ERROR, "360SCVP should be set up before selecting tiles based on viewport !\n");
+        OMAF_LOG(LOG_ERROR, "Tiles selected based on viewport should be set before layout !\n");
         return OMAF_ERROR_NULL_PTR;
     }
 
-    if ((yaw < -180.0) || (yaw > 180.0))
-    {
-        OMAF_LOG(LOG_ERROR, "Invalid yaw in selecting tiles based on viewport !\n");
-        return OMAF_ERROR_INVALID_DATA;
-    }
-
-    if ((pitch < -90.0) || (pitch > 90.0))
-    {
-        OMAF_LOG(LOG_ERROR, "Invalid pitch in selecting tiles based on viewport !\n");
-        return OMAF_ERROR_INVALID_DATA;
-    }
-
-    int32_t ret = I360SCVP_setViewPort(m_360scvpHandle, yaw, pitch);
-    if (ret)
-    {
-        OMAF_LOG(LOG_ERROR, "Failed to set viewport !\n");
-        return OMAF_ERROR_SCVP_SET_FAILED;
-    }
-
-    ret = I360SCVP_process(m_360scvpParam, m_360scvpHandle);
-    if (ret)
-    {
-        OMAF_LOG(LOG_ERROR, "Failed in 360SCVP process !\n");
-        return OMAF_ERROR_SCVP_PROCESS_FAILED;
-    }
-
     uint64_t totalTiles = tileInRow * tileInCol;
     TileDef *tilesInView = new TileDef[1024];
     if (!tilesInView)
@@ -164,18 +144,14 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
 
     memset(tilesInView, 0, 1024 * sizeof(TileDef));
 
-    Param_ViewportOutput paramViewport;
-    int32_t selectedTilesNum = 0;
-    selectedTilesNum = I360SCVP_getTilesInViewport(tilesInView, &paramViewport, m_360scvpHandle);
-
     #ifdef _USE_TRACE_
         tracepoint(bandwidth_tp_provider, tiles_selection_redundancy,
-            paramViewport.dstWidthNet,
-            paramViewport.dstHeightNet,
-            paramViewport.dstWidthAlignTile,
-            paramViewport.dstHeightAlignTile,
-            paramViewport.dstWidthAlignTile / (m_initInfo->viewportInfo)->viewportWidth,
-            paramViewport.dstHeightAlignTile / (m_initInfo->viewportInfo)->viewportHeight);
+            paramViewport->dstWidthNet,
+            paramViewport->dstHeightNet,
+            paramViewport->dstWidthAlignTile,
+            paramViewport->dstHeightAlignTile,
+            paramViewport->dstWidthAlignTile / (m_initInfo->viewportInfo)->viewportWidth,
+            paramViewport->dstHeightAlignTile / (m_initInfo->viewportInfo)->viewportHeight);
     #endif
 
     if ((selectedTilesNum <= 0) || ((uint64_t)(selectedTilesNum) > totalTiles))
@@ -185,6 +161,7 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
         tilesInView = NULL;
         return OMAF_ERROR_SCVP_INCORRECT_RESULT;
     }
+    memcpy_s(tilesInView, selectedTilesNum * sizeof(TileDef), selectedTiles, selectedTilesNum * sizeof(TileDef));
 
     uint32_t sqrtedSize = (uint32_t)sqrt(selectedTilesNum);
     while(sqrtedSize && (selectedTilesNum % sqrtedSize)) { sqrtedSize--; }
@@ -273,16 +250,7 @@ int32_t ExtractorTrackGenerator::SelectTilesInView(
         tilesInView = NULL;
         return OMAF_ERROR_NULL_PTR;
     }
-    ret = I360SCVP_getContentCoverage(m_360scvpHandle, outCC);
-    if (ret)
-    {
-        OMAF_LOG(LOG_ERROR, "Failed to calculate Content coverage information !\n");
-        delete [] tilesInView;
-        tilesInView = NULL;
-        delete outCC;
-        outCC = NULL;
-        return OMAF_ERROR_SCVP_INCORRECT_RESULT;
-    }
+    *outCC = *viewportCC;
 
     std::map<uint16_t, std::map<uint16_t, TileDef*>>::iterator it;
     it = m_middleSelection.find((uint16_t)selectedTilesNum);
@@ -609,20 +577,36 @@ int32_t ExtractorTrackGenerator::CalculateViewportNum()
 
     OMAF_LOG(LOG_INFO, "Yaw and Pitch steps for going through all viewports are %f and %f\n", m_yawStep, m_pitchStep);
 
-    m_360scvpHandle = I360SCVP_Init(m_360scvpParam);
+    // the handle is a session of a context kept by the generator, so the viewports
+    // of the batch threads below are copied from the context instead of being
+    // initialized one by one
+    if (!m_360scvpContext)
+    {
+        m_360scvpContext = I360SCVP_CreateContext(m_360scvpParam);
+        if (!m_360scvpContext)
+        {
+            OMAF_LOG(LOG_ERROR, "Failed to create 360SCVP context !\n");
+            return OMAF_ERROR_SCVP_INIT_FAILED;
+        }
+    }
+    m_360scvpHandle = I360SCVP_CreateSession(m_360scvpContext);
     if (!m_360scvpHandle)
     {
         OMAF_LOG(LOG_ERROR, "Failed to create 360SCVP handle !\n");
         return OMAF_ERROR_SCVP_INIT_FAILED;
     }
 
+    // select the tiles of all the viewports in one batch, then lay them out in order
+    std::vector<HeadPose> poses;
     for (float one_yaw = -180.0; one_yaw <= 180.0; )
     {
         for (float one_pitch = -90.0; one_pitch <= 90.0; )
         {
-            int ret = SelectTilesInView(one_yaw, one_pitch, tileInRow, tileInCol);
-            if (ret)
-                return ret;
+            HeadPose pose;
+            memset(&pose, 0, sizeof(HeadPose));
+            pose.yaw = one_yaw;
+            pose.pitch = one_pitch;
+            poses.push_back(pose);
 
             one_pitch += m_pitchStep;
         }
@@ -630,6 +614,34 @@ int32_t ExtractorTrackGenerator::CalculateViewportNum()
         one_yaw += m_yawStep;
     }
 
+    int32_t maxTilesNum = tileInRow * tileInCol;
+    std::vector<TileDef> tilesInViews(poses.size() * maxTilesNum);
+    std::vector<int32_t> tilesNums(poses.size());
+    std::vector<Param_ViewportOutput> viewportOutputs(poses.size());
+    std::vector<CCDef> viewportCCs(poses.size());
+    Param_TilesBatch tilesBatch;
+    tilesBatch.pPoses = poses.data();
+    tilesBatch.posesNum = (int32_t)poses.size();
+    tilesBatch.maxTilesNum = maxTilesNum;
+    tilesBatch.pTiles = tilesInViews.data();
+    tilesBatch.pTilesNum = tilesNums.data();
+    tilesBatch.pViewportOutputs = viewportOutputs.data();
+    tilesBatch.pContentCoverages = viewportCCs.data();
+    int32_t ret = I360SCVP_getTilesInViewportBatch(&tilesBatch, m_360scvpHandle);
+    if (ret)
+    {
+        OMAF_LOG(LOG_ERROR, "Failed to select tiles based on viewports !\n");
+        return OMAF_ERROR_SCVP_INCORRECT_RESULT;
+    }
+
+    for (uint32_t i = 0; i < poses.size(); i++)
+    {
+        ret = SelectTilesInView(&(tilesInViews[i * maxTilesNum]), tilesNums[i],
+            &(viewportOutputs[i]), &(viewportCCs[i]), tileInRow, tileInCol);
+        if (ret)
+            return ret;
+    }
+
     if (m_middleViewNum > 100)
     {
         OMAF_LOG(LOG_INFO, "Too many extractor tracks, now need to refine tiles selection!\n");
@@ -69,6 +69,7 @@ public:
         m_videoIdxInMedia = NULL;
         m_360scvpParam    = NULL;
         m_360scvpHandle   = NULL;
+        m_360scvpContext  = NULL;
         m_origResWidth    = 0;
         m_origResHeight   = 0;
         m_origTileInRow     = 0;
@@ -106,6 +107,7 @@ public:
         m_videoIdxInMedia = NULL;
         m_360scvpParam    = NULL;
         m_360scvpHandle   = NULL;
+        m_360scvpContext  = NULL;
         m_origResWidth    = 0;
         m_origResHeight   = 0;
         m_origTileInRow     = 0;
@@ -135,6 +137,7 @@ public:
         m_videoIdxInMedia = std::move(src.m_videoIdxInMedia);
         m_360scvpParam    = std::move(src.m_360scvpParam);
         m_360scvpHandle   = std::move(src.m_360scvpHandle);
+        m_360scvpContext  = NULL;
         m_origResWidth    = src.m_origResWidth;
         m_origResHeight   = src.m_origResHeight;
         m_origTileInRow     = src.m_origTileInRow;
@@ -164,6 +167,7 @@ public:
         m_videoIdxInMedia = NULL;
         m_360scvpParam    = NULL;
         m_360scvpHandle   = NULL;
+        m_360scvpContext  = NULL;
         m_origResWidth    = other.m_origResWidth;
         m_origResHeight   = other.m_origResHeight;
         m_origTileInRow     = other.m_origTileInRow;
@@ -235,8 +239,13 @@ public:
 
 private:
 
+    //!
+    //! \brief  Lay out the tiles selected for one viewport, and keep
+    //!         them as a new tiles selection if no same one exists
+    //!
     int32_t SelectTilesInView(
-        float yaw, float pitch,
+        TileDef *selectedTiles, int32_t selectedTilesNum,
+        Param_ViewportOutput *paramViewport, CCDef *viewportCC,
         uint8_t tileInRow, uint8_t tileInCol);
 
     //!
@@ -351,6 +360,7 @@ private:
     uint8_t                         *m_videoIdxInMedia;   //!< pointer to index of video streams in media streams
     param_360SCVP                   *m_360scvpParam;      //!< 360SCVP library initial parameter
     void                            *m_360scvpHandle;     //!< 360SCVP library handle
+    void                            *m_360scvpContext;    //!< 360SCVP library context the handle is a session of
     uint16_t                        m_origResWidth;       //!< frame width of high resolution video stream
     uint16_t                        m_origResHeight;      //!< frame height of high resolution video stream
     uint8_t                         m_origTileInRow;        //!< the number of high resolution tiles in one row in original picture
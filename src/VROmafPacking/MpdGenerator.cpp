@@ -180,7 +180,7 @@ int32_t MpdGenerator::Initialize()
     return ERROR_NONE;
 }
 
-int32_t MpdGenerator::WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx)
+int32_t MpdGenerator::WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx, uint32_t tilesNum)
 {
     TrackSegmentCtx trackSegCtx = *pTrackSegCtx;
 
@@ -225,6 +225,17 @@ int32_t MpdGenerator::WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *p
     essentialEle1->SetAttribute(OMAF_PACKINGTYPE, 0);
     asEle->InsertEndChild(essentialEle1);
 
+    if (m_segInfo->packTileSegments)
+    {
+        // packed segment of all tiles in the same video, and its index entries number
+        XMLElement *packedEle = m_xmlDoc->NewElement(SUPPLEMENTALPROPERTY);
+        packedEle->SetAttribute(SCHEMEIDURI, SCHEMEIDURI_PACKED_TILES);
+        memset_s(string, 1024, 0);
+        snprintf(string, 1024, "%s_packed%d.$Number$.mp4,%d", m_segInfo->outName, trackSegCtx.qualityRanking, tilesNum);
+        packedEle->SetAttribute(COMMON_VALUE, string);
+        asEle->InsertEndChild(packedEle);
+    }
+
     XMLElement *representationEle = m_xmlDoc->NewElement(REPRESENTATION);
     memset_s(string, 1024, 0);
     snprintf(string, 1024, "%s_track%d", m_segInfo->outName, trackSegCtx.trackIdx.GetIndex());
@@ -707,7 +718,7 @@ int32_t MpdGenerator::WriteMpd(uint64_t totalFramesNum)
             TrackSegmentCtx *trackSegCtxs = itTrackCtx->second;
             for (uint32_t i = 0; i < tilesNum; i++)
             {
-                WriteTileTrackAS(periodEle, &(trackSegCtxs[i]));
+                WriteTileTrackAS(periodEle, &(trackSegCtxs[i]), tilesNum);
             }
         }
         else if (stream && (stream->GetMediaType() == AUDIOTYPE))
@@ -139,11 +139,14 @@ private:
     //!         mpd file using tinyxml2
     //! \param  [in] pTrackSegCtx
     //!         pointer to track segmentation context for tile track
+    //! \param  [in] tilesNum
+    //!         tiles number of the video the tile track belongs to,
+    //!         which is the entries number of the packed segment index
     //!
     //! \return int32_t
     //!         ERROR_NONE if success, else failed reason
     //!
-    int32_t WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx);
+    int32_t WriteTileTrackAS(XMLElement *periodEle, TrackSegmentCtx *pTrackSegCtx, uint32_t tilesNum);
 
     //!
     //! \brief  Write AdaptationSet for audio track in mpd file
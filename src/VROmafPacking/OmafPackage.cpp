@@ -37,6 +37,7 @@
 #include "VideoStreamPluginAPI.h"
 #include "AudioStreamPluginAPI.h"
 #include "DefaultSegmentation.h"
+#include "AsyncLog.h"
 
 VCD_NS_BEGIN
 
@@ -49,6 +50,7 @@ OmafPackage::OmafPackage()
     m_videoThreadId = 0;
     m_hasAudio = false;
     m_audioThreadId = 0;
+    m_asyncLog = false;
 }
 
 OmafPackage::OmafPackage(const OmafPackage& src)
@@ -60,6 +62,7 @@ OmafPackage::OmafPackage(const OmafPackage& src)
     m_videoThreadId = src.m_videoThreadId;
     m_hasAudio      = src.m_hasAudio;
     m_audioThreadId = src.m_audioThreadId;
+    m_asyncLog = false;
 }
 
 OmafPackage& OmafPackage::operator=(OmafPackage&& other)
@@ -71,6 +74,8 @@ OmafPackage& OmafPackage::operator=(OmafPackage&& other)
     m_videoThreadId = other.m_videoThreadId;
     m_hasAudio      = other.m_hasAudio;
     m_audioThreadId = other.m_audioThreadId;
+    m_asyncLog = other.m_asyncLog;
+    other.m_asyncLog = false;
 
     return *this;
 }
@@ -87,6 +92,12 @@ OmafPackage::~OmafPackage()
         pthread_join(m_audioThreadId, NULL);
     }
 
+    if (m_asyncLog)
+    {
+        m_asyncLog = false;
+        StopAsyncLog();
+    }
+
     DELETE_MEMORY(m_segmentation);
     DELETE_MEMORY(m_extractorTrackMan);
 
@@ -418,6 +429,33 @@ int32_t OmafPackage::SetLogCallBack(LogFunction logFunction)
     return ERROR_NONE;
 }
 
+int32_t OmafPackage::SetLogLevel(LogLevel minLevel, bool enableAsync)
+{
+    if (minLevel < LOG_INFO || minLevel > LOG_FATAL)
+        return OMAF_ERROR_INVALID_DATA;
+
+    logMinLevel = minLevel;
+
+    // the customized logging callback is always called synchronously
+    if (enableAsync && !m_asyncLog && (logCallBack == GlogFunction || logCallBack == AsyncLogFunction))
+    {
+        int32_t ret = StartAsyncLog(0);
+        if (ret)
+            return ret;
+
+        m_asyncLog = true;
+        logCallBack = AsyncLogFunction;
+    }
+    else if (!enableAsync && m_asyncLog)
+    {
+        // other packages may still log asynchronously, only the own start is released
+        m_asyncLog = false;
+        StopAsyncLog();
+    }
+
+    return ERROR_NONE;
+}
+
 int32_t OmafPackage::SetFrameInfo(uint8_t streamIdx, FrameBSInfo *frameInfo)
 {
     MediaStream *stream = m_streams[streamIdx];
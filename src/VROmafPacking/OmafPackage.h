@@ -89,6 +89,20 @@ public:
     //!
     int32_t SetLogCallBack(LogFunction logFunction);
 
+    //!
+    //! \brief  Set the logging level and the asynchronous logging
+    //!
+    //! \param  [in] minLevel
+    //!         the logging calls below this level are skipped
+    //! \param  [in] enableAsync
+    //!         whether the default glog output is formatted on
+    //!         a background thread
+    //!
+    //! \return int32_t
+    //!         ERROR_NONE if success, else failed reason
+    //!
+    int32_t SetLogLevel(LogLevel minLevel, bool enableAsync);
+
     //!
     //! \brief  Packet the specified media stream
     //!
@@ -200,6 +214,7 @@ private:
     pthread_t                       m_videoThreadId;           //!< thread index of video segmentation thread
     bool                            m_hasAudio;
     pthread_t                       m_audioThreadId;           //!< thread index of audio segmentation thread
+    bool                            m_asyncLog;                //!< whether this package holds one start of the asynchronous logging
 };
 
 VCD_NS_END;
@@ -73,6 +73,25 @@ Handler VROmafPackingInit(InitialInfo *initInfo);
 //!
 int32_t VROmafPackingSetLogCallBack(Handler hdl, void* externalLog);
 
+//!
+//! \brief  VR OMAF Packing library set the logging level. The
+//!         logging calls below the level are skipped before
+//!         their arguments are evaluated. The default glog
+//!         output can be formatted on a background thread
+//!
+//! \param  [in] hdl
+//!         VR OMAF Packing library handle
+//! \param  [in] minLevel
+//!         the minimal LogLevel to output
+//! \param  [in] enableAsync
+//!         whether the glog output is asynchronous, it has
+//!         no effect on the customized logging callback
+//!
+//! \return int32_t
+//!         ERROR_NONE if success, else failed reason
+//!
+int32_t VROmafPackingSetLogLevel(Handler hdl, int32_t minLevel, bool enableAsync);
+
 //!
 //! \brief  VR OMAF Packing library writes segment for specified
 //!         media stream, called when one new frame is needed to
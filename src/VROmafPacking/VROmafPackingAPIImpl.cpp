@@ -76,6 +76,15 @@ int32_t VROmafPackingSetLogCallBack(Handler hdl, void* externalLog)
     return ERROR_NONE;
 }
 
+int32_t VROmafPackingSetLogLevel(Handler hdl, int32_t minLevel, bool enableAsync)
+{
+    OmafPackage *omafPackage = (OmafPackage*)hdl;
+    if (!omafPackage)
+        return OMAF_ERROR_NULL_PTR;
+
+    return omafPackage->SetLogLevel((LogLevel)minLevel, enableAsync);
+}
+
 int32_t VROmafPackingWriteSegment(Handler hdl, uint8_t streamIdx, FrameBSInfo *frameInfo)
 {
     OmafPackage *omafPackage = (OmafPackage*)hdl;
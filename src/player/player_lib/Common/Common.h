@@ -57,4 +57,23 @@ extern "C"
 #define SAFE_FREE(x)   if(NULL != (x)) { free((x));    (x)=NULL; };
 #define SAFE_DELETE_ARRAY(x) if(NULL != (x)) { delete [] (x); (x)=NULL; };
 
+//!
+//! \brief  free the region wise packing and source resolutions of a packet or frame, they are
+//!         a reference to the metadata shared across packets if meta is set, else owned copies
+//!
+inline void ReleaseRegionInfo(RegionWisePacking *&rwpk, SourceResolution *&qtyResolution, DashPacketMeta *&meta)
+{
+    if (NULL != meta)
+    {
+        meta->release(meta);
+        meta = NULL;
+        rwpk = NULL;
+        qtyResolution = NULL;
+        return;
+    }
+    if (NULL != rwpk) SAFE_DELETE_ARRAY(rwpk->rectRegionPacking);
+    SAFE_DELETE(rwpk);
+    SAFE_DELETE_ARRAY(qtyResolution);
+}
+
 #endif /* _COMMON_H_ */
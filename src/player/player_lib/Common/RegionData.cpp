@@ -40,8 +40,17 @@
 
 VCD_NS_BEGIN
 
-RegionData::RegionData(RegionWisePacking* rwpk, uint32_t sourceNumber, SourceResolution* qtyRes) {
+RegionData::RegionData(RegionWisePacking* rwpk, uint32_t sourceNumber, SourceResolution* qtyRes, DashPacketMeta* meta) {
   m_sourceInRegion = sourceNumber;
+  m_packetMeta = meta;
+
+  if (m_packetMeta != NULL) {
+    // the metadata is immutable, so sharing it replaces the copy
+    m_packetMeta->retain(m_packetMeta);
+    m_regionWisePacking = rwpk;
+    m_sourceInfo = qtyRes;
+    return;
+  }
 
   m_regionWisePacking = new RegionWisePacking;
   *m_regionWisePacking = *rwpk;
@@ -61,6 +70,13 @@ RegionData::RegionData(RegionWisePacking* rwpk, uint32_t sourceNumber, SourceRes
 
 RegionData::~RegionData() {
   m_sourceInRegion = 0;
+  if (m_packetMeta != NULL) {
+    m_packetMeta->release(m_packetMeta);
+    m_packetMeta = NULL;
+    m_regionWisePacking = NULL;
+    m_sourceInfo = NULL;
+    return;
+  }
   if (m_regionWisePacking != NULL) {
     if (m_regionWisePacking->rectRegionPacking != NULL) {
       delete[] m_regionWisePacking->rectRegionPacking;
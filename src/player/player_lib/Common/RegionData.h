@@ -53,8 +53,13 @@ public:
         m_sourceInRegion = 0;
         m_regionWisePacking = NULL;
         m_sourceInfo = NULL;
+        m_packetMeta = NULL;
     };
-    RegionData(RegionWisePacking* rwpk, uint32_t sourceNumber, SourceResolution* qtyRes);
+    //!
+    //! \brief  construct with a copy of rwpk and qtyRes, or with a reference
+    //!         to the shared metadata they point into if meta is set
+    //!
+    RegionData(RegionWisePacking* rwpk, uint32_t sourceNumber, SourceResolution* qtyRes, DashPacketMeta* meta = NULL);
     //!
     //! \brief  de-construct
     //!
@@ -67,6 +72,8 @@ public:
 
     SourceResolution* GetSourceInfo() { return m_sourceInfo; }
 
+    DashPacketMeta* GetPacketMeta() { return m_packetMeta; }
+
 private:
     RegionData& operator=(const RegionData& other) { return *this; };
     RegionData(const RegionData& other) { /* do not create copies */ };
@@ -76,6 +83,7 @@ private:
     uint32_t m_sourceInRegion;
     RegionWisePacking *m_regionWisePacking;
     SourceResolution *m_sourceInfo;
+    DashPacketMeta *m_packetMeta;    //! the reference held if the region info is shared, else NULL
 };
 
 VCD_NS_END;
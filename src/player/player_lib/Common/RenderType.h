@@ -44,6 +44,10 @@
 #endif
 #include "ns_def.h"
 
+VCD_NS_BEGIN
+class PooledFrame;
+VCD_NS_END
+
 typedef bool bool_t;
 typedef char char_t;
 typedef char utf8_t;
@@ -298,6 +302,28 @@ struct BufferInfo {
   bool bFormatChange;
   VCD::VRVideo::RegionData *regionInfo;
   uint64_t pts;
+  VCD::VRVideo::PooledFrame *frameRef;  //! owner of the buffers, valid during FrameHandler::process unless borrowed
+};
+
+struct DecodeMetrics {
+  uint32_t videoId;
+  uint32_t packetQueueDepth;  // coded packets waiting for decoding
+  uint32_t frameQueueDepth;   // decoded frames waiting for rendering
+  uint64_t decodedFrames;
+  uint64_t lastDecodeTime;    // us
+  uint64_t avgDecodeTime;     // us
+  uint64_t maxDecodeTime;     // us
+};
+
+struct FrameSyncMetrics {
+  uint64_t presentedFrames;
+  uint64_t partialFrames;     // presented without the streams that were late
+  uint64_t skippedFrames;     // pts given up because no stream could provide it
+  uint64_t lateTiles;         // tiles dropped from partial frames
+  uint32_t pendingFrames;     // pts with packets sent but not presented yet
+  uint64_t lastLatency;       // ms from packet arrival to frame update
+  uint64_t avgLatency;        // ms
+  uint64_t maxLatency;        // ms
 };
 
 struct MultiBufferInfo {
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     DecodeScheduler.cpp
+//! \brief    Implement class for DecodeScheduler.
+//!
+
+#ifdef _LINUX_OS_
+
+#include "DecodeScheduler.h"
+
+VCD_NS_BEGIN
+
+DecodeScheduler::DecodeScheduler()
+{
+    mCodecThreadNum = 1;
+    mStop           = false;
+}
+
+DecodeScheduler::~DecodeScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWorkReady.notify_all();
+    for (auto &worker : mWorkers)
+    {
+        worker.join();
+    }
+    mWorkers.clear();
+    mDecoders.clear();
+}
+
+RenderStatus DecodeScheduler::Initialize(uint32_t workerNum)
+{
+    if (!mWorkers.empty()) return RENDER_ERROR;
+
+    uint32_t coreNum = std::thread::hardware_concurrency();
+    if (0 == coreNum) coreNum = 1;
+    if (0 == workerNum)
+    {
+        workerNum = coreNum < MAX_DECODE_WORKER_NUM ? coreNum : MAX_DECODE_WORKER_NUM;
+    }
+    // split the cores between the workers and the slice/frame threads of each codec
+    mCodecThreadNum = coreNum / workerNum;
+    if (0 == mCodecThreadNum) mCodecThreadNum = 1;
+
+    for (uint32_t i = 0; i < workerNum; i++)
+    {
+        mWorkers.push_back(std::thread(&DecodeScheduler::WorkerLoop, this));
+    }
+    LOG(INFO) << "Decode scheduler starts " << workerNum << " workers, " << mCodecThreadNum << " threads per codec" << std::endl;
+    return RENDER_STATUS_OK;
+}
+
+void DecodeScheduler::Register(ScheduledDecoder *decoder)
+{
+    if (NULL == decoder) return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mDecoders.find(decoder) == mDecoders.end())
+    {
+        DecoderState state = { false, false };
+        mDecoders[decoder] = state;
+    }
+}
+
+void DecodeScheduler::Unregister(ScheduledDecoder *decoder)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto it = mDecoders.find(decoder);
+    if (it == mDecoders.end()) return;
+
+    mStepDone.wait(lock, [this, decoder] { return !mDecoders[decoder].running; });
+    mDecoders.erase(decoder);
+}
+
+void DecodeScheduler::Notify(ScheduledDecoder *decoder)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mDecoders.find(decoder);
+        if (it == mDecoders.end()) return;
+        it->second.queued = true;
+    }
+    mWorkReady.notify_one();
+}
+
+ScheduledDecoder* DecodeScheduler::PickDecoder()
+{
+    ScheduledDecoder *picked = NULL;
+    uint64_t pickedDeadline = 0;
+    int32_t pickedPriority = 0;
+    for (auto &it : mDecoders)
+    {
+        if (!it.second.queued || it.second.running) continue;
+
+        uint64_t deadline = it.first->GetDeadline();
+        int32_t priority = it.first->GetPriority();
+        if (NULL == picked || deadline < pickedDeadline ||
+            (deadline == pickedDeadline && priority < pickedPriority))
+        {
+            picked = it.first;
+            pickedDeadline = deadline;
+            pickedPriority = priority;
+        }
+    }
+    return picked;
+}
+
+void DecodeScheduler::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mStop)
+    {
+        ScheduledDecoder *decoder = PickDecoder();
+        if (NULL == decoder)
+        {
+            mWorkReady.wait(lock);
+            continue;
+        }
+        DecoderState &state = mDecoders[decoder];
+        state.queued  = false;
+        state.running = true;
+
+        lock.unlock();
+        bool hasMore = decoder->DecodeStep();
+        lock.lock();
+
+        // the decoder can not be unregistered while it is running
+        DecoderState &doneState = mDecoders[decoder];
+        doneState.running = false;
+        if (hasMore)
+        {
+            doneState.queued = true;
+        }
+        if (doneState.queued)
+        {
+            mWorkReady.notify_one();
+        }
+        mStepDone.notify_all();
+    }
+}
+
+VCD_NS_END
+#endif // _LINUX_OS_
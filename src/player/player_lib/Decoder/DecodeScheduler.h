@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     DecodeScheduler.h
+//! \brief    Defines class for DecodeScheduler which runs all active video
+//!           decoders on one shared pool of worker threads.
+//!
+
+#ifdef _LINUX_OS_
+
+#ifndef _DECODESCHEDULER_H_
+#define _DECODESCHEDULER_H_
+
+#include "../Common/Common.h"
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define MAX_DECODE_WORKER_NUM 4
+
+VCD_NS_BEGIN
+
+//!
+//! \class  ScheduledDecoder
+//! \brief  Interface of a decoder driven by DecodeScheduler
+//!
+class ScheduledDecoder
+{
+public:
+     ScheduledDecoder()=default;
+     virtual ~ScheduledDecoder()=default;
+
+     //!
+     //! \brief  run one decoding step on the calling worker, never blocks on input
+     //!
+     //! \return bool
+     //!         true if there is more work to do right now
+     //!
+     virtual bool DecodeStep()=0;
+
+     //!
+     //! \brief  deadline of the next step, it is the pts of the oldest pending packet
+     //!
+     virtual uint64_t GetDeadline()=0;
+
+     //!
+     //! \brief  priority among decoders with the same deadline, smaller is more important
+     //!
+     virtual int32_t GetPriority()=0;
+};
+
+//!
+//! \class  DecodeScheduler
+//! \brief  Dispatches decoding steps of registered decoders to a fixed number of
+//!         workers. The ready decoder with the earliest deadline is run first,
+//!         ties are broken by priority, so the high quality viewport stream of a
+//!         frame is decoded before the low resolution background. One decoder is
+//!         never run by two workers at the same time.
+//!
+class DecodeScheduler
+{
+public:
+     DecodeScheduler();
+     ~DecodeScheduler();
+
+     //!
+     //! \brief  start the workers
+     //!
+     //! \param  [in] workerNum: number of workers, 0 to derive it from the number of cores
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus Initialize(uint32_t workerNum);
+
+     //!
+     //! \brief  add a decoder to be scheduled
+     //!
+     void Register(ScheduledDecoder *decoder);
+
+     //!
+     //! \brief  remove a decoder, waiting for its running step to finish
+     //!
+     void Unregister(ScheduledDecoder *decoder);
+
+     //!
+     //! \brief  tell the scheduler that a decoder has work, e.g. a new packet
+     //!
+     void Notify(ScheduledDecoder *decoder);
+
+     //!
+     //! \brief  number of threads each codec context should use beside the workers
+     //!
+     uint32_t GetCodecThreadNumber() { return mCodecThreadNum; };
+
+     uint32_t GetWorkerNumber() { return mWorkers.size(); };
+
+private:
+     DecodeScheduler& operator=(const DecodeScheduler& other) { return *this; };
+     DecodeScheduler(const DecodeScheduler& other) { /* do not create copies */ };
+
+     void WorkerLoop();
+
+     //!
+     //! \brief  pick the most urgent ready decoder, must be called with mMutex held
+     //!
+     ScheduledDecoder* PickDecoder();
+
+     struct DecoderState {
+          bool queued;    //!< has work to do
+          bool running;   //!< a worker is running its step
+     };
+
+private:
+     std::map<ScheduledDecoder*, DecoderState> mDecoders;
+     std::vector<std::thread>                  mWorkers;
+     uint32_t                                  mCodecThreadNum;
+     bool                                      mStop;
+     std::mutex                                mMutex;
+     std::condition_variable                   mWorkReady;
+     std::condition_variable                   mStepDone;
+};
+
+VCD_NS_END
+
+#endif /* _DECODESCHEDULER_H_ */
+#endif // _LINUX_OS_
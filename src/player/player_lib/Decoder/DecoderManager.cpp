@@ -32,10 +32,14 @@
 //!
 
 #include <stdio.h>
+#include <chrono>
 #include "DecoderManager.h"
 #include "VideoDecoder.h"
 #include "VideoDecoder_hw.h"
 #include "AudioDecoder.h"
+#ifdef _LINUX_OS_
+#include "DecodeScheduler.h"
+#endif
 #ifndef _ANDROID_OS_
 #ifdef _USE_TRACE_
 #include "../../../trace/MtHQ_tp.h"
@@ -45,6 +49,11 @@ VCD_NS_BEGIN
 
 #define MAX_DECODER_NUM 5
 
+static uint64_t GetCurrentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 DecoderManager::DecoderManager()
 {
     m_handlerFactory = NULL;
@@ -53,6 +62,15 @@ DecoderManager::DecoderManager()
     m_surfaces.resize(MAX_DECODER_NUM);
     m_textures.resize(MAX_DECODER_NUM);
     memset_s(&m_decodeInfo, sizeof(m_decodeInfo), 0);
+    m_scheduler = NULL;
+#ifdef _LINUX_OS_
+    m_scheduler = new DecodeScheduler();
+    if (RENDER_STATUS_OK != m_scheduler->Initialize(0))
+    {
+        LOG(ERROR) << "Failed to start decode scheduler, decoders will run in their own threads!" << endl;
+        SAFE_DELETE(m_scheduler);
+    }
+#endif
 }
 
 DecoderManager::~DecoderManager()
@@ -65,6 +83,9 @@ DecoderManager::~DecoderManager()
     {
         SAFE_DELETE(it->second);
     }
+#ifdef _LINUX_OS_
+    SAFE_DELETE(m_scheduler);
+#endif
 }
 
 RenderStatus DecoderManager::Initialize(FrameHandlerFactory* factory)
@@ -82,6 +103,7 @@ RenderStatus DecoderManager::CreateVideoDecoder(uint32_t video_id, Codec_Type vi
 {
 #ifdef _LINUX_OS_
     VideoDecoder* pDecoder = new VideoDecoder();
+    pDecoder->SetScheduler(m_scheduler);
 #endif
 #ifdef _ANDROID_OS_
     VideoDecoder_hw* pDecoder = new VideoDecoder_hw();
@@ -166,19 +188,19 @@ RenderStatus DecoderManager::CheckVideoDecoders(DashPacket* packets, uint32_t cn
 
 RenderStatus DecoderManager::SendVideoPackets( DashPacket* packets, uint32_t cnt )
 {
-    static uint64_t currentPts = 0;//for case test
     RenderStatus ret = RENDER_STATUS_OK;
+    if (0 == cnt) return RENDER_STATUS_OK;
 
-    ret = CheckVideoDecoders(packets, cnt, currentPts);
+    ret = CheckVideoDecoders(packets, cnt, packets[0].pts);
     if(RENDER_STATUS_OK!=ret) return ret;
 
+    uint64_t now = GetCurrentTimeMs();
     for(int i=0; i<cnt; i++){
-        packets[i].pts = currentPts;
+        m_frameAssembler.AddPacket(packets[i].pts, packets[i].segID, packets[i].videoID, now);
         ScopeLock lock(m_mapDecoderLock);
         m_mapVideoDecoder[packets[i].videoID]->SendPacket(&(packets[i]));
-        LOG(INFO)<<"send packet to video "<<packets[i].videoID<<" and pts is : "<<currentPts<<endl;
+        LOG(INFO)<<"send packet to video "<<packets[i].videoID<<" and pts is : "<<packets[i].pts<<endl;
     }
-    currentPts++;
     return RENDER_STATUS_OK;
 }
 
@@ -204,17 +226,38 @@ RenderStatus DecoderManager::UpdateVideoFrame( uint32_t video_id, uint64_t pts )
     return ret;
 }
 
-RenderStatus DecoderManager::UpdateVideoFrames( uint64_t pts )
+RenderStatus DecoderManager::UpdateVideoFrames( uint64_t renderPts )
 {
     RenderStatus ret = RENDER_STATUS_OK;
     uint32_t errorCnt = 0;
+    uint64_t pts = 0;
     ScopeLock lock(m_mapDecoderLock);
-    if (m_mapVideoDecoder.size() == 0 || !IsReady(pts))
+    if (m_mapVideoDecoder.size() == 0 || !m_frameAssembler.GetMediaPts(renderPts, &pts))
     {
         ret = RENDER_NO_FRAME;
         LOG(INFO)<<"There is no valid decoder for now!"<<endl;
         return ret;
     }
+    std::set<uint32_t> readyIds;
+    std::vector<uint32_t> lateIds;
+    GetReadyDecoders(pts, readyIds);
+    uint64_t now = GetCurrentTimeMs();
+    AssembleResult result = m_frameAssembler.Check(pts, readyIds, now, &lateIds);
+    if (ASSEMBLE_HOLD == result)
+    {
+        LOG(INFO)<<"Frame at pts " << pts << " is held back for " << lateIds.size() << " late videos" <<endl;
+        return RENDER_NO_FRAME;
+    }
+    if (ASSEMBLE_SKIP == result)
+    {
+        LOG(WARNING)<<"No video can provide frame at pts " << pts << ", skip it!" <<endl;
+        m_frameAssembler.Presented(pts, result, 0, now);
+        return RENDER_STATUS_OK;
+    }
+    for (auto id : lateIds)
+    {
+        LOG(INFO)<<"Video "<< id <<" is late at pts " << pts << ", drop its tile from the frame" <<endl;
+    }
     for(auto it=m_mapVideoDecoder.begin(); it!=m_mapVideoDecoder.end(); it++){
         ret = UpdateVideoFrame(it->first, pts);
         if( ret == RENDER_NO_FRAME ){
@@ -230,11 +273,13 @@ RenderStatus DecoderManager::UpdateVideoFrames( uint64_t pts )
     if (errorCnt == m_mapVideoDecoder.size()) // all decoder are error!
     {
         ret = RENDER_NO_FRAME;
+        result = ASSEMBLE_SKIP;
     }
     else
     {
         ret = RENDER_STATUS_OK;
     }
+    m_frameAssembler.Presented(pts, result, lateIds.size(), now);
     // delete IDLE decoder.
     for(auto it=m_mapVideoDecoder.begin(); it!=m_mapVideoDecoder.end(); ){
         if (it->second == NULL){
@@ -255,6 +300,22 @@ RenderStatus DecoderManager::UpdateVideoFrames( uint64_t pts )
     return ret;
 }
 
+RenderStatus DecoderManager::GetDecodeMetrics(std::vector<DecodeMetrics> &metrics)
+{
+    ScopeLock lock(m_mapDecoderLock);
+    metrics.clear();
+    for (auto it = m_mapVideoDecoder.begin(); it != m_mapVideoDecoder.end(); it++)
+    {
+        DecodeMetrics decoderMetrics;
+        memset_s(&decoderMetrics, sizeof(decoderMetrics), 0);
+        if (NULL != it->second && RENDER_STATUS_OK == it->second->GetMetrics(&decoderMetrics))
+        {
+            metrics.push_back(decoderMetrics);
+        }
+    }
+    return RENDER_STATUS_OK;
+}
+
 RenderStatus DecoderManager::ResetDecoders()
 {
     RenderStatus ret =  RENDER_STATUS_OK;
@@ -37,12 +37,16 @@
 #include "MediaDecoder.h"
 #include "FrameHandler.h"
 #include "FrameHandlerFactory.h"
+#include "FrameAssembler.h"
 #include "../../../utils/Threadable.h"
 #include <map>
 #include <vector>
+#include <set>
 
 VCD_NS_BEGIN
 
+class DecodeScheduler;
+
 class DecoderManager{
 public:
      DecoderManager();
@@ -93,13 +97,15 @@ public:
      RenderStatus UpdateVideoFrame( uint32_t video_id, uint64_t pts );
 
      //!
-     //! \brief  reset the decoder when decoding information changes
+     //! \brief  update the frame of all video streams at one pts. Streams still
+     //!         decoding hold the frame back for a short while, after that the
+     //!         frame is updated without them.
      //!
-     //! \param  [in] struct RenderConfig
-     //!         render Configuration
+     //! \param  [in] pts: frame count of render loop, mapped to media pts from
+     //!         the first packet sent
      //!
      //! \return RenderStatus
-     //!         RENDER_STATUS_OK if success, else fail reason
+     //!         RENDER_STATUS_OK if success, RENDER_NO_FRAME if the frame is held back
      //!
      RenderStatus UpdateVideoFrames( uint64_t pts );
 
@@ -131,24 +137,40 @@ public:
           return ret;
      };
 
-     bool IsReady(uint64_t pts)
+     //!
+     //! \brief  get decode time and queue depth statistics of every video decoder
+     //!
+     //! \param  [out] metrics: one entry per active video stream
+     //!
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus GetDecodeMetrics(std::vector<DecodeMetrics> &metrics);
+
+     //!
+     //! \brief  get glass-to-glass latency and late stream statistics of updated frames
+     //!
+     //! \param  [out] metrics: the statistics
+     //!
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus GetFrameSyncMetrics(struct FrameSyncMetrics *metrics) { return m_frameAssembler.GetMetrics(metrics); };
+
+     //!
+     //! \brief  collect the video streams that need no more waiting for pts
+     //!
+     void GetReadyDecoders(uint64_t pts, std::set<uint32_t> &readyIds)
      {
-          bool isReadyStatus = true;
-          if (m_mapVideoDecoder.empty())
-          {
-               return false;
-          }
+          readyIds.clear();
           for (auto it = m_mapVideoDecoder.begin(); it != m_mapVideoDecoder.end(); it++)
           {
                MediaDecoder* decoder = it->second;
-               if (!decoder->IsReady(pts))
+               if (decoder && decoder->IsFrameReady(pts))
                {
-                    LOG(INFO)<<"decoder is not ready!"<<std::endl;
-                    isReadyStatus = false;
-                    break;
+                    readyIds.insert(it->first);
                }
           }
-          return isReadyStatus;
      }
 
 private:
@@ -164,6 +186,8 @@ private:
     std::vector<void*>                  m_surfaces;
     std::vector<uint32_t>               m_textures;
     DecodeInfo                          m_decodeInfo;
+    DecodeScheduler*                    m_scheduler;       //! shared workers running all video decoders
+    FrameAssembler                      m_frameAssembler;  //! groups decoded frames of all streams by pts
 };
 
 VCD_NS_END
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     FrameAssembler.cpp
+//! \brief    Implement class for FrameAssembler.
+//!
+
+#include "FrameAssembler.h"
+
+VCD_NS_BEGIN
+
+FrameAssembler::FrameAssembler()
+{
+    mHoldTimeout = FRAME_SYNC_HOLD_TIMEOUT;
+    Reset();
+}
+
+FrameAssembler::~FrameAssembler()
+{
+    ScopeLock lock(mLock);
+    mSlots.clear();
+}
+
+void FrameAssembler::Reset()
+{
+    ScopeLock lock(mLock);
+    mSlots.clear();
+    mHasBase         = false;
+    mBasePts         = 0;
+    mPresentedAny    = false;
+    mCheckPts        = UINT64_MAX;
+    mCheckStart      = 0;
+    mPresentedFrames = 0;
+    mPartialFrames   = 0;
+    mSkippedFrames   = 0;
+    mLateTiles       = 0;
+    mLastLatency     = 0;
+    mTotalLatency    = 0;
+    mMaxLatency      = 0;
+}
+
+void FrameAssembler::AddPacket(uint64_t pts, int32_t segId, uint32_t videoId, uint64_t now)
+{
+    ScopeLock lock(mLock);
+    if (!mHasBase)
+    {
+        mHasBase = true;
+        mBasePts = pts;
+        LOG(INFO) << "Frame sync base pts is " << pts << std::endl;
+    }
+
+    auto it = mSlots.find(pts);
+    if (it == mSlots.end())
+    {
+        FrameSlot slot;
+        slot.segId      = segId;
+        slot.arriveTime = now;
+        it = mSlots.insert(std::make_pair(pts, slot)).first;
+    }
+    else if (it->second.segId != segId)
+    {
+        LOG(WARNING) << "Packets of pts " << pts << " come from segment " << segId << " and " << it->second.segId << std::endl;
+    }
+    it->second.videoIds.insert(videoId);
+
+    // render side stopped pulling frames, do not grow without bound
+    while (mSlots.size() > MAX_ASSEMBLY_SLOT_NUM)
+    {
+        mSlots.erase(mSlots.begin());
+    }
+}
+
+bool FrameAssembler::GetMediaPts(uint64_t renderPts, uint64_t *pts)
+{
+    ScopeLock lock(mLock);
+    if (!mHasBase || NULL == pts)
+    {
+        return false;
+    }
+    *pts = mBasePts + renderPts;
+    return true;
+}
+
+AssembleResult FrameAssembler::Check(uint64_t pts, const std::set<uint32_t> &readyIds, uint64_t now, std::vector<uint32_t> *lateIds)
+{
+    ScopeLock lock(mLock);
+    if (lateIds) lateIds->clear();
+    if (!mHasBase)
+    {
+        return ASSEMBLE_HOLD;
+    }
+    if (mCheckPts != pts)
+    {
+        mCheckPts   = pts;
+        mCheckStart = now;
+    }
+    // before the first frame is shown every stream is waited for, so playback
+    // does not start with missing tiles
+    bool expired = mPresentedAny && (now - mCheckStart >= mHoldTimeout);
+    bool hasNewer = mSlots.upper_bound(pts) != mSlots.end();
+
+    auto it = mSlots.find(pts);
+    if (it == mSlots.end())
+    {
+        // packets of this pts are lost if later ones have already arrived
+        return (expired && hasNewer) ? ASSEMBLE_SKIP : ASSEMBLE_HOLD;
+    }
+
+    uint32_t lateNum = 0;
+    for (auto id : it->second.videoIds)
+    {
+        if (readyIds.find(id) == readyIds.end())
+        {
+            lateNum++;
+            if (lateIds) lateIds->push_back(id);
+        }
+    }
+    if (0 == lateNum)
+    {
+        return ASSEMBLE_READY;
+    }
+    if (!expired)
+    {
+        return ASSEMBLE_HOLD;
+    }
+    return (lateNum < it->second.videoIds.size()) ? ASSEMBLE_PARTIAL : ASSEMBLE_SKIP;
+}
+
+void FrameAssembler::Presented(uint64_t pts, AssembleResult result, uint32_t lateNum, uint64_t now)
+{
+    ScopeLock lock(mLock);
+    auto it = mSlots.find(pts);
+    if (ASSEMBLE_SKIP == result)
+    {
+        mSkippedFrames++;
+    }
+    else if (it != mSlots.end())
+    {
+        mPresentedFrames++;
+        if (ASSEMBLE_PARTIAL == result)
+        {
+            mPartialFrames++;
+            mLateTiles += lateNum;
+        }
+        uint64_t latency = now > it->second.arriveTime ? now - it->second.arriveTime : 0;
+        mLastLatency = latency;
+        mTotalLatency += latency;
+        if (latency > mMaxLatency)
+            mMaxLatency = latency;
+    }
+    mSlots.erase(mSlots.begin(), mSlots.upper_bound(pts));
+    mPresentedAny = true;
+    mCheckPts     = UINT64_MAX;
+}
+
+RenderStatus FrameAssembler::GetMetrics(struct FrameSyncMetrics *metrics)
+{
+    if (NULL == metrics) return RENDER_ERROR;
+
+    ScopeLock lock(mLock);
+    metrics->presentedFrames = mPresentedFrames;
+    metrics->partialFrames   = mPartialFrames;
+    metrics->skippedFrames   = mSkippedFrames;
+    metrics->lateTiles       = mLateTiles;
+    metrics->pendingFrames   = mSlots.size();
+    metrics->lastLatency     = mLastLatency;
+    metrics->avgLatency      = mPresentedFrames ? mTotalLatency / mPresentedFrames : 0;
+    metrics->maxLatency      = mMaxLatency;
+    return RENDER_STATUS_OK;
+}
+
+VCD_NS_END
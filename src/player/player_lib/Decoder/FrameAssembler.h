@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     FrameAssembler.h
+//! \brief    Defines class for FrameAssembler which groups the decoded frames
+//!           of all video streams by presentation timestamp.
+//!
+
+#ifndef _FRAMEASSEMBLER_H_
+#define _FRAMEASSEMBLER_H_
+
+#include "../Common/Common.h"
+#include "../../../utils/Threadable.h"
+#include <map>
+#include <set>
+#include <vector>
+
+#define FRAME_SYNC_HOLD_TIMEOUT 20    // ms a frame is held back for late streams
+#define MAX_ASSEMBLY_SLOT_NUM   256
+
+VCD_NS_BEGIN
+
+enum AssembleResult {
+     ASSEMBLE_READY = 0,   //!< every stream of the pts is decoded
+     ASSEMBLE_PARTIAL,     //!< hold timeout expired, present without the late streams
+     ASSEMBLE_HOLD,        //!< wait for late streams or for packets of the pts
+     ASSEMBLE_SKIP,        //!< no packet of the pts will come, present nothing new
+};
+
+//!
+//! \class  FrameAssembler
+//! \brief  Keeps one slot per pts recording which streams received a packet of
+//!         that pts, the segment it belongs to and when it arrived. A frame is
+//!         presented as soon as all of its streams are decoded; a slow stream
+//!         only holds the frame back for the hold timeout, after that its tile
+//!         is dropped for this pts instead of stalling the fast streams.
+//!         Render side counts frames from 0, they are mapped to media pts from
+//!         the first pts sent.
+//!
+class FrameAssembler
+{
+public:
+     FrameAssembler();
+     ~FrameAssembler();
+
+     //!
+     //! \brief  drop all slots and statistics, the next sent pts becomes the base
+     //!
+     void Reset();
+
+     void SetHoldTimeout(uint64_t timeout) { mHoldTimeout = timeout; };
+
+     //!
+     //! \brief  record a packet sent to the decoder of one stream
+     //!
+     //! \param  [in] pts: media pts of the packet
+     //!         [in] segId: segment the packet belongs to
+     //!         [in] videoId: id of the stream
+     //!         [in] now: arrival time in ms
+     //!
+     void AddPacket(uint64_t pts, int32_t segId, uint32_t videoId, uint64_t now);
+
+     //!
+     //! \brief  map a render frame count to media pts
+     //!
+     //! \param  [in] renderPts: frame count of render loop
+     //!         [out] pts: media pts
+     //! \return bool
+     //!         false if no packet has been sent yet
+     //!
+     bool GetMediaPts(uint64_t renderPts, uint64_t *pts);
+
+     //!
+     //! \brief  decide whether the frame of pts can be presented
+     //!
+     //! \param  [in] pts: media pts to present
+     //!         [in] readyIds: streams having a decoded frame for pts
+     //!         [in] now: current time in ms
+     //!         [out] lateIds: streams of the slot which are not ready, can be NULL
+     //! \return AssembleResult
+     //!
+     AssembleResult Check(uint64_t pts, const std::set<uint32_t> &readyIds, uint64_t now, std::vector<uint32_t> *lateIds);
+
+     //!
+     //! \brief  the frame of pts is presented, measure its latency and drop older slots
+     //!
+     void Presented(uint64_t pts, AssembleResult result, uint32_t lateNum, uint64_t now);
+
+     //!
+     //! \brief  get latency and drop statistics
+     //!
+     //! \param  [out] metrics: the statistics
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus GetMetrics(struct FrameSyncMetrics *metrics);
+
+private:
+     FrameAssembler& operator=(const FrameAssembler& other) { return *this; };
+     FrameAssembler(const FrameAssembler& other) { /* do not create copies */ };
+
+     struct FrameSlot {
+          std::set<uint32_t> videoIds;   //!< streams expected in the frame
+          int32_t            segId;
+          uint64_t           arriveTime; //!< ms when the first packet was sent
+     };
+
+private:
+     std::map<uint64_t, FrameSlot> mSlots;
+     ThreadLock                    mLock;
+     bool                          mHasBase;
+     uint64_t                      mBasePts;
+     uint64_t                      mHoldTimeout;
+     bool                          mPresentedAny;
+     uint64_t                      mCheckPts;       //!< pts being held back
+     uint64_t                      mCheckStart;     //!< ms when holding mCheckPts began
+     uint64_t                      mPresentedFrames;
+     uint64_t                      mPartialFrames;
+     uint64_t                      mSkippedFrames;
+     uint64_t                      mLateTiles;
+     uint64_t                      mLastLatency;
+     uint64_t                      mTotalLatency;
+     uint64_t                      mMaxLatency;
+};
+
+VCD_NS_END
+
+#endif /* _FRAMEASSEMBLER_H_ */
@@ -45,6 +45,8 @@ public:
 public:
      //!
      //! \brief interface to process an decoded frame, such as mapping an buffer to texture
+     //!         the buffers are only valid during the call; a handler keeping them longer
+     //!         must Borrow() bufInfo->frameRef and Return() it when done.
      //!
      //! \param  [in] bufInfo: the buffer to be processed
      //! \return RenderStatus
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     FramePool.cpp
+//! \brief    Implement class for FramePool.
+//!
+
+#ifdef _LINUX_OS_
+
+#include "FramePool.h"
+#include <chrono>
+#include <stdlib.h>
+
+VCD_NS_BEGIN
+
+static void FreeAlignedPlane(void *opaque, uint8_t *data)
+{
+    free(data);
+}
+
+//! plane allocator of the buffer pools, av_malloc only guarantees 64 bytes
+//! alignment when FFmpeg is built with AVX-512
+static AVBufferRef* AllocAlignedPlane(int size)
+{
+    void *data = NULL;
+    if (0 != posix_memalign(&data, FRAME_PLANE_ALIGNMENT, size))
+    {
+        return NULL;
+    }
+    AVBufferRef *buf = av_buffer_create((uint8_t*)data, size, FreeAlignedPlane, NULL, 0);
+    if (NULL == buf)
+    {
+        free(data);
+    }
+    return buf;
+}
+
+PooledFrame::PooledFrame()
+{
+    mAVFrame  = av_frame_alloc();
+    mRefCount = 0;
+    mPool     = NULL;
+}
+
+PooledFrame::~PooledFrame()
+{
+    av_frame_free(&mAVFrame);
+}
+
+void PooledFrame::Borrow()
+{
+    mRefCount.fetch_add(1);
+}
+
+void PooledFrame::Return()
+{
+    if (1 == mRefCount.fetch_sub(1))
+    {
+        mPool->Recycle(this);
+    }
+}
+
+FramePool::FramePool()
+{
+    mRefCount   = 1;
+    mPoolWidth  = 0;
+    mPoolHeight = 0;
+    for (uint32_t i = 0; i < FRAME_PLANE_NUM; i++)
+    {
+        mPlanePool[i]   = NULL;
+        mPlaneStride[i] = 0;
+    }
+}
+
+FramePool::~FramePool()
+{
+    for (auto frame : mFrames)
+    {
+        SAFE_DELETE(frame);
+    }
+    mFrames.clear();
+    mFreeFrames.clear();
+    UninitPlanePools();
+}
+
+RenderStatus FramePool::Initialize(uint32_t size)
+{
+    std::lock_guard<std::mutex> lock(mFrameMutex);
+    if (!mFrames.empty() || 0 == size) return RENDER_ERROR;
+
+    mFrames.reserve(size);
+    mFreeFrames.reserve(size);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        PooledFrame *frame = new PooledFrame();
+        if (NULL == frame->mAVFrame)
+        {
+            LOG(ERROR) << "alloc av frame failed in frame pool!" << std::endl;
+            SAFE_DELETE(frame);
+            return RENDER_ERROR;
+        }
+        frame->mPool = this;
+        mFrames.push_back(frame);
+        mFreeFrames.push_back(frame);
+    }
+    return RENDER_STATUS_OK;
+}
+
+void FramePool::Destroy()
+{
+    Release();
+}
+
+void FramePool::Release()
+{
+    if (1 == mRefCount.fetch_sub(1))
+    {
+        delete this;
+    }
+}
+
+void FramePool::Attach(AVCodecContext *codecCtx)
+{
+    if (NULL == codecCtx) return;
+
+    codecCtx->opaque                = this;
+    codecCtx->get_buffer2           = FramePool::GetBuffer2;
+    codecCtx->thread_safe_callbacks = 1;
+}
+
+PooledFrame* FramePool::Acquire(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mFrameMutex);
+    if (!mFrameReturned.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                 [this] { return !mFreeFrames.empty(); }))
+    {
+        return NULL;
+    }
+    PooledFrame *frame = mFreeFrames.back();
+    mFreeFrames.pop_back();
+    frame->mRefCount = 1;
+    // the frame keeps the pool alive until it is recycled
+    mRefCount.fetch_add(1);
+    return frame;
+}
+
+bool FramePool::HasFreeFrame()
+{
+    std::lock_guard<std::mutex> lock(mFrameMutex);
+    return !mFreeFrames.empty();
+}
+
+void FramePool::Recycle(PooledFrame *frame)
+{
+    // planes go back to the plane pools here
+    av_frame_unref(frame->mAVFrame);
+
+    {
+        std::lock_guard<std::mutex> lock(mFrameMutex);
+        mFreeFrames.push_back(frame);
+        mFrameReturned.notify_one();
+    }
+    // the pool may be deleted here, after the last use of it
+    Release();
+}
+
+int FramePool::GetBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags)
+{
+    FramePool *pool = (FramePool*)codecCtx->opaque;
+    if (NULL == pool || AV_PIX_FMT_YUV420P != frame->format)
+    {
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+    return pool->AllocPlanes(codecCtx, frame);
+}
+
+int FramePool::AllocPlanes(AVCodecContext *codecCtx, AVFrame *frame)
+{
+    int32_t width  = frame->width;
+    int32_t height = frame->height;
+    int32_t linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecCtx, &width, &height, linesizeAlign);
+
+    std::lock_guard<std::mutex> lock(mPlaneMutex);
+    if (width != mPoolWidth || height != mPoolHeight || NULL == mPlanePool[0])
+    {
+        // buffers still referenced by old frames are kept alive by their pools
+        UninitPlanePools();
+        int32_t planeHeight[FRAME_PLANE_NUM] = { height, (height + 1) / 2, (height + 1) / 2 };
+        mPlaneStride[0] = FFALIGN(width, FRAME_PLANE_ALIGNMENT);
+        mPlaneStride[1] = FFALIGN((width + 1) / 2, FRAME_PLANE_ALIGNMENT);
+        mPlaneStride[2] = mPlaneStride[1];
+        for (uint32_t i = 0; i < FRAME_PLANE_NUM; i++)
+        {
+            int32_t size = mPlaneStride[i] * planeHeight[i] + AV_INPUT_BUFFER_PADDING_SIZE + FRAME_PLANE_ALIGNMENT;
+            mPlanePool[i] = av_buffer_pool_init(size, AllocAlignedPlane);
+            if (NULL == mPlanePool[i])
+            {
+                LOG(ERROR) << "init plane pool failed in frame pool!" << std::endl;
+                UninitPlanePools();
+                return AVERROR(ENOMEM);
+            }
+        }
+        mPoolWidth  = width;
+        mPoolHeight = height;
+        LOG(INFO) << "frame pool planes are set to " << width << " x " << height << std::endl;
+    }
+
+    for (uint32_t i = 0; i < FRAME_PLANE_NUM; i++)
+    {
+        frame->buf[i] = av_buffer_pool_get(mPlanePool[i]);
+        if (NULL == frame->buf[i])
+        {
+            for (uint32_t j = 0; j < i; j++)
+            {
+                av_buffer_unref(&frame->buf[j]);
+            }
+            return AVERROR(ENOMEM);
+        }
+        frame->data[i]     = frame->buf[i]->data;
+        frame->linesize[i] = mPlaneStride[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+void FramePool::UninitPlanePools()
+{
+    for (uint32_t i = 0; i < FRAME_PLANE_NUM; i++)
+    {
+        if (mPlanePool[i])
+        {
+            av_buffer_pool_uninit(&mPlanePool[i]);
+        }
+    }
+    mPoolWidth  = 0;
+    mPoolHeight = 0;
+}
+
+VCD_NS_END
+#endif // _LINUX_OS_
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     FramePool.h
+//! \brief    Defines class for FramePool, a fixed-size pool of ref-counted decoded
+//!           frames whose planes are allocated by the decoder through get_buffer2.
+//!
+
+#ifdef _LINUX_OS_
+
+#ifndef _FRAMEPOOL_H_
+#define _FRAMEPOOL_H_
+
+#include "../Common/Common.h"
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#define DEFAULT_FRAME_POOL_SIZE 16
+#define FRAME_PLANE_ALIGNMENT   64
+#define FRAME_PLANE_NUM         3
+
+VCD_NS_BEGIN
+
+class FramePool;
+
+//!
+//! \class  PooledFrame
+//! \brief  A decoded frame owned by FramePool. The decoder holds one reference
+//!         from Acquire(); a renderer that needs the planes after
+//!         FrameHandler::process() returns must Borrow() the frame and Return()
+//!         it when done. The frame goes back to the pool with the last Return().
+//!
+class PooledFrame
+{
+public:
+     PooledFrame();
+     ~PooledFrame();
+
+     AVFrame* GetAVFrame() { return mAVFrame; };
+
+     //!
+     //! \brief  take one more reference on the frame
+     //!
+     void Borrow();
+
+     //!
+     //! \brief  drop one reference; the frame is recycled when it is the last one
+     //!
+     void Return();
+
+private:
+     PooledFrame& operator=(const PooledFrame& other) { return *this; };
+     PooledFrame(const PooledFrame& other) { /* do not create copies */ };
+
+     friend class FramePool;
+
+     AVFrame                      *mAVFrame;
+     std::atomic<int32_t>          mRefCount;
+     FramePool                    *mPool;
+};
+
+//!
+//! \class  FramePool
+//! \brief  Fixed number of PooledFrame shared by a decoder and its renderers.
+//!         Plane buffers come from AVBufferPools of 64-byte aligned memory via
+//!         the get_buffer2 callback, so after warming up no frame memory is
+//!         allocated or freed. The pools are rebuilt only when the frame
+//!         geometry changes.
+//!
+class FramePool
+{
+public:
+     FramePool();
+
+     //!
+     //! \brief  allocate the frames of the pool
+     //!
+     //! \param  [in] size: number of frames in the pool
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus Initialize(uint32_t size);
+
+     //!
+     //! \brief  release the pool; it is deleted once every borrowed frame is returned
+     //!
+     void Destroy();
+
+     //!
+     //! \brief  bind the pool to a codec context so that frames are decoded into it
+     //!
+     void Attach(AVCodecContext *codecCtx);
+
+     //!
+     //! \brief  get a free frame with one reference, blocking while all are in use
+     //!
+     //! \param  [in] timeoutMs: max waiting time in milliseconds
+     //! \return PooledFrame*
+     //!         a free frame, or NULL if none is returned until timeout
+     //!
+     PooledFrame* Acquire(uint32_t timeoutMs);
+
+     bool HasFreeFrame();
+
+     //!
+     //! \brief  the get_buffer2 callback of AVCodecContext
+     //!
+     static int GetBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags);
+
+private:
+     ~FramePool();
+     FramePool& operator=(const FramePool& other) { return *this; };
+     FramePool(const FramePool& other) { /* do not create copies */ };
+
+     friend class PooledFrame;
+
+     //!
+     //! \brief  called by PooledFrame when its last reference is returned
+     //!
+     void Recycle(PooledFrame *frame);
+
+     //!
+     //! \brief  drop one reference on the pool; the owner holds one and every
+     //!         acquired frame one more, and the last one deletes the pool
+     //!
+     void Release();
+
+     //!
+     //! \brief  fill the planes of frame from the plane pools
+     //!
+     int AllocPlanes(AVCodecContext *codecCtx, AVFrame *frame);
+
+     void UninitPlanePools();
+
+private:
+     std::vector<PooledFrame*>     mFrames;
+     std::vector<PooledFrame*>     mFreeFrames;
+     std::atomic<int32_t>          mRefCount;
+     std::mutex                    mFrameMutex;
+     std::condition_variable       mFrameReturned;
+
+     AVBufferPool                 *mPlanePool[FRAME_PLANE_NUM];
+     int32_t                       mPlaneStride[FRAME_PLANE_NUM];
+     int32_t                       mPoolWidth;
+     int32_t                       mPoolHeight;
+     std::mutex                    mPlaneMutex;
+};
+
+VCD_NS_END
+
+#endif /* _FRAMEPOOL_H_ */
+#endif // _LINUX_OS_
@@ -104,6 +104,17 @@ public:
 
      virtual bool IsReady(uint64_t pts) = 0;
 
+     //!
+     //! \brief  whether UpdateFrame(pts) needs no more waiting, i.e. the frame of
+     //!         pts or a later one is decoded, or no more frames will come
+     //!
+     virtual bool IsFrameReady(uint64_t pts) { return IsReady(pts); };
+
+     //!
+     //! \brief  get decode time and queue depth statistics of the decoder
+     //!
+     virtual RenderStatus GetMetrics(struct DecodeMetrics *metrics) { return RENDER_NOT_FOUND; };
+
 protected:
     ThreadStatus m_status;
     void*    m_nativeSurface;
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     PacketQueue.cpp
+//! \brief    Implement class for PacketQueue.
+//!
+
+#ifdef _LINUX_OS_
+
+#include "PacketQueue.h"
+#include <chrono>
+
+VCD_NS_BEGIN
+
+PacketQueue::PacketQueue()
+{
+    mCapacity    = 0;
+    mHead        = 0;
+    mTail        = 0;
+    mInterrupted = false;
+}
+
+PacketQueue::~PacketQueue()
+{
+    Clear();
+    for (auto &slot : mSlots)
+    {
+        av_packet_free(&slot.pkt);
+    }
+    mSlots.clear();
+}
+
+RenderStatus PacketQueue::Initialize(uint32_t capacity)
+{
+    if (0 == capacity) return RENDER_ERROR;
+
+    mSlots.resize(capacity);
+    for (auto &slot : mSlots)
+    {
+        memset_s(&slot, sizeof(PacketInfo), 0);
+        slot.pkt = av_packet_alloc();
+        if (NULL == slot.pkt)
+        {
+            LOG(ERROR) << "alloc packet failed in packet queue!" << std::endl;
+            return RENDER_ERROR;
+        }
+    }
+    mCapacity = capacity;
+    mHead     = 0;
+    mTail     = 0;
+    return RENDER_STATUS_OK;
+}
+
+PacketInfo* PacketQueue::AcquireSlot(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (0 == mCapacity) return NULL;
+    if (!mNotFull.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                           [this] { return mTail - mHead < mCapacity; }))
+    {
+        return NULL;
+    }
+    PacketInfo *slot   = &mSlots[mTail % mCapacity];
+    slot->bCodecChange = false;
+    slot->bEOS         = false;
+    slot->pts          = 0;
+    slot->video_id     = 0;
+    return slot;
+}
+
+void PacketQueue::Commit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTail++;
+    }
+    mNotEmpty.notify_one();
+}
+
+PacketInfo* PacketQueue::Front(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNotEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [this] { return mTail != mHead || mInterrupted; });
+    mInterrupted = false;
+    if (mTail == mHead) return NULL;
+    return &mSlots[mHead % mCapacity];
+}
+
+void PacketQueue::Pop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mTail == mHead) return;
+        av_packet_unref(mSlots[mHead % mCapacity].pkt);
+        mHead++;
+    }
+    mNotFull.notify_one();
+}
+
+void PacketQueue::Interrupt()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mInterrupted = true;
+    }
+    mNotEmpty.notify_all();
+}
+
+void PacketQueue::Clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while (mTail != mHead)
+        {
+            av_packet_unref(mSlots[mHead % mCapacity].pkt);
+            mHead++;
+        }
+    }
+    mNotFull.notify_all();
+}
+
+uint32_t PacketQueue::Size()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return (uint32_t)(mTail - mHead);
+}
+
+VCD_NS_END
+#endif // _LINUX_OS_
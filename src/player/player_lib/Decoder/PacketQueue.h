@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     PacketQueue.h
+//! \brief    Defines class for PacketQueue, a bounded single-producer/single-consumer
+//!           queue of coded packets feeding one video decoder.
+//!
+
+#ifdef _LINUX_OS_
+
+#ifndef _PACKETQUEUE_H_
+#define _PACKETQUEUE_H_
+
+#include "../Common/Common.h"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#define DEFAULT_PACKET_QUEUE_SIZE 64
+
+VCD_NS_BEGIN
+
+typedef struct PacketInfo{
+     AVPacket *pkt;
+     bool      bCodecChange;
+     bool      bEOS;
+     uint64_t  pts;
+     uint32_t  video_id;
+}PacketInfo;
+
+//!
+//! \class  PacketQueue
+//! \brief  Ring of preallocated PacketInfo slots, each owning one AVPacket for the
+//!         whole life time of the queue. The producer (media source thread) fills
+//!         a slot got from AcquireSlot() and publishes it with Commit(); the consumer
+//!         (decoder thread) blocks in Front() until a packet arrives and hands the
+//!         slot back with Pop(). No allocation happens after Initialize().
+//!
+class PacketQueue
+{
+public:
+     PacketQueue();
+     ~PacketQueue();
+
+     //!
+     //! \brief  allocate the slots and their AVPackets
+     //!
+     //! \param  [in] capacity: max number of packets in the queue
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus Initialize(uint32_t capacity);
+
+     //!
+     //! \brief  get the next free slot for writing, blocking while the queue is full
+     //!
+     //! \param  [in] timeoutMs: max waiting time in milliseconds
+     //! \return PacketInfo*
+     //!         the slot to be filled, or NULL if the queue stays full until timeout
+     //!
+     PacketInfo* AcquireSlot(uint32_t timeoutMs);
+
+     //!
+     //! \brief  publish the slot got from AcquireSlot() to the consumer
+     //!
+     void Commit();
+
+     //!
+     //! \brief  get the oldest packet, blocking until one is available
+     //!
+     //! \param  [in] timeoutMs: max waiting time in milliseconds
+     //! \return PacketInfo*
+     //!         the oldest packet, or NULL if timeout or Interrupt() is called
+     //!
+     PacketInfo* Front(uint32_t timeoutMs);
+
+     //!
+     //! \brief  release the packet got from Front() and recycle its slot
+     //!
+     void Pop();
+
+     //!
+     //! \brief  wake up the consumer blocked in Front(), e.g. on status change
+     //!
+     void Interrupt();
+
+     //!
+     //! \brief  drop all queued packets
+     //!
+     void Clear();
+
+     uint32_t Size();
+
+private:
+     PacketQueue& operator=(const PacketQueue& other) { return *this; };
+     PacketQueue(const PacketQueue& other) { /* do not create copies */ };
+
+private:
+     std::vector<PacketInfo>       mSlots;
+     uint32_t                      mCapacity;
+     uint64_t                      mHead;        //!< index of the next slot to be read
+     uint64_t                      mTail;        //!< index of the next slot to be written
+     bool                          mInterrupted;
+     std::mutex                    mMutex;
+     std::condition_variable       mNotEmpty;
+     std::condition_variable       mNotFull;
+};
+
+VCD_NS_END
+
+#endif /* _PACKETQUEUE_H_ */
+#endif // _LINUX_OS_
@@ -38,19 +38,43 @@
 
 #define DECODE_THREAD_COUNT 16
 #define MIN_REMAIN_SIZE_IN_FRAME 2
+#define PACKET_QUEUE_PUSH_TIMEOUT 1000 // ms, max time to wait for a free packet slot
+#define PACKET_QUEUE_POP_TIMEOUT 100   // ms, periodic wake up of the decoder thread to check status
+#define FRAME_POOL_WAIT_TIMEOUT 100    // ms, wait for renderer to return a frame
 
 VCD_NS_BEGIN
 
+//! free callback of the AVBufferRef wrapping a DashPacket payload
+static void FreeDashPacketBuffer(void *opaque, uint8_t *data)
+{
+    free(data);
+}
+
 VideoDecoder::VideoDecoder()
 {
     mDecCtx     = new DecoderContext();
     mHandler    = NULL;
     m_status    = STATUS_UNKNOWN;
     mVideoId    = -1;
-    mPkt        = NULL;
-    mPktInfo    = NULL;
-    mRwpk       = NULL;
     mIsFlushed  = false;
+    mDraining   = false;
+    mOutputPending = false;
+    if (RENDER_STATUS_OK != mDecCtx->packetQueue.Initialize(DEFAULT_PACKET_QUEUE_SIZE))
+    {
+        LOG(ERROR) << "Failed to initialize packet queue!" << endl;
+    }
+    mFramePool  = new FramePool();
+    if (RENDER_STATUS_OK != mFramePool->Initialize(DEFAULT_FRAME_POOL_SIZE))
+    {
+        LOG(ERROR) << "Failed to initialize frame pool!" << endl;
+    }
+    mScheduler       = NULL;
+    mPriority        = INVALID_QUALITY_RANKING;
+    mFrameStalled    = false;
+    mDecodedFrames   = 0;
+    mTotalDecodeTime = 0;
+    mLastDecodeTime  = 0;
+    mMaxDecodeTime   = 0;
 }
 
 VideoDecoder::~VideoDecoder()
@@ -58,14 +82,12 @@ VideoDecoder::~VideoDecoder()
     m_status = STATUS_STOPPED;
     CloseDecoder();
     SAFE_DELETE(mDecCtx);
-    if (mPkt)
-    {
-        av_packet_free(&mPkt);
-        mPkt = NULL;
-    }
-    mPktInfo = NULL;
-    mRwpk = NULL;
+    // the pool is deleted after renderers return all borrowed frames
+    mFramePool->Destroy();
+    mFramePool = NULL;
     mIsFlushed = false;
+    mDraining = false;
+    mOutputPending = false;
 }
 
 RenderStatus VideoDecoder::Initialize(int32_t id, Codec_Type codec, FrameHandler* handler, uint64_t startPts)
@@ -109,7 +131,12 @@ RenderStatus VideoDecoder::Initialize()
         LOG(ERROR)<<"avcodec alloc context failed!"<<std::endl;
         return RENDER_ERROR;
     }
-    mDecCtx->codec_ctx->thread_count = DECODE_THREAD_COUNT;
+    // workers of a shared scheduler already run decoders in parallel
+    mDecCtx->codec_ctx->thread_count = mScheduler ? mScheduler->GetCodecThreadNumber() : DECODE_THREAD_COUNT;
+    if (mDecCtx->decoder->capabilities & AV_CODEC_CAP_DR1)
+    {
+        mFramePool->Attach(mDecCtx->codec_ctx);
+    }
     // mDecCtx->codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
     // mDecCtx->codec_ctx->delay = 2;
 
@@ -120,8 +147,19 @@ RenderStatus VideoDecoder::Initialize()
     }
     mDecCtx->codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
 
-    StartThread();
     mIsFlushed = false;
+    mDraining = false;
+    mOutputPending = false;
+    if (mScheduler)
+    {
+        m_status = STATUS_RUNNING;
+        mScheduler->Register(this);
+        mScheduler->Notify(this);
+    }
+    else
+    {
+        StartThread();
+    }
     LOG(INFO) << "A new video decoder is created!" << std::endl;
     return RENDER_STATUS_OK;
 }
@@ -134,9 +172,16 @@ RenderStatus VideoDecoder::Destroy()
 
 void VideoDecoder::CloseDecoder()
 {
-    if( (m_status == STATUS_STOPPED) || (m_status == STATUS_IDLE) || m_status == STATUS_PENDING){
+    if (mScheduler)
+    {
+        // no step of this decoder is running once it is unregistered
+        m_status = STATUS_STOPPED;
+        mScheduler->Unregister(this);
+    }
+    else if( (m_status == STATUS_STOPPED) || (m_status == STATUS_IDLE) || m_status == STATUS_PENDING){
         m_status = STATUS_STOPPED;
         LOG(INFO)<<" decoder is closed! video id is " << mVideoId<<endl;
+        mDecCtx->packetQueue.Interrupt();
         this->Join();
     }
 
@@ -158,159 +203,202 @@ RenderStatus VideoDecoder::SendPacket(DashPacket* packet)
 {
     if(NULL == packet) return RENDER_NULL_PACKET;
 
+    PacketInfo* pktInfo = mDecCtx->packetQueue.AcquireSlot(PACKET_QUEUE_PUSH_TIMEOUT);
+    if (NULL == pktInfo)
+    {
+        LOG(ERROR)<<" packet queue is full in send packet! video id " << mVideoId << endl;
+        return RENDER_NULL_QUEUE;
+    }
+
     if (packet->bEOS) // eos
     {
-        PacketInfo* endPkt = new PacketInfo;
-        endPkt->bEOS = true;
-        mDecCtx->push_packet(endPkt);
+        pktInfo->bEOS = true;
+        mDecCtx->packetQueue.Commit();
         mDecCtx->bPacketEOS = true;
+        if (mScheduler) mScheduler->Notify(this);
         return RENDER_STATUS_OK;
     }
-    RenderStatus ret = RENDER_STATUS_OK;
 
-    mPktInfo = new PacketInfo;
-    mRwpk = new RegionWisePacking;
-    mPkt = av_packet_alloc();
-    if (mPktInfo == NULL || mRwpk == NULL || mPkt == NULL)
-    {
-        LOG(ERROR)<<" alloc memory failed in send packet! " << endl;
-        SAFE_DELETE(mPktInfo);
-        SAFE_DELETE(mRwpk);
-        av_packet_free(&mPkt);
-        return RENDER_ERROR;
-    }
-    mPktInfo->bCodecChange = MediaInfoChange(packet);
+    pktInfo->bCodecChange = MediaInfoChange(packet);
 
     mDecCtx->width = packet->width;
     mDecCtx->height = packet->height;
 
-    //send a packet to AVPACKET list
+    //send a packet to AVPACKET list, the slot is simply reused if nothing is committed
 
     if (NULL != packet->buf && packet->size)
     {
         int size = packet->size;
-        if (av_new_packet(mPkt, size) < 0)
+        // decoder may read over the end of packet, so grow the payload for the
+        // padding in place instead of copying it into a new buffer.
+        uint8_t *payload = (uint8_t*)realloc(packet->buf, size + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (NULL == payload)
         {
-            SAFE_DELETE(mPktInfo);
-            av_packet_free(&mPkt);
-            SAFE_DELETE(mRwpk);
+            LOG(ERROR)<<" alloc memory failed in send packet! " << endl;
             return RENDER_ERROR;
         }
-        memcpy_s(mPkt->data, size, packet->buf, size);
-        mPkt->size = size;
-        *mRwpk = *(packet->rwpk);
+        packet->buf = NULL;
+        memset_s(payload + size, AV_INPUT_BUFFER_PADDING_SIZE, 0);
 
-        SAFE_FREE(packet->buf);
-        SAFE_DELETE(packet->rwpk);
+        AVPacket *pkt = pktInfo->pkt;
+        pkt->buf = av_buffer_create(payload, size + AV_INPUT_BUFFER_PADDING_SIZE, FreeDashPacketBuffer, NULL, 0);
+        if (NULL == pkt->buf)
+        {
+            LOG(ERROR)<<" wrap packet buffer failed in send packet! " << endl;
+            free(payload);
+            return RENDER_ERROR;
+        }
+        pkt->data = payload;
+        pkt->size = size;
 
+        // region wise packing and resolution info are moved to frame data directly
         FrameData* data = new FrameData;
-        mPktInfo->pkt = mPkt;
-        mPktInfo->bEOS = packet->bEOS;
-        mPktInfo->pts = packet->pts;
-        mPktInfo->video_id = packet->videoID;
-        mDecCtx->push_packet(mPktInfo);
-        data->rwpk = mRwpk;
-        // data->pts = mPkt->pts;
-        data->pts = mPktInfo->pts;
+        data->rwpk = packet->rwpk;
+        packet->rwpk = NULL;
+        data->qtyResolution = packet->qtyResolution;
+        packet->qtyResolution = NULL;
+        data->meta = packet->meta;
+        packet->meta = NULL;
         data->numQuality = packet->numQuality;
-        data->qtyResolution = new SourceResolution[packet->numQuality];
-        data->bCodecChange = mPktInfo->bCodecChange;
+        data->pts = packet->pts;
+        data->bCodecChange = pktInfo->bCodecChange;
         data->width = packet->width;
         data->height = packet->height;
-        for(int i =0; i<data->numQuality; i++){
-            data->qtyResolution[i].height = packet->qtyResolution[i].height;
-            data->qtyResolution[i].width = packet->qtyResolution[i].width;
-            data->qtyResolution[i].left = packet->qtyResolution[i].left;
-            data->qtyResolution[i].top = packet->qtyResolution[i].top;
-            data->qtyResolution[i].qualityRanking = packet->qtyResolution[i].qualityRanking;
+        for (int32_t i = 0; i < data->numQuality; i++)
+        {
+            if (data->qtyResolution && data->qtyResolution[i].qualityRanking < mPriority)
+                mPriority = data->qtyResolution[i].qualityRanking;
         }
+
+        pktInfo->bEOS = packet->bEOS;
+        pktInfo->pts = packet->pts;
+        pktInfo->video_id = packet->videoID;
         mDecCtx->push_framedata(data);
-        LOG(INFO)<<"frame data fifo size is: "<<mDecCtx->get_size_of_framedata() <<"pts is " << data->pts <<" VIDEO ID : " << mPktInfo->video_id <<endl;
-        // SAFE_DELETE_ARRAY(packet->qtyResolution);
+        mDecCtx->packetQueue.Commit();
+        if (mScheduler) mScheduler->Notify(this);
+        LOG(INFO)<<"frame data fifo size is: "<<mDecCtx->get_size_of_framedata() <<"pts is " << data->pts <<" VIDEO ID : " << pktInfo->video_id <<endl;
     }
 
-    return ret;
+    return RENDER_STATUS_OK;
 }
 
 RenderStatus VideoDecoder::DecodeFrame(AVPacket *pkt, uint32_t video_id, uint64_t pts)
 {
     std::chrono::high_resolution_clock clock;
-    uint64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
+    uint64_t start = std::chrono::duration_cast<std::chrono::microseconds>(clock.now().time_since_epoch()).count();
     int32_t ret = 0;
     ret = avcodec_send_packet(mDecCtx->codec_ctx, pkt);
+    while (ret == AVERROR(EAGAIN))
+    {
+        // the codec still holds output of earlier packets, receive it and send again
+        RenderStatus status = ReceiveFrames(video_id, start);
+        if (RENDER_WAIT == status)
+            return RENDER_WAIT;
+        if (RENDER_DECODE_FAIL == status)
+            break;
+        ret = avcodec_send_packet(mDecCtx->codec_ctx, pkt);
+    }
     av_packet_unref(pkt);
     if (ret < 0)
     {
         FrameData* data = mDecCtx->pop_framedata();//delete invalid data
+        if (data) ReleaseRegionInfo(data->rwpk, data->qtyResolution, data->meta);
         SAFE_DELETE(data);
         LOG(ERROR)<<"error code " << ret << "stream_index " << pkt->stream_index << " send packet failed! video id " << video_id << " pts is " << pts <<endl;
         return RENDER_DECODE_FAIL;
     }
 
-    while (ret >= 0){
-    AVFrame* av_frame = av_frame_alloc();
-    if (NULL == av_frame)
-    {
-        LOG(ERROR)<<" alloc av frame failed in decode one frame! " << endl;
-        return RENDER_DECODE_FAIL;
-    }
-    ret = avcodec_receive_frame(mDecCtx->codec_ctx, av_frame);
-    if (ret < 0 || ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+    RenderStatus status = ReceiveFrames(video_id, start);
+    // the packet is consumed, frames left in the codec are received before the next one is sent
+    return RENDER_WAIT == status ? RENDER_STATUS_OK : status;
+}
+
+RenderStatus VideoDecoder::ReceiveFrames(uint32_t video_id, uint64_t start)
+{
+    std::chrono::high_resolution_clock clock;
+    int32_t ret = 0;
+    while (ret >= 0)
     {
-        LOG(WARNING) << "avcodec_receive_frame FAILED video id is " << mVideoId << endl;// decoder at first few frames, need some buffers
-        av_frame_free(&av_frame);
-        return RENDER_DECODE_FAIL;
-    }
-    int32_t bufferNumber = 3;
-    for (uint32_t i = 0; i < bufferNumber; i++){
-        if (av_frame->linesize[i] == 0)
+        PooledFrame* pooled = AcquireFrame();
+        if (NULL == pooled)
         {
-            LOG(ERROR)<<"av_frame is null! video_id is "<<video_id<<endl;
-            av_frame_free(&av_frame);
-            return RENDER_DECODER_INVALID_FRAME;
+            // the decoder keeps the pending output until the step is rescheduled
+            if (mScheduler && m_status != STATUS_STOPPED)
+            {
+                mOutputPending = true;
+                return RENDER_WAIT;
+            }
+            LOG(ERROR)<<" get av frame failed in decode one frame! " << endl;
+            return RENDER_DECODE_FAIL;
         }
-    }
-    FrameData* data = mDecCtx->pop_framedata();
-    if (data == NULL)
-    {
-        LOG(ERROR) << "Frame data is empty!" << endl;
-        av_frame_free(&av_frame);
-        return RENDER_NO_FRAME;
-    }
-    DecodedFrame* frame = new DecodedFrame;
-    frame->av_frame = av_frame;
-    frame->rwpk  = data->rwpk;
-    frame->pts = data->pts;
-    frame->bFmtChange = data->bCodecChange;
-    frame->numQuality = data->numQuality;
-    frame->qtyResolution = data->qtyResolution;
-    frame->video_id = video_id;
-    frame->bEOS = false;
-    if (frame->av_frame->width != data->width || frame->av_frame->height != data->height)
-    {
-        frame->av_frame->width = data->width;//correct w/h
-        frame->av_frame->height = data->height;
-        LOG(WARNING) << "PTS : " << data->pts << " frame->av_frame->width " << frame->av_frame->width << " is not equal to " << data->width << " or frame->av_frame->height " << frame->av_frame->height << " is not equal to " << data->height << endl;
-    }
-    LOG(INFO)<<"Push one frame at:"<<data->pts<<" video id is:"<<video_id << " and frame fifo size is " << mDecCtx->get_size_of_frame()<<endl;
-    mDecCtx->push_frame(frame);
+        AVFrame* av_frame = pooled->GetAVFrame();
+        ret = avcodec_receive_frame(mDecCtx->codec_ctx, av_frame);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+        {
+            // all output is received, the codec wants the next packet
+            pooled->Return();
+            mOutputPending = false;
+            return RENDER_STATUS_OK;
+        }
+        if (ret < 0)
+        {
+            LOG(WARNING) << "avcodec_receive_frame FAILED video id is " << mVideoId << endl;
+            pooled->Return();
+            mOutputPending = false;
+            return RENDER_DECODE_FAIL;
+        }
+        int32_t bufferNumber = 3;
+        for (uint32_t i = 0; i < bufferNumber; i++){
+            if (av_frame->linesize[i] == 0)
+            {
+                LOG(ERROR)<<"av_frame is null! video_id is "<<video_id<<endl;
+                pooled->Return();
+                return RENDER_DECODER_INVALID_FRAME;
+            }
+        }
+        FrameData* data = mDecCtx->pop_framedata();
+        if (data == NULL)
+        {
+            LOG(ERROR) << "Frame data is empty!" << endl;
+            pooled->Return();
+            return RENDER_NO_FRAME;
+        }
+        DecodedFrame* frame = new DecodedFrame;
+        frame->pooled = pooled;
+        frame->av_frame = av_frame;
+        frame->rwpk  = data->rwpk;
+        frame->pts = data->pts;
+        frame->bFmtChange = data->bCodecChange;
+        frame->numQuality = data->numQuality;
+        frame->qtyResolution = data->qtyResolution;
+        frame->meta = data->meta;
+        frame->video_id = video_id;
+        frame->bEOS = false;
+        // the pool follows the geometry of the decoded frame, which is the one to render
+        if (frame->av_frame->width != data->width || frame->av_frame->height != data->height)
+        {
+            LOG(WARNING) << "PTS : " << data->pts << " frame->av_frame->width " << frame->av_frame->width << " is not equal to " << data->width << " or frame->av_frame->height " << frame->av_frame->height << " is not equal to " << data->height << endl;
+        }
+        LOG(INFO)<<"Push one frame at:"<<data->pts<<" video id is:"<<video_id << " and frame fifo size is " << mDecCtx->get_size_of_frame()<<endl;
+        mDecCtx->push_frame(frame);
 #ifdef _USE_TRACE_
-    // trace
-    tracepoint(mthq_tp_provider, T9_push_frame_to_fifo, data->pts, video_id);
+        // trace
+        tracepoint(mthq_tp_provider, T9_push_frame_to_fifo, data->pts, video_id);
 #endif
-    //SAFE_DELETE(data->rwpk);
-    uint64_t end = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
-    LOG(INFO)<<" video id is "<< video_id <<" decode one frame cost time "<<(end-start)<<" ms reso is " << mDecCtx->codec_ctx->width <<" x " <<mDecCtx->codec_ctx->height<<endl;
+        //SAFE_DELETE(data->rwpk);
+        uint64_t end = std::chrono::duration_cast<std::chrono::microseconds>(clock.now().time_since_epoch()).count();
+        UpdateMetrics(end - start);
+        LOG(INFO)<<" video id is "<< video_id <<" decode one frame cost time "<<(end-start)/1000<<" ms reso is " << mDecCtx->codec_ctx->width <<" x " <<mDecCtx->codec_ctx->height<<endl;
 #ifdef _USE_TRACE_
-    // trace
-    tracepoint(mthq_tp_provider, T10_decode_time_cost, data->pts, video_id, end-start, mDecCtx->codec_ctx->width, mDecCtx->codec_ctx->height);
-    string tag = "videoIdx:" + to_string(video_id);
-    tracepoint(E2E_latency_tp_provider,
-               pre_rd_info,
-               frame->pts,
-               tag.c_str());
+        // trace
+        tracepoint(mthq_tp_provider, T10_decode_time_cost, data->pts, video_id, (end-start)/1000, mDecCtx->codec_ctx->width, mDecCtx->codec_ctx->height);
+        string tag = "videoIdx:" + to_string(video_id);
+        tracepoint(E2E_latency_tp_provider,
+                   pre_rd_info,
+                   frame->pts,
+                   tag.c_str());
 #endif
-    SAFE_DELETE(data);
+        SAFE_DELETE(data);
     }
     return RENDER_STATUS_OK;
 }
@@ -318,40 +406,59 @@ RenderStatus VideoDecoder::DecodeFrame(AVPacket *pkt, uint32_t video_id, uint64_
 RenderStatus VideoDecoder::FlushDecoder(uint32_t video_id)
 {
     int32_t ret = 0;
-    ret = avcodec_send_packet(mDecCtx->codec_ctx, NULL);
-    if (ret < 0)
+    // a flush stalled for free frames goes on draining without sending the flush packet again
+    if (!mDraining)
     {
-        LOG(ERROR)<<"Send packet failed!"<<endl;
-        return RENDER_DECODE_FAIL;
+        ret = avcodec_send_packet(mDecCtx->codec_ctx, NULL);
+        if (ret < 0)
+        {
+            LOG(ERROR)<<"Send packet failed!"<<endl;
+            return RENDER_DECODE_FAIL;
+        }
+        mDraining = true;
     }
+    RenderStatus status = DrainDecoder(video_id);
+    if (RENDER_WAIT != status)
+        mDraining = false;
+    return status;
+}
+
+RenderStatus VideoDecoder::DrainDecoder(uint32_t video_id)
+{
+    int32_t ret = 0;
     while(ret >= 0)
     {
-        AVFrame* av_frame = av_frame_alloc();
-        if (NULL == av_frame)
+        PooledFrame* pooled = AcquireFrame();
+        if (NULL == pooled)
         {
-            LOG(ERROR)<<"alloc av frame failed in flushing frame!" << endl;
+            if (mScheduler && m_status != STATUS_STOPPED)
+                return RENDER_WAIT;
+            LOG(ERROR)<<"get av frame failed in flushing frame!" << endl;
             return RENDER_DECODE_FAIL;
         }
+        AVFrame* av_frame = pooled->GetAVFrame();
         ret = avcodec_receive_frame(mDecCtx->codec_ctx, av_frame);
         if (ret < 0 || ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
         {
             LOG(INFO)<<"Receive frame failed!"<<std::endl;
-            av_frame_free(&av_frame);
+            pooled->Return();
             return RENDER_DECODE_FAIL;
         }
         if (av_frame->linesize[0] == 0)
         {
             LOG(INFO)<<"av_frame is null in flush!"<<endl;
-            av_frame_free(&av_frame);
+            pooled->Return();
             continue;
         }
         FrameData* data = mDecCtx->pop_framedata();
         if (data == NULL)
         {
             LOG(INFO)<<"Now will end decoder flush!"<<endl;
+            pooled->Return();
             return RENDER_STATUS_OK;
         }
         DecodedFrame* frame = new DecodedFrame;
+        frame->pooled = pooled;
         frame->av_frame = av_frame;
         frame->rwpk  = data->rwpk;
         frame->pts = data->pts;
@@ -359,6 +466,7 @@ RenderStatus VideoDecoder::FlushDecoder(uint32_t video_id)
         frame->numQuality = data->numQuality;
         frame->video_id = video_id;
         frame->qtyResolution = data->qtyResolution;
+        frame->meta = data->meta;
         if (NULL == mDecCtx->get_front_of_framedata()) // set last frame eos to true
         {
             frame->bEOS = true;
@@ -413,69 +521,118 @@ bool VideoDecoder::MediaInfoChange(DashPacket* packet)
 
 void VideoDecoder::Run()
 {
-    RenderStatus ret = RENDER_STATUS_OK;
-
     m_status = STATUS_RUNNING;
 
     while (m_status != STATUS_STOPPED && m_status != STATUS_IDLE)
     {
-        // when the status is set to pending
-        if (m_status == STATUS_PENDING)
+        if (!DecodeStep())
         {
-            //flush decoder until all packets are popped.
-            if (mDecCtx->get_size_of_packet() == 0 && !mIsFlushed)
-            {
-                LOG(INFO)<<"Now will flush the decoder "<< mVideoId << endl;
-                ret = FlushDecoder(mVideoId);
-                if (RENDER_STATUS_OK != ret)
-                {
-                    LOG(INFO)<<"Video "<< mVideoId <<": failed to flush decoder when status is pending!"<<std::endl;
-                }
-                mIsFlushed = true;
-                continue;
-            }
-        }
-        if(0 == mDecCtx->get_size_of_packet()){
-            usleep(1000);
-            continue;
-        }
-        PacketInfo* pkt_info = mDecCtx->pop_packet();
-
-        if(NULL == pkt_info){
-            LOG(INFO)<<"possible error since null packet has been pushed to queue"<<std::endl;
-            continue;
+            // block until a packet arrives or the status is changed
+            mDecCtx->packetQueue.Front(PACKET_QUEUE_POP_TIMEOUT);
         }
+    }
+}
 
-        LOG(INFO)<<"Now packet pts is "<<pkt_info->pts<<"video id is " << mVideoId<<endl;
+bool VideoDecoder::DecodeStep()
+{
+    RenderStatus ret = RENDER_STATUS_OK;
 
-	    // check eos status and do flush operation.
-        if(pkt_info->bEOS)
+    if (m_status == STATUS_STOPPED || m_status == STATUS_IDLE)
+    {
+        return false;
+    }
+    // output left in the codec by a stalled step goes first, the codec takes no input until then
+    if (mOutputPending)
+    {
+        std::chrono::high_resolution_clock clock;
+        uint64_t start = std::chrono::duration_cast<std::chrono::microseconds>(clock.now().time_since_epoch()).count();
+        if (RENDER_WAIT == ReceiveFrames(mVideoId, start))
+        {
+            return false;
+        }
+    }
+    // when the status is set to pending
+    if (m_status == STATUS_PENDING)
+    {
+        //flush decoder until all packets are popped.
+        if (mDecCtx->get_size_of_packet() == 0 && !mIsFlushed)
         {
+            LOG(INFO)<<"Now will flush the decoder "<< mVideoId << endl;
             ret = FlushDecoder(mVideoId);
-            if(RENDER_STATUS_OK != ret){
-                LOG(INFO)<<"Video "<< mVideoId <<": failed to flush decoder when EOS"<<std::endl;
+            if (RENDER_WAIT == ret)
+            {
+                return false;
+            }
+            if (RENDER_STATUS_OK != ret)
+            {
+                LOG(INFO)<<"Video "<< mVideoId <<": failed to flush decoder when status is pending!"<<std::endl;
             }
-            m_status = STATUS_IDLE;
-	        continue;
+            mIsFlushed = true;
+            return false;
         }
-        ///need not to reset decoder if w/h changed
-        // if(pkt_info->bCodecChange){
-        //     LOG(INFO)<<"Video "<< mVideoId <<":Input stream parameters Changed, reset decoder"<<std::endl;
-        //     // this->Reset();
-        //     mbFmtChange = true;
-        // }
+    }
+    // a shared worker must not wait for the renderer, so retry once a frame is returned.
+    // the check and the mark are done under mStallLock so ResumeIfStalled can't miss it
+    if (mScheduler)
+    {
+        ScopeLock lock(mStallLock);
+        if (!mFramePool->HasFreeFrame())
+        {
+            mFrameStalled = true;
+            return false;
+        }
+    }
+    PacketInfo* pkt_info = mDecCtx->packetQueue.Front(0);
+
+    if(NULL == pkt_info){
+        return false;
+    }
 
+    LOG(INFO)<<"Now packet pts is "<<pkt_info->pts<<"video id is " << mVideoId<<endl;
 
-        ret = DecodeFrame(pkt_info->pkt, pkt_info->video_id, pkt_info->pts);
+    // check eos status and do flush operation.
+    if(pkt_info->bEOS)
+    {
+        ret = FlushDecoder(mVideoId);
+        if (RENDER_WAIT == ret)
+        {
+            // keep the EOS packet, the flush goes on when a frame is returned
+            return false;
+        }
+        mDecCtx->packetQueue.Pop();
         if(RENDER_STATUS_OK != ret){
-             LOG(INFO)<<"Video "<< mVideoId <<": failed to decoder one frame"<<std::endl;
+            LOG(INFO)<<"Video "<< mVideoId <<": failed to flush decoder when EOS"<<std::endl;
         }
+        m_status = STATUS_IDLE;
+        return false;
+    }
+    ///need not to reset decoder if w/h changed
+    // if(pkt_info->bCodecChange){
+    //     LOG(INFO)<<"Video "<< mVideoId <<":Input stream parameters Changed, reset decoder"<<std::endl;
+    //     // this->Reset();
+    //     mbFmtChange = true;
+    // }
 
-        av_packet_unref(pkt_info->pkt);
+    ret = DecodeFrame(pkt_info->pkt, pkt_info->video_id, pkt_info->pts);
+    if (RENDER_WAIT == ret)
+    {
+        // keep the packet, it is sent again when a frame is returned
+        return false;
+    }
+    if(RENDER_STATUS_OK != ret){
+         LOG(INFO)<<"Video "<< mVideoId <<": failed to decoder one frame"<<std::endl;
+    }
 
-        SAFE_DELETE(pkt_info);
+    // the payload is released here, and the slot goes back to producer
+    mDecCtx->packetQueue.Pop();
 
-    }
+    return mDecCtx->get_size_of_packet() > 0;
+}
+
+uint64_t VideoDecoder::GetDeadline()
+{
+    PacketInfo* pkt_info = mDecCtx->packetQueue.Front(0);
+    return pkt_info ? pkt_info->pts : UINT64_MAX;
 }
 
 DecodedFrame* VideoDecoder::GetFrame(uint64_t pts)
@@ -501,11 +658,8 @@ DecodedFrame* VideoDecoder::GetFrame(uint64_t pts)
         // drop over time frame.
         frame = mDecCtx->pop_frame();
         LOG(INFO)<<"Now will drop one frame since pts is over time! input pts is:" << pts <<" frame pts is:" << frame->pts<<"video id is:" << mVideoId<<endl;
-        av_frame_free(&frame->av_frame);
-        if (frame->rwpk)
-            SAFE_DELETE_ARRAY(frame->rwpk->rectRegionPacking);
-        SAFE_DELETE(frame->rwpk);
-        SAFE_DELETE_ARRAY(frame->qtyResolution);
+        frame->pooled->Return();
+        ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
         SAFE_DELETE(frame);
     }
 
@@ -517,11 +671,76 @@ DecodedFrame* VideoDecoder::GetFrame(uint64_t pts)
     return frame;
 }
 
+PooledFrame* VideoDecoder::AcquireFrame()
+{
+    PooledFrame* pooled = NULL;
+    if (mScheduler)
+    {
+        ScopeLock lock(mStallLock);
+        pooled = mFramePool->Acquire(0);
+        if (NULL == pooled)
+            mFrameStalled = true;
+        return pooled;
+    }
+    // the fixed pool bounds the decoded frame fifo, so wait here until one comes back
+    while (NULL == (pooled = mFramePool->Acquire(FRAME_POOL_WAIT_TIMEOUT)))
+    {
+        if (m_status == STATUS_STOPPED)
+            break;
+        LOG(INFO)<<"All frames in pool are in use! video id is " << mVideoId << endl;
+    }
+    return pooled;
+}
+
+void VideoDecoder::ResumeIfStalled()
+{
+    if (NULL == mScheduler)
+        return;
+
+    bool stalled = false;
+    {
+        ScopeLock lock(mStallLock);
+        stalled = mFrameStalled;
+        mFrameStalled = false;
+    }
+    if (stalled)
+    {
+        mScheduler->Notify(this);
+    }
+}
+
+void VideoDecoder::UpdateMetrics(uint64_t decodeTime)
+{
+    ScopeLock lock(mMetricsLock);
+    mDecodedFrames++;
+    mTotalDecodeTime += decodeTime;
+    mLastDecodeTime = decodeTime;
+    if (decodeTime > mMaxDecodeTime)
+        mMaxDecodeTime = decodeTime;
+}
+
+RenderStatus VideoDecoder::GetMetrics(struct DecodeMetrics *metrics)
+{
+    if (NULL == metrics) return RENDER_ERROR;
+
+    metrics->videoId = mVideoId;
+    metrics->packetQueueDepth = mDecCtx->get_size_of_packet();
+    metrics->frameQueueDepth = mDecCtx->get_size_of_frame();
+    ScopeLock lock(mMetricsLock);
+    metrics->decodedFrames = mDecodedFrames;
+    metrics->lastDecodeTime = mLastDecodeTime;
+    metrics->avgDecodeTime = mDecodedFrames ? mTotalDecodeTime / mDecodedFrames : 0;
+    metrics->maxDecodeTime = mMaxDecodeTime;
+    return RENDER_STATUS_OK;
+}
+
 void VideoDecoder::Pending()
 {
     mDecCtx->bPacketEOS = true;
     LOG(INFO) << "Set decoder status to PENDING!" << endl;
     m_status = STATUS_PENDING;
+    mDecCtx->packetQueue.Interrupt();
+    if (mScheduler) mScheduler->Notify(this);
 }
 
 RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
@@ -534,6 +753,7 @@ RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
     if(NULL==frame)
     {
         LOG(INFO)<<"Frame is empty!"<<endl;
+        ResumeIfStalled();
         return RENDER_NO_FRAME;
     }
     if (frame->bEOS)
@@ -541,7 +761,8 @@ RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
         this->SetEOS(true);
     }
     if( 0 >= frame->av_frame->linesize[0]){
-        av_free(frame->av_frame);
+        frame->pooled->Return();
+        ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
         SAFE_DELETE(frame);
         return RENDER_DECODER_INVALID_FRAME;
     }
@@ -549,6 +770,8 @@ RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
     uint64_t start2 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
     BufferInfo* buf_info = new BufferInfo;
     uint32_t bufferNumber = 0;
+    // renderers borrow the frame if they keep its planes after process()
+    buf_info->frameRef = frame->pooled;
 
     switch ( mDecCtx->codec_ctx->pix_fmt ){
         case AV_PIX_FMT_YUV420P:
@@ -584,7 +807,7 @@ RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
         LOG(INFO) << "i " << i << " buf stride is " <<buf_info->stride[i] << " PTS " << frame->pts << " video id " << mVideoId << endl;
     }
 
-    buf_info->regionInfo = new RegionData(frame->rwpk, frame->numQuality, frame->qtyResolution);
+    buf_info->regionInfo = new RegionData(frame->rwpk, frame->numQuality, frame->qtyResolution, frame->meta);
 
     buf_info->pts = frame->pts;
     LOG(INFO) << "buf_info w " << buf_info->width << " h " << buf_info->height << " video id " << mVideoId << " pts " << frame->pts << endl;
@@ -606,12 +829,11 @@ RenderStatus VideoDecoder::UpdateFrame(uint64_t pts)
     buf_info->regionInfo = nullptr;
     SAFE_DELETE(buf_info);
 
-    av_frame_free(&frame->av_frame);
-    // av_frame_unref(frame->av_frame);
-    SAFE_DELETE_ARRAY(frame->rwpk->rectRegionPacking);
-    SAFE_DELETE(frame->rwpk);
-    SAFE_DELETE_ARRAY(frame->qtyResolution);
+    // the planes go back to frame pool unless a renderer has borrowed the frame
+    frame->pooled->Return();
+    ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
     SAFE_DELETE(frame);
+    ResumeIfStalled();
     uint64_t end4 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
     LOG(INFO)<<"delete frame time is:"<<(end4 - start4)<<endl;
     return RENDER_STATUS_OK;
@@ -632,5 +854,14 @@ bool VideoDecoder::IsReady(uint64_t pts)
     }
 }
 
+bool VideoDecoder::IsFrameReady(uint64_t pts)
+{
+    if (mDecCtx->has_frame_since(pts))
+    {
+        return true;
+    }
+    return mDecCtx->bPacketEOS || m_status == STATUS_PENDING || m_status == STATUS_IDLE;
+}
+
 VCD_NS_END
 #endif // _LINUX_OS_
@@ -36,6 +36,9 @@
 #define _VIDEODEOCODER_H__
 
 #include "MediaDecoder.h"
+#include "PacketQueue.h"
+#include "FramePool.h"
+#include "DecodeScheduler.h"
 #include "../../../utils/Threadable.h"
 #include <list>
 
@@ -43,21 +46,15 @@
 
 VCD_NS_BEGIN
 
-typedef struct PacketInfo{
-     AVPacket *pkt;
-     bool      bCodecChange;
-     bool      bEOS;
-     uint64_t  pts;
-     uint32_t  video_id;
-}PacketInfo;
-
 typedef struct DecodedFrame{
-     AVFrame            *av_frame;
+     PooledFrame        *pooled;
+     AVFrame            *av_frame;    //! the AVFrame of pooled
      RegionWisePacking  *rwpk;
      uint64_t           pts;
      bool               bFmtChange;
      int32_t            numQuality;
      SourceResolution   *qtyResolution;
+     DashPacketMeta     *meta;        //! the shared metadata rwpk and qtyResolution point into, or NULL
      uint32_t           video_id;
      bool               bEOS;
 }DecodedFrame;
@@ -67,6 +64,7 @@ typedef struct FrameData{
      RegionWisePacking* rwpk;
      int32_t            numQuality;
      SourceResolution*  qtyResolution;
+     DashPacketMeta*    meta;
      bool               bCodecChange;
      uint32_t           width;
      uint32_t           height;
@@ -88,7 +86,6 @@ public:
          tileRowNum     = 0;
          tileColNum     = 0;
          listFrame.clear();
-         listPacket.clear();
          listFrameData.clear();
          bPacketEOS     = false;
      };
@@ -96,36 +93,21 @@ public:
           while(get_size_of_frame()>0){
                DecodedFrame* frame = listFrame.front();
                listFrame.pop_front();
-               SAFE_DELETE_ARRAY(frame->rwpk->rectRegionPacking);
-               SAFE_DELETE(frame->rwpk);
-               SAFE_DELETE_ARRAY(frame->qtyResolution);
-               av_frame_free(&frame->av_frame);
+               ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
+               frame->pooled->Return();
                SAFE_DELETE(frame);
           }
 
-          while(get_size_of_packet()>0){
-               PacketInfo* pktInfo = listPacket.front();
-               listPacket.pop_front();
-               av_packet_unref(pktInfo->pkt);
-               SAFE_DELETE(pktInfo);
-          }
+          packetQueue.Clear();
 
           while(get_size_of_framedata()>0){
                FrameData* data = listFrameData.front();
                listFrameData.pop_front();
-               SAFE_DELETE_ARRAY(data->rwpk->rectRegionPacking);
-               SAFE_DELETE_ARRAY(data->qtyResolution);
-               SAFE_DELETE(data->rwpk);
+               ReleaseRegionInfo(data->rwpk, data->qtyResolution, data->meta);
                SAFE_DELETE(data);
           }
      };
 
-     void push_packet(PacketInfo* pktInfo)
-     {
-          ScopeLock lock(PacketLock);
-          listPacket.push_back(pktInfo);
-     };
-
      void push_framedata(FrameData* data)
      {
           ScopeLock lock(DataLock);
@@ -154,15 +136,6 @@ public:
           // }
      };
 
-     PacketInfo* pop_packet()
-     {
-          ScopeLock lock(PacketLock);
-          PacketInfo* pkt = listPacket.front();
-          if (!listPacket.empty())
-               listPacket.pop_front();
-          return pkt;
-     };
-
      FrameData* pop_framedata()
      {
           ScopeLock lock(DataLock);
@@ -195,18 +168,9 @@ public:
           return data;
      };
 
-     PacketInfo* get_front_of_packet()
-     {
-          ScopeLock lock(PacketLock);
-          PacketInfo* packet = listPacket.front();
-          return packet;
-     };
-
      uint32_t get_size_of_packet()
      {
-          ScopeLock lock(PacketLock);
-          uint32_t size = listPacket.size();
-          return size;
+          return packetQueue.Size();
      };
 
      uint32_t get_size_of_framedata()
@@ -222,12 +186,23 @@ public:
           uint32_t size = listFrame.size();
           return size;
      };
+
+     bool has_frame_since(uint64_t pts)
+     {
+          ScopeLock lock(FrameLock);
+          for (auto it=listFrame.begin(); it!=listFrame.end(); it++)
+          {
+               if ((*it)->pts >= pts)
+                    return true;
+          }
+          return false;
+     };
 public:
      AVCodecID                     codec_id;
      AVCodecContext               *codec_ctx;
      AVCodec                      *decoder;
      std::list<FrameData*>         listFrameData;
-     std::list<PacketInfo*>        listPacket;
+     PacketQueue                   packetQueue;
      std::list<DecodedFrame*>      listFrame;
      int32_t                       height;
      int32_t                       width;
@@ -239,13 +214,13 @@ public:
      uint32_t                      tileColNum;
 
      ThreadLock                    FrameLock;
-     ThreadLock                    PacketLock;
      ThreadLock                    DataLock;
      bool                          bPacketEOS;
 };
 
 
 class VideoDecoder : public MediaDecoder,
+                     public ScheduledDecoder,
                      public Threadable
 {
 public:
@@ -289,12 +264,37 @@ public:
 
      virtual bool IsReady(uint64_t pts);
 
+     virtual bool IsFrameReady(uint64_t pts);
+
+     virtual RenderStatus GetMetrics(struct DecodeMetrics *metrics);
+
+     //!
+     //! \brief  run the decoder on a shared scheduler instead of its own thread,
+     //!         must be set before Initialize
+     //!
+     void SetScheduler(DecodeScheduler *scheduler) { mScheduler = scheduler; };
+
+     //!
+     //! \brief  decode at most one packet, or flush the decoder when pending
+     //!
+     virtual bool DecodeStep();
+
+     virtual uint64_t GetDeadline();
+
+     virtual int32_t GetPriority() { return mPriority; };
+
 private:
      //!
      //! \brief  Decoder one frame
      //!
      RenderStatus DecodeFrame(AVPacket *pkt, uint32_t video_id, uint64_t pts);
 
+     //!
+     //! \brief  receive decoded frames until the codec wants the next packet,
+     //!         RENDER_WAIT if stalled for free frames with output still pending
+     //!
+     RenderStatus ReceiveFrames(uint32_t video_id, uint64_t start);
+
      //!
      //! \brief  close decoder
      //!
@@ -305,6 +305,11 @@ private:
      //!
      RenderStatus FlushDecoder(uint32_t video_id);
 
+     //!
+     //! \brief  receive the flushed frames, RENDER_WAIT if stalled for free frames
+     //!
+     RenderStatus DrainDecoder(uint32_t video_id);
+
      //!
      //! \brief  update media information with new packet input
      //!
@@ -322,6 +327,19 @@ private:
      //!
      DecodedFrame* GetFrame(uint64_t pts);
 
+     //!
+     //! \brief  get a free frame from frame pool, waiting for renderers to return one if needed.
+     //!         with a shared scheduler it doesn't wait, but marks the decoder stalled.
+     //!
+     PooledFrame* AcquireFrame();
+
+     //!
+     //! \brief  reschedule the decoder if it stopped for lack of free frames.
+     //!
+     void ResumeIfStalled();
+
+     void UpdateMetrics(uint64_t decodeTime);
+
      RenderStatus SetRegionInfo(struct RegionInfo *regionInfo, int32_t nQuality, SourceResolution *qtyRes);
 
 private:
@@ -332,10 +350,19 @@ private:
      DecoderContext              *mDecCtx;
      int32_t                      mVideoId;
      FrameHandler*                mHandler;
-     AVPacket                    *mPkt;
-     PacketInfo                  *mPktInfo;
-     RegionWisePacking           *mRwpk;
+     FramePool                   *mFramePool;
      bool                         mIsFlushed;
+     bool                         mDraining;       //! flush packet sent, frames still to be received
+     bool                         mOutputPending;  //! decoded frames left in the codec by a stalled step
+     DecodeScheduler             *mScheduler;
+     int32_t                      mPriority;       //! best quality ranking in the stream
+     bool                         mFrameStalled;   //! protected by mStallLock
+     ThreadLock                   mStallLock;
+     ThreadLock                   mMetricsLock;
+     uint64_t                     mDecodedFrames;
+     uint64_t                     mTotalDecodeTime;
+     uint64_t                     mLastDecodeTime;
+     uint64_t                     mMaxDecodeTime;
 };
 
 VCD_NS_END
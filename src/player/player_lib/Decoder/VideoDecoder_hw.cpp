@@ -240,23 +240,33 @@ RenderStatus VideoDecoder_hw::SendPacket(DashPacket* packet)
         {
             ANDROID_LOGD("Push empty buf at pts %ld ", packet->pts);
         }
-        data->rwpk = new RegionWisePacking;
-        *(data->rwpk) = *mRwpk;
-        data->rwpk->rectRegionPacking = new RectangularRegionWisePacking[mRwpk->numRegions];
-        memcpy_s(data->rwpk->rectRegionPacking, mRwpk->numRegions * sizeof(RectangularRegionWisePacking),
-           mRwpk->rectRegionPacking, mRwpk->numRegions * sizeof(RectangularRegionWisePacking));
-
         // data->pts = mPkt->pts;
         data->pts = mPktInfo->pts;
         data->numQuality = packet->numQuality;
-        data->qtyResolution = new SourceResolution[packet->numQuality];
         data->bCodecChange = mPktInfo->bCodecChange;
-        for(int i =0; i<data->numQuality; i++){
-            data->qtyResolution[i].height = packet->qtyResolution[i].height;
-            data->qtyResolution[i].width = packet->qtyResolution[i].width;
-            data->qtyResolution[i].left = packet->qtyResolution[i].left;
-            data->qtyResolution[i].top = packet->qtyResolution[i].top;
-            data->qtyResolution[i].qualityRanking = packet->qtyResolution[i].qualityRanking;
+        data->meta = packet->meta;
+        if (NULL != data->meta)
+        {
+            // shared metadata is immutable, a reference replaces the copy
+            data->meta->retain(data->meta);
+            data->rwpk = packet->rwpk;
+            data->qtyResolution = packet->qtyResolution;
+        }
+        else
+        {
+            data->rwpk = new RegionWisePacking;
+            *(data->rwpk) = *mRwpk;
+            data->rwpk->rectRegionPacking = new RectangularRegionWisePacking[mRwpk->numRegions];
+            memcpy_s(data->rwpk->rectRegionPacking, mRwpk->numRegions * sizeof(RectangularRegionWisePacking),
+               mRwpk->rectRegionPacking, mRwpk->numRegions * sizeof(RectangularRegionWisePacking));
+            data->qtyResolution = new SourceResolution[packet->numQuality];
+            for(int i =0; i<data->numQuality; i++){
+                data->qtyResolution[i].height = packet->qtyResolution[i].height;
+                data->qtyResolution[i].width = packet->qtyResolution[i].width;
+                data->qtyResolution[i].left = packet->qtyResolution[i].left;
+                data->qtyResolution[i].top = packet->qtyResolution[i].top;
+                data->qtyResolution[i].qualityRanking = packet->qtyResolution[i].qualityRanking;
+            }
         }
         mDecCtx->push_framedata(data);
         // for (uint32_t i = 0; i < data->rwpk->numRegions; i++){
@@ -356,6 +366,7 @@ RenderStatus VideoDecoder_hw::DecodeFrame(DashPacket *pkt, uint32_t video_id)
         frame->bFmtChange = data->bCodecChange;
         frame->numQuality = data->numQuality;
         frame->qtyResolution = data->qtyResolution;
+        frame->meta = data->meta;
         frame->video_id = video_id;
         frame->bEOS = false;
         mDecCtx->push_frame(frame);
@@ -531,10 +542,7 @@ DecodedFrame* VideoDecoder_hw::GetFrame(uint64_t pts)
         // drop over time frame.
         frame = mDecCtx->pop_frame();
         ANDROID_LOGD("Now will drop one frame since pts is over time! input pts is: %d, frame pts is %d, video id is %d", pts, frame->pts, mVideoId);
-        if (frame->rwpk)
-            SAFE_DELETE_ARRAY(frame->rwpk->rectRegionPacking);
-        SAFE_DELETE(frame->rwpk);
-        SAFE_DELETE_ARRAY(frame->qtyResolution);
+        ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
         SAFE_DELETE(frame);
     }
 
@@ -567,17 +575,17 @@ RenderStatus VideoDecoder_hw::UpdateFrame(uint64_t pts)
     }
     // ANDROID_LOGD("frame numQ is %d, rwpk is %p, rwpk->rect is %p, source reso is %p", frame->numQuality, frame->rwpk, frame->rwpk->rectRegionPacking, frame->qtyResolution);
     BufferInfo* buf_info = new BufferInfo;
-    buf_info->regionInfo = new RegionData(frame->rwpk, frame->numQuality, frame->qtyResolution);
+    buf_info->frameRef = nullptr;
+    buf_info->regionInfo = new RegionData(frame->rwpk, frame->numQuality, frame->qtyResolution, frame->meta);
     // ANDROID_LOGD("frame->numQuality: %d", frame->numQuality);
     if(NULL != this->mHandler){
         mHandler->process(buf_info);// pass region data
         // ANDROID_LOGD("VideoDecoder_hw::Do process");
     }
-    buf_info->regionInfo = nullptr;
+    // the handler keeps its own region data, drop the reference held by this one
+    SAFE_DELETE(buf_info->regionInfo);
     SAFE_DELETE(buf_info);
-    // SAFE_DELETE_ARRAY(frame->rwpk->rectRegionPacking);
-    SAFE_DELETE(frame->rwpk);
-    SAFE_DELETE_ARRAY(frame->qtyResolution);
+    ReleaseRegionInfo(frame->rwpk, frame->qtyResolution, frame->meta);
     SAFE_DELETE(frame);
     return RENDER_STATUS_OK;
 }
@@ -59,6 +59,7 @@ typedef struct DecodedFrame{
      bool               bFmtChange;
      int32_t            numQuality;
      SourceResolution   *qtyResolution;
+     DashPacketMeta     *meta;        //! the shared metadata rwpk and qtyResolution point into, or NULL
      uint32_t           video_id;
      bool               bEOS;
 }DecodedFrame;
@@ -68,6 +69,7 @@ typedef struct FrameData{
      RegionWisePacking* rwpk;
      int32_t            numQuality;
      SourceResolution*  qtyResolution;
+     DashPacketMeta*    meta;
      bool               bCodecChange;
      uint32_t           video_id;
 }FrameData;
@@ -100,9 +102,7 @@ public:
           while(get_size_of_framedata()>0){
                FrameData* data = listFrameData.front();
                listFrameData.pop_front();
-               SAFE_DELETE_ARRAY(data->rwpk->rectRegionPacking);
-               SAFE_DELETE_ARRAY(data->qtyResolution);
-               SAFE_DELETE(data->rwpk);
+               ReleaseRegionInfo(data->rwpk, data->qtyResolution, data->meta);
                SAFE_DELETE(data);
           }
      };
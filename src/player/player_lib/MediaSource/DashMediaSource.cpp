@@ -49,6 +49,7 @@
 #define DECODE_THREAD_COUNT 16
 #define MAX_PACKETS 16
 #define WAIT_PACKET_TIME_OUT 5000 // 5s
+#define WAIT_PACKET_SLICE 100 // ms to block for packets per call
 #define TEST_GET_PACKET_ONLY 0
 #define MAX_DUMP_FILE_NUM 10
 using namespace tinyxml2;
@@ -59,6 +60,7 @@ DashMediaSource::DashMediaSource() {
   pthread_mutex_init(&m_frameMutex, NULL);
   m_status = STATUS_UNKNOWN;
   m_handler = NULL;
+  m_waitingPacket = false;
   m_DecoderManager = NULL;
   GetStreamDumpedOptionParams();
   m_singleFile = NULL;
@@ -118,6 +120,11 @@ RenderStatus DashMediaSource::Initialize(struct RenderConfig renderConfig, Rende
   pCtxDashStreaming->omaf_params.http_params.conn_timeout = -1;  // not set
   pCtxDashStreaming->omaf_params.http_params.retry_times = 3;
   pCtxDashStreaming->omaf_params.http_params.total_timeout = -1;  // not set
+  pCtxDashStreaming->omaf_params.http_params.enable_event_loop = 1;  // epoll driven downloader
+  pCtxDashStreaming->omaf_params.http_params.enable_http2 = 1;
+  pCtxDashStreaming->omaf_params.http_params.max_concurrent_streams = 100;
+  // packed tile segments are only written when the packager enables them
+  pCtxDashStreaming->omaf_params.http_params.enable_packed_tile_fetch = 0;
 
   pCtxDashStreaming->omaf_params.max_parallel_transfers = 256;
   pCtxDashStreaming->omaf_params.segment_open_timeout_ms = 3000;           // ms
@@ -126,6 +133,23 @@ RenderStatus DashMediaSource::Initialize(struct RenderConfig renderConfig, Rende
 
   pCtxDashStreaming->omaf_params.synchronizer_params.enable = 0;               //  enable dash segment number syncer
   pCtxDashStreaming->omaf_params.synchronizer_params.segment_range_size = 20;  // 20
+
+  pCtxDashStreaming->omaf_params.abr_params.enable = 0;                    // enable tile quality adaptation
+  pCtxDashStreaming->omaf_params.abr_params.policy = OMAF_ABR_THROUGHPUT;  // or OMAF_ABR_BOLA
+  pCtxDashStreaming->omaf_params.abr_params.buffer_target_ms = 6000;       // ms
+  pCtxDashStreaming->omaf_params.predictor_params.prefetch_tile_num = 0;  // predicted tiles to prefetch, 0 to disable
+  pCtxDashStreaming->omaf_params.viewport_hysteresis = 0;                 // degrees moved before the tiles are selected again, 0 to disable
+  pCtxDashStreaming->omaf_params.cache_params.memory_budget = 64 * 1024 * 1024;  // bytes of segments kept in memory
+  pCtxDashStreaming->omaf_params.cache_params.spill_to_disk = 0;
+  pCtxDashStreaming->omaf_params.buffer_params.max_parsed_segments = 4;           // segments ahead of rendering
+  pCtxDashStreaming->omaf_params.buffer_params.max_packet_bytes = 256 * 1024 * 1024;  // bytes of parsed packets
+  pCtxDashStreaming->omaf_params.buffer_params.max_downloading_segments = 4;
+  pCtxDashStreaming->omaf_params.metrics_params.enable_dump = 0;             // periodic JSON dump of pipeline metrics
+  pCtxDashStreaming->omaf_params.metrics_params.dump_interval_ms = 1000;
+  pCtxDashStreaming->omaf_params.metrics_params.dump_path = nullptr;
+  pCtxDashStreaming->omaf_params.log_params.min_level = renderConfig.minLogLevel;  // glog severities share the LogLevel values
+  pCtxDashStreaming->omaf_params.log_params.enable_async = 1;               // keep log formatting off the frame loops
+  pCtxDashStreaming->omaf_params.log_params.async_queue_size = 4096;
   pCtxDashStreaming->omaf_params.max_decode_width = renderConfig.maxVideoDecodeWidth;
   pCtxDashStreaming->omaf_params.max_decode_height = renderConfig.maxVideoDecodeHeight;
   PluginDef def;
@@ -346,57 +370,72 @@ RenderStatus DashMediaSource::ChangeViewport(HeadPose *pose) {
 void DashMediaSource::ProcessVideoPacket() {
   VideoInfo vi;
   mMediaInfo.GetActiveVideoInfo(vi);
-  // 1. get one packet from DashStreaming lib.
+  // 1. wait for a batch of packets from DashStreaming lib, without holding the lock.
   DashPacket dashPkt[MAX_PACKETS];
   memset(dashPkt, 0, MAX_PACKETS * sizeof(DashPacket));
   int dashPktNum = 0;
   static bool needHeaders = true;
-  static uint64_t currentWaitTime = 0;
-  uint64_t pts = 0;
-  int ret =
-      OmafAccess_GetPacket(m_handler, vi.streamID, &(dashPkt[0]), &dashPktNum, (uint64_t *)&pts, needHeaders, false);
+  int ret = OmafAccess_WaitPackets(m_handler, vi.streamID, &(dashPkt[0]), MAX_PACKETS, &dashPktNum,
+                                   WAIT_PACKET_SLICE, needHeaders, false);
   if (ERROR_NONE != ret) {
     // LOG(INFO) << "Get packet failed: stream_id:" << vi.streamID << ", ret:" << ret << std::endl;
-    currentWaitTime++;
-    if (currentWaitTime > WAIT_PACKET_TIME_OUT) // wait 5s but get packet failed
+    // the failures may return at once, so the wait is measured in time rather than in calls
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!m_waitingPacket) {
+      m_waitingPacket = true;
+      m_waitStartTime = now;
+    } else if (std::chrono::duration_cast<std::chrono::milliseconds>(now - m_waitStartTime).count() >
+               WAIT_PACKET_TIME_OUT) // wait 5s but get packet failed
     {
       m_status = STATUS_TIMEOUT;
       LOG(ERROR) << " Wait too long to get packet from Omaf Dash Access library! Force to quit! " << std::endl;
     }
+    if (ERROR_NULL_PACKET != ret) usleep(1000);
     return;
   }
-  currentWaitTime = 0;
-  if (dashPkt[0].bEOS) {
-    m_status = STATUS_STOPPED;
-  }
-  LOG(INFO) << "Get packet has done! and pts is " << dashPkt[0].pts << std::endl;
+  m_waitingPacket = false;
+
+  // 2. send the packets frame by frame, a frame is the packets with the same pts
+  int frameStart = 0;
+  while (frameStart < dashPktNum) {
+    int frameNum = 1;
+    while (frameStart + frameNum < dashPktNum && dashPkt[frameStart + frameNum].pts == dashPkt[frameStart].pts) {
+      frameNum++;
+    }
+    DashPacket *framePkt = &(dashPkt[frameStart]);
+    frameStart += frameNum;
+
+    ScopeLock lock(m_Lock);
+    if (framePkt[0].bEOS) {
+      m_status = STATUS_STOPPED;
+    }
+    LOG(INFO) << "Get packet has done! and pts is " << framePkt[0].pts << std::endl;
 #ifndef _ANDROID_OS_
 #ifdef _USE_TRACE_
-  // trace
-  tracepoint(mthq_tp_provider, T8_get_packet, dashPkt[0].pts);
+    // trace
+    tracepoint(mthq_tp_provider, T8_get_packet, framePkt[0].pts);
 #endif
 #endif
-  if (m_needStreamDumped && !m_dumpedFile.empty()) {
-    for (uint32_t i = 0; i < dashPktNum; i++)
-    {
-      fwrite(dashPkt[i].buf, 1, dashPkt[i].size, m_dumpedFile[i]);
+    if (m_needStreamDumped && !m_dumpedFile.empty()) {
+      for (int i = 0; i < frameNum && i < (int)m_dumpedFile.size(); i++)
+      {
+        fwrite(framePkt[i].buf, 1, framePkt[i].size, m_dumpedFile[i]);
+      }
     }
-  }
 #if !TEST_GET_PACKET_ONLY
-  if (NULL != m_DecoderManager) {
-    RenderStatus ret = m_DecoderManager->SendVideoPackets(&(dashPkt[0]), dashPktNum);
-    // needHeaders = false;
-    if (RENDER_STATUS_OK != ret) {
-      LOG(INFO) << "m_DecoderManager::SendVideoPackets: stream_id:" << vi.streamID << " segment id" << dashPkt[0].segID
-                << std::endl;
+    if (NULL != m_DecoderManager) {
+      RenderStatus ret = m_DecoderManager->SendVideoPackets(framePkt, frameNum);
+      // needHeaders = false;
+      if (RENDER_STATUS_OK != ret) {
+        LOG(INFO) << "m_DecoderManager::SendVideoPackets: stream_id:" << vi.streamID << " segment id" << framePkt[0].segID
+                  << std::endl;
+      }
     }
-  }
 #endif
+  }
+  // the decoders take the payloads and the references to the shared metadata they keep
   for (int i = 0; i < dashPktNum; i++) {
-    SAFE_FREE(dashPkt[i].buf);
-    if (dashPkt[i].rwpk) SAFE_DELETE_ARRAY(dashPkt[i].rwpk->rectRegionPacking);
-    SAFE_DELETE(dashPkt[i].rwpk);
-    SAFE_DELETE_ARRAY(dashPkt[i].qtyResolution);
+    OmafAccess_ReleasePacket(m_handler, &(dashPkt[i]));
   }
 }
 
@@ -411,12 +450,9 @@ void DashMediaSource::Run() {
   }
 
   m_status = STATUS_PLAYING;
+  // ProcessVideoPacket blocks until packets arrive and takes the lock per frame
   while (m_status != STATUS_STOPPED && m_status != STATUS_TIMEOUT) {
-    {
-      ScopeLock lock(m_Lock);
-      ProcessVideoPacket();
-    }
-    usleep(1000);
+    ProcessVideoPacket();
   }
 }
 
@@ -39,6 +39,7 @@
 #include "../Decoder/DecoderManager.h"
 #include "../../../utils/Threadable.h"
 #include <list>
+#include <chrono>
 
 VCD_NS_BEGIN
 
@@ -159,6 +160,8 @@ private:
 
     void                               *m_handler;//Dash Source handle
     int32_t                             m_status;
+    bool                                m_waitingPacket;//whether the packets are being waited for since m_waitStartTime
+    std::chrono::steady_clock::time_point m_waitStartTime;
     pthread_mutex_t                     m_frameMutex;
     DecoderManager                     *m_DecoderManager;
     ThreadLock                          m_Lock;
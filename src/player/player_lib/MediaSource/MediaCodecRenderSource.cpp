@@ -138,7 +138,7 @@ RenderStatus MediaCodecRenderSource::process(BufferInfo* bufInfo)
     RenderStatus ret = RENDER_STATUS_OK;
     // ANDROID_LOGD("input rwpk num: %d, one rrwpk w: %d, h: %d, l: %d, t: %d", bufInfo->regionInfo->GetRegionWisePacking()->numRegions, bufInfo->regionInfo->GetRegionWisePacking()->rectRegionPacking[0].projRegWidth,
     // bufInfo->regionInfo->GetRegionWisePacking()->rectRegionPacking[0].projRegHeight, bufInfo->regionInfo->GetRegionWisePacking()->rectRegionPacking[0].projRegLeft, bufInfo->regionInfo->GetRegionWisePacking()->rectRegionPacking[0].projRegTop);
-    RegionData* curData = new RegionData(bufInfo->regionInfo->GetRegionWisePacking(), bufInfo->regionInfo->GetSourceInRegion(), bufInfo->regionInfo->GetSourceInfo());
+    RegionData* curData = new RegionData(bufInfo->regionInfo->GetRegionWisePacking(), bufInfo->regionInfo->GetSourceInRegion(), bufInfo->regionInfo->GetSourceInfo(), bufInfo->regionInfo->GetPacketMeta());
     mCurRegionInfo.push_back(curData);
     ANDROID_LOGD("mCurrentRegionInfo size is %d", mCurRegionInfo.size());
     // ANDROID_LOGD("mCurRegionInfo rwpk num: %d, one rrwpk w: %d, h: %d, l: %d, t: %d", curData->GetRegionWisePacking()->numRegions, curData->GetRegionWisePacking()->rectRegionPacking[0].projRegWidth,
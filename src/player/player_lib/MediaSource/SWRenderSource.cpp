@@ -36,12 +36,14 @@
 #include "SWRenderSource.h"
 #include <chrono>
 #include "../Mesh/Render2TextureMesh.h"
+#include "../Decoder/FramePool.h"
 
 VCD_NS_BEGIN
 
 SWRenderSource::SWRenderSource()
 {
     bInited = false;
+    m_heldFrame = NULL;
     //1.render to texture : vertex and texCoords assign
     m_videoShaderOfR2T.Bind();
     m_meshOfR2T = new Render2TextureMesh();
@@ -306,6 +308,11 @@ RenderStatus SWRenderSource::UpdateR2T(BufferInfo* bufInfo)
 
 RenderStatus SWRenderSource::DestroyRenderSource()
 {
+    if (m_heldFrame)
+    {
+        m_heldFrame->Return();
+        m_heldFrame = NULL;
+    }
     RenderBackend *renderBackend = RENDERBACKEND::GetInstance();
     uint32_t textureOfR2T = GetTextureOfR2T();
     if (textureOfR2T)
@@ -343,19 +350,24 @@ RenderStatus SWRenderSource::process(BufferInfo* bufInfo)
     LOG(INFO)<<"init process is:"<<(end3 - start3)<<endl;
     // mCurRegionInfo = bufInfo->regionInfo;
     uint64_t start1 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
-    RegionData* curData = new RegionData(bufInfo->regionInfo->GetRegionWisePacking(), bufInfo->regionInfo->GetSourceInRegion(), bufInfo->regionInfo->GetSourceInfo());
+    RegionData* curData = new RegionData(bufInfo->regionInfo->GetRegionWisePacking(), bufInfo->regionInfo->GetSourceInRegion(), bufInfo->regionInfo->GetSourceInfo(), bufInfo->regionInfo->GetPacketMeta());
     mCurRegionInfo.push_back(curData);
     // LOG(INFO)<<"regionInfo ptr:"<<mCurRegionInfo->GetSourceInRegion()<<" rwpk:"<<mCurRegionInfo->GetRegionWisePacking()->rectRegionPacking<<" source:"<<mCurRegionInfo->GetSourceInfo()->width<<endl;
     uint64_t end1 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
     LOG(INFO)<<"regioninfo process is:"<<(end1 - start1)<<endl;
+    // draw from the decoder planes directly, and keep the frame until the next one is drawn
+    if (bufInfo->frameRef) bufInfo->frameRef->Borrow();
     uint64_t start2 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
     ret = this->UpdateR2T(bufInfo);
     uint64_t end2 = std::chrono::duration_cast<std::chrono::milliseconds>(clock.now().time_since_epoch()).count();
     LOG(INFO)<<"UpdateR2T process is:"<<(end2 - start2)<<endl;
     if(RENDER_STATUS_OK!=ret){
         LOG(ERROR)<<"Video "<< GetVideoID() <<": UpdateR2T failed"<<std::endl;
+        if (bufInfo->frameRef) bufInfo->frameRef->Return();
         return ret;
     }
+    if (m_heldFrame) m_heldFrame->Return();
+    m_heldFrame = bufInfo->frameRef;
 
     return RENDER_STATUS_OK;
 }
@@ -100,6 +100,7 @@ private:
     RenderStatus CreateR2TFBO(bool hasInited);
 private:
     bool            bInited;
+    PooledFrame    *m_heldFrame;   //!< decoded frame borrowed until the next one is drawn
 };
 
 VCD_NS_END
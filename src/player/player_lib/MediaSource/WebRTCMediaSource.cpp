@@ -512,6 +512,7 @@ bool WebRTCMediaSource::OnVideoPacket(
   dashPkt.size = bitstream_buf->size();
   dashPkt.pts = frame->time_stamp;
   dashPkt.rwpk = rwpk;
+  dashPkt.meta = NULL;
   dashPkt.bEOS = false;
 
   RenderStatus ret = m_DecoderManager->SendVideoPackets(&dashPkt, 1);
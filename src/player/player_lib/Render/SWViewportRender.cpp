@@ -0,0 +1,754 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     SWViewportRender.cpp
+//! \brief    Implement class for SWViewportRender.
+//!
+
+#include "SWViewportRender.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SW_RENDER_X86
+#endif
+
+VCD_NS_BEGIN
+
+#define SW_RENDER_PI 3.14159265358979323846f
+
+//! planes and coordinates a row kernel samples from
+struct SamplePlanes {
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+    int32_t        strideY;
+    int32_t        strideC;
+    float          chromaWidth;
+    float          chromaHeight;
+    bool           wrapX;
+};
+
+static inline float Lerp2D(const uint8_t *p, int32_t stride, float fx, float fy)
+{
+    float a = p[0] + (p[1] - p[0]) * fx;
+    float b = p[stride] + (p[stride + 1] - p[stride]) * fx;
+    return a + (b - a) * fy;
+}
+
+static inline uint32_t ClampToByte(float v)
+{
+    v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+    return (uint32_t)(v + 0.5f);
+}
+
+static inline void ChromaCoordinate(const SamplePlanes &sp, float x, float y, float *cx, float *cy)
+{
+    *cx = (x + 0.5f) * 0.5f - 0.5f;
+    *cy = (y + 0.5f) * 0.5f - 0.5f;
+    if (*cx < 0.0f) *cx = sp.wrapX ? *cx + sp.chromaWidth : 0.0f;
+    if (!sp.wrapX && *cx > sp.chromaWidth - 1) *cx = sp.chromaWidth - 1;
+    *cy = std::min(std::max(*cy, 0.0f), sp.chromaHeight - 1);
+}
+
+//! same math as shader_r2t_fs, on 0..255 values
+static inline uint32_t YUVToRGBA(float y, float u, float v)
+{
+    float c = (y - 16.0f) * 1.164f;
+    u -= 128.0f;
+    v -= 128.0f;
+    uint32_t r = ClampToByte(c + 1.596f * v);
+    uint32_t g = ClampToByte(c - 0.813f * v - 0.392f * u);
+    uint32_t b = ClampToByte(c + 2.017f * u);
+    return r | (g << 8) | (b << 16) | 0xFF000000;
+}
+
+static void SampleRowC(const SamplePlanes &sp, const float *xs, const float *ys, uint32_t begin, uint32_t num, uint32_t *out)
+{
+    for (uint32_t i = begin; i < num; i++)
+    {
+        float x = xs[i];
+        float y = ys[i];
+        int32_t x0 = (int32_t)x;
+        int32_t y0 = (int32_t)y;
+        float yv = Lerp2D(sp.y + y0 * sp.strideY + x0, sp.strideY, x - x0, y - y0);
+
+        float cx, cy;
+        ChromaCoordinate(sp, x, y, &cx, &cy);
+        int32_t cx0 = (int32_t)cx;
+        int32_t cy0 = (int32_t)cy;
+        int32_t offset = cy0 * sp.strideC + cx0;
+        float uv = Lerp2D(sp.u + offset, sp.strideC, cx - cx0, cy - cy0);
+        float vv = Lerp2D(sp.v + offset, sp.strideC, cx - cx0, cy - cy0);
+        out[i] = YUVToRGBA(yv, uv, vv);
+    }
+}
+
+#ifdef SW_RENDER_X86
+//! bilinear taps of 8 pixels, each gather loads the pixel and its right neighbour
+__attribute__((target("avx2")))
+static inline __m256 Lerp2DAVX2(const uint8_t *base, int32_t stride, __m256i idx, __m256 fx, __m256 fy)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i top = _mm256_i32gather_epi32((const int *)base, idx, 1);
+    __m256i bottom = _mm256_i32gather_epi32((const int *)(base + stride), idx, 1);
+    __m256 p00 = _mm256_cvtepi32_ps(_mm256_and_si256(top, mask));
+    __m256 p01 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(top, 8), mask));
+    __m256 p10 = _mm256_cvtepi32_ps(_mm256_and_si256(bottom, mask));
+    __m256 p11 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bottom, 8), mask));
+    __m256 a = _mm256_add_ps(p00, _mm256_mul_ps(_mm256_sub_ps(p01, p00), fx));
+    __m256 b = _mm256_add_ps(p10, _mm256_mul_ps(_mm256_sub_ps(p11, p10), fx));
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), fy));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ClampToByteAVX2(__m256 v)
+{
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(v, _mm256_set1_ps(0.5f)));
+}
+
+__attribute__((target("avx2")))
+static void SampleRowAVX2(const SamplePlanes &sp, const float *xs, const float *ys, uint32_t num, uint32_t *out)
+{
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 chromaWidth = _mm256_set1_ps(sp.wrapX ? sp.chromaWidth : 0.0f);
+    const __m256 chromaRight = _mm256_set1_ps(sp.wrapX ? sp.chromaWidth : sp.chromaWidth - 1);
+    const __m256 chromaBottom = _mm256_set1_ps(sp.chromaHeight - 1);
+    const __m256i strideY = _mm256_set1_epi32(sp.strideY);
+    const __m256i strideC = _mm256_set1_epi32(sp.strideC);
+    const __m256 c16 = _mm256_set1_ps(16.0f);
+    const __m256 c128 = _mm256_set1_ps(128.0f);
+    const __m256 kY = _mm256_set1_ps(1.164f);
+    const __m256 kRV = _mm256_set1_ps(1.596f);
+    const __m256 kGV = _mm256_set1_ps(0.813f);
+    const __m256 kGU = _mm256_set1_ps(0.392f);
+    const __m256 kBU = _mm256_set1_ps(2.017f);
+    const __m256i alpha = _mm256_set1_epi32((int32_t)0xFF000000);
+
+    uint32_t i = 0;
+    for (; i + 8 <= num; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256i x0 = _mm256_cvttps_epi32(x);
+        __m256i y0 = _mm256_cvttps_epi32(y);
+        __m256 fx = _mm256_sub_ps(x, _mm256_cvtepi32_ps(x0));
+        __m256 fy = _mm256_sub_ps(y, _mm256_cvtepi32_ps(y0));
+        __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(y0, strideY), x0);
+        __m256 yv = Lerp2DAVX2(sp.y, sp.strideY, idx, fx, fy);
+
+        __m256 cx = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(x, half), half), half);
+        __m256 cy = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(y, half), half), half);
+        // wrap ERP at the left border, clamp the other borders
+        __m256 negative = _mm256_cmp_ps(cx, zero, _CMP_LT_OQ);
+        cx = _mm256_blendv_ps(cx, _mm256_add_ps(cx, chromaWidth), negative);
+        cx = _mm256_min_ps(_mm256_max_ps(cx, zero), chromaRight);
+        cy = _mm256_min_ps(_mm256_max_ps(cy, zero), chromaBottom);
+        __m256i cx0 = _mm256_cvttps_epi32(cx);
+        __m256i cy0 = _mm256_cvttps_epi32(cy);
+        __m256 cfx = _mm256_sub_ps(cx, _mm256_cvtepi32_ps(cx0));
+        __m256 cfy = _mm256_sub_ps(cy, _mm256_cvtepi32_ps(cy0));
+        __m256i cidx = _mm256_add_epi32(_mm256_mullo_epi32(cy0, strideC), cx0);
+        __m256 uv = _mm256_sub_ps(Lerp2DAVX2(sp.u, sp.strideC, cidx, cfx, cfy), c128);
+        __m256 vv = _mm256_sub_ps(Lerp2DAVX2(sp.v, sp.strideC, cidx, cfx, cfy), c128);
+
+        __m256 c = _mm256_mul_ps(_mm256_sub_ps(yv, c16), kY);
+        __m256i r = ClampToByteAVX2(_mm256_add_ps(c, _mm256_mul_ps(kRV, vv)));
+        __m256i g = ClampToByteAVX2(_mm256_sub_ps(_mm256_sub_ps(c, _mm256_mul_ps(kGV, vv)), _mm256_mul_ps(kGU, uv)));
+        __m256i b = ClampToByteAVX2(_mm256_add_ps(c, _mm256_mul_ps(kBU, uv)));
+        __m256i rgba = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                       _mm256_or_si256(_mm256_slli_epi32(b, 16), alpha));
+        _mm256_storeu_si256((__m256i *)(out + i), rgba);
+    }
+    SampleRowC(sp, xs, ys, i, num, out);
+}
+#endif
+
+SWViewportRender::SWViewportRender()
+{
+    mProjFormat     = VCD::OMAF::PF_ERP;
+    mProjWidth      = 0;
+    mProjHeight     = 0;
+    mFaceWidth      = 0;
+    mFaceHeight     = 0;
+    mViewportWidth  = 0;
+    mViewportHeight = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        mPlanes[i]  = NULL;
+        mStrides[i] = 0;
+    }
+#ifdef SW_RENDER_X86
+    mHasAVX2 = __builtin_cpu_supports("avx2");
+#else
+    mHasAVX2 = false;
+#endif
+    mUseAVX2     = mHasAVX2;
+    mGridCols    = 0;
+    mGridRows    = 0;
+    mTanHalfH    = 0;
+    mTanHalfV    = 0;
+    mTaskNum     = 0;
+    mTaskNext    = 0;
+    mTaskPending = 0;
+    mTaskChunk   = 1;
+    mGeneration  = 0;
+    mStop        = false;
+}
+
+SWViewportRender::~SWViewportRender()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mTaskReady.notify_all();
+    for (auto &worker : mWorkers)
+    {
+        worker.join();
+    }
+    mWorkers.clear();
+    FreePlanes();
+}
+
+void SWViewportRender::FreePlanes()
+{
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        SAFE_FREE(mPlanes[i]);
+    }
+}
+
+RenderStatus SWViewportRender::Initialize(int32_t projFormat, uint32_t projWidth, uint32_t projHeight,
+                                          uint32_t viewportWidth, uint32_t viewportHeight, uint32_t threadNum)
+{
+    if (projFormat != VCD::OMAF::PF_ERP && projFormat != VCD::OMAF::PF_CUBEMAP)
+    {
+        LOG(ERROR) << "Projection format " << projFormat << " is not supported by software render!" << std::endl;
+        return RENDER_ERROR;
+    }
+    if (projWidth < 2 || projHeight < 2 || viewportWidth == 0 || viewportHeight == 0 || !mWorkers.empty())
+    {
+        return RENDER_ERROR;
+    }
+    mProjFormat     = projFormat;
+    mProjWidth      = projWidth & ~1;
+    mProjHeight     = projHeight & ~1;
+    mFaceWidth      = mProjWidth / 3;
+    mFaceHeight     = mProjHeight / 2;
+    mViewportWidth  = viewportWidth;
+    mViewportHeight = viewportHeight;
+
+    // one padding column for the wrapped or weightless right tap, one padding
+    // row for the weightless bottom tap, gathers read up to 3 bytes further
+    FreePlanes();
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        uint32_t width  = i ? mProjWidth / 2 : mProjWidth;
+        uint32_t height = i ? mProjHeight / 2 : mProjHeight;
+        mStrides[i] = (width + SW_RENDER_PLANE_PAD + SW_RENDER_PLANE_PAD - 1) / SW_RENDER_PLANE_PAD * SW_RENDER_PLANE_PAD;
+        size_t size = (size_t)mStrides[i] * (height + 1) + SW_RENDER_PLANE_PAD;
+        void *plane = NULL;
+        if (0 != posix_memalign(&plane, SW_RENDER_PLANE_PAD, size))
+        {
+            LOG(ERROR) << "Failed to allocate projected plane " << i << std::endl;
+            FreePlanes();
+            return RENDER_ERROR;
+        }
+        mPlanes[i] = (uint8_t *)plane;
+        memset(mPlanes[i], i ? 128 : 16, size);
+    }
+
+    mGridCols = (mViewportWidth + SW_RENDER_MAP_GRID - 1) / SW_RENDER_MAP_GRID + 1;
+    mGridRows = (mViewportHeight + SW_RENDER_MAP_GRID - 1) / SW_RENDER_MAP_GRID + 1;
+    mGridX.resize(mGridCols * mGridRows);
+    mGridY.resize(mGridCols * mGridRows);
+    mGridFace.resize(mGridCols * mGridRows);
+    mBlockExact.resize((mGridCols - 1) * (mGridRows - 1));
+
+    if (0 == threadNum)
+    {
+        threadNum = std::thread::hardware_concurrency();
+    }
+    threadNum = std::max(1u, std::min(threadNum, (uint32_t)MAX_SW_RENDER_THREAD));
+    mRowX.resize((size_t)threadNum * mViewportWidth);
+    mRowY.resize((size_t)threadNum * mViewportWidth);
+    // the calling thread works too
+    for (uint32_t i = 1; i < threadNum; i++)
+    {
+        mWorkers.push_back(std::thread(&SWViewportRender::WorkerLoop, this, i));
+    }
+    LOG(INFO) << "Software render " << mProjWidth << "x" << mProjHeight << " to " << mViewportWidth << "x" << mViewportHeight
+              << " with " << threadNum << " threads, AVX2 " << (mUseAVX2 ? "on" : "off") << std::endl;
+    return RENDER_STATUS_OK;
+}
+
+uint8_t* SWViewportRender::GetProjectedPlane(uint32_t idx, uint32_t *stride)
+{
+    if (idx >= 3) return NULL;
+    if (stride) *stride = mStrides[idx];
+    return mPlanes[idx];
+}
+
+void SWViewportRender::WorkerLoop(uint32_t slot)
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mTaskReady.wait(lock, [&] { return mStop || (mGeneration != seen && mTaskNext < mTaskNum); });
+        if (mStop)
+        {
+            break;
+        }
+        seen = mGeneration;
+        while (mTaskNext < mTaskNum)
+        {
+            uint32_t begin = mTaskNext;
+            uint32_t end = std::min(begin + mTaskChunk, mTaskNum);
+            mTaskNext = end;
+            lock.unlock();
+            mTask(begin, end, slot);
+            lock.lock();
+            if (--mTaskPending == 0)
+            {
+                mTaskDone.notify_all();
+            }
+        }
+    }
+}
+
+void SWViewportRender::RunParallel(uint32_t num, std::function<void(uint32_t, uint32_t, uint32_t)> task)
+{
+    if (0 == num) return;
+    if (mWorkers.empty())
+    {
+        task(0, num, 0);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    // several chunks per thread so a slow chunk does not leave the others idle
+    mTask        = task;
+    mTaskNum     = num;
+    mTaskNext    = 0;
+    mTaskChunk   = std::max(1u, num / ((uint32_t)(mWorkers.size() + 1) * 4));
+    mTaskPending = (num + mTaskChunk - 1) / mTaskChunk;
+    mGeneration++;
+    mTaskReady.notify_all();
+    while (mTaskNext < mTaskNum)
+    {
+        uint32_t begin = mTaskNext;
+        uint32_t end = std::min(begin + mTaskChunk, mTaskNum);
+        mTaskNext = end;
+        lock.unlock();
+        task(begin, end, 0);
+        lock.lock();
+        mTaskPending--;
+    }
+    mTaskDone.wait(lock, [&] { return 0 == mTaskPending; });
+    mTask = nullptr;
+}
+
+//! quality ranking of the source a region is packed from, 0 if unknown
+static int32_t RegionQuality(RectangularRegionWisePacking *region, SourceResolution *sources, int32_t sourceNum)
+{
+    for (int32_t i = 0; i < sourceNum; i++)
+    {
+        if (region->packedRegLeft >= sources[i].left && region->packedRegLeft < sources[i].left + sources[i].width
+            && region->packedRegTop >= sources[i].top && region->packedRegTop < sources[i].top + sources[i].height)
+        {
+            return sources[i].qualityRanking;
+        }
+    }
+    return 0;
+}
+
+static bool ProjectedOverlap(RectangularRegionWisePacking *a, RectangularRegionWisePacking *b)
+{
+    return a->projRegLeft < b->projRegLeft + b->projRegWidth && b->projRegLeft < a->projRegLeft + a->projRegWidth
+        && a->projRegTop < b->projRegTop + b->projRegHeight && b->projRegTop < a->projRegTop + a->projRegHeight;
+}
+
+RenderStatus SWViewportRender::UnpackRegions(uint8_t *planes[3], int32_t strides[3], RegionWisePacking *rwpk,
+                                             SourceResolution *sources, int32_t sourceNum)
+{
+    if (NULL == planes || NULL == strides || NULL == rwpk || NULL == rwpk->rectRegionPacking || NULL == mPlanes[0])
+    {
+        return RENDER_NULL_HANDLE;
+    }
+    std::vector<RectangularRegionWisePacking*> regions;
+    for (uint32_t i = 0; i < rwpk->numRegions; i++)
+    {
+        RectangularRegionWisePacking *region = &(rwpk->rectRegionPacking[i]);
+        if (region->projRegLeft + region->projRegWidth > mProjWidth || region->projRegTop + region->projRegHeight > mProjHeight
+            || region->packedRegLeft + region->packedRegWidth > rwpk->packedPicWidth
+            || region->packedRegTop + region->packedRegHeight > rwpk->packedPicHeight
+            || region->projRegWidth < 2 || region->projRegHeight < 2 || region->packedRegWidth < 2 || region->packedRegHeight < 2)
+        {
+            LOG(WARNING) << "Region " << i << " is out of the projected or packed picture, skip it!" << std::endl;
+            continue;
+        }
+        regions.push_back(region);
+    }
+    // the high quality ranking is the smallest value, so copy the largest first
+    if (sources && sourceNum > 0)
+    {
+        std::stable_sort(regions.begin(), regions.end(),
+                         [&](RectangularRegionWisePacking *a, RectangularRegionWisePacking *b) {
+                             return RegionQuality(a, sources, sourceNum) > RegionQuality(b, sources, sourceNum);
+                         });
+    }
+    // a region goes to the pass after the last one it overlaps, so the regions
+    // copied in parallel are disjoint and the passes keep the order above
+    std::vector<uint32_t> regionPass(regions.size(), 0);
+    uint32_t passNum = regions.empty() ? 0 : 1;
+    for (uint32_t i = 0; i < regions.size(); i++)
+    {
+        for (uint32_t j = 0; j < i; j++)
+        {
+            if (regionPass[j] + 1 > regionPass[i] && ProjectedOverlap(regions[i], regions[j]))
+            {
+                regionPass[i] = regionPass[j] + 1;
+            }
+        }
+        passNum = std::max(passNum, regionPass[i] + 1);
+    }
+    std::vector<RectangularRegionWisePacking*> passRegions;
+    for (uint32_t pass = 0; pass < passNum; pass++)
+    {
+        passRegions.clear();
+        for (uint32_t i = 0; i < regions.size(); i++)
+        {
+            if (regionPass[i] == pass) passRegions.push_back(regions[i]);
+        }
+        RunParallel(passRegions.size(), [&](uint32_t begin, uint32_t end, uint32_t slot) {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                UnpackRegion(passRegions[i], planes, strides);
+            }
+        });
+    }
+    FillWrapColumn();
+    return RENDER_STATUS_OK;
+}
+
+void SWViewportRender::UnpackRegion(RectangularRegionWisePacking *region, uint8_t *planes[3], int32_t strides[3])
+{
+    uint8_t type = region->transformType;
+    for (uint32_t p = 0; p < 3; p++)
+    {
+        uint32_t shift = p ? 1 : 0;
+        uint32_t projLeft = region->projRegLeft >> shift;
+        uint32_t projTop = region->projRegTop >> shift;
+        uint32_t projWidth = region->projRegWidth >> shift;
+        uint32_t projHeight = region->projRegHeight >> shift;
+        uint32_t packedLeft = region->packedRegLeft >> shift;
+        uint32_t packedTop = region->packedRegTop >> shift;
+        uint32_t packedWidth = region->packedRegWidth >> shift;
+        uint32_t packedHeight = region->packedRegHeight >> shift;
+        const uint8_t *src = planes[p];
+        uint8_t *dst = mPlanes[p];
+
+        if (0 == type)
+        {
+            // nearest sampling at pixel centres like the GL_NEAREST blit
+            std::vector<uint32_t> srcX(projWidth);
+            for (uint32_t i = 0; i < projWidth; i++)
+            {
+                srcX[i] = packedLeft + (uint32_t)(((uint64_t)(2 * i + 1) * packedWidth) / (2 * projWidth));
+            }
+            for (uint32_t j = 0; j < projHeight; j++)
+            {
+                uint32_t srcY = packedTop + (uint32_t)(((uint64_t)(2 * j + 1) * packedHeight) / (2 * projHeight));
+                const uint8_t *srcRow = src + (size_t)srcY * strides[p];
+                uint8_t *dstRow = dst + (size_t)(projTop + j) * mStrides[p] + projLeft;
+                if (projWidth == packedWidth)
+                {
+                    memcpy(dstRow, srcRow + packedLeft, projWidth);
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < projWidth; i++)
+                    {
+                        dstRow[i] = srcRow[srcX[i]];
+                    }
+                }
+            }
+            continue;
+        }
+
+        // packed region is the projected one transformed, rotations swap its sides
+        bool swap = type >= 4;
+        uint32_t transWidth = swap ? projHeight : projWidth;
+        uint32_t transHeight = swap ? projWidth : projHeight;
+        for (uint32_t j = 0; j < projHeight; j++)
+        {
+            uint8_t *dstRow = dst + (size_t)(projTop + j) * mStrides[p] + projLeft;
+            for (uint32_t i = 0; i < projWidth; i++)
+            {
+                uint32_t a = i, b = j;
+                switch (type)
+                {
+                    case 1: a = projWidth - 1 - i; b = j; break;                      // mirroring horizontally
+                    case 2: a = projWidth - 1 - i; b = projHeight - 1 - j; break;     // rotation 180
+                    case 3: a = i; b = projHeight - 1 - j; break;                     // rotation 180 after mirroring
+                    case 4: a = projHeight - 1 - j; b = projWidth - 1 - i; break;     // rotation 90 before mirroring
+                    case 5: a = j; b = projWidth - 1 - i; break;                      // rotation 90 anticlockwise
+                    case 6: a = j; b = i; break;                                      // rotation 270 before mirroring
+                    case 7: a = projHeight - 1 - j; b = i; break;                     // rotation 270 anticlockwise
+                    default: break;
+                }
+                uint32_t srcX = packedLeft + (uint32_t)(((uint64_t)(2 * a + 1) * packedWidth) / (2 * transWidth));
+                uint32_t srcY = packedTop + (uint32_t)(((uint64_t)(2 * b + 1) * packedHeight) / (2 * transHeight));
+                dstRow[i] = src[(size_t)srcY * strides[p] + srcX];
+            }
+        }
+    }
+}
+
+void SWViewportRender::FillWrapColumn()
+{
+    if (mProjFormat != VCD::OMAF::PF_ERP) return;
+    for (uint32_t p = 0; p < 3; p++)
+    {
+        uint32_t width  = p ? mProjWidth / 2 : mProjWidth;
+        uint32_t height = p ? mProjHeight / 2 : mProjHeight;
+        for (uint32_t j = 0; j < height; j++)
+        {
+            uint8_t *row = mPlanes[p] + (size_t)j * mStrides[p];
+            row[width] = row[0];
+        }
+    }
+}
+
+uint32_t SWViewportRender::ProjectDirection(float dx, float dy, float dz, float *x, float *y)
+{
+    if (mProjFormat == VCD::OMAF::PF_ERP)
+    {
+        float longitude = atan2f(dx, -dz);
+        float latitude = atan2f(dy, sqrtf(dx * dx + dz * dz));
+        *x = (longitude / (2 * SW_RENDER_PI) + 0.5f) * mProjWidth - 0.5f;
+        *y = (0.5f - latitude / SW_RENDER_PI) * mProjHeight - 0.5f;
+        return 0;
+    }
+
+    float ax = fabsf(dx), ay = fabsf(dy), az = fabsf(dz);
+    float s, t;
+    uint32_t face;
+    if (ax >= ay && ax >= az)
+    {
+        face = dx > 0 ? 2 : 0;                       // right : left
+        s = dx > 0 ? dz / ax : -dz / ax;
+        t = -dy / ax;
+    }
+    else if (ay >= az)
+    {
+        face = dy > 0 ? 5 : 3;                       // top : bottom
+        s = dx / ay;
+        t = dy > 0 ? -dz / ay : dz / ay;
+    }
+    else
+    {
+        face = dz < 0 ? 1 : 4;                       // front : back
+        s = dz < 0 ? dx / az : -dx / az;
+        t = -dy / az;
+    }
+    // clamp to edge inside the face
+    float fx = std::min(std::max((s + 1) * 0.5f * mFaceWidth - 0.5f, 0.0f), (float)(mFaceWidth - 1));
+    float fy = std::min(std::max((t + 1) * 0.5f * mFaceHeight - 0.5f, 0.0f), (float)(mFaceHeight - 1));
+    *x = (face % 3) * mFaceWidth + fx;
+    *y = (face / 3) * mFaceHeight + fy;
+    return face;
+}
+
+uint32_t SWViewportRender::ProjectPixel(uint32_t px, uint32_t py, float *x, float *y)
+{
+    float sx = (2.0f * (px + 0.5f) / mViewportWidth - 1.0f) * mTanHalfH;
+    float sy = (1.0f - 2.0f * (py + 0.5f) / mViewportHeight) * mTanHalfV;
+    float d[3];
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        d[k] = mForward[k] + sx * mRight[k] + sy * mUp[k];
+    }
+    return ProjectDirection(d[0], d[1], d[2], x, y);
+}
+
+void SWViewportRender::FixCoordinates(float *x, float *y)
+{
+    if (mProjFormat == VCD::OMAF::PF_ERP)
+    {
+        *x -= floorf(*x / mProjWidth) * mProjWidth;
+        if (*x >= mProjWidth) *x = 0.0f;
+    }
+    else
+    {
+        *x = std::min(std::max(*x, 0.0f), (float)(mProjWidth - 1));
+    }
+    *y = std::min(std::max(*y, 0.0f), (float)(mProjHeight - 1));
+}
+
+void SWViewportRender::BuildSampleGrid(float yaw, float pitch, float hFOV, float vFOV)
+{
+    float yawRad = yaw * SW_RENDER_PI / 180;
+    float pitchRad = pitch * SW_RENDER_PI / 180;
+    // forward looks at the front (-z) for yaw 0 and pitch 0
+    mForward[0] = cosf(pitchRad) * sinf(yawRad);
+    mForward[1] = sinf(pitchRad);
+    mForward[2] = -cosf(pitchRad) * cosf(yawRad);
+    mRight[0] = cosf(yawRad);
+    mRight[1] = 0;
+    mRight[2] = sinf(yawRad);
+    mUp[0] = -sinf(pitchRad) * sinf(yawRad);
+    mUp[1] = cosf(pitchRad);
+    mUp[2] = sinf(pitchRad) * cosf(yawRad);
+    // same frustum as RenderContext, whose aspect is hFOV / vFOV
+    mTanHalfV = tanf(vFOV * SW_RENDER_PI / 360);
+    mTanHalfH = mTanHalfV * hFOV / vFOV;
+
+    for (uint32_t r = 0; r < mGridRows; r++)
+    {
+        uint32_t py = std::min(r * SW_RENDER_MAP_GRID, mViewportHeight - 1);
+        for (uint32_t c = 0; c < mGridCols; c++)
+        {
+            uint32_t px = std::min(c * SW_RENDER_MAP_GRID, mViewportWidth - 1);
+            uint32_t idx = r * mGridCols + c;
+            mGridFace[idx] = ProjectPixel(px, py, &mGridX[idx], &mGridY[idx]);
+        }
+    }
+
+    // blocks crossing a CubeMap edge, the ERP seam or a pole are not linear
+    float maxSpan = mProjWidth / 8.0f;
+    for (uint32_t r = 0; r + 1 < mGridRows; r++)
+    {
+        for (uint32_t c = 0; c + 1 < mGridCols; c++)
+        {
+            uint32_t idx[4] = { r * mGridCols + c, r * mGridCols + c + 1, (r + 1) * mGridCols + c, (r + 1) * mGridCols + c + 1 };
+            bool exact = false;
+            for (uint32_t k = 1; k < 4; k++)
+            {
+                if (mGridFace[idx[k]] != mGridFace[idx[0]])
+                    exact = true;
+                if (mProjFormat == VCD::OMAF::PF_ERP && fabsf(mGridX[idx[k]] - mGridX[idx[0]]) > maxSpan)
+                    exact = true;
+            }
+            mBlockExact[r * (mGridCols - 1) + c] = exact;
+        }
+    }
+}
+
+void SWViewportRender::InterpolateRow(uint32_t row, float *xs, float *ys)
+{
+    uint32_t r = row / SW_RENDER_MAP_GRID;
+    uint32_t top = r * SW_RENDER_MAP_GRID;
+    uint32_t bottom = std::min(top + SW_RENDER_MAP_GRID, mViewportHeight - 1);
+    float fy = bottom > top ? (float)(row - top) / (bottom - top) : 0.0f;
+
+    for (uint32_t c = 0; c + 1 < mGridCols; c++)
+    {
+        uint32_t left = c * SW_RENDER_MAP_GRID;
+        if (left >= mViewportWidth) break;
+        uint32_t right = std::min(left + SW_RENDER_MAP_GRID, mViewportWidth - 1);
+        uint32_t end = std::min(left + SW_RENDER_MAP_GRID, mViewportWidth);
+
+        if (mBlockExact[r * (mGridCols - 1) + c])
+        {
+            for (uint32_t px = left; px < end; px++)
+            {
+                ProjectPixel(px, row, &xs[px], &ys[px]);
+                FixCoordinates(&xs[px], &ys[px]);
+            }
+            continue;
+        }
+
+        uint32_t i00 = r * mGridCols + c;
+        uint32_t i10 = (r + 1) * mGridCols + c;
+        float x0 = mGridX[i00] + (mGridX[i10] - mGridX[i00]) * fy;
+        float x1 = mGridX[i00 + 1] + (mGridX[i10 + 1] - mGridX[i00 + 1]) * fy;
+        float y0 = mGridY[i00] + (mGridY[i10] - mGridY[i00]) * fy;
+        float y1 = mGridY[i00 + 1] + (mGridY[i10 + 1] - mGridY[i00 + 1]) * fy;
+        float step = right > left ? 1.0f / (right - left) : 0.0f;
+        for (uint32_t px = left; px < end; px++)
+        {
+            float fx = (px - left) * step;
+            xs[px] = x0 + (x1 - x0) * fx;
+            ys[px] = y0 + (y1 - y0) * fx;
+            FixCoordinates(&xs[px], &ys[px]);
+        }
+    }
+}
+
+void SWViewportRender::SampleRow(const float *xs, const float *ys, uint32_t num, uint32_t *out)
+{
+    SamplePlanes sp;
+    sp.y            = mPlanes[0];
+    sp.u            = mPlanes[1];
+    sp.v            = mPlanes[2];
+    sp.strideY      = mStrides[0];
+    sp.strideC      = mStrides[1];
+    sp.chromaWidth  = mProjWidth / 2;
+    sp.chromaHeight = mProjHeight / 2;
+    sp.wrapX        = mProjFormat == VCD::OMAF::PF_ERP;
+#ifdef SW_RENDER_X86
+    if (mUseAVX2)
+    {
+        SampleRowAVX2(sp, xs, ys, num, out);
+        return;
+    }
+#endif
+    SampleRowC(sp, xs, ys, 0, num, out);
+}
+
+RenderStatus SWViewportRender::Render(float yaw, float pitch, float hFOV, float vFOV, uint8_t *rgba, uint32_t stride)
+{
+    if (NULL == rgba || NULL == mPlanes[0])
+    {
+        return RENDER_NULL_HANDLE;
+    }
+    if (hFOV <= 0 || vFOV <= 0 || hFOV >= 180 || vFOV >= 180 || stride < mViewportWidth * 4)
+    {
+        LOG(ERROR) << "Invalid FOV or output stride for software render!" << std::endl;
+        return RENDER_ERROR;
+    }
+    BuildSampleGrid(yaw, pitch, hFOV, vFOV);
+    RunParallel(mViewportHeight, [&](uint32_t begin, uint32_t end, uint32_t slot) {
+        float *xs = mRowX.data() + (size_t)slot * mViewportWidth;
+        float *ys = mRowY.data() + (size_t)slot * mViewportWidth;
+        for (uint32_t row = begin; row < end; row++)
+        {
+            InterpolateRow(row, xs, ys);
+            SampleRow(xs, ys, mViewportWidth, (uint32_t *)(rgba + (size_t)row * stride));
+        }
+    });
+    return RENDER_STATUS_OK;
+}
+
+VCD_NS_END
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     SWViewportRender.h
+//! \brief    Defines class for SWViewportRender which renders the viewport of
+//!           a decoded 360 frame on CPU, without any OpenGL context.
+//!
+
+#ifndef _SWVIEWPORTRENDER_H_
+#define _SWVIEWPORTRENDER_H_
+
+#include "../Common/Common.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#define SW_RENDER_MAP_GRID     16   // pixels between exactly projected sample points
+#define SW_RENDER_PLANE_PAD    64   // bytes padded after each plane row and one extra row
+#define MAX_SW_RENDER_THREAD   16
+
+VCD_NS_BEGIN
+
+//!
+//! \class  SWViewportRender
+//! \brief  CPU counterpart of RenderTarget plus SurfaceRender. Packed YUV420
+//!         frames are unpacked by their region wise packing into projected
+//!         ERP or 3x2 CubeMap planes, then the viewport is resampled from them
+//!         with bilinear filtering and converted to RGBA with the coefficients
+//!         of the R2T shader. Sample positions are projected exactly on a
+//!         SW_RENDER_MAP_GRID grid and interpolated in between, like the GL
+//!         path interpolates over its sphere mesh. Rows are resampled by AVX2
+//!         kernels when the CPU supports them, split over worker threads.
+//!
+//!         yaw and pitch follow HeadPose: yaw in [-180, 180] grows to the
+//!         right of the ERP picture, pitch in [-90, 90] grows to its top.
+//!         CubeMap faces are in OMAF order left, front, right / bottom, back,
+//!         top, each seen unrotated from the centre of the sphere.
+//!
+class SWViewportRender
+{
+public:
+     SWViewportRender();
+     ~SWViewportRender();
+
+     //!
+     //! \brief  allocate projected planes and start worker threads
+     //!
+     //! \param  [in] projFormat: VCD::OMAF::PF_ERP or VCD::OMAF::PF_CUBEMAP
+     //!         [in] projWidth, projHeight: size of the projected picture
+     //!         [in] viewportWidth, viewportHeight: size of the rendered viewport
+     //!         [in] threadNum: 0 to derive it from the number of cores
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus Initialize(int32_t projFormat, uint32_t projWidth, uint32_t projHeight,
+                             uint32_t viewportWidth, uint32_t viewportHeight, uint32_t threadNum);
+
+     //!
+     //! \brief  copy the regions of one packed frame to the projected planes.
+     //!         Low quality regions are copied before high quality ones, and
+     //!         of the same quality later regions cover earlier ones, as in the
+     //!         GL blits. With several frames call it from low to high quality
+     //!
+     //! \param  [in] planes: Y, U and V planes of the packed YUV420 frame
+     //!         [in] strides: line size of each plane
+     //!         [in] rwpk: region wise packing of the frame
+     //!         [in] sources, sourceNum: the quality sources packed in the frame,
+     //!              NULL to keep the order of rwpk
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus UnpackRegions(uint8_t *planes[3], int32_t strides[3], RegionWisePacking *rwpk,
+                                SourceResolution *sources = NULL, int32_t sourceNum = 0);
+
+     //!
+     //! \brief  render the viewport into an RGBA buffer
+     //!
+     //! \param  [in] yaw, pitch: viewport centre in degrees
+     //!         [in] hFOV, vFOV: field of view in degrees
+     //!         [out] rgba: output of viewportWidth x viewportHeight pixels
+     //!         [in] stride: line size of rgba in bytes
+     //! \return RenderStatus
+     //!         RENDER_STATUS_OK if success, else fail reason
+     //!
+     RenderStatus Render(float yaw, float pitch, float hFOV, float vFOV, uint8_t *rgba, uint32_t stride);
+
+     //!
+     //! \brief  use the portable kernels even if AVX2 is available
+     //!
+     void SetSimdEnabled(bool enable) { mUseAVX2 = enable && mHasAVX2; };
+
+     bool IsSimdEnabled() { return mUseAVX2; };
+
+     //!
+     //! \brief  get the projected luma plane, for debugging and tests
+     //!
+     uint8_t* GetProjectedPlane(uint32_t idx, uint32_t *stride);
+
+private:
+     SWViewportRender& operator=(const SWViewportRender& other) { return *this; };
+     SWViewportRender(const SWViewportRender& other) { /* do not create copies */ };
+
+     //!
+     //! \brief  project a viewing direction to luma coordinates of the projected picture
+     //!
+     //! \return uint32_t
+     //!         the CubeMap face in OMAF order the direction hits, 0 for ERP
+     //!
+     uint32_t ProjectDirection(float dx, float dy, float dz, float *x, float *y);
+
+     //!
+     //! \brief  project the centre of viewport pixel (px, py) with the camera of the current Render
+     //!
+     uint32_t ProjectPixel(uint32_t px, uint32_t py, float *x, float *y);
+
+     //!
+     //! \brief  project every grid point of the viewport and mark blocks that can not be interpolated
+     //!
+     void BuildSampleGrid(float yaw, float pitch, float hFOV, float vFOV);
+
+     //!
+     //! \brief  fill luma coordinates of one viewport row from the grid
+     //!
+     void InterpolateRow(uint32_t row, float *xs, float *ys);
+
+     //!
+     //! \brief  bring coordinates into the projected picture, wrapping ERP horizontally
+     //!
+     void FixCoordinates(float *x, float *y);
+
+     void UnpackRegion(RectangularRegionWisePacking *region, uint8_t *planes[3], int32_t strides[3]);
+
+     //!
+     //! \brief  fill the padding column of ERP planes so bilinear taps wrap around
+     //!
+     void FillWrapColumn();
+
+     void SampleRow(const float *xs, const float *ys, uint32_t num, uint32_t *out);
+
+     //!
+     //! \brief  run task(begin, end, slot) over [0, num) split among the workers, returns when all are done.
+     //!         slot is 0 for the calling thread and 1..n for the workers
+     //!
+     void RunParallel(uint32_t num, std::function<void(uint32_t, uint32_t, uint32_t)> task);
+
+     void WorkerLoop(uint32_t slot);
+
+     void FreePlanes();
+
+private:
+     int32_t                  mProjFormat;
+     uint32_t                 mProjWidth;
+     uint32_t                 mProjHeight;
+     uint32_t                 mFaceWidth;      //!< CubeMap face size
+     uint32_t                 mFaceHeight;
+     uint32_t                 mViewportWidth;
+     uint32_t                 mViewportHeight;
+     uint8_t                 *mPlanes[3];      //!< projected Y, U and V planes
+     uint32_t                 mStrides[3];
+     bool                     mHasAVX2;
+     bool                     mUseAVX2;
+
+     uint32_t                 mGridCols;       //!< grid points per row
+     uint32_t                 mGridRows;
+     std::vector<float>       mGridX;          //!< luma coordinates of grid points, ERP x not wrapped
+     std::vector<float>       mGridY;
+     std::vector<uint8_t>     mGridFace;       //!< CubeMap face of grid points
+     std::vector<uint8_t>     mBlockExact;     //!< block needs per pixel projection
+     std::vector<float>       mRowX;           //!< luma coordinates of one viewport row per thread slot
+     std::vector<float>       mRowY;
+     float                    mForward[3];     //!< camera of the current Render
+     float                    mRight[3];
+     float                    mUp[3];
+     float                    mTanHalfH;
+     float                    mTanHalfV;
+
+     std::vector<std::thread> mWorkers;
+     std::mutex               mMutex;
+     std::condition_variable  mTaskReady;
+     std::condition_variable  mTaskDone;
+     std::function<void(uint32_t, uint32_t, uint32_t)> mTask;
+     uint32_t                 mTaskNum;
+     uint32_t                 mTaskNext;       //!< next chunk to be taken
+     uint32_t                 mTaskPending;    //!< chunks not finished yet
+     uint32_t                 mTaskChunk;
+     uint64_t                 mGeneration;
+     bool                     mStop;
+};
+
+VCD_NS_END
+
+#endif /* _SWVIEWPORTRENDER_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     benchSWViewportRender.cpp
+//! \brief    frames per second of SWViewportRender at 4K input and 1080p viewport.
+//!
+#include "../Render/SWViewportRender.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+
+using namespace VCD::VRVideo;
+
+#define BENCH_FRAME_NUM 120
+
+static double RunBench(int32_t format, uint32_t projWidth, uint32_t projHeight, uint32_t threadNum, bool simd)
+{
+    std::vector<uint8_t> data[3];
+    uint8_t *planes[3];
+    int32_t strides[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        strides[i] = i ? projWidth / 2 : projWidth;
+        data[i].resize(strides[i] * (i ? projHeight / 2 : projHeight));
+        for (auto &v : data[i])
+            v = rand() & 0xFF;
+        planes[i] = data[i].data();
+    }
+    RectangularRegionWisePacking region;
+    memset(&region, 0, sizeof(region));
+    region.projRegWidth = region.packedRegWidth = projWidth;
+    region.projRegHeight = region.packedRegHeight = projHeight;
+    RegionWisePacking rwpk;
+    memset(&rwpk, 0, sizeof(rwpk));
+    rwpk.numRegions = 1;
+    rwpk.packedPicWidth = projWidth;
+    rwpk.packedPicHeight = projHeight;
+    rwpk.rectRegionPacking = &region;
+
+    SWViewportRender render;
+    if (RENDER_STATUS_OK != render.Initialize(format, projWidth, projHeight, 1920, 1080, threadNum))
+        return 0;
+    render.SetSimdEnabled(simd);
+    std::vector<uint32_t> out(1920 * 1080);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_FRAME_NUM; i++)
+    {
+        // a new frame and a new pose every time, as in playback
+        render.UnpackRegions(planes, strides, &rwpk);
+        render.Render(-180.0f + 3.0f * i, 30.0f * sinf(i * 0.1f), 90, 90, (uint8_t *)out.data(), 1920 * 4);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return BENCH_FRAME_NUM / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t threadNum = argc > 1 ? atoi(argv[1]) : 0;
+    struct { const char *name; int32_t format; uint32_t width; uint32_t height; } inputs[] = {
+        { "ERP 3840x1920", VCD::OMAF::PF_ERP, 3840, 1920 },
+        { "CubeMap 3840x2560", VCD::OMAF::PF_CUBEMAP, 3840, 2560 },
+    };
+    for (auto &input : inputs)
+    {
+        for (uint32_t threads : { 1u, threadNum })
+        {
+            for (bool simd : { false, true })
+            {
+                double fps = RunBench(input.format, input.width, input.height, threads, simd);
+                std::cout << input.name << " -> 1920x1080, threads " << (threads ? threads : std::thread::hardware_concurrency())
+                          << (simd ? ", AVX2: " : ", scalar: ") << fps << " fps" << std::endl;
+            }
+        }
+    }
+    return 0;
+}
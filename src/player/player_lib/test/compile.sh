@@ -5,15 +5,35 @@ cp ../../google_test/libgtest.a .
 LD_FLAGS="-lavfilter -lavformat -lavcodec -lavdevice -lavutil -lswscale -lswresample -lpostproc -lglfw -lGL -lGLU -lX11 -l360SCVP -ldash -lOmafDashAccess -lpthread -ldl -g -lz -llzma -lva -lva-x11 -lva-drm -lglog -lEGL -lGLESv2"
 
 g++ -Wall -g -fPIC -lglog -std=c++11 -fpermissive -c ../*.cpp
+g++ -Wall -g -fPIC -lglog -std=c++11 -fpermissive -D_LINUX_OS_ -c ../Decoder/PacketQueue.cpp ../Decoder/FramePool.cpp ../Decoder/DecodeScheduler.cpp ../Decoder/FrameAssembler.cpp
+g++ -Wall -g -O2 -fPIC -lglog -std=c++11 -fpermissive -D_LINUX_OS_ -c ../Render/SWViewportRender.cpp
 
 g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testMediaSource.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testRenderSource.cpp -D_GLIBCXX_USE_CXX11_ABI=0
 g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testRenderManager.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testPacketQueue.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
+g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testFramePool.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
+g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testDecodeScheduler.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
+g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testFrameAssembler.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
+g++ -I. -I../../google_test -DGPAC_HAVE_CONFIG_H -std=c++11 -g  -c testSWViewportRender.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
+g++ -I. -DGPAC_HAVE_CONFIG_H -std=c++11 -O2 -c benchSWViewportRender.cpp -D_GLIBCXX_USE_CXX11_ABI=0 -D_LINUX_OS_
 
 g++ -g -I../../google_test MediaSource.o testMediaSource.o FFmpegMediaSource.o libgtest.a -o testMediaSource ${LD_FLAGS}
 g++ -g -I../../google_test Mesh.o Render2TextureMesh.o RenderBackend.o FFmpegMediaSource.o MediaSource.o VideoShader.o SWRenderSource.o RenderSource.o testRenderSource.o libgtest.a -o testRenderSource ${LD_FLAGS}
 g++ -g -I../../google_test ViewPortManager.o RenderBackend.o RenderTarget.o SurfaceRender.o ERPRender.o CubeMapRender.o Mesh.o ERPMesh.o Render2TextureMesh.o CubeMapMesh.o DashMediaSource.o FFmpegMediaSource.o MediaSource.o HWRenderSource.o SWRenderSource.o DMABufferRenderSource.o RenderContext.o EGLRenderContext.o GLFWRenderContext.o RenderSource.o VideoShader.o RenderManager.o testRenderManager.o libgtest.a -o testRenderManager ${LD_FLAGS}
+g++ -g -I../../google_test PacketQueue.o testPacketQueue.o libgtest.a -o testPacketQueue ${LD_FLAGS}
+g++ -g -I../../google_test FramePool.o testFramePool.o libgtest.a -o testFramePool ${LD_FLAGS}
+g++ -g -I../../google_test DecodeScheduler.o testDecodeScheduler.o libgtest.a -o testDecodeScheduler ${LD_FLAGS}
+g++ -g -I../../google_test FrameAssembler.o testFrameAssembler.o libgtest.a -o testFrameAssembler ${LD_FLAGS}
+g++ -g -I../../google_test SWViewportRender.o testSWViewportRender.o libgtest.a -o testSWViewportRender ${LD_FLAGS}
+g++ -g SWViewportRender.o benchSWViewportRender.o -o benchSWViewportRender ${LD_FLAGS}
 
 ./testMediaSource
 ./testRenderSource
 ./testRenderManager
+./testPacketQueue
+./testFramePool
+./testDecodeScheduler
+./testFrameAssembler
+./testSWViewportRender
+./benchSWViewportRender
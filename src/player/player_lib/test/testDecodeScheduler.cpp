@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     testDecodeScheduler.cpp
+//! \brief    unit test for DecodeScheduler.
+//!
+#include "gtest/gtest.h"
+#include "../Decoder/DecodeScheduler.h"
+#include <atomic>
+
+VCD_NS_BEGIN
+
+namespace
+{
+class FakeDecoder : public ScheduledDecoder
+{
+public:
+    FakeDecoder(uint64_t deadline, int32_t priority, std::vector<int32_t> *order, std::mutex *orderLock)
+        : mDeadline(deadline), mPriority(priority), mSteps(0), mOrder(order), mOrderLock(orderLock) {};
+
+    virtual bool DecodeStep()
+    {
+        {
+            std::lock_guard<std::mutex> lock(*mOrderLock);
+            mOrder->push_back(mPriority);
+        }
+        mSteps++;
+        return false;
+    };
+    virtual uint64_t GetDeadline() { return mDeadline; };
+    virtual int32_t GetPriority() { return mPriority; };
+
+    uint64_t              mDeadline;
+    int32_t               mPriority;
+    std::atomic<uint32_t> mSteps;
+    std::vector<int32_t> *mOrder;
+    std::mutex           *mOrderLock;
+};
+
+class DecodeSchedulerTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        scheduler = new DecodeScheduler();
+    }
+    virtual void TearDown()
+    {
+        SAFE_DELETE(scheduler);
+    }
+    DecodeScheduler *scheduler;
+};
+
+TEST_F(DecodeSchedulerTest, HighQualityStreamFirst)
+{
+    std::vector<int32_t> order;
+    std::mutex orderLock;
+    FakeDecoder background(10, SECOND_QUALITY_RANKING, &order, &orderLock);
+    FakeDecoder viewport(10, HIGHEST_QUALITY_RANKING, &order, &orderLock);
+    FakeDecoder late(20, HIGHEST_QUALITY_RANKING - 1, &order, &orderLock);
+
+    // register and queue work before any worker is running
+    scheduler->Register(&late);
+    scheduler->Register(&background);
+    scheduler->Register(&viewport);
+    scheduler->Notify(&late);
+    scheduler->Notify(&background);
+    scheduler->Notify(&viewport);
+    ASSERT_EQ(scheduler->Initialize(1), RENDER_STATUS_OK);
+
+    while (late.mSteps == 0) usleep(1000);
+    scheduler->Unregister(&late);
+    scheduler->Unregister(&background);
+    scheduler->Unregister(&viewport);
+
+    ASSERT_EQ(order.size(), (size_t)3);
+    EXPECT_EQ(order[0], HIGHEST_QUALITY_RANKING);
+    EXPECT_EQ(order[1], SECOND_QUALITY_RANKING);
+    EXPECT_EQ(order[2], HIGHEST_QUALITY_RANKING - 1);
+}
+
+TEST_F(DecodeSchedulerTest, UnregisteredDecoderIsNotRun)
+{
+    std::vector<int32_t> order;
+    std::mutex orderLock;
+    FakeDecoder decoder(0, HIGHEST_QUALITY_RANKING, &order, &orderLock);
+    ASSERT_EQ(scheduler->Initialize(2), RENDER_STATUS_OK);
+    scheduler->Notify(&decoder);
+    usleep(20000);
+    EXPECT_EQ(decoder.mSteps, (uint32_t)0);
+
+    scheduler->Register(&decoder);
+    scheduler->Notify(&decoder);
+    while (decoder.mSteps == 0) usleep(1000);
+    scheduler->Unregister(&decoder);
+    EXPECT_EQ(decoder.mSteps, (uint32_t)1);
+}
+
+} // namespace
+
+VCD_NS_END
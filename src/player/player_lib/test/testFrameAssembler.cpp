@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     testFrameAssembler.cpp
+//! \brief    unit test for FrameAssembler.
+//!
+#include "gtest/gtest.h"
+#include "../Decoder/FrameAssembler.h"
+
+VCD_NS_BEGIN
+
+namespace
+{
+class FrameAssemblerTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        assembler = new FrameAssembler();
+        assembler->SetHoldTimeout(20);
+    }
+    virtual void TearDown()
+    {
+        SAFE_DELETE(assembler);
+    }
+    void AddFrame(uint64_t pts, int32_t segId, uint64_t now)
+    {
+        assembler->AddPacket(pts, segId, 0, now);
+        assembler->AddPacket(pts, segId, 1, now);
+    }
+    FrameAssembler *assembler;
+};
+
+TEST_F(FrameAssemblerTest, MapRenderCountToMediaPts)
+{
+    uint64_t pts = 0;
+    EXPECT_FALSE(assembler->GetMediaPts(0, &pts));
+    AddFrame(90, 4, 0);
+    EXPECT_TRUE(assembler->GetMediaPts(0, &pts));
+    EXPECT_EQ(pts, 90);
+    EXPECT_TRUE(assembler->GetMediaPts(5, &pts));
+    EXPECT_EQ(pts, 95);
+}
+
+TEST_F(FrameAssemblerTest, HoldLateStreamThenDropIt)
+{
+    std::set<uint32_t> all = {0, 1};
+    std::set<uint32_t> fast = {0};
+    std::vector<uint32_t> late;
+    AddFrame(0, 1, 0);
+    AddFrame(1, 1, 0);
+    // startup waits for every stream
+    EXPECT_EQ(assembler->Check(0, fast, 100, &late), ASSEMBLE_HOLD);
+    EXPECT_EQ(assembler->Check(0, all, 110, &late), ASSEMBLE_READY);
+    assembler->Presented(0, ASSEMBLE_READY, 0, 110);
+
+    EXPECT_EQ(assembler->Check(1, fast, 120, &late), ASSEMBLE_HOLD);
+    ASSERT_EQ(late.size(), 1);
+    EXPECT_EQ(late[0], 1);
+    EXPECT_EQ(assembler->Check(1, fast, 141, &late), ASSEMBLE_PARTIAL);
+    assembler->Presented(1, ASSEMBLE_PARTIAL, late.size(), 141);
+
+    FrameSyncMetrics metrics;
+    EXPECT_EQ(assembler->GetMetrics(&metrics), RENDER_STATUS_OK);
+    EXPECT_EQ(metrics.presentedFrames, 2);
+    EXPECT_EQ(metrics.partialFrames, 1);
+    EXPECT_EQ(metrics.lateTiles, 1);
+    EXPECT_EQ(metrics.pendingFrames, 0);
+    EXPECT_EQ(metrics.lastLatency, 141);
+    EXPECT_EQ(metrics.maxLatency, 141);
+}
+
+TEST_F(FrameAssemblerTest, SkipLostPts)
+{
+    std::set<uint32_t> all = {0, 1};
+    AddFrame(0, 1, 0);
+    AddFrame(2, 1, 0);
+    EXPECT_EQ(assembler->Check(0, all, 0, NULL), ASSEMBLE_READY);
+    assembler->Presented(0, ASSEMBLE_READY, 0, 0);
+    EXPECT_EQ(assembler->Check(1, all, 10, NULL), ASSEMBLE_HOLD);
+    EXPECT_EQ(assembler->Check(1, all, 30, NULL), ASSEMBLE_SKIP);
+    assembler->Presented(1, ASSEMBLE_SKIP, 0, 30);
+    EXPECT_EQ(assembler->Check(2, all, 30, NULL), ASSEMBLE_READY);
+}
+
+TEST_F(FrameAssemblerTest, FrameOnlyWaitsForItsOwnStreams)
+{
+    // after a viewport switch, stream 1 is replaced by stream 2
+    std::set<uint32_t> ready = {0, 2};
+    AddFrame(0, 1, 0);
+    assembler->AddPacket(1, 2, 0, 0);
+    assembler->AddPacket(1, 2, 2, 0);
+    EXPECT_EQ(assembler->Check(0, {0, 1}, 0, NULL), ASSEMBLE_READY);
+    assembler->Presented(0, ASSEMBLE_READY, 0, 0);
+    EXPECT_EQ(assembler->Check(1, ready, 0, NULL), ASSEMBLE_READY);
+}
+}
+
+VCD_NS_END
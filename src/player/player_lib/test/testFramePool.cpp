@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     testFramePool.cpp
+//! \brief    unit test for FramePool.
+//!
+#include "gtest/gtest.h"
+#include "../Decoder/FramePool.h"
+#include <thread>
+
+VCD_NS_BEGIN
+
+#define TEST_POOL_SIZE 2
+
+namespace
+{
+class FramePoolTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        pool = new FramePool();
+        ASSERT_EQ(pool->Initialize(TEST_POOL_SIZE), RENDER_STATUS_OK);
+    }
+    virtual void TearDown()
+    {
+        pool->Destroy();
+    }
+    FramePool *pool;
+};
+
+TEST_F(FramePoolTest, FramesAreReused)
+{
+    PooledFrame *frame1 = pool->Acquire(0);
+    PooledFrame *frame2 = pool->Acquire(0);
+    ASSERT_TRUE(frame1 != NULL);
+    ASSERT_TRUE(frame2 != NULL);
+    EXPECT_TRUE(frame1 != frame2);
+    // pool is exhausted
+    EXPECT_TRUE(pool->Acquire(10) == NULL);
+
+    frame1->Return();
+    PooledFrame *frame3 = pool->Acquire(0);
+    EXPECT_EQ(frame3, frame1);
+    frame2->Return();
+    frame3->Return();
+}
+
+TEST_F(FramePoolTest, BorrowedFrameIsKept)
+{
+    PooledFrame *frame1 = pool->Acquire(0);
+    PooledFrame *frame2 = pool->Acquire(0);
+    frame1->Borrow();   // renderer
+    frame1->Return();   // decoder
+    EXPECT_TRUE(pool->Acquire(10) == NULL);
+
+    std::thread renderer([frame1] {
+        usleep(20000);
+        frame1->Return();
+    });
+    PooledFrame *frame3 = pool->Acquire(5000);
+    renderer.join();
+    EXPECT_EQ(frame3, frame1);
+    frame2->Return();
+    frame3->Return();
+}
+
+TEST_F(FramePoolTest, DestroyWithBorrowedFrame)
+{
+    FramePool *other = new FramePool();
+    ASSERT_EQ(other->Initialize(TEST_POOL_SIZE), RENDER_STATUS_OK);
+    PooledFrame *frame = other->Acquire(0);
+    ASSERT_TRUE(frame != NULL);
+    // pool is really deleted after the last frame is returned
+    other->Destroy();
+    frame->Return();
+}
+
+TEST_F(FramePoolTest, DestroyWhileRendererReturns)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        FramePool *other = new FramePool();
+        ASSERT_EQ(other->Initialize(TEST_POOL_SIZE), RENDER_STATUS_OK);
+        PooledFrame *frame = other->Acquire(0);
+        ASSERT_TRUE(frame != NULL);
+        // whichever side is last deletes the pool, exactly once
+        std::thread renderer([frame] { frame->Return(); });
+        other->Destroy();
+        renderer.join();
+    }
+}
+
+} // namespace
+
+VCD_NS_END
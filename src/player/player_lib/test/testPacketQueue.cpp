@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file     testPacketQueue.cpp
+//! \brief    unit test for PacketQueue.
+//!
+#include "gtest/gtest.h"
+#include "../Decoder/PacketQueue.h"
+#include <thread>
+
+VCD_NS_BEGIN
+
+#define TEST_QUEUE_SIZE 4
+
+namespace
+{
+class PacketQueueTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        queue = new PacketQueue();
+        ASSERT_EQ(queue->Initialize(TEST_QUEUE_SIZE), RENDER_STATUS_OK);
+    }
+    virtual void TearDown()
+    {
+        SAFE_DELETE(queue);
+    }
+    PacketQueue *queue;
+};
+
+TEST_F(PacketQueueTest, PushPopInOrder)
+{
+    for (uint32_t i = 0; i < TEST_QUEUE_SIZE; i++)
+    {
+        PacketInfo *slot = queue->AcquireSlot(0);
+        ASSERT_TRUE(slot != NULL);
+        slot->pts = i;
+        queue->Commit();
+    }
+    // queue is full now
+    EXPECT_TRUE(queue->AcquireSlot(10) == NULL);
+    EXPECT_EQ(queue->Size(), (uint32_t)TEST_QUEUE_SIZE);
+
+    for (uint32_t i = 0; i < TEST_QUEUE_SIZE; i++)
+    {
+        PacketInfo *pkt = queue->Front(0);
+        ASSERT_TRUE(pkt != NULL);
+        EXPECT_EQ(pkt->pts, (uint64_t)i);
+        queue->Pop();
+    }
+    EXPECT_TRUE(queue->Front(10) == NULL);
+}
+
+TEST_F(PacketQueueTest, FrontWakesUpOnCommit)
+{
+    std::thread producer([this] {
+        usleep(20000);
+        PacketInfo *slot = queue->AcquireSlot(0);
+        slot->pts = 100;
+        queue->Commit();
+    });
+    PacketInfo *pkt = queue->Front(5000);
+    producer.join();
+    ASSERT_TRUE(pkt != NULL);
+    EXPECT_EQ(pkt->pts, (uint64_t)100);
+    queue->Pop();
+}
+
+TEST_F(PacketQueueTest, Interrupt)
+{
+    std::thread waker([this] {
+        usleep(20000);
+        queue->Interrupt();
+    });
+    PacketInfo *pkt = queue->Front(5000);
+    waker.join();
+    EXPECT_TRUE(pkt == NULL);
+}
+
+} // namespace
+
+VCD_NS_END
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+//!
+//! \file     testSWViewportRender.cpp
+//! \brief    unit test for SWViewportRender.
+//!
+#include "gtest/gtest.h"
+#include "../Render/SWViewportRender.h"
+#include <stdlib.h>
+
+VCD_NS_BEGIN
+
+namespace
+{
+#define FULL_WHITE 235
+#define FULL_BLACK 16
+
+class PackedFrame
+{
+public:
+    PackedFrame(uint32_t width, uint32_t height)
+    {
+        this->width = width;
+        this->height = height;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            strides[i] = i ? width / 2 : width;
+            data[i].resize(strides[i] * (i ? height / 2 : height), i ? 128 : FULL_BLACK);
+            planes[i] = data[i].data();
+        }
+        memset(&rwpk, 0, sizeof(rwpk));
+        rwpk.packedPicWidth = width;
+        rwpk.packedPicHeight = height;
+    }
+    void AddRegion(uint32_t projLeft, uint32_t projTop, uint32_t projWidth, uint32_t projHeight,
+                   uint32_t packedLeft, uint32_t packedTop, uint32_t packedWidth, uint32_t packedHeight, uint8_t type)
+    {
+        RectangularRegionWisePacking region;
+        memset(&region, 0, sizeof(region));
+        region.projRegLeft = projLeft;
+        region.projRegTop = projTop;
+        region.projRegWidth = projWidth;
+        region.projRegHeight = projHeight;
+        region.packedRegLeft = packedLeft;
+        region.packedRegTop = packedTop;
+        region.packedRegWidth = packedWidth;
+        region.packedRegHeight = packedHeight;
+        region.transformType = type;
+        regions.push_back(region);
+        rwpk.numRegions = regions.size();
+        rwpk.rectRegionPacking = regions.data();
+    }
+    void FillLuma(uint32_t left, uint32_t top, uint32_t w, uint32_t h, uint8_t value)
+    {
+        for (uint32_t j = top; j < top + h; j++)
+            memset(planes[0] + j * strides[0] + left, value, w);
+    }
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> data[3];
+    uint8_t *planes[3];
+    int32_t strides[3];
+    RegionWisePacking rwpk;
+    std::vector<RectangularRegionWisePacking> regions;
+};
+
+static uint8_t CentreRed(SWViewportRender *render, float yaw, float pitch)
+{
+    std::vector<uint32_t> out(33 * 33);
+    EXPECT_EQ(render->Render(yaw, pitch, 60, 60, (uint8_t *)out.data(), 33 * 4), RENDER_STATUS_OK);
+    return out[16 * 33 + 16] & 0xFF;
+}
+
+TEST(SWViewportRenderTest, UnpackTransformedAndScaledRegions)
+{
+    PackedFrame frame(64, 32);
+    for (uint32_t j = 0; j < 32; j++)
+        for (uint32_t i = 0; i < 64; i++)
+            frame.planes[0][j * 64 + i] = i;
+    frame.AddRegion(0, 0, 32, 32, 0, 0, 32, 32, 0);
+    frame.AddRegion(32, 0, 32, 32, 32, 0, 32, 32, 1);     // mirrored
+    SWViewportRender render;
+    ASSERT_EQ(render.Initialize(VCD::OMAF::PF_ERP, 64, 32, 16, 16, 1), RENDER_STATUS_OK);
+    ASSERT_EQ(render.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+    uint32_t stride = 0;
+    uint8_t *proj = render.GetProjectedPlane(0, &stride);
+    EXPECT_EQ(proj[5 * stride + 3], 3);
+    EXPECT_EQ(proj[5 * stride + 32], 63);
+    EXPECT_EQ(proj[5 * stride + 63], 32);
+    EXPECT_EQ(proj[5 * stride + 64], proj[5 * stride]);   // wrap column
+
+    // low resolution region is upscaled with nearest sampling
+    PackedFrame low(64, 32);
+    for (uint32_t j = 0; j < 32; j++)
+        for (uint32_t i = 0; i < 64; i++)
+            low.planes[0][j * 64 + i] = i;
+    low.AddRegion(0, 0, 64, 32, 0, 0, 32, 16, 0);
+    ASSERT_EQ(render.UnpackRegions(low.planes, low.strides, &low.rwpk), RENDER_STATUS_OK);
+    EXPECT_EQ(proj[0], 0);
+    EXPECT_EQ(proj[1], 0);
+    EXPECT_EQ(proj[2], 1);
+    EXPECT_EQ(proj[63], 31);
+}
+
+TEST(SWViewportRenderTest, HighQualityCoversLowQuality)
+{
+    // high quality source on the left of the packed frame, low quality on the right
+    PackedFrame frame(128, 32);
+    frame.FillLuma(0, 0, 64, 32, FULL_WHITE);
+    frame.AddRegion(0, 0, 64, 32, 0, 0, 64, 32, 0);
+    frame.AddRegion(0, 0, 128, 32, 64, 0, 64, 32, 0);      // whole sphere, listed last
+    SourceResolution sources[2];
+    memset(sources, 0, sizeof(sources));
+    sources[0].qualityRanking = HIGHEST_QUALITY_RANKING;
+    sources[0].width = 64;
+    sources[0].height = 32;
+    sources[1].qualityRanking = (QualityRank)(HIGHEST_QUALITY_RANKING + 1);
+    sources[1].left = 64;
+    sources[1].width = 64;
+    sources[1].height = 32;
+    SWViewportRender render;
+    ASSERT_EQ(render.Initialize(VCD::OMAF::PF_ERP, 128, 32, 16, 16, 4), RENDER_STATUS_OK);
+    uint32_t stride = 0;
+    uint8_t *proj = render.GetProjectedPlane(0, &stride);
+    for (uint32_t round = 0; round < 10; round++)
+    {
+        ASSERT_EQ(render.UnpackRegions(frame.planes, frame.strides, &frame.rwpk, sources, 2), RENDER_STATUS_OK);
+        EXPECT_EQ(proj[5 * stride + 10], FULL_WHITE);
+        EXPECT_EQ(proj[5 * stride + 100], FULL_BLACK);
+    }
+
+    // without the sources the later region covers the earlier one
+    ASSERT_EQ(render.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+    EXPECT_EQ(proj[5 * stride + 10], FULL_BLACK);
+}
+
+TEST(SWViewportRenderTest, ERPViewportFollowsPose)
+{
+    PackedFrame frame(256, 128);
+    frame.FillLuma(128, 0, 128, 128, FULL_WHITE);          // right half of ERP
+    frame.AddRegion(0, 0, 256, 128, 0, 0, 256, 128, 0);
+    SWViewportRender render;
+    ASSERT_EQ(render.Initialize(VCD::OMAF::PF_ERP, 256, 128, 33, 33, 2), RENDER_STATUS_OK);
+    ASSERT_EQ(render.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+    EXPECT_EQ(CentreRed(&render, 90, 0), 255);
+    EXPECT_EQ(CentreRed(&render, -90, 0), 0);
+    EXPECT_EQ(CentreRed(&render, 179, 0), 255);
+    EXPECT_EQ(CentreRed(&render, -179, 0), 0);
+}
+
+TEST(SWViewportRenderTest, CubeMapViewportFollowsPose)
+{
+    // 3x2 layout: left, front, right / bottom, back, top
+    PackedFrame frame(192, 128);
+    frame.FillLuma(64, 0, 64, 64, FULL_WHITE);             // front
+    frame.FillLuma(128, 64, 64, 64, FULL_WHITE);           // top
+    frame.AddRegion(0, 0, 192, 128, 0, 0, 192, 128, 0);
+    SWViewportRender render;
+    ASSERT_EQ(render.Initialize(VCD::OMAF::PF_CUBEMAP, 192, 128, 33, 33, 2), RENDER_STATUS_OK);
+    ASSERT_EQ(render.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+    EXPECT_EQ(CentreRed(&render, 0, 0), 255);
+    EXPECT_EQ(CentreRed(&render, 180, 0), 0);
+    EXPECT_EQ(CentreRed(&render, 90, 0), 0);
+    EXPECT_EQ(CentreRed(&render, 0, 89), 255);
+    EXPECT_EQ(CentreRed(&render, 0, -89), 0);
+}
+
+TEST(SWViewportRenderTest, KernelsAndThreadsGiveSameOutput)
+{
+    PackedFrame frame(512, 256);
+    srand(1);
+    for (uint32_t p = 0; p < 3; p++)
+        for (auto &v : frame.data[p])
+            v = rand() & 0xFF;
+    frame.AddRegion(0, 0, 512, 256, 0, 0, 512, 256, 0);
+    const uint32_t width = 160, height = 90;
+    int32_t formats[2] = { VCD::OMAF::PF_ERP, VCD::OMAF::PF_CUBEMAP };
+    for (auto format : formats)
+    {
+        SWViewportRender single, multi;
+        ASSERT_EQ(single.Initialize(format, 512, 256, width, height, 1), RENDER_STATUS_OK);
+        ASSERT_EQ(multi.Initialize(format, 512, 256, width, height, 4), RENDER_STATUS_OK);
+        single.SetSimdEnabled(false);
+        ASSERT_EQ(single.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+        ASSERT_EQ(multi.UnpackRegions(frame.planes, frame.strides, &frame.rwpk), RENDER_STATUS_OK);
+        std::vector<uint32_t> ref(width * height), out(width * height);
+        float poses[3][2] = { {0, 0}, {170, 40}, {-60, -85} };
+        for (auto pose : poses)
+        {
+            ASSERT_EQ(single.Render(pose[0], pose[1], 100, 70, (uint8_t *)ref.data(), width * 4), RENDER_STATUS_OK);
+            ASSERT_EQ(multi.Render(pose[0], pose[1], 100, 70, (uint8_t *)out.data(), width * 4), RENDER_STATUS_OK);
+            int32_t maxDiff = 0;
+            for (uint32_t i = 0; i < ref.size(); i++)
+                for (uint32_t c = 0; c < 32; c += 8)
+                    maxDiff = std::max(maxDiff, abs((int32_t)((ref[i] >> c) & 0xFF) - (int32_t)((out[i] >> c) & 0xFF)));
+            EXPECT_LE(maxDiff, 1);
+        }
+    }
+}
+}
+
+VCD_NS_END
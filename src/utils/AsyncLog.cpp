@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   AsyncLog.cpp
+//! \brief:  Asynchronous logging backend implementation
+//!
+
+#include "AsyncLog.h"
+#include "error.h"
+#include "glog/logging.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define ASYNC_LOG_MAX_ARGS        8
+#define ASYNC_LOG_STRING_BYTES    160
+#define ASYNC_LOG_LINE_BYTES      1024
+#define ASYNC_LOG_DEFAULT_QUEUE   4096
+
+enum ArgType
+{
+    ARG_SIGNED = 0,
+    ARG_UNSIGNED,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+};
+
+//!
+//! \struct: LogRecord
+//! \brief:  one captured log call, the arguments are kept as raw words
+//!
+struct LogRecord
+{
+    std::atomic<uint64_t> sequence;
+    LogLevel              level;
+    uint64_t              line;
+    const char           *sourceFile;
+    const char           *fmt;
+    uint32_t              argNum;
+    uint8_t               argTypes[ASYNC_LOG_MAX_ARGS];
+    union
+    {
+        int64_t     i;
+        uint64_t    u;
+        double      d;
+        const void *p;
+    }                     args[ASYNC_LOG_MAX_ARGS];
+    uint32_t              stringBytes;
+    char                  strings[ASYNC_LOG_STRING_BYTES + 1];  //<! ends with '\0' for the strings not fitting
+};
+
+//!
+//! \struct: ConvSpec
+//! \brief:  one printf conversion specification
+//!
+struct ConvSpec
+{
+    const char *flags;
+    uint32_t    flagsLen;
+    bool        widthStar;
+    const char *width;
+    uint32_t    widthLen;
+    bool        hasPrecision;
+    bool        precisionStar;
+    const char *precision;
+    uint32_t    precisionLen;
+    bool        isLong;        // l, ll, j, z or t
+    bool        isLongDouble;  // L
+    char        conv;
+    const char *end;
+};
+
+// parse the conversion after '%', false for the conversions not supported
+static bool ParseSpec(const char *str, ConvSpec *spec)
+{
+    memset(spec, 0, sizeof(ConvSpec));
+
+    spec->flags = str;
+    while (*str && strchr("-+ #0", *str))
+        str++;
+    spec->flagsLen = str - spec->flags;
+
+    if (*str == '*')
+    {
+        spec->widthStar = true;
+        str++;
+    }
+    spec->width = str;
+    while (*str >= '0' && *str <= '9')
+        str++;
+    spec->widthLen = str - spec->width;
+
+    if (*str == '.')
+    {
+        spec->hasPrecision = true;
+        str++;
+        if (*str == '*')
+        {
+            spec->precisionStar = true;
+            str++;
+        }
+        spec->precision = str;
+        while (*str >= '0' && *str <= '9')
+            str++;
+        spec->precisionLen = str - spec->precision;
+    }
+
+    while (*str && strchr("hljztL", *str))
+    {
+        if (*str == 'L')
+            spec->isLongDouble = true;
+        else if (*str != 'h')
+            spec->isLong = true;
+        str++;
+    }
+
+    spec->conv = *str;
+    if (!spec->conv || !strchr("diuxXocfFeEgGaAsp", spec->conv))
+        return false;
+
+    spec->end = str + 1;
+    return true;
+}
+
+static void CaptureArgs(LogRecord *record, va_list params)
+{
+    record->argNum = 0;
+    record->stringBytes = 0;
+    record->strings[ASYNC_LOG_STRING_BYTES] = '\0';
+
+    const char *str = record->fmt;
+    while ((str = strchr(str, '%')) != NULL)
+    {
+        if (*(str + 1) == '%')
+        {
+            str += 2;
+            continue;
+        }
+
+        ConvSpec spec;
+        if (!ParseSpec(str + 1, &spec))
+            return;
+
+        uint32_t needed = 1 + (spec.widthStar ? 1 : 0) + (spec.precisionStar ? 1 : 0);
+        if (record->argNum + needed > ASYNC_LOG_MAX_ARGS)
+            return;
+
+        if (spec.widthStar)
+        {
+            record->argTypes[record->argNum] = ARG_SIGNED;
+            record->args[record->argNum++].i = va_arg(params, int);
+        }
+        if (spec.precisionStar)
+        {
+            record->argTypes[record->argNum] = ARG_SIGNED;
+            record->args[record->argNum++].i = va_arg(params, int);
+        }
+
+        uint32_t idx = record->argNum++;
+        switch (spec.conv)
+        {
+            case 'd':
+            case 'i':
+            case 'c':
+                record->argTypes[idx] = ARG_SIGNED;
+                record->args[idx].i = spec.isLong ? va_arg(params, long long) : va_arg(params, int);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                record->argTypes[idx] = ARG_UNSIGNED;
+                record->args[idx].u = spec.isLong ? va_arg(params, unsigned long long) : va_arg(params, unsigned int);
+                break;
+            case 's':
+            {
+                // the string may not outlive the call, so it is copied
+                const char *value = va_arg(params, const char*);
+                if (!value)
+                    value = "(null)";
+                uint32_t left = ASYNC_LOG_STRING_BYTES - record->stringBytes;
+                uint32_t len = left ? strnlen(value, left - 1) : 0;
+                record->argTypes[idx] = ARG_STRING;
+                record->args[idx].u = record->stringBytes;
+                if (left)
+                {
+                    memcpy(record->strings + record->stringBytes, value, len);
+                    record->strings[record->stringBytes + len] = '\0';
+                    record->stringBytes += len + 1;
+                }
+                break;
+            }
+            case 'p':
+                record->argTypes[idx] = ARG_POINTER;
+                record->args[idx].p = va_arg(params, void*);
+                break;
+            default:
+                record->argTypes[idx] = ARG_DOUBLE;
+                record->args[idx].d = spec.isLongDouble ? (double)va_arg(params, long double) : va_arg(params, double);
+                break;
+        }
+        str = spec.end;
+    }
+}
+
+static uint32_t AppendSpec(char *out, uint32_t size, const char *begin, uint32_t len)
+{
+    uint32_t cnt = (len < size - 1) ? len : size - 1;
+    memcpy(out, begin, cnt);
+    out[cnt] = '\0';
+    return cnt;
+}
+
+static void FormatRecord(const LogRecord *record, char *out, uint32_t size)
+{
+    uint32_t pos = 0;
+    uint32_t argIdx = 0;
+    const char *str = record->fmt;
+
+    while (*str && pos < size - 1)
+    {
+        if (*str != '%')
+        {
+            out[pos++] = *str++;
+            continue;
+        }
+        if (*(str + 1) == '%')
+        {
+            out[pos++] = '%';
+            str += 2;
+            continue;
+        }
+
+        ConvSpec spec;
+        uint32_t needed = 0;
+        if (ParseSpec(str + 1, &spec))
+            needed = 1 + (spec.widthStar ? 1 : 0) + (spec.precisionStar ? 1 : 0);
+        if (!needed || argIdx + needed > record->argNum)
+        {
+            // the arguments beyond the capture are not printed
+            pos += AppendSpec(out + pos, size - pos, str, strlen(str));
+            break;
+        }
+
+        // rebuild the conversion with the star values and 64 bit integers
+        char specStr[64];
+        uint32_t specLen = 0;
+        specStr[specLen++] = '%';
+        specLen += AppendSpec(specStr + specLen, 16, spec.flags, spec.flagsLen);
+        if (spec.widthStar)
+            specLen += snprintf(specStr + specLen, 16, "%d", (int)record->args[argIdx++].i);
+        else
+            specLen += AppendSpec(specStr + specLen, 16, spec.width, spec.widthLen);
+        if (spec.hasPrecision)
+        {
+            specStr[specLen++] = '.';
+            if (spec.precisionStar)
+                specLen += snprintf(specStr + specLen, 16, "%d", (int)record->args[argIdx++].i);
+            else
+                specLen += AppendSpec(specStr + specLen, 16, spec.precision, spec.precisionLen);
+        }
+        if (record->argTypes[argIdx] == ARG_SIGNED || record->argTypes[argIdx] == ARG_UNSIGNED)
+        {
+            if (spec.conv != 'c')
+            {
+                specStr[specLen++] = 'l';
+                specStr[specLen++] = 'l';
+            }
+        }
+        specStr[specLen++] = spec.conv;
+        specStr[specLen] = '\0';
+
+        int32_t written = 0;
+        switch (record->argTypes[argIdx])
+        {
+            case ARG_SIGNED:
+                if (spec.conv == 'c')
+                    written = snprintf(out + pos, size - pos, specStr, (int)record->args[argIdx].i);
+                else
+                    written = snprintf(out + pos, size - pos, specStr, (long long)record->args[argIdx].i);
+                break;
+            case ARG_UNSIGNED:
+                written = snprintf(out + pos, size - pos, specStr, (unsigned long long)record->args[argIdx].u);
+                break;
+            case ARG_DOUBLE:
+                written = snprintf(out + pos, size - pos, specStr, record->args[argIdx].d);
+                break;
+            case ARG_STRING:
+                written = snprintf(out + pos, size - pos, specStr, record->strings + record->args[argIdx].u);
+                break;
+            case ARG_POINTER:
+                written = snprintf(out + pos, size - pos, specStr, record->args[argIdx].p);
+                break;
+            default:
+                break;
+        }
+        argIdx++;
+        if (written > 0)
+            pos += ((uint32_t)written < size - pos) ? (uint32_t)written : size - pos - 1;
+        str = spec.end;
+    }
+
+    // glog ends every message with a new line
+    while (pos > 0 && out[pos - 1] == '\n')
+        pos--;
+    out[pos] = '\0';
+}
+
+static void GlogSink(LogLevel logLevel, const char *sourceFile, uint64_t line, const char *message)
+{
+    google::LogSeverity severity = google::INFO;
+    if (logLevel == LOG_WARNING)
+        severity = google::WARNING;
+    else if (logLevel == LOG_ERROR)
+        severity = google::ERROR;
+    else if (logLevel == LOG_FATAL)
+        severity = google::FATAL;
+
+    google::LogMessage(sourceFile, (int)line, severity).stream() << message;
+}
+
+//!
+//! \class: AsyncLogger
+//! \brief: bounded multi-producer ring of log records drained by one thread
+//!
+class AsyncLogger
+{
+public:
+    AsyncLogger() : m_capacity(0), m_enqueuePos(0), m_dequeuePos(0), m_running(false), m_sleeping(false), m_dropped(0),
+                    m_sink(GlogSink), m_users(0) {};
+
+    ~AsyncLogger()
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_users = 0;
+        Shutdown();
+    };
+
+    // every start takes one reference, the thread runs until the last stop
+    int32_t Start(uint32_t queueSize)
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        m_users++;
+        if (m_running.load())
+            return ERROR_NONE;
+
+        // the ring is kept until exit, producers may still hold a slot
+        if (!m_records)
+        {
+            uint64_t capacity = 2;
+            while (capacity < (queueSize ? queueSize : ASYNC_LOG_DEFAULT_QUEUE))
+                capacity <<= 1;
+            m_records.reset(new LogRecord[capacity]);
+            for (uint64_t i = 0; i < capacity; i++)
+                m_records[i].sequence.store(i, std::memory_order_relaxed);
+            m_capacity = capacity;
+        }
+
+        m_running.store(true);
+        m_thread = std::thread(&AsyncLogger::Run, this);
+        return ERROR_NONE;
+    };
+
+    void Stop()
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (m_users == 0 || --m_users > 0)
+            return;
+
+        Shutdown();
+    };
+
+    void Log(LogLevel logLevel, const char *sourceFile, uint64_t line, const char *fmt, va_list params)
+    {
+        if (logLevel != LOG_FATAL && m_running.load(std::memory_order_relaxed))
+        {
+            uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            LogRecord *record = NULL;
+            for (;;)
+            {
+                record = &m_records[pos & (m_capacity - 1)];
+                uint64_t seq = record->sequence.load(std::memory_order_acquire);
+                int64_t diff = (int64_t)seq - (int64_t)pos;
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            record->level = logLevel;
+            record->sourceFile = sourceFile;
+            record->line = line;
+            record->fmt = fmt;
+            CaptureArgs(record, params);
+            record->sequence.store(pos + 1, std::memory_order_release);
+
+            // pairs with the fence in Run, either the writer sees the record
+            // before it sleeps or it is woken here
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_sleeping.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+                m_wakeCv.notify_one();
+            }
+            return;
+        }
+
+        // fatal records and the calls before start are written at once
+        LogRecord record;
+        record.level = logLevel;
+        record.sourceFile = sourceFile;
+        record.line = line;
+        record.fmt = fmt;
+        CaptureArgs(&record, params);
+        Write(&record);
+    };
+
+    uint64_t GetDroppedNum() { return m_dropped.load(); };
+
+    void SetSink(AsyncLogSink sink) { m_sink.store(sink ? sink : GlogSink); };
+
+private:
+    void Run()
+    {
+        while (m_running.load())
+        {
+            if (WriteOne())
+                continue;
+
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_wakeCv.wait(lock, [this]() { return !m_running.load() || HasRecord(); });
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    // called with m_controlMutex held
+    void Shutdown()
+    {
+        if (!m_running.load())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_running.store(false);
+            m_wakeCv.notify_one();
+        }
+        if (m_thread.joinable())
+            m_thread.join();
+        while (WriteOne())
+        {
+        }
+    };
+
+    bool HasRecord()
+    {
+        if (!m_records)
+            return false;
+
+        LogRecord *record = &m_records[m_dequeuePos & (m_capacity - 1)];
+        return record->sequence.load(std::memory_order_acquire) == m_dequeuePos + 1;
+    };
+
+    bool WriteOne()
+    {
+        if (!HasRecord())
+            return false;
+
+        LogRecord *record = &m_records[m_dequeuePos & (m_capacity - 1)];
+        Write(record);
+        record->sequence.store(m_dequeuePos + m_capacity, std::memory_order_release);
+        m_dequeuePos++;
+        return true;
+    };
+
+    void Write(const LogRecord *record)
+    {
+        char message[ASYNC_LOG_LINE_BYTES];
+        FormatRecord(record, message, ASYNC_LOG_LINE_BYTES);
+        m_sink.load()(record->level, record->sourceFile, record->line, message);
+    };
+
+    std::unique_ptr<LogRecord[]> m_records;
+    uint64_t                     m_capacity;
+    std::atomic<uint64_t>        m_enqueuePos;
+    uint64_t                     m_dequeuePos;  //<! only used by the writing thread
+    std::atomic<bool>            m_running;
+    std::atomic<bool>            m_sleeping;    //<! the writing thread waits on m_wakeCv
+    std::atomic<uint64_t>        m_dropped;
+    std::atomic<AsyncLogSink>    m_sink;
+    std::thread                  m_thread;
+    std::mutex                   m_controlMutex;
+    uint32_t                     m_users;       //<! starts not stopped yet, protected by m_controlMutex
+    std::mutex                   m_wakeMutex;
+    std::condition_variable      m_wakeCv;
+};
+
+static AsyncLogger& GetAsyncLogger()
+{
+    static AsyncLogger logger;
+    return logger;
+}
+
+void AsyncLogFunction(LogLevel logLevel, const char *sourceFile, uint64_t line, const char *fmt, ...)
+{
+    if (!fmt)
+        return;
+
+    va_list params;
+    va_start(params, fmt);
+    GetAsyncLogger().Log(logLevel, sourceFile, line, fmt, params);
+    va_end(params);
+}
+
+int32_t StartAsyncLog(uint32_t queueSize)
+{
+    return GetAsyncLogger().Start(queueSize);
+}
+
+void StopAsyncLog()
+{
+    GetAsyncLogger().Stop();
+}
+
+uint64_t GetAsyncLogDroppedNum()
+{
+    return GetAsyncLogger().GetDroppedNum();
+}
+
+void SetAsyncLogSink(AsyncLogSink sink)
+{
+    GetAsyncLogger().SetSink(sink);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020, Intel Corporation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+ *
+ */
+
+//!
+//! \file:   AsyncLog.h
+//! \brief:  Asynchronous logging backend declaration
+//! \detail: AsyncLogFunction has the LogFunction signature and can be set
+//!          as logCallBack. It only captures the format pointer, the source
+//!          location and the raw argument words into a lock-free ring, and a
+//!          background thread formats the records and writes them to glog.
+//!          The format and the source file must be string literals, "%s"
+//!          arguments are copied into the record.
+//!
+
+#ifndef _ASYNCLOG_H_
+#define _ASYNCLOG_H_
+
+#include "Log.h"
+
+#include <stdint.h>
+
+//!
+//! \brief  the writer of one formatted log line, glog by default
+//!
+typedef void (*AsyncLogSink)(LogLevel logLevel, const char* sourceFile, uint64_t line, const char* message);
+
+//!
+//! \brief  Capture one log record into the ring, the arguments are formatted
+//!         later on the background thread. Records are dropped, not waited
+//!         for, when the ring is full. LOG_FATAL is written synchronously
+//!
+//! \param  [in] logLevel
+//!         the level of the logging
+//! \param  [in] sourceFile
+//!         the source file name where log information comes from
+//! \param  [in] line
+//!         the line number the output log information in source file
+//! \param  [in] fmt
+//!         the printf style format
+//!
+//! \return void
+//!
+void AsyncLogFunction(LogLevel logLevel, const char* sourceFile, uint64_t line, const char* fmt, ...);
+
+//!
+//! \brief  Start the background thread of the asynchronous logging, every
+//!         start must be paired with one StopAsyncLog
+//!
+//! \param  [in] queueSize
+//!         the number of records in the ring, rounded up to a power of two
+//!
+//! \return int32_t
+//!         ERROR_NONE if success, else failed reason
+//!
+int32_t StartAsyncLog(uint32_t queueSize);
+
+//!
+//! \brief  Release one start, the last one writes all captured records and
+//!         stops the background thread. Records logged after that are
+//!         written synchronously
+//!
+//! \return void
+//!
+void StopAsyncLog();
+
+//!
+//! \brief  Get the number of records dropped because the ring was full
+//!
+//! \return uint64_t
+//!
+uint64_t GetAsyncLogDroppedNum();
+
+//!
+//! \brief  Replace the writer of the formatted lines, nullptr for glog
+//!
+//! \return void
+//!
+void SetAsyncLogSink(AsyncLogSink sink);
+
+#endif /* _ASYNCLOG_H_ */
@@ -35,3 +35,4 @@
 
 
 LogFunction logCallBack = GlogFunction;
+LogLevel logMinLevel = LOG_INFO;
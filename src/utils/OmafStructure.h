@@ -48,6 +48,10 @@ VCD_OMAF_BEGIN
 #define HEVC_NALUHEADER_LEN                     2 //<! the number of bytes for HEVC NALU Header
 #define DASH_SAMPLELENFIELD_SIZE                4 //<! the number of bytes for DASH sample length field
 
+#define PACKED_TILES_INDEX_TYPE                 "ptix" //<! box type of the tile index in a packed tiles segment
+#define PACKED_TILES_INDEX_HEADER_SIZE          16 //<! box size, type, version and flags, entry count
+#define PACKED_TILES_INDEX_ENTRY_SIZE           12 //<! track id, offset and size of one tile segment
+
 #define HEVC_SPS_NALU_TYPE                      33
 
 #define HEVC_PPS_NALU_TYPE                      34
@@ -75,6 +79,7 @@ VCD_OMAF_BEGIN
 #define SCHEMEIDURI_SRD                         "urn:mpeg:dash:srd:2014"
 #define SCHEMEIDURI_PRESELECTION                "urn:mpeg:dash:preselection:2016"
 #define SCHEMEIDURI_AUDIO                       "urn:mpeg:dash:23003:3:audio_channel_configuration:2011"
+#define SCHEMEIDURI_PACKED_TILES                "urn:intel:omaf:packed-tiles:2020"
 #define OMAF_XMLNS_VALUE                        "urn:mpeg:mpegI:omaf:2017"
 #define XSI_XMLNS_VALUE                         "null"
 #define XMLNS_VALUE                             "urn:mpeg:dash:schema:mpd:2011"
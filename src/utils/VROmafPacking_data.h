@@ -144,6 +144,7 @@ typedef struct SegmentationInfo
     bool          isLive;
     int32_t       splitTile;
     bool          hasMainAS;
+    bool          packTileSegments; //whether to also pack segments of all tiles of one video into one indexed segment
 }SegmentationInfo;
 
 //!
@@ -87,12 +87,81 @@ typedef struct SOURCERESOLUTION {
 /*
  * avg_bandwidth : average bandwidth since the begin of downloading
  * immediate_bandwidth: immediate bandwidth at the moment
+ * prefetch_bytes : bytes downloaded for tiles prefetched by viewport prediction
+ * prefetch_wasted_bytes : prefetched bytes of tiles which were never selected
+ * prefetch_hit_tiles : prefetched tile segments which were selected afterwards
+ * new_connections : connections opened by finished segment downloads
+ * reused_connections : finished segment downloads served over an existing connection
+ * cache_hits : segment opens served by the segment cache, from memory or spilled files
+ * cache_misses : segment opens which needed the download
+ * cache_bytes : bytes of segments kept in memory by the segment cache
  */
 typedef struct DASHSTATISTICINFO {
   int32_t avg_bandwidth;
   int32_t immediate_bandwidth;
+  uint64_t prefetch_bytes;
+  uint64_t prefetch_wasted_bytes;
+  uint32_t prefetch_hit_tiles;
+  uint64_t new_connections;
+  uint64_t reused_connections;
+  uint64_t cache_hits;
+  uint64_t cache_misses;
+  uint64_t cache_bytes;
 } DashStatisticInfo;
 
+/*
+ * summary of one latency histogram, all values in microseconds
+ * count : samples recorded
+ * mean_us / max_us : mean and maximum of the samples
+ * p50_us / p90_us / p99_us : percentiles, within the bucket precision (about 6%)
+ */
+typedef struct LATENCYSUMMARY {
+  uint64_t count;
+  uint64_t mean_us;
+  uint64_t p50_us;
+  uint64_t p90_us;
+  uint64_t p99_us;
+  uint64_t max_us;
+} LatencySummary;
+
+/*
+ * segments_downloaded / download_failures : finished and failed segment downloads
+ * downloaded_bytes : bytes of the finished segment downloads
+ * segments_parsed / parse_failures : segments parsed into packets or failed in parse
+ * viewport_changes : poses passed to OmafAccess_ChangeViewport
+ * tile_selections : track selections done for new segments
+ * stitched_frames : frames merged from the selected tiles
+ * packets_output : packets returned by OmafAccess_GetPacket
+ * last_segment_bandwidth : bits per second of the last finished segment download
+ * buffer_level_ms : media duration parsed and not consumed yet
+ * download_latency : from the segment request to the end of its download
+ * parse_latency : parse of one segment into packets
+ * selection_latency : track selection for one segment
+ * stitch_latency : tile merge of one frame
+ * get_packet_latency : one call of OmafAccess_GetPacket
+ * motion_to_hq_latency : from a viewport change to the first packet of the
+ *                        segments selected after it
+ */
+typedef struct DASHMETRICSINFO {
+  uint64_t segments_downloaded;
+  uint64_t download_failures;
+  uint64_t downloaded_bytes;
+  uint64_t segments_parsed;
+  uint64_t parse_failures;
+  uint64_t viewport_changes;
+  uint64_t tile_selections;
+  uint64_t stitched_frames;
+  uint64_t packets_output;
+  int64_t last_segment_bandwidth;
+  int64_t buffer_level_ms;
+  LatencySummary download_latency;
+  LatencySummary parse_latency;
+  LatencySummary selection_latency;
+  LatencySummary stitch_latency;
+  LatencySummary get_packet_latency;
+  LatencySummary motion_to_hq_latency;
+} DashMetricsInfo;
+
 /*
  * stream_type : Video or Audio stream
  * height : the height of original video
@@ -143,6 +212,21 @@ typedef struct DASHMEDIAINFO {
   DashStreamInfo stream_info[16];
 } DashMediaInfo;
 
+/*
+ * the region wise packing and the source resolutions shared by all the packets with one layout,
+ * immutable and reference counted
+ * rwpk / numQuality / qtyResolution : the metadata, read only
+ * retain : adds a reference for a new holder of the metadata
+ * release : drops a reference, the metadata is freed with the last one
+ */
+typedef struct DASHPACKETMETA {
+  RegionWisePacking* rwpk;
+  int32_t numQuality;
+  SourceResolution* qtyResolution;
+  void (*retain)(struct DASHPACKETMETA* meta);
+  void (*release)(struct DASHPACKETMETA* meta);
+} DashPacketMeta;
+
 typedef struct DASHPACKET {
   uint32_t videoID;
   Codec_Type video_codec;
@@ -158,6 +242,7 @@ typedef struct DASHPACKET {
   uint32_t tileRowNum;              //! til row after aggregation
   uint32_t tileColNum;              //! til row after aggregation
   bool bEOS;
+  DashPacketMeta* meta;             //! the reference rwpk and qtyResolution point into, NULL if the packet owns them
 } DashPacket;
 
 typedef enum {